@@ -0,0 +1,82 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_BENCH_H
+#define GGP_BENCH_H
+
+#include <glib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Each benchmark source is compiled without the plugin, with the
+ * lowering enabled and, if the runtime library is built, with the
+ * calls redirected to the format programs. All the binaries run the
+ * same cases. The calls with the "expect:" comments must be rewritten
+ * in the listed ways. */
+
+/* Benchmarks with expensive cases define it before including the
+ * header. */
+#ifndef BENCH_DEFAULT_ITERATIONS
+#define BENCH_DEFAULT_ITERATIONS 1000000
+#endif
+
+typedef void (*BenchFunc) (gpointer data);
+
+typedef struct
+{
+  const gchar *name;
+  BenchFunc func;
+  gpointer data;
+} BenchCase;
+
+static inline void
+bench_run (const BenchCase *cases,
+           gsize n_cases,
+           int argc,
+           char **argv)
+{
+  guint iterations = BENCH_DEFAULT_ITERATIONS;
+  gsize idx;
+
+  if (argc > 1)
+    iterations = (guint) strtoul (argv[1], NULL, 10);
+
+  for (idx = 0; idx < n_cases; ++idx)
+    {
+      const BenchCase *bench_case = &cases[idx];
+      gint64 start;
+      gint64 end;
+      guint iteration;
+
+      /* warm up */
+      for (iteration = 0; iteration < iterations / 10; ++iteration)
+        bench_case->func (bench_case->data);
+
+      start = g_get_monotonic_time ();
+      for (iteration = 0; iteration < iterations; ++iteration)
+        bench_case->func (bench_case->data);
+      end = g_get_monotonic_time ();
+
+      printf ("%-32s %10.1f ns/op\n",
+              bench_case->name,
+              (end - start) * 1000.0 / iterations);
+    }
+}
+
+#endif /* GGP_BENCH_H */
@@ -0,0 +1,152 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks g_variant_get calls with constant formats, unpacking
+ * serialized values like the ones coming in D-Bus messages. */
+
+#include "bench.h"
+
+static void
+get_borrowed (gpointer data)
+{
+  const gchar *name;
+  const gchar *old_owner;
+  const gchar *new_owner;
+
+  /* like org.freedesktop.DBus.NameOwnerChanged */
+  g_variant_get ((GVariant *) data, "(&s&s&s)", &name, &old_owner, &new_owner); /* expect: lowered program */
+}
+
+static void
+get_duplicated (gpointer data)
+{
+  gchar *name;
+  gchar *old_owner;
+  gchar *new_owner;
+
+  g_variant_get ((GVariant *) data, "(sss)", &name, &old_owner, &new_owner); /* expect: lowered program */
+  g_free (name);
+  g_free (old_owner);
+  g_free (new_owner);
+}
+
+static void
+get_fixed (gpointer data)
+{
+  guint32 serial;
+  guint32 flags;
+  gboolean allowed;
+
+  g_variant_get ((GVariant *) data, "(uub)", &serial, &flags, &allowed); /* expect: lowered program */
+}
+
+static void
+get_all_basic (gpointer data)
+{
+  gboolean b;
+  guchar y;
+  gint16 n;
+  guint16 q;
+  gint32 i;
+  guint32 u;
+  gint64 x;
+  guint64 t;
+  gint32 h;
+  gdouble d;
+
+  g_variant_get ((GVariant *) data, "(bynqiuxthd)", &b, &y, &n, &q, &i, &u, &x, &t, &h, &d); /* expect: lowered program */
+}
+
+static void
+get_signal_args (gpointer data)
+{
+  const gchar *interface_name;
+  const gchar *path;
+  const gchar *property;
+  GVariant *value;
+
+  g_variant_get ((GVariant *) data, "(&s&o(&sv))", &interface_name, &path, &property, &value); /* expect: lowered program */
+  g_variant_unref (value);
+}
+
+static void
+get_child (gpointer data)
+{
+  const gchar *path;
+
+  g_variant_get_child ((GVariant *) data, 1, "&o", &path); /* expect: lowered program */
+}
+
+/* Values coming from D-Bus are serialized and not trusted. */
+static GVariant *
+serialize (GVariant *value)
+{
+  GVariant *serialized;
+
+  g_variant_ref_sink (value);
+  serialized = g_variant_new_from_data (g_variant_get_type (value),
+                                        g_memdup2 (g_variant_get_data (value), g_variant_get_size (value)),
+                                        g_variant_get_size (value),
+                                        FALSE,
+                                        g_free,
+                                        NULL);
+  g_variant_unref (value);
+
+  return g_variant_ref_sink (serialized);
+}
+
+int
+main (int argc,
+      char **argv)
+{
+  GVariant *owner_changed = serialize (g_variant_new ("(sss)", "org.example.Name", "", ":1.42"));
+  GVariant *fixed = serialize (g_variant_new ("(uub)", 17u, 4u, TRUE));
+  GVariant *all_basic = serialize (g_variant_new ("(bynqiuxthd)",
+                                                  TRUE,
+                                                  (guchar) 1,
+                                                  (gint16) -2,
+                                                  (guint16) 3,
+                                                  (gint32) -4,
+                                                  (guint32) 5,
+                                                  (gint64) -6,
+                                                  (guint64) 7,
+                                                  (gint32) 0,
+                                                  8.5));
+  GVariant *signal_args = serialize (g_variant_new ("(so(sv))",
+                                                    "org.example.Interface",
+                                                    "/org/example/Object",
+                                                    "Property",
+                                                    g_variant_new_string ("value")));
+  const BenchCase cases[] = {
+    { "g_variant_get (\"(&s&s&s)\")", get_borrowed, owner_changed },
+    { "g_variant_get (\"(sss)\")", get_duplicated, owner_changed },
+    { "g_variant_get (\"(uub)\")", get_fixed, fixed },
+    { "g_variant_get (\"(bynqiuxthd)\")", get_all_basic, all_basic },
+    { "g_variant_get (\"(&s&o(&sv))\")", get_signal_args, signal_args },
+    { "g_variant_get_child (\"&o\")", get_child, signal_args },
+  };
+
+  bench_run (cases, G_N_ELEMENTS (cases), argc, argv);
+
+  g_variant_unref (owner_changed);
+  g_variant_unref (fixed);
+  g_variant_unref (all_basic);
+  g_variant_unref (signal_args);
+
+  return 0;
+}
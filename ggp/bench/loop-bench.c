@@ -0,0 +1,151 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks g_variant_builder_add and g_variant_iter_next calls with
+ * constant formats in loops over many children. */
+
+#define BENCH_DEFAULT_ITERATIONS 1000
+
+#include "bench.h"
+
+#define N_ENTRIES 1000
+
+static void
+builder_add_entries (gpointer data)
+{
+  GVariantBuilder builder;
+  guint idx;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  for (idx = 0; idx < N_ENTRIES; ++idx)
+    g_variant_builder_add (&builder, "{sv}", (const gchar *) data, g_variant_new_uint32 (idx)); /* expect: lowered program */
+  g_variant_unref (g_variant_ref_sink (g_variant_builder_end (&builder)));
+}
+
+static void
+builder_add_pairs (gpointer data)
+{
+  GVariantBuilder builder;
+  guint idx;
+
+  (void) data;
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(uu)"));
+  for (idx = 0; idx < N_ENTRIES; ++idx)
+    g_variant_builder_add (&builder, "(uu)", idx, idx * 2); /* expect: lowered program */
+  g_variant_unref (g_variant_ref_sink (g_variant_builder_end (&builder)));
+}
+
+static void
+iter_next_entries (gpointer data)
+{
+  GVariantIter iter;
+  const gchar *key;
+  GVariant *value;
+
+  g_variant_iter_init (&iter, (GVariant *) data);
+  while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) /* expect: lowered */
+    g_variant_unref (value);
+}
+
+static void
+iter_next_pairs (gpointer data)
+{
+  GVariantIter iter;
+  guint32 first;
+  guint32 second;
+  guint64 sum = 0;
+
+  g_variant_iter_init (&iter, (GVariant *) data);
+  while (g_variant_iter_next (&iter, "(uu)", &first, &second)) /* expect: lowered */
+    sum += first + second;
+  if (sum == 0)
+    abort ();
+}
+
+/* Values coming from D-Bus are serialized and not trusted. */
+static GVariant *
+build_serialized (const gchar *type,
+                  void (*build) (GVariantBuilder *builder))
+{
+  GVariantBuilder builder;
+  GVariant *value;
+  GVariant *serialized;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (type));
+  build (&builder);
+  value = g_variant_ref_sink (g_variant_builder_end (&builder));
+  serialized = g_variant_new_from_data (g_variant_get_type (value),
+                                        g_memdup2 (g_variant_get_data (value), g_variant_get_size (value)),
+                                        g_variant_get_size (value),
+                                        FALSE,
+                                        g_free,
+                                        NULL);
+  g_variant_unref (value);
+
+  return g_variant_ref_sink (serialized);
+}
+
+static void
+build_entries (GVariantBuilder *builder)
+{
+  guint idx;
+
+  for (idx = 0; idx < N_ENTRIES; ++idx)
+    {
+      gchar *key = g_strdup_printf ("key%u", idx);
+
+      g_variant_builder_add_value (builder,
+                                   g_variant_new_dict_entry (g_variant_new_string (key),
+                                                             g_variant_new_variant (g_variant_new_uint32 (idx))));
+      g_free (key);
+    }
+}
+
+static void
+build_pairs (GVariantBuilder *builder)
+{
+  guint idx;
+
+  for (idx = 0; idx < N_ENTRIES; ++idx)
+    {
+      GVariant *children[] = { g_variant_new_uint32 (idx), g_variant_new_uint32 (idx * 2) };
+
+      g_variant_builder_add_value (builder, g_variant_new_tuple (children, G_N_ELEMENTS (children)));
+    }
+}
+
+int
+main (int argc,
+      char **argv)
+{
+  GVariant *entries = build_serialized ("a{sv}", build_entries);
+  GVariant *pairs = build_serialized ("a(uu)", build_pairs);
+  const BenchCase cases[] = {
+    { "g_variant_builder_add (\"{sv}\") x1000", builder_add_entries, "key" },
+    { "g_variant_builder_add (\"(uu)\") x1000", builder_add_pairs, NULL },
+    { "g_variant_iter_next (\"{&sv}\") x1000", iter_next_entries, entries },
+    { "g_variant_iter_next (\"(uu)\") x1000", iter_next_pairs, pairs },
+  };
+
+  bench_run (cases, G_N_ELEMENTS (cases), argc, argv);
+
+  g_variant_unref (entries);
+  g_variant_unref (pairs);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks g_variant_new calls with constant formats. */
+
+#include "bench.h"
+
+static void
+new_isu (gpointer data)
+{
+  GVariant *value = g_variant_new ("(isu)", 42, (const gchar *) data, 17u); /* expect: lowered program */
+
+  g_variant_unref (g_variant_ref_sink (value));
+}
+
+static void
+new_all_basic (gpointer data)
+{
+  GVariant *value = g_variant_new ("(bynqiuxthd)", /* expect: lowered program */
+                                   TRUE,
+                                   (guchar) 1,
+                                   (gint16) -2,
+                                   (guint16) 3,
+                                   (gint32) -4,
+                                   (guint32) 5,
+                                   (gint64) -6,
+                                   (guint64) 7,
+                                   (gint32) 0,
+                                   8.5);
+
+  (void) data;
+  g_variant_unref (g_variant_ref_sink (value));
+}
+
+static void
+new_entry (gpointer data)
+{
+  GVariant *value = g_variant_new ("{sv}", /* expect: lowered program */
+                                   (const gchar *) data,
+                                   g_variant_new_uint32 (42));
+
+  g_variant_unref (g_variant_ref_sink (value));
+}
+
+static void
+new_signal_args (gpointer data)
+{
+  /* like org.freedesktop.DBus.Properties.PropertiesChanged without
+   * the arrays */
+  GVariant *value = g_variant_new ("(so(sv))", /* expect: lowered program */
+                                   "org.example.Interface",
+                                   "/org/example/Object",
+                                   (const gchar *) data,
+                                   g_variant_new_string ("value"));
+
+  g_variant_unref (g_variant_ref_sink (value));
+}
+
+static void
+new_constant_reply (gpointer data)
+{
+  /* all the parameters are literals */
+  GVariant *value = g_variant_new ("(sou)", /* expect: lowered program */
+                                   "org.example.Name",
+                                   "/org/example/Object",
+                                   1u);
+
+  (void) data;
+  g_variant_unref (g_variant_ref_sink (value));
+}
+
+static void
+new_string (gpointer data)
+{
+  GVariant *value = g_variant_new ("s", (const gchar *) data); /* expect: lowered program */
+
+  g_variant_unref (g_variant_ref_sink (value));
+}
+
+int
+main (int argc,
+      char **argv)
+{
+  static const BenchCase cases[] = {
+    { "g_variant_new (\"(isu)\")", new_isu, "foo" },
+    { "g_variant_new (\"(bynqiuxthd)\")", new_all_basic, NULL },
+    { "g_variant_new (\"{sv}\")", new_entry, "key" },
+    { "g_variant_new (\"(so(sv))\")", new_signal_args, "Property" },
+    { "g_variant_new (\"(sou)\")", new_constant_reply, NULL },
+    { "g_variant_new (\"s\")", new_string, "foo" },
+  };
+
+  bench_run (cases, G_N_ELEMENTS (cases), argc, argv);
+
+  return 0;
+}
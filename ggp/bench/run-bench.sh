@@ -0,0 +1,135 @@
+#!/bin/bash
+
+set -e
+
+compiler=''
+plugin=''
+input_file=''
+iterations=''
+preload=''
+runtime=''
+
+parse_options() {
+    local default_compiler="${compiler}"
+    local default_plugin="${plugin}"
+    local default_input_file="${input_file}"
+    local default_iterations="${iterations}"
+    local default_preload="${preload}"
+    local default_runtime="${runtime}"
+
+    while [[ -n "${1}" ]]; do
+        case "${1}" in
+            --compiler)
+                compiler="${2}"
+                shift 2
+                ;;
+            --help)
+                cat <<HELP
+Usage: $0 [FLAGS]
+FLAGS:
+--compiler <COMPILER> - GNU C compiler to use for compiling the benchmark, default: ${default_compiler}
+--help - prints this message and quits
+--input-file <FILE> - benchmark source file, default: ${default_input_file}
+--iterations <COUNT> - how many times each case is run, default: ${default_iterations}
+--plugin <PLUGIN> - a path to the compiler plugin, default: ${default_plugin}
+--preload <LIBRARY> - a path to the format program cache library, the plain binary is also run with it preloaded if given, default: ${default_preload}
+--runtime <LIBRARY> - a path to the runtime library for the format programs, a binary with the calls redirected to the programs is also run if given, default: ${default_runtime}
+HELP
+                exit 0
+                ;;
+            --input-file)
+                input_file="${2}"
+                shift 2
+                ;;
+            --iterations)
+                iterations="${2}"
+                shift 2
+                ;;
+            --plugin)
+                plugin="${2}"
+                shift 2
+                ;;
+            --preload)
+                preload="${2}"
+                shift 2
+                ;;
+            --runtime)
+                runtime="${2}"
+                shift 2
+                ;;
+            *=*)
+                echo "--foo=bar flags are not supported, use --foo bar"
+                exit 1
+                ;;
+            *)
+                echo "unknown flag ${1}, use --help to get help" >&2
+                exit 1
+                ;;
+        esac
+    done
+
+    if [ -z "${compiler}" ]; then
+        echo "Compiler not specified" >&2
+        exit 1
+    fi
+    if [ -z "${plugin}" ]; then
+        echo "Plugin not specified" >&2
+        exit 1
+    fi
+    if [ -z "${input_file}" ]; then
+        echo "Input file not specified" >&2
+        exit 1
+    fi
+}
+
+# Fails if any of the calls with the "expect:" comments listing the
+# given way of rewriting them was not reported by the plugin in the
+# -fopt-info file, the benchmark would time the GLib calls then.
+check_rewritten() {
+    local way="${1}"
+    local opt_info_file="${2}"
+    local verb="${3}"
+    local missing
+
+    missing=$(comm -23 \
+                   <(grep -n "/\* expect:.*\b${way}\b.*\*/" "${input_file}" | cut -d: -f1 | sort) \
+                   <(sed -n "s/^[^:]*:\([0-9]*\):[0-9]*: optimized: ${verb} .*$/\1/p" "${opt_info_file}" | sort -u))
+    if [ -n "${missing}" ]; then
+        # shellcheck disable=SC2086
+        echo "The calls in lines" ${missing} "were not ${verb}" >&2
+        exit 1
+    fi
+}
+
+parse_options "${@}"
+
+input_file="${MESON_SOURCE_ROOT}/${MESON_SUBDIR}/${input_file}"
+output_dir="${MESON_BUILD_ROOT}/${MESON_SUBDIR}/$(basename "${input_file}" .c).dir"
+plugin_name=$(basename "${plugin}" .so)
+glib_flags=$(pkg-config --cflags --libs glib-2.0)
+
+mkdir -p "${output_dir}"
+
+# shellcheck disable=SC2086
+"${compiler}" -O2 -o "${output_dir}/plain" "${input_file}" ${glib_flags}
+# shellcheck disable=SC2086
+"${compiler}" -O2 "-fplugin=${plugin}" "-fplugin-arg-${plugin_name}-lower" "-fopt-info-optimized=${output_dir}/lowered.opt" -o "${output_dir}/lowered" "${input_file}" ${glib_flags}
+check_rewritten lowered "${output_dir}/lowered.opt" lowered
+if [ -n "${runtime}" ]; then
+    # shellcheck disable=SC2086
+    "${compiler}" -O2 "-fplugin=${plugin}" "-fplugin-arg-${plugin_name}-lower-programs" "-fopt-info-optimized=${output_dir}/programs.opt" -o "${output_dir}/programs" "${input_file}" "${runtime}" "-Wl,-rpath,$(dirname "${runtime}")" ${glib_flags}
+    check_rewritten program "${output_dir}/programs.opt" redirected
+fi
+
+echo "plain:"
+"${output_dir}/plain" ${iterations}
+echo "lowered:"
+"${output_dir}/lowered" ${iterations}
+if [ -n "${runtime}" ]; then
+    echo "programs:"
+    "${output_dir}/programs" ${iterations}
+fi
+if [ -n "${preload}" ]; then
+    echo "plain with cache:"
+    LD_PRELOAD="${preload}" "${output_dir}/plain" ${iterations}
+fi
@@ -47,3 +47,71 @@ bar (void)
   GVariant *v = variant_new (33, "(iyyttssdddiiuuu)", /*0*/i, /*1*/c, /*2*/(guchar)(c), /*3*/(guint64)(c), /*4*/(guint64)42, /*5*/"foo", /*6*/s, /*7*/f, /*8*/d, /*9*/(gdouble)f, /*10*/c, /*11*/(gint32)c, /*12*/u, /*13*/c, /*14*/(guint32)c);
   //extern_variant_get (1, "(dms&st)", &d, NULL, &foo, (unsigned long long)5);
 }
+
+static void
+loop_invariant (int count)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    /* format and all the arguments are loop-invariant */
+    GVariant *v = variant_new (1, "(su)", "name", 0);
+    /* i changes on every iteration */
+    GVariant *w = variant_new (1, "(su)", "name", i);
+  }
+}
+
+static void
+variant_get (GVariant *v, const char *format, ...) __attribute__((glib_variant("get", 2, 3)));
+
+void g_free (void *mem);
+gchar *g_strdup (const gchar *str);
+void use_string (const gchar *str);
+
+static gchar *
+strings (GVariant *v)
+{
+  gchar *dup;
+  const gchar *borrowed;
+
+  /* dup is only read and freed, &s would do */
+  variant_get (v, "(s)", &dup);
+  use_string (dup);
+  g_free (dup);
+
+  /* borrowed is only copied, s would do */
+  variant_get (v, "(&s)", &borrowed);
+  return g_strdup (borrowed);
+}
+
+gchar *g_strdup_printf (const gchar *format, ...);
+
+static GVariant *
+take_string (int id)
+{
+  gchar *name = g_strdup_printf ("item-%d", id);
+  /* name is copied and then freed, g_variant_new_take_string would do */
+  GVariant *v = variant_new (1, "(s)", name);
+
+  g_free (name);
+  return v;
+}
+
+/* gets the glib_variant attribute from the plugin */
+gboolean g_variant_lookup (GVariant *dictionary, const gchar *key, const gchar *format_string, ...);
+
+static void
+lookups (GVariant *props, const gchar **keys)
+{
+  gint32 a, b, c, d;
+  const gchar *s;
+
+  /* more than three lookups in the same dictionary */
+  g_variant_lookup (props, "a", "i", &a);
+  g_variant_lookup (props, "b", "i", &b);
+  g_variant_lookup (props, "c", "i", &c);
+  g_variant_lookup (props, "d", "i", &d);
+
+  /* a lookup in the same dictionary on every iteration */
+  for (; *keys != NULL; ++keys)
+    g_variant_lookup (props, *keys, "&s", &s);
+}
@@ -0,0 +1,136 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/args.hh"
+
+#include <limits>
+#include <string_view>
+
+namespace Ggp::Gcc
+{
+
+auto
+get_plugin_arg (struct plugin_name_args* plugin_info,
+                char const* key) -> std::optional<std::string>
+{
+  for (auto idx {0}; idx < plugin_info->argc; ++idx)
+  {
+    auto const& arg {plugin_info->argv[idx]};
+
+    if (strcmp (arg.key, key) != 0)
+    {
+      continue;
+    }
+    if (arg.value == nullptr)
+    {
+      return {""};
+    }
+
+    return {arg.value};
+  }
+
+  return {};
+}
+
+auto
+get_plugin_arg_uint (struct plugin_name_args* plugin_info,
+                     char const* key,
+                     unsigned default_value) -> unsigned
+{
+  auto maybe_value {get_plugin_arg (plugin_info, key)};
+
+  if (!maybe_value)
+  {
+    return default_value;
+  }
+
+  auto const& value {*maybe_value};
+
+  if (value.empty () ||
+      value.size () > std::numeric_limits<unsigned>::digits10 ||
+      !std::all_of (value.cbegin (), value.cend (), [](char c) { return c >= '0' && c <= '9'; }))
+  {
+    error ("expected a number as a value of %s plugin argument, got %qs", key, value.c_str ());
+    return default_value;
+  }
+
+  return static_cast<unsigned> (std::stoul (value));
+}
+
+auto
+get_plugin_arg_bool (struct plugin_name_args* plugin_info,
+                     char const* key,
+                     bool default_value) -> bool
+{
+  auto maybe_value {get_plugin_arg (plugin_info, key)};
+
+  if (!maybe_value)
+  {
+    return default_value;
+  }
+
+  auto const& value {*maybe_value};
+
+  if (value.empty () || value == "yes" || value == "1")
+  {
+    return true;
+  }
+  if (value == "no" || value == "0")
+  {
+    return false;
+  }
+
+  error ("expected yes or no as a value of %s plugin argument, got %qs", key, value.c_str ());
+
+  return default_value;
+}
+
+auto
+get_plugin_arg_list (struct plugin_name_args* plugin_info,
+                     char const* key) -> std::vector<std::string>
+{
+  std::vector<std::string> values;
+
+  for (auto idx {0}; idx < plugin_info->argc; ++idx)
+  {
+    auto const& arg {plugin_info->argv[idx]};
+
+    if (strcmp (arg.key, key) != 0 || arg.value == nullptr)
+    {
+      continue;
+    }
+
+    std::string_view list {arg.value};
+
+    while (!list.empty ())
+    {
+      auto const colon {list.find (':')};
+      auto const value {list.substr (0, colon)};
+
+      if (!value.empty ())
+      {
+        values.emplace_back (value);
+      }
+      list.remove_prefix ((colon == std::string_view::npos) ? list.size () : colon + 1);
+    }
+  }
+
+  return values;
+}
+
+} // namespace Ggp::Gcc
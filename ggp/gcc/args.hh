@@ -0,0 +1,62 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_GCC_ARGS_HH
+#define GGP_GCC_ARGS_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Ggp::Gcc
+{
+
+// Returns the value of the plugin argument passed as
+// -fplugin-arg-<plugin>-<key>=<value>. An argument passed without a
+// value gives an empty string.
+auto
+get_plugin_arg (struct plugin_name_args* plugin_info,
+                char const* key) -> std::optional<std::string>;
+
+// Like get_plugin_arg, but the value needs to be a non-negative
+// number. Reports an error and returns the default value if it is
+// not.
+auto
+get_plugin_arg_uint (struct plugin_name_args* plugin_info,
+                     char const* key,
+                     unsigned default_value) -> unsigned;
+
+// Like get_plugin_arg, but the value can be omitted or be one of
+// "yes", "no", "1", "0". Reports an error and returns the default
+// value if it is not.
+auto
+get_plugin_arg_bool (struct plugin_name_args* plugin_info,
+                     char const* key,
+                     bool default_value) -> bool;
+
+// Collects the colon-separated values of all the plugin arguments
+// with the key, empty values are skipped.
+auto
+get_plugin_arg_list (struct plugin_name_args* plugin_info,
+                     char const* key) -> std::vector<std::string>;
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_GCC_ARGS_HH */
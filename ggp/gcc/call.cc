@@ -0,0 +1,134 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/call.hh"
+
+namespace Ggp::Gcc
+{
+
+auto
+get_called_function_name (gcall const* call) -> char const*
+{
+  auto function_decl = gimple_call_fndecl (call);
+
+  if (function_decl == NULL_TREE || DECL_NAME (function_decl) == NULL_TREE)
+  {
+    return nullptr;
+  }
+
+  return IDENTIFIER_POINTER (DECL_NAME (function_decl));
+}
+
+auto
+get_arg_kind (tree arg) -> char
+{
+  auto const type {TREE_TYPE (arg)};
+
+  // Plain 0 or NULL defined as an integer is fine where a pointer is
+  // expected if it has the size of a pointer, but so is a 64-bit zero
+  // where a 64-bit integer is, so it gets a kind of its own.
+  if (integer_zerop (arg) && INTEGRAL_TYPE_P (type) && TYPE_PRECISION (type) == TYPE_PRECISION (ptr_type_node))
+  {
+    return '0';
+  }
+  if (INTEGRAL_TYPE_P (type))
+  {
+    if (TYPE_PRECISION (type) <= TYPE_PRECISION (integer_type_node))
+    {
+      return 'i';
+    }
+    if (TYPE_PRECISION (type) == 64)
+    {
+      return 'x';
+    }
+    return '?';
+  }
+  if (SCALAR_FLOAT_TYPE_P (type) && TYPE_PRECISION (type) == TYPE_PRECISION (double_type_node))
+  {
+    return 'd';
+  }
+  if (POINTER_TYPE_P (type))
+  {
+    return 'p';
+  }
+
+  return '?';
+}
+
+auto
+make_variant_call (gcall* call,
+                   FormatInfo const& info) -> std::optional<VariantCall>
+{
+  auto const name = get_called_function_name (call);
+  auto const args_count = gimple_call_num_args (call);
+  if (name == nullptr || args_count < info.string_index)
+  {
+    return {};
+  }
+
+  auto const format = get_string_literal (gimple_call_arg (call, info.string_index - 1));
+  std::vector<tree> args;
+
+  for (auto idx {info.args_index}; idx <= args_count; ++idx)
+  {
+    args.push_back (gimple_call_arg (call, idx - 1));
+  }
+
+  return {{name, call, info, format, std::move (args)}};
+}
+
+auto
+get_variant_call (gimple* stmt) -> std::optional<VariantCall>
+{
+  auto call = dyn_cast<gcall*> (stmt);
+  if (call == nullptr)
+  {
+    return {};
+  }
+
+  auto function_decl = gimple_call_fndecl (call);
+  auto attribute = get_glib_variant_attribute (function_decl);
+  if (attribute == NULL_TREE)
+  {
+    return {};
+  }
+
+  return make_variant_call (call, must_get_format_info_from_args (TREE_VALUE (attribute)));
+}
+
+auto
+get_variant_calls (function* fn) -> std::vector<VariantCall>
+{
+  std::vector<VariantCall> calls;
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      if (auto maybe_call {get_variant_call (gsi_stmt (gsi))}; maybe_call)
+      {
+        calls.push_back (std::move (*maybe_call));
+      }
+    }
+  }
+
+  return calls;
+}
+
+} // namespace Ggp::Gcc
@@ -0,0 +1,68 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_GCC_CALL_HH
+#define GGP_GCC_CALL_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/format.hh"
+
+#include <optional>
+
+namespace Ggp::Gcc
+{
+
+// A GIMPLE call to a function with a glib_variant attribute.
+struct VariantCall
+{
+  std::string name;
+  gcall* call;
+  FormatInfo info;
+  // nullptr if the format is not a string literal.
+  char const* format;
+  // Parameters passed after the format string.
+  std::vector<tree> args;
+};
+
+// Returns the name of a directly called function or nullptr for
+// indirect calls.
+auto
+get_called_function_name (gcall const* call) -> char const*;
+
+// Returns the kind of the argument after the default argument
+// promotions, '?' if it can't be passed through varargs. Mirrors the
+// kinds in ggp-rt.h, which are the kinds of Lib's ArgKind.
+auto
+get_arg_kind (tree arg) -> char;
+
+// Makes a VariantCall for a call to a function taking a format
+// described by the info, regardless of its attributes.
+auto
+make_variant_call (gcall* call,
+                   FormatInfo const& info) -> std::optional<VariantCall>;
+
+auto
+get_variant_call (gimple* stmt) -> std::optional<VariantCall>;
+
+auto
+get_variant_calls (function* fn) -> std::vector<VariantCall>;
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_GCC_CALL_HH */
@@ -0,0 +1,128 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/args.hh"
+#include "ggp/gcc/filter.hh"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace Ggp::Gcc
+{
+
+namespace
+{
+
+auto
+get_path_filter (struct plugin_name_args* plugin_info) -> std::optional<Lib::PathFilter>
+{
+  auto const includes {get_plugin_arg_list (plugin_info, "include-paths")};
+  auto const excludes {get_plugin_arg_list (plugin_info, "exclude-paths")};
+
+  if (includes.empty () && excludes.empty ())
+  {
+    return {};
+  }
+
+  return {Lib::make_path_filter (includes, excludes)};
+}
+
+auto
+get_line_filter (struct plugin_name_args* plugin_info) -> std::optional<Lib::LineFilter>
+{
+  auto const maybe_path {get_plugin_arg (plugin_info, "changed-lines")};
+
+  if (!maybe_path)
+  {
+    return {};
+  }
+
+  std::ifstream file {*maybe_path, std::ios::binary};
+  std::ostringstream contents;
+
+  contents << file.rdbuf ();
+  if (!file)
+  {
+    error ("failed to read the changed lines from %qs", maybe_path->c_str ());
+    return {};
+  }
+
+  auto filter {Lib::parse_line_filter (contents.str ())};
+
+  if (!filter)
+  {
+    error ("%qs is neither a unified diff nor a list of line ranges", maybe_path->c_str ());
+  }
+
+  return filter;
+}
+
+} // anonymous namespace
+
+SourceFilter::SourceFilter (struct plugin_name_args* plugin_info)
+  : paths {get_path_filter (plugin_info)},
+    lines {get_line_filter (plugin_info)}
+{}
+
+auto
+SourceFilter::wants_function (tree function_decl) const -> bool
+{
+  auto const file {DECL_SOURCE_FILE (function_decl)};
+
+  if (file == nullptr)
+  {
+    return true;
+  }
+  if (this->paths && !Lib::path_is_wanted (*this->paths, file))
+  {
+    return false;
+  }
+  if (this->lines)
+  {
+    auto const first {static_cast<std::uint32_t> (DECL_SOURCE_LINE (function_decl))};
+    // If the end of the function is not known, any change after its
+    // start could be in it.
+    auto last {std::numeric_limits<std::uint32_t>::max ()};
+
+    if (auto const fn {DECL_STRUCT_FUNCTION (function_decl)}; fn != nullptr)
+    {
+      auto const end {expand_location (fn->function_end_locus)};
+
+      if (end.file != nullptr && std::strcmp (end.file, file) == 0 &&
+          static_cast<std::uint32_t> (end.line) >= first)
+      {
+        last = static_cast<std::uint32_t> (end.line);
+      }
+    }
+
+    return Lib::lines_are_wanted (*this->lines, file, first, last);
+  }
+
+  return true;
+}
+
+auto
+SourceFilter::wants_diagnostic (Lib::Diagnostic const& diagnostic) const -> bool
+{
+  return !this->lines ||
+    Lib::lines_are_wanted (*this->lines, diagnostic.file, diagnostic.line, diagnostic.line);
+}
+
+} // namespace Ggp::Gcc
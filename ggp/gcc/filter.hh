@@ -0,0 +1,62 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_GCC_FILTER_HH
+#define GGP_GCC_FILTER_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/generated/sarif.hh"
+#include "ggp/gcc/generated/source-filter.hh"
+
+#include <optional>
+
+namespace Ggp::Gcc
+{
+
+// Limits the checks and the advice to the code of interest. Functions
+// filtered out are skipped before their bodies are looked at.
+//
+// -fplugin-arg-<plugin>-include-paths=<prefix>[:<prefix>…] and
+// -fplugin-arg-<plugin>-exclude-paths=<prefix>[:<prefix>…] filter the
+// functions by the path of the file they are defined in, see
+// Lib::path_is_wanted.
+//
+// -fplugin-arg-<plugin>-changed-lines=<file> keeps only the functions
+// and the diagnostics on the lines listed in the file, which is
+// either a unified diff or a list of line ranges, see
+// Lib::parse_line_filter.
+struct SourceFilter
+{
+  SourceFilter (struct plugin_name_args* plugin_info);
+
+  auto
+  wants_function (tree function_decl) const -> bool;
+
+  auto
+  wants_diagnostic (Lib::Diagnostic const& diagnostic) const -> bool;
+
+  // Empty if no prefixes were given.
+  std::optional<Lib::PathFilter> paths;
+  // Empty if no changed lines were given.
+  std::optional<Lib::LineFilter> lines;
+};
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_GCC_FILTER_HH */
@@ -0,0 +1,299 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2017, 2018, 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/args.hh"
+#include "ggp/gcc/format.hh"
+
+#include <sys/mman.h>
+
+namespace Ggp::Gcc
+{
+
+namespace {
+
+std::optional<unsigned HOST_WIDE_INT>
+get_int (tree expr)
+{
+  if (tree_fits_uhwi_p (expr))
+  {
+    return {TREE_INT_CST_LOW (expr)};
+  }
+
+  return {};
+}
+
+unsigned HOST_WIDE_INT
+must_get_int (tree expr)
+{
+  auto maybe_int {get_int (expr)};
+
+  gcc_assert (maybe_int.has_value ());
+
+  return maybe_int.value ();
+}
+
+std::optional<std::string>
+get_string (tree expr)
+{
+  if (expr != NULL_TREE &&
+      TREE_CODE (expr) == STRING_CST)
+  {
+    return {TREE_STRING_POINTER (expr)};
+  }
+
+  return {};
+}
+
+std::string
+must_get_string (tree expr)
+{
+  auto maybe_string {get_string (expr)};
+
+  gcc_assert (maybe_string.has_value ());
+
+  return maybe_string.value ();
+}
+
+std::optional<FormatType>
+get_format_type (std::string const& type_string)
+{
+  if (type_string == "new")
+  {
+    return {FormatType::New};
+  }
+
+  if (type_string == "get")
+  {
+    return {FormatType::Get};
+  }
+
+  return {};
+}
+
+FormatType
+must_get_format_type (std::string const& type_string)
+{
+  auto maybe_format_type {get_format_type (type_string)};
+
+  gcc_assert (maybe_format_type.has_value ());
+
+  return maybe_format_type.value ();
+}
+
+} // anonymous namespace
+
+auto
+get_format_info_from_args (tree attribute_args) -> std::optional<FormatInfo>
+{
+  auto maybe_format_type_string = get_string (TREE_VALUE (attribute_args));
+  if (!maybe_format_type_string.has_value ())
+  {
+    error ("expected a string as a first parameter");
+    return {};
+  }
+
+  auto maybe_format_type = get_format_type (maybe_format_type_string.value ());
+  if (!maybe_format_type.has_value ())
+  {
+    error ("expected either \"get\" or \"set\" as a format type");
+    return {};
+  }
+
+  auto maybe_string_index = get_int (TREE_VALUE (TREE_CHAIN (attribute_args)));
+  if (!maybe_string_index.has_value ())
+  {
+    error("expected an integer as a second parameter");
+    return {};
+  }
+
+  auto maybe_args_index = get_int (TREE_VALUE (TREE_CHAIN (TREE_CHAIN (attribute_args))));
+  if (!maybe_args_index.has_value ())
+  {
+    error("expected an integer as a second parameter");
+    return {};
+  }
+
+  if (maybe_string_index.value() >= maybe_args_index.value())
+  {
+    error("format string should come before formating arguments");
+    return {};
+  }
+
+  return {FormatInfo {maybe_format_type.value(), maybe_string_index.value(), maybe_args_index.value()}};
+}
+
+auto
+must_get_format_info_from_args (tree attribute_args) -> FormatInfo
+{
+  auto format_type_string = must_get_string (TREE_VALUE (attribute_args));
+  auto format_type = must_get_format_type (format_type_string);
+  auto string_index = must_get_int (TREE_VALUE (TREE_CHAIN (attribute_args)));
+  auto args_index = must_get_int (TREE_VALUE (TREE_CHAIN (TREE_CHAIN (attribute_args))));
+
+  return FormatInfo {format_type, string_index, args_index};
+}
+
+KnownFunctions::KnownFunctions (struct plugin_name_args* plugin_info)
+  : spec_data {nullptr},
+    spec_size {0u},
+    table {}
+{
+  auto functions {Lib::glib_api_functions ()};
+
+  if (auto const maybe_path {get_plugin_arg (plugin_info, "api-spec")}; maybe_path)
+  {
+    auto const maybe_contents {this->map_spec (*maybe_path)};
+    auto const maybe_spec_functions {maybe_contents ?
+                                     Lib::parse_api_spec (*maybe_contents) :
+                                     std::nullopt};
+
+    if (maybe_spec_functions)
+    {
+      functions.insert (functions.end (), maybe_spec_functions->begin (), maybe_spec_functions->end ());
+    }
+    else if (maybe_contents)
+    {
+      error ("%qs is not a valid API spec file", maybe_path->c_str ());
+    }
+  }
+  this->table = Lib::make_api_table (functions);
+}
+
+KnownFunctions::~KnownFunctions ()
+{
+  if (this->spec_data != nullptr)
+  {
+    munmap (this->spec_data, this->spec_size);
+  }
+}
+
+auto
+KnownFunctions::get_format_info (char const* function_name) const -> std::optional<FormatInfo>
+{
+  auto const function {Lib::find_api_function (this->table, function_name)};
+
+  if (function == nullptr)
+  {
+    return {};
+  }
+
+  return FormatInfo {(function->use == Lib::FormatUse::New) ? FormatType::New : FormatType::Get,
+                     function->string_index,
+                     function->args_index};
+}
+
+auto
+KnownFunctions::map_spec (std::string const& path) -> std::optional<std::string_view>
+{
+  auto const fd {open (path.c_str (), O_RDONLY)};
+
+  if (fd < 0)
+  {
+    error ("failed to open the API spec file %qs", path.c_str ());
+    return {};
+  }
+
+  struct stat st;
+
+  if (fstat (fd, &st) != 0)
+  {
+    error ("failed to stat the API spec file %qs", path.c_str ());
+    close (fd);
+    return {};
+  }
+  // mmap does not take empty files.
+  if (st.st_size == 0)
+  {
+    close (fd);
+    return {std::string_view {}};
+  }
+
+  auto const size {static_cast<std::size_t> (st.st_size)};
+  auto const data {mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+
+  close (fd);
+  if (data == MAP_FAILED)
+  {
+    error ("failed to map the API spec file %qs", path.c_str ());
+    return {};
+  }
+  this->spec_data = data;
+  this->spec_size = size;
+
+  return {std::string_view {static_cast<char const*> (data), size}};
+}
+
+auto
+build_glib_variant_attribute_args (FormatInfo const& info) -> tree
+{
+  auto const type_string {(info.type == FormatType::New) ? "new" : "get"};
+  auto args {tree_cons (NULL_TREE, build_int_cst (integer_type_node, info.args_index), NULL_TREE)};
+
+  args = tree_cons (NULL_TREE, build_int_cst (integer_type_node, info.string_index), args);
+  args = tree_cons (NULL_TREE, build_string (strlen (type_string) + 1, type_string), args);
+
+  return args;
+}
+
+auto
+get_glib_variant_attribute (tree function_decl) -> tree
+{
+  if (function_decl == NULL_TREE ||
+      TREE_CODE (function_decl) != FUNCTION_DECL)
+  {
+    return NULL_TREE;
+  }
+
+  auto function_type = TREE_TYPE (function_decl);
+  if (TREE_CODE (function_type) != FUNCTION_TYPE)
+  {
+    return NULL_TREE;
+  }
+
+  return lookup_attribute ("glib_variant", TYPE_ATTRIBUTES (function_type));
+}
+
+auto
+get_string_literal (tree arg) -> char const*
+{
+  if (arg == NULL_TREE)
+  {
+    return nullptr;
+  }
+
+  STRIP_NOPS (arg);
+  if (TREE_CODE (arg) != ADDR_EXPR)
+  {
+    return nullptr;
+  }
+
+  auto addr_op_0 = TREE_OPERAND (arg, 0);
+  if (TREE_CODE (addr_op_0) == ARRAY_REF &&
+      integer_zerop (TREE_OPERAND (addr_op_0, 1)))
+  {
+    addr_op_0 = TREE_OPERAND (addr_op_0, 0);
+  }
+  if (TREE_CODE (addr_op_0) != STRING_CST)
+  {
+    return nullptr;
+  }
+
+  return TREE_STRING_POINTER (addr_op_0);
+}
+
+} // namespace Ggp::Gcc
@@ -0,0 +1,98 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_GCC_FORMAT_HH
+#define GGP_GCC_FORMAT_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/generated/api.hh"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Ggp::Gcc
+{
+
+enum class FormatType
+{
+  New,
+  Get
+};
+
+// Indices are 1-based, like in the glib_variant attribute.
+struct FormatInfo {
+  FormatType type;
+  unsigned HOST_WIDE_INT string_index;
+  unsigned HOST_WIDE_INT args_index;
+};
+
+auto
+get_format_info_from_args (tree attribute_args) -> std::optional<FormatInfo>;
+
+auto
+must_get_format_info_from_args (tree attribute_args) -> FormatInfo;
+
+// Functions that should be checked even if their declarations lack
+// the glib_variant attribute - the GLib ones, see
+// Lib::glib_api_functions, and the ones listed in the spec file given
+// with -fplugin-arg-<plugin>-api-spec=<file>, see
+// Lib::parse_api_spec. The spec file stays mapped into memory, the
+// table refers to the names in it.
+class KnownFunctions
+{
+public:
+  KnownFunctions (struct plugin_name_args* plugin_info);
+  ~KnownFunctions ();
+  KnownFunctions (KnownFunctions const&) = delete;
+  KnownFunctions& operator= (KnownFunctions const&) = delete;
+
+  auto
+  get_format_info (char const* function_name) const -> std::optional<FormatInfo>;
+
+private:
+  // Returns the contents of the spec file.
+  auto
+  map_spec (std::string const& path) -> std::optional<std::string_view>;
+
+  void* spec_data;
+  std::size_t spec_size;
+  Lib::ApiTable table;
+};
+
+// Builds the arguments of a glib_variant attribute.
+auto
+build_glib_variant_attribute_args (FormatInfo const& info) -> tree;
+
+// Returns the glib_variant attribute of a function declaration or
+// NULL_TREE if there is none.
+auto
+get_glib_variant_attribute (tree function_decl) -> tree;
+
+// Returns the contents of a string literal passed as a parameter to
+// a function. Handles both GENERIC (nop_expr (addr_expr
+// (string_cst))) and GIMPLE (addr_expr (array_ref (string_cst, 0)))
+// forms. Returns nullptr for anything that is not a string literal.
+auto
+get_string_literal (tree arg) -> char const*;
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_GCC_FORMAT_HH */
@@ -29,9 +29,11 @@
 // Do not sort.
 
 #include "gcc-plugin.h"
+#include "ggc.h"
 #include "diagnostic.h"
 #include "errors.h"
 #include "tree.h"
+#include "fold-const.h"
 #include "dumpfile.h"
 #include "tree-iterator.h"
 #include "tree-pass.h"
@@ -39,9 +41,19 @@
 #include "context.h"
 #include "stringpool.h"
 #include "attribs.h"
+#include "cgraph.h"
 #include "gimple.h"
 #include "gimple-pretty-print.h"
 #include "gimple-iterator.h"
+#include "cfg.h"
+#include "cfghooks.h"
+#include "dominance.h"
+#include "cfgloop.h"
+#include "predict.h"
+#include "langhooks.h"
+#include "opts.h"
+#include "toplev.h"
+#include "version.h"
 
 // system.h header includes ctype.h, which defines the macros undeffed
 // below. system.h actually indirectly undefs them and replaces them
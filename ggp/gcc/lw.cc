@@ -0,0 +1,1980 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/args.hh"
+#include "ggp/gcc/call.hh"
+#include "ggp/gcc/lw.hh"
+
+#include "ggp/gcc/generated/layout.hh"
+#include "ggp/gcc/generated/program.hh"
+#include "ggp/gcc/generated/serialize.hh"
+#include "ggp/gcc/generated/variant.hh"
+#include "ggp/gcc/generated/variant-print.hh"
+#include "ggp/gcc/generated/variant-text.hh"
+#include "ggp/gcc/generated/variant-value.hh"
+
+#include <cstring>
+
+namespace Ggp::Gcc
+{
+
+namespace {
+
+// C types used in the signatures of the GLib functions the calls are
+// lowered to. GVariant and string pointers are all void pointers -
+// conversions between pointer types are no-ops in GIMPLE.
+enum class CType
+{
+  Void,
+  Pointer,
+  Int,
+  UInt,
+  UChar,
+  Short,
+  UShort,
+  LongLong,
+  ULongLong,
+  Double,
+  Size,
+};
+
+auto
+get_c_type (CType type) -> tree
+{
+  switch (type)
+  {
+  case CType::Void:
+    return void_type_node;
+  case CType::Pointer:
+    return ptr_type_node;
+  case CType::Int:
+    return integer_type_node;
+  case CType::UInt:
+    return unsigned_type_node;
+  case CType::UChar:
+    return unsigned_char_type_node;
+  case CType::Short:
+    return short_integer_type_node;
+  case CType::UShort:
+    return short_unsigned_type_node;
+  case CType::LongLong:
+    return long_long_integer_type_node;
+  case CType::ULongLong:
+    return long_long_unsigned_type_node;
+  case CType::Double:
+    return double_type_node;
+  case CType::Size:
+    return size_type_node;
+  }
+
+  gcc_unreachable ();
+}
+
+enum class Glib : unsigned
+{
+  VariantNewBoolean,
+  VariantNewByte,
+  VariantNewInt16,
+  VariantNewUint16,
+  VariantNewInt32,
+  VariantNewUint32,
+  VariantNewInt64,
+  VariantNewUint64,
+  VariantNewHandle,
+  VariantNewDouble,
+  VariantNewString,
+  VariantNewObjectPath,
+  VariantNewSignature,
+  VariantNewVariant,
+  VariantNewTuple,
+  VariantNewDictEntry,
+  VariantGetBoolean,
+  VariantGetByte,
+  VariantGetInt16,
+  VariantGetUint16,
+  VariantGetInt32,
+  VariantGetUint32,
+  VariantGetInt64,
+  VariantGetUint64,
+  VariantGetHandle,
+  VariantGetDouble,
+  VariantGetString,
+  VariantDupString,
+  VariantGetVariant,
+  VariantGetChildValue,
+  VariantGetSize,
+  VariantGetData,
+  VariantIsOfType,
+  VariantRef,
+  VariantUnref,
+  VariantGet,
+  VariantBuilderAddValue,
+  VariantIterNextValue,
+  VariantNewFromData,
+  // From libggp-rt.
+  GgpVariantNewProgram,
+  GgpVariantGetProgram,
+
+  Count
+};
+
+struct GlibFunction
+{
+  Glib id;
+  char const* name;
+  CType return_type;
+  std::vector<CType> param_types;
+  bool variadic {false};
+};
+
+// Needs to be in the same order as the Glib enum.
+std::vector<GlibFunction> const glib_functions {
+  {Glib::VariantNewBoolean, "g_variant_new_boolean", CType::Pointer, {CType::Int}},
+  {Glib::VariantNewByte, "g_variant_new_byte", CType::Pointer, {CType::UChar}},
+  {Glib::VariantNewInt16, "g_variant_new_int16", CType::Pointer, {CType::Short}},
+  {Glib::VariantNewUint16, "g_variant_new_uint16", CType::Pointer, {CType::UShort}},
+  {Glib::VariantNewInt32, "g_variant_new_int32", CType::Pointer, {CType::Int}},
+  {Glib::VariantNewUint32, "g_variant_new_uint32", CType::Pointer, {CType::UInt}},
+  {Glib::VariantNewInt64, "g_variant_new_int64", CType::Pointer, {CType::LongLong}},
+  {Glib::VariantNewUint64, "g_variant_new_uint64", CType::Pointer, {CType::ULongLong}},
+  {Glib::VariantNewHandle, "g_variant_new_handle", CType::Pointer, {CType::Int}},
+  {Glib::VariantNewDouble, "g_variant_new_double", CType::Pointer, {CType::Double}},
+  {Glib::VariantNewString, "g_variant_new_string", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantNewObjectPath, "g_variant_new_object_path", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantNewSignature, "g_variant_new_signature", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantNewVariant, "g_variant_new_variant", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantNewTuple, "g_variant_new_tuple", CType::Pointer, {CType::Pointer, CType::Size}},
+  {Glib::VariantNewDictEntry, "g_variant_new_dict_entry", CType::Pointer, {CType::Pointer, CType::Pointer}},
+  {Glib::VariantGetBoolean, "g_variant_get_boolean", CType::Int, {CType::Pointer}},
+  {Glib::VariantGetByte, "g_variant_get_byte", CType::UChar, {CType::Pointer}},
+  {Glib::VariantGetInt16, "g_variant_get_int16", CType::Short, {CType::Pointer}},
+  {Glib::VariantGetUint16, "g_variant_get_uint16", CType::UShort, {CType::Pointer}},
+  {Glib::VariantGetInt32, "g_variant_get_int32", CType::Int, {CType::Pointer}},
+  {Glib::VariantGetUint32, "g_variant_get_uint32", CType::UInt, {CType::Pointer}},
+  {Glib::VariantGetInt64, "g_variant_get_int64", CType::LongLong, {CType::Pointer}},
+  {Glib::VariantGetUint64, "g_variant_get_uint64", CType::ULongLong, {CType::Pointer}},
+  {Glib::VariantGetHandle, "g_variant_get_handle", CType::Int, {CType::Pointer}},
+  {Glib::VariantGetDouble, "g_variant_get_double", CType::Double, {CType::Pointer}},
+  {Glib::VariantGetString, "g_variant_get_string", CType::Pointer, {CType::Pointer, CType::Pointer}},
+  {Glib::VariantDupString, "g_variant_dup_string", CType::Pointer, {CType::Pointer, CType::Pointer}},
+  {Glib::VariantGetVariant, "g_variant_get_variant", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantGetChildValue, "g_variant_get_child_value", CType::Pointer, {CType::Pointer, CType::Size}},
+  {Glib::VariantGetSize, "g_variant_get_size", CType::Size, {CType::Pointer}},
+  {Glib::VariantGetData, "g_variant_get_data", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantIsOfType, "g_variant_is_of_type", CType::Int, {CType::Pointer, CType::Pointer}},
+  {Glib::VariantRef, "g_variant_ref", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantUnref, "g_variant_unref", CType::Void, {CType::Pointer}},
+  {Glib::VariantGet, "g_variant_get", CType::Void, {CType::Pointer, CType::Pointer}, true},
+  {Glib::VariantBuilderAddValue, "g_variant_builder_add_value", CType::Void, {CType::Pointer, CType::Pointer}},
+  {Glib::VariantIterNextValue, "g_variant_iter_next_value", CType::Pointer, {CType::Pointer}},
+  {Glib::VariantNewFromData, "g_variant_new_from_data", CType::Pointer, {CType::Pointer, CType::Pointer, CType::Size, CType::Int, CType::Pointer, CType::Pointer}},
+  {Glib::GgpVariantNewProgram, "ggp_variant_new_program", CType::Pointer, {CType::Pointer}, true},
+  {Glib::GgpVariantGetProgram, "ggp_variant_get_program", CType::Void, {CType::Pointer, CType::Pointer}, true},
+};
+
+// The declarations are taken from the translation unit or created on
+// demand, and reused in all the functions, so the garbage collector
+// needs to know about them.
+tree glib_function_decls[static_cast<unsigned> (Glib::Count)];
+
+ggc_root_tab const glib_function_decls_roots[] = {
+  {glib_function_decls, static_cast<unsigned> (Glib::Count), sizeof (tree), &gt_ggc_mx_tree_node, &gt_pch_nx_tree_node},
+  LAST_GGC_ROOT_TAB
+};
+
+// Whether the declaration from the translation unit can be called
+// like the function - it needs the same number of parameters and to
+// take varargs if the function does.
+auto
+decl_matches_glib_function (tree decl,
+                            GlibFunction const& function) -> bool
+{
+  auto const fntype {TREE_TYPE (decl)};
+
+  if (!prototype_p (fntype) || stdarg_p (fntype) != function.variadic)
+  {
+    return false;
+  }
+
+  auto params_count {std::size_t {0u}};
+
+  for (auto param {TYPE_ARG_TYPES (fntype)}; param != NULL_TREE && param != void_list_node; param = TREE_CHAIN (param))
+  {
+    ++params_count;
+  }
+
+  return params_count == function.param_types.size ();
+}
+
+// Keeps the declarations of the functions the translation unit
+// declares itself, so the calls added by the lowering use the same
+// types, like gint64, as the code does. Declarations of the same
+// function with different types would make LTO warn about a type
+// mismatch.
+void
+ggp_lw_finish_decl (void* gcc_data,
+                    void* /* user_data */)
+{
+  auto const decl {static_cast<tree> (gcc_data)};
+
+  if (TREE_CODE (decl) != FUNCTION_DECL || DECL_NAME (decl) == NULL_TREE || !TREE_PUBLIC (decl))
+  {
+    return;
+  }
+
+  auto const name {IDENTIFIER_POINTER (DECL_NAME (decl))};
+
+  if (std::strncmp (name, "g_variant_", 10u) != 0 && std::strncmp (name, "ggp_variant_", 12u) != 0)
+  {
+    return;
+  }
+  for (auto const& function : glib_functions)
+  {
+    if (std::strcmp (name, function.name) != 0)
+    {
+      continue;
+    }
+    if (decl_matches_glib_function (decl, function))
+    {
+      glib_function_decls[static_cast<unsigned> (function.id)] = decl;
+    }
+    return;
+  }
+}
+
+auto
+get_glib_function_decl (Glib id) -> tree
+{
+  auto const idx {static_cast<unsigned> (id)};
+  auto& decl {glib_function_decls[idx]};
+
+  if (decl == NULL_TREE)
+  {
+    auto const& function {glib_functions[idx]};
+    // A parameter list not terminated with void means varargs.
+    auto param_types {function.variadic ? NULL_TREE : void_list_node};
+
+    gcc_assert (function.id == id);
+    for (auto iter {function.param_types.crbegin ()}; iter != function.param_types.crend (); ++iter)
+    {
+      param_types = tree_cons (NULL_TREE, get_c_type (*iter), param_types);
+    }
+    decl = build_fn_decl (function.name,
+                          build_function_type (get_c_type (function.return_type), param_types));
+  }
+
+  return decl;
+}
+
+// Collects the statements replacing a lowered call.
+struct Emitter
+{
+  auto
+  emit (gimple* stmt) -> void;
+
+  auto
+  convert (tree value,
+           tree type) -> tree;
+
+  auto
+  call (Glib function,
+        std::vector<tree> const& args) -> tree;
+
+  auto
+  compute (tree_code code,
+           tree type,
+           tree lhs,
+           tree rhs) -> tree;
+
+  auto
+  store (tree pointer,
+         tree value) -> void;
+
+  location_t location;
+  tree block;
+  gimple_seq seq;
+};
+
+auto
+Emitter::emit (gimple* stmt) -> void
+{
+  gimple_set_location (stmt, this->location);
+  gimple_set_block (stmt, this->block);
+  gimple_seq_add_stmt (&this->seq, stmt);
+}
+
+auto
+Emitter::convert (tree value,
+                  tree type) -> tree
+{
+  if (useless_type_conversion_p (type, TREE_TYPE (value)))
+  {
+    return value;
+  }
+  if (CONSTANT_CLASS_P (value))
+  {
+    return fold_convert (type, value);
+  }
+
+  auto converted {create_tmp_var (type)};
+
+  this->emit (gimple_build_assign (converted, NOP_EXPR, value));
+
+  return converted;
+}
+
+// Returns a temporary holding the returned value or NULL_TREE if the
+// function returns nothing.
+auto
+Emitter::call (Glib function,
+               std::vector<tree> const& args) -> tree
+{
+  auto const decl {get_glib_function_decl (function)};
+  auto const fntype {TREE_TYPE (decl)};
+  auto params {TYPE_ARG_TYPES (fntype)};
+  auto_vec<tree> call_args;
+
+  for (auto arg : args)
+  {
+    // Parameters passed through varargs are taken as they are.
+    if (params == NULL_TREE)
+    {
+      call_args.safe_push (arg);
+      continue;
+    }
+    call_args.safe_push (this->convert (arg, TREE_VALUE (params)));
+    params = TREE_CHAIN (params);
+  }
+
+  auto stmt {gimple_build_call_vec (decl, call_args)};
+  auto result {NULL_TREE};
+
+  if (!VOID_TYPE_P (TREE_TYPE (fntype)))
+  {
+    result = create_tmp_var (TREE_TYPE (fntype));
+    gimple_call_set_lhs (stmt, result);
+  }
+  gimple_call_set_nothrow (stmt, true);
+  this->emit (stmt);
+
+  return result;
+}
+
+// Returns a temporary holding the result of the binary operation.
+auto
+Emitter::compute (tree_code code,
+                  tree type,
+                  tree lhs,
+                  tree rhs) -> tree
+{
+  auto result {create_tmp_var (type)};
+
+  this->emit (gimple_build_assign (result, code, lhs, rhs));
+
+  return result;
+}
+
+auto
+Emitter::store (tree pointer,
+                tree value) -> void
+{
+  auto const ref {build_simple_mem_ref (pointer)};
+
+  this->emit (gimple_build_assign (ref, this->convert (value, TREE_TYPE (ref))));
+}
+
+// How a parameter for a leaf of the format is passed through
+// varargs.
+enum class ArgKind
+{
+  // Anything up to 32 bits, promoted to int.
+  Int,
+  Int64,
+  Double,
+  Pointer,
+};
+
+// Whether the parameter matches what GLib would read with va_arg.
+// Otherwise the lowered code would not behave like the original.
+auto
+arg_has_kind (tree arg,
+              ArgKind kind) -> bool
+{
+  auto const type {TREE_TYPE (arg)};
+
+  switch (kind)
+  {
+  case ArgKind::Int:
+    return INTEGRAL_TYPE_P (type) && TYPE_PRECISION (type) == TYPE_PRECISION (integer_type_node);
+  case ArgKind::Int64:
+    return INTEGRAL_TYPE_P (type) && TYPE_PRECISION (type) == 64;
+  case ArgKind::Double:
+    return SCALAR_FLOAT_TYPE_P (type) && TYPE_PRECISION (type) == TYPE_PRECISION (double_type_node);
+  case ArgKind::Pointer:
+    return POINTER_TYPE_P (type);
+  }
+
+  gcc_unreachable ();
+}
+
+struct Leaf
+{
+  Glib constructor;
+  ArgKind kind;
+};
+
+auto
+get_basic_leaf (Lib::Leaf::Basic const& basic) -> Leaf
+{
+  auto vh {Lib::VisitHelper {
+    [](Lib::Leaf::Bool const&) { return Leaf {Glib::VariantNewBoolean, ArgKind::Int}; },
+    [](Lib::Leaf::Byte const&) { return Leaf {Glib::VariantNewByte, ArgKind::Int}; },
+    [](Lib::Leaf::I16 const&) { return Leaf {Glib::VariantNewInt16, ArgKind::Int}; },
+    [](Lib::Leaf::U16 const&) { return Leaf {Glib::VariantNewUint16, ArgKind::Int}; },
+    [](Lib::Leaf::I32 const&) { return Leaf {Glib::VariantNewInt32, ArgKind::Int}; },
+    [](Lib::Leaf::U32 const&) { return Leaf {Glib::VariantNewUint32, ArgKind::Int}; },
+    [](Lib::Leaf::I64 const&) { return Leaf {Glib::VariantNewInt64, ArgKind::Int64}; },
+    [](Lib::Leaf::U64 const&) { return Leaf {Glib::VariantNewUint64, ArgKind::Int64}; },
+    [](Lib::Leaf::Handle const&) { return Leaf {Glib::VariantNewHandle, ArgKind::Int}; },
+    [](Lib::Leaf::Double const&) { return Leaf {Glib::VariantNewDouble, ArgKind::Double}; },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+auto
+get_string_type_leaf (Lib::Leaf::StringType const& string_type) -> Leaf
+{
+  auto vh {Lib::VisitHelper {
+    [](Lib::Leaf::String const&) { return Leaf {Glib::VariantNewString, ArgKind::Pointer}; },
+    [](Lib::Leaf::ObjectPath const&) { return Leaf {Glib::VariantNewObjectPath, ArgKind::Pointer}; },
+    [](Lib::Leaf::Signature const&) { return Leaf {Glib::VariantNewSignature, ArgKind::Pointer}; },
+  }};
+
+  return std::visit (vh, string_type.v);
+}
+
+// Builds a GVariant the same way g_variant_new would, taking the
+// parameters in order. All the constructors return floating
+// references and the container constructors sink the floating
+// children, just like g_variant_new does.
+struct NewLowering
+{
+  // Returns a temporary holding the built GVariant or NULL_TREE if
+  // the format or the parameters can't be lowered.
+  auto
+  lower (Lib::VariantFormat const& format) -> tree;
+
+  auto
+  lower_entry_key (Lib::VF::EntryKeyFormat const& key) -> tree;
+
+  auto
+  lower_leaf (Leaf const& leaf) -> tree;
+
+  auto
+  take_arg (ArgKind kind) -> tree;
+
+  auto
+  build_tuple (std::vector<tree> const& children) -> tree;
+
+  Emitter& emitter;
+  std::vector<tree> const& args;
+  std::size_t next_arg;
+};
+
+auto
+NewLowering::lower (Lib::VariantFormat const& format) -> tree
+{
+  auto vh {Lib::VisitHelper {
+    [this](Lib::Leaf::Basic const& basic) { return this->lower_leaf (get_basic_leaf (basic)); },
+    [this](Lib::Leaf::StringType const& string_type) { return this->lower_leaf (get_string_type_leaf (string_type)); },
+    // "&s" means the same as "s" for g_variant_new.
+    [this](Lib::VF::Pointer const& pointer) { return this->lower_leaf (get_string_type_leaf (pointer.string_type)); },
+    [this](Lib::Leaf::Variant const&) { return this->lower_leaf (Leaf {Glib::VariantNewVariant, ArgKind::Pointer}); },
+    // "@type", "*", "?" and "r" take a ready GVariant, which GLib
+    // checks against the type and aborts on a mismatch. The lowered
+    // code would build an ill-typed value instead, so such formats
+    // are left alone.
+    [](Lib::VF::AtVariantType const&) { return tree {NULL_TREE}; },
+    [this](Lib::VF::Tuple const& tuple)
+    {
+      std::vector<tree> children;
+
+      for (auto const& member : tuple.formats)
+      {
+        auto child {this->lower (member)};
+
+        if (child == NULL_TREE)
+        {
+          return NULL_TREE;
+        }
+        children.push_back (child);
+      }
+
+      return this->build_tuple (children);
+    },
+    [this](Lib::VF::Entry const& entry)
+    {
+      auto key {this->lower_entry_key (entry.key)};
+
+      if (key == NULL_TREE)
+      {
+        return NULL_TREE;
+      }
+
+      auto value {this->lower (entry.value)};
+
+      if (value == NULL_TREE)
+      {
+        return NULL_TREE;
+      }
+
+      return this->emitter.call (Glib::VariantNewDictEntry, {key, value});
+    },
+    // Arrays take a GVariantBuilder, maybes and the convenience
+    // formats have their own rules - not worth it.
+    [](Lib::VT::Array const&) { return tree {NULL_TREE}; },
+    [](Lib::VF::Maybe const&) { return tree {NULL_TREE}; },
+    [](Lib::VF::Convenience const&) { return tree {NULL_TREE}; },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+auto
+NewLowering::lower_entry_key (Lib::VF::EntryKeyFormat const& key) -> tree
+{
+  auto vh {Lib::VisitHelper {
+    [this](Lib::Leaf::Basic const& basic) { return this->lower_leaf (get_basic_leaf (basic)); },
+    [this](Lib::Leaf::StringType const& string_type) { return this->lower_leaf (get_string_type_leaf (string_type)); },
+    [this](Lib::VF::Pointer const& pointer) { return this->lower_leaf (get_string_type_leaf (pointer.string_type)); },
+    // Same as "@type" in NewLowering::lower.
+    [](Lib::VF::AtEntryKeyType const&) { return tree {NULL_TREE}; },
+  }};
+
+  return std::visit (vh, key.v);
+}
+
+auto
+NewLowering::lower_leaf (Leaf const& leaf) -> tree
+{
+  auto arg {this->take_arg (leaf.kind)};
+
+  if (arg == NULL_TREE)
+  {
+    return NULL_TREE;
+  }
+
+  return this->emitter.call (leaf.constructor, {arg});
+}
+
+auto
+NewLowering::take_arg (ArgKind kind) -> tree
+{
+  if (this->next_arg >= this->args.size ())
+  {
+    return NULL_TREE;
+  }
+
+  auto arg {this->args[this->next_arg]};
+
+  ++this->next_arg;
+  if (!arg_has_kind (arg, kind))
+  {
+    return NULL_TREE;
+  }
+
+  return arg;
+}
+
+auto
+NewLowering::build_tuple (std::vector<tree> const& children) -> tree
+{
+  if (children.empty ())
+  {
+    return this->emitter.call (Glib::VariantNewTuple, {null_pointer_node, size_zero_node});
+  }
+
+  auto array {create_tmp_var (build_array_type_nelts (ptr_type_node, children.size ()), "children")};
+
+  TREE_ADDRESSABLE (array) = 1;
+  for (auto idx {0u}; idx < children.size (); ++idx)
+  {
+    auto element {build4 (ARRAY_REF, ptr_type_node, array, size_int (idx), NULL_TREE, NULL_TREE)};
+
+    this->emitter.emit (gimple_build_assign (element, children[idx]));
+  }
+
+  return this->emitter.call (Glib::VariantNewTuple, {build_fold_addr_expr (array), size_int (children.size ())});
+}
+
+// Takes the values of g_variant_new parameters that are all
+// constants, in the same order as NewLowering does. The values are
+// serialized at compile time.
+struct ConstantLowering
+{
+  // Returns an empty value if the format or the parameters can't be
+  // lowered.
+  auto
+  lower (Lib::VariantFormat const& format) -> std::optional<Lib::VariantValue>;
+
+  auto
+  lower_entry_key (Lib::VF::EntryKeyFormat const& key) -> std::optional<Lib::VariantValue>;
+
+  auto
+  lower_basic (Lib::Leaf::Basic const& basic) -> std::optional<Lib::VariantValue>;
+
+  auto
+  lower_string (Lib::Leaf::StringType const& string_type) -> std::optional<Lib::VariantValue>;
+
+  auto
+  take_arg (ArgKind kind) -> tree;
+
+  std::vector<tree> const& args;
+  std::size_t next_arg;
+};
+
+auto
+ConstantLowering::lower (Lib::VariantFormat const& format) -> std::optional<Lib::VariantValue>
+{
+  using Result = std::optional<Lib::VariantValue>;
+
+  auto vh {Lib::VisitHelper {
+    [this](Lib::Leaf::Basic const& basic) { return this->lower_basic (basic); },
+    [this](Lib::Leaf::StringType const& string_type) { return this->lower_string (string_type); },
+    [this](Lib::VF::Pointer const& pointer) { return this->lower_string (pointer.string_type); },
+    [this](Lib::VF::Tuple const& tuple) -> Result
+    {
+      std::vector<Lib::VariantValue> values;
+
+      for (auto const& member : tuple.formats)
+      {
+        auto maybe_value {this->lower (member)};
+
+        if (!maybe_value)
+        {
+          return {};
+        }
+        values.push_back (std::move (*maybe_value));
+      }
+
+      return {{Lib::VV::Tuple {std::move (values)}}};
+    },
+    [this](Lib::VF::Entry const& entry) -> Result
+    {
+      auto maybe_key {this->lower_entry_key (entry.key)};
+
+      if (!maybe_key)
+      {
+        return {};
+      }
+
+      auto maybe_value {this->lower (entry.value)};
+
+      if (!maybe_value)
+      {
+        return {};
+      }
+
+      return {{Lib::VV::Entry {std::move (*maybe_key), std::move (*maybe_value)}}};
+    },
+    // Variants and ready GVariants are never constant. The rest is
+    // not lowered by NewLowering either.
+    [](auto const&) -> Result { return {}; },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+auto
+ConstantLowering::lower_entry_key (Lib::VF::EntryKeyFormat const& key) -> std::optional<Lib::VariantValue>
+{
+  auto vh {Lib::VisitHelper {
+    [this](Lib::Leaf::Basic const& basic) { return this->lower_basic (basic); },
+    [this](Lib::Leaf::StringType const& string_type) { return this->lower_string (string_type); },
+    [this](Lib::VF::Pointer const& pointer) { return this->lower_string (pointer.string_type); },
+    [](Lib::VF::AtEntryKeyType const&) -> std::optional<Lib::VariantValue> { return {}; },
+  }};
+
+  return std::visit (vh, key.v);
+}
+
+auto
+ConstantLowering::lower_basic (Lib::Leaf::Basic const& basic) -> std::optional<Lib::VariantValue>
+{
+  using Result = std::optional<Lib::VariantValue>;
+
+  auto const arg {this->take_arg (get_basic_leaf (basic).kind)};
+
+  if (arg == NULL_TREE)
+  {
+    return {};
+  }
+  if (TREE_CODE (arg) == REAL_CST)
+  {
+    if (REAL_VALUE_ISNAN (TREE_REAL_CST (arg)))
+    {
+      return {};
+    }
+
+    // Two 32-bit words in the target order.
+    long words[2];
+
+    REAL_VALUE_TO_TARGET_DOUBLE (TREE_REAL_CST (arg), words);
+
+    auto const low {static_cast<std::uint64_t> (words[FLOAT_WORDS_BIG_ENDIAN ? 1 : 0]) & 0xffffffffu};
+    auto const high {static_cast<std::uint64_t> (words[FLOAT_WORDS_BIG_ENDIAN ? 0 : 1]) & 0xffffffffu};
+    auto const bits {(high << 32u) | low};
+    double value;
+
+    std::memcpy (&value, &bits, sizeof (value));
+
+    return {{Lib::VV::Basic {Lib::VV::Double {value}}}};
+  }
+  if (TREE_CODE (arg) != INTEGER_CST)
+  {
+    return {};
+  }
+
+  // The constructors truncate the promoted parameter.
+  auto const bits {static_cast<std::uint64_t> (TREE_INT_CST_LOW (arg))};
+  auto vh {Lib::VisitHelper {
+    // Anything else than 0 or 1 would not be in the normal form.
+    [bits](Lib::Leaf::Bool const&) -> Result
+    {
+      if (bits > 1u)
+      {
+        return {};
+      }
+      return {{Lib::VV::Basic {Lib::VV::Bool {bits == 1u}}}};
+    },
+    [bits](Lib::Leaf::Byte const&) -> Result { return {{Lib::VV::Basic {Lib::VV::Byte {static_cast<std::uint8_t> (bits)}}}}; },
+    [bits](Lib::Leaf::I16 const&) -> Result { return {{Lib::VV::Basic {Lib::VV::I16 {static_cast<std::int16_t> (bits)}}}}; },
+    [bits](Lib::Leaf::U16 const&) -> Result { return {{Lib::VV::Basic {Lib::VV::U16 {static_cast<std::uint16_t> (bits)}}}}; },
+    [bits](Lib::Leaf::I32 const&) -> Result { return {{Lib::VV::Basic {Lib::VV::I32 {static_cast<std::int32_t> (bits)}}}}; },
+    [bits](Lib::Leaf::U32 const&) -> Result { return {{Lib::VV::Basic {Lib::VV::U32 {static_cast<std::uint32_t> (bits)}}}}; },
+    [bits](Lib::Leaf::I64 const&) -> Result { return {{Lib::VV::Basic {Lib::VV::I64 {static_cast<std::int64_t> (bits)}}}}; },
+    [bits](Lib::Leaf::U64 const&) -> Result { return {{Lib::VV::Basic {Lib::VV::U64 {bits}}}}; },
+    [bits](Lib::Leaf::Handle const&) -> Result { return {{Lib::VV::Basic {Lib::VV::Handle {static_cast<std::int32_t> (bits)}}}}; },
+    [](Lib::Leaf::Double const&) -> Result { return {}; },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+// The string is taken only if GLib would accept it, so invalid
+// strings are still reported at runtime.
+auto
+ConstantLowering::lower_string (Lib::Leaf::StringType const& string_type) -> std::optional<Lib::VariantValue>
+{
+  auto const arg {this->take_arg (ArgKind::Pointer)};
+  auto const literal {get_string_literal (arg)};
+
+  if (literal == nullptr || !Lib::string_is_valid (string_type, literal))
+  {
+    return {};
+  }
+
+  return {{Lib::VV::String {string_type, literal}}};
+}
+
+auto
+ConstantLowering::take_arg (ArgKind kind) -> tree
+{
+  if (this->next_arg >= this->args.size ())
+  {
+    return NULL_TREE;
+  }
+
+  auto arg {this->args[this->next_arg]};
+
+  ++this->next_arg;
+  if (!arg_has_kind (arg, kind))
+  {
+    return NULL_TREE;
+  }
+
+  return arg;
+}
+
+// Returns the address of a read-only static copy of the data.
+auto
+build_static_data (std::vector<std::uint8_t> const& data,
+                   std::size_t alignment) -> tree
+{
+  auto const type {build_array_type_nelts (unsigned_char_type_node, data.size ())};
+  auto const decl {build_decl (UNKNOWN_LOCATION, VAR_DECL, create_tmp_var_name ("ggp_serialized"), type)};
+  auto const init {build_string (data.size (), reinterpret_cast<char const*> (data.data ()))};
+
+  TREE_TYPE (init) = type;
+  TREE_STATIC (decl) = 1;
+  TREE_READONLY (decl) = 1;
+  TREE_ADDRESSABLE (decl) = 1;
+  TREE_USED (decl) = 1;
+  DECL_ARTIFICIAL (decl) = 1;
+  DECL_IGNORED_P (decl) = 1;
+  SET_DECL_ALIGN (decl, alignment * BITS_PER_UNIT);
+  DECL_USER_ALIGN (decl) = 1;
+  DECL_INITIAL (decl) = init;
+  varpool_node::finalize_decl (decl);
+
+  return build_fold_addr_expr_with_type (decl, ptr_type_node);
+}
+
+// Serializes the value at compile time. g_variant_new_from_data
+// neither copies nor checks the trusted static data, and the data is
+// aligned, so nothing is serialized or allocated for the payload at
+// runtime.
+auto
+build_constant_value (Emitter& emitter,
+                      Lib::VariantValue const& value) -> tree
+{
+  auto const type {value.type ()};
+  auto const maybe_layout {Lib::layout_of (type)};
+
+  gcc_assert (maybe_layout);
+
+  auto const data {Lib::serialize (value, BYTES_BIG_ENDIAN ? Lib::ByteOrder::Big : Lib::ByteOrder::Little)};
+  auto const type_string {type_to_string (type)};
+  auto const type_literal {build_string_literal (type_string.size () + 1, type_string.c_str ())};
+  auto const static_data {build_static_data (data, maybe_layout->alignment)};
+
+  return emitter.call (Glib::VariantNewFromData,
+                       {type_literal, static_data, size_int (data.size ()), integer_one_node, null_pointer_node, null_pointer_node});
+}
+
+// A value with only constant parameters is built at compile time.
+auto
+lower_constant_new (Emitter& emitter,
+                    Lib::VariantFormat const& format,
+                    std::vector<tree> const& args) -> tree
+{
+  ConstantLowering lowering {args, 0u};
+  auto const maybe_value {lowering.lower (format)};
+
+  if (!maybe_value || lowering.next_arg != args.size ())
+  {
+    return NULL_TREE;
+  }
+
+  return build_constant_value (emitter, *maybe_value);
+}
+
+// Returns a temporary holding the built GVariant or NULL_TREE if the
+// format or the parameters can't be lowered.
+auto
+lower_new (Emitter& emitter,
+           Lib::VariantFormat const& format,
+           std::vector<tree> const& args) -> tree
+{
+  if (auto const value {lower_constant_new (emitter, format, args)}; value != NULL_TREE)
+  {
+    return value;
+  }
+
+  NewLowering lowering {emitter, args, 0u};
+  auto const value {lowering.lower (format)};
+
+  if (value == NULL_TREE || lowering.next_arg != args.size ())
+  {
+    return NULL_TREE;
+  }
+
+  return value;
+}
+
+auto
+replace_call (gcall* call,
+              gimple_seq seq) -> void
+{
+  auto gsi {gsi_for_stmt (call)};
+
+  gsi_insert_seq_before (&gsi, seq, GSI_SAME_STMT);
+  gsi_remove (&gsi, true);
+}
+
+auto
+lower_new_call (VariantCall const& variant_call) -> bool
+{
+  auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+  if (!maybe_format)
+  {
+    return false;
+  }
+  // g_variant_new refuses to take a ready GVariant as a whole.
+  if (std::holds_alternative<Lib::VF::AtVariantType> (maybe_format->v))
+  {
+    return false;
+  }
+
+  auto const call {variant_call.call};
+  Emitter emitter {gimple_location (call), gimple_block (call), nullptr};
+  auto const value {lower_new (emitter, *maybe_format, variant_call.args)};
+
+  if (value == NULL_TREE)
+  {
+    return false;
+  }
+
+  if (auto const lhs {gimple_call_lhs (call)}; lhs != NULL_TREE)
+  {
+    emitter.emit (gimple_build_assign (lhs, emitter.convert (value, TREE_TYPE (lhs))));
+  }
+  replace_call (call, emitter.seq);
+
+  return true;
+}
+
+// g_variant_builder_add builds the value like g_variant_new does and
+// passes it to g_variant_builder_add_value, which sinks it. Formats
+// taking ready GVariants are left alone by lower_new, here too.
+auto
+lower_builder_add_call (VariantCall const& variant_call) -> bool
+{
+  auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+  if (!maybe_format)
+  {
+    return false;
+  }
+
+  auto const call {variant_call.call};
+  Emitter emitter {gimple_location (call), gimple_block (call), nullptr};
+  auto const value {lower_new (emitter, *maybe_format, variant_call.args)};
+
+  if (value == NULL_TREE)
+  {
+    return false;
+  }
+
+  emitter.call (Glib::VariantBuilderAddValue, {gimple_call_arg (call, 0), value});
+  replace_call (call, emitter.seq);
+
+  return true;
+}
+
+// A constant text without positional parameters always gives the
+// same value, so it is built at compile time instead of being parsed
+// on each call. Texts GLib rejects are left alone, so the program
+// still aborts the same way.
+auto
+lower_new_parsed_call (VariantCall const& variant_call) -> bool
+{
+  if (!variant_call.args.empty ())
+  {
+    return false;
+  }
+
+  auto const maybe_value {Lib::parse_variant_text (variant_call.format)};
+
+  if (!maybe_value)
+  {
+    return false;
+  }
+
+  auto const call {variant_call.call};
+  Emitter emitter {gimple_location (call), gimple_block (call), nullptr};
+  auto const value {build_constant_value (emitter, *maybe_value)};
+
+  if (auto const lhs {gimple_call_lhs (call)}; lhs != NULL_TREE)
+  {
+    emitter.emit (gimple_build_assign (lhs, emitter.convert (value, TREE_TYPE (lhs))));
+  }
+  replace_call (call, emitter.seq);
+
+  return true;
+}
+
+auto
+get_glib_return_type (Glib function) -> tree
+{
+  return TREE_TYPE (TREE_TYPE (get_glib_function_decl (function)));
+}
+
+auto
+get_basic_getter (Lib::Leaf::Basic const& basic) -> Glib
+{
+  auto vh {Lib::VisitHelper {
+    [](Lib::Leaf::Bool const&) { return Glib::VariantGetBoolean; },
+    [](Lib::Leaf::Byte const&) { return Glib::VariantGetByte; },
+    [](Lib::Leaf::I16 const&) { return Glib::VariantGetInt16; },
+    [](Lib::Leaf::U16 const&) { return Glib::VariantGetUint16; },
+    [](Lib::Leaf::I32 const&) { return Glib::VariantGetInt32; },
+    [](Lib::Leaf::U32 const&) { return Glib::VariantGetUint32; },
+    [](Lib::Leaf::I64 const&) { return Glib::VariantGetInt64; },
+    [](Lib::Leaf::U64 const&) { return Glib::VariantGetUint64; },
+    [](Lib::Leaf::Handle const&) { return Glib::VariantGetHandle; },
+    [](Lib::Leaf::Double const&) { return Glib::VariantGetDouble; },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+// The C type of a basic value in the serialized form. Booleans are
+// stored in a single byte.
+auto
+get_basic_serialized_type (Lib::Leaf::Basic const& basic) -> CType
+{
+  auto vh {Lib::VisitHelper {
+    [](Lib::Leaf::Bool const&) { return CType::UChar; },
+    [](Lib::Leaf::Byte const&) { return CType::UChar; },
+    [](Lib::Leaf::I16 const&) { return CType::Short; },
+    [](Lib::Leaf::U16 const&) { return CType::UShort; },
+    [](Lib::Leaf::I32 const&) { return CType::Int; },
+    [](Lib::Leaf::U32 const&) { return CType::UInt; },
+    [](Lib::Leaf::I64 const&) { return CType::LongLong; },
+    [](Lib::Leaf::U64 const&) { return CType::ULongLong; },
+    [](Lib::Leaf::Handle const&) { return CType::Int; },
+    [](Lib::Leaf::Double const&) { return CType::Double; },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+// Whether a value of the type can be stored through the out
+// parameter the same way GLib would store it.
+auto
+out_arg_takes_type (tree arg,
+                    tree type) -> bool
+{
+  auto const pointee {TREE_TYPE (TREE_TYPE (arg))};
+
+  if (INTEGRAL_TYPE_P (type))
+  {
+    return INTEGRAL_TYPE_P (pointee) && TYPE_PRECISION (pointee) == TYPE_PRECISION (type);
+  }
+  if (SCALAR_FLOAT_TYPE_P (type))
+  {
+    return SCALAR_FLOAT_TYPE_P (pointee) && TYPE_PRECISION (pointee) == TYPE_PRECISION (type);
+  }
+
+  return POINTER_TYPE_P (type) && POINTER_TYPE_P (pointee);
+}
+
+// Reads the values from a GVariant the same way g_variant_get would
+// and stores them through the out parameters, in order. GLib skips
+// the values for null out parameters, so does the lowered code.
+struct GetLowering
+{
+  // Returns false if the format or the parameters can't be lowered.
+  auto
+  lower (Lib::VariantFormat const& format,
+         tree value) -> bool;
+
+  auto
+  lower_entry_key (Lib::VF::EntryKeyFormat const& key,
+                   tree value) -> bool;
+
+  auto
+  lower_leaf (Glib getter,
+              tree value) -> bool;
+
+  template <typename LowerMemberFunc>
+  auto
+  lower_child (tree value,
+               std::size_t index,
+               std::size_t args_count,
+               LowerMemberFunc const& lower_member) -> bool;
+
+  // Reads the values straight from the serialized data of a fixed
+  // size container, at offsets computed at compile time.
+  auto
+  lower_fixed (Lib::VariantFormat const& format,
+               tree data,
+               std::size_t offset) -> bool;
+
+  auto
+  lower_fixed_leaf (Lib::Leaf::Basic const& basic,
+                    tree data,
+                    std::size_t offset) -> bool;
+
+  auto
+  take_out_arg () -> tree;
+
+  Emitter& emitter;
+  std::vector<tree> const& args;
+  std::size_t next_arg;
+};
+
+auto
+GetLowering::lower (Lib::VariantFormat const& format,
+                    tree value) -> bool
+{
+  auto vh {Lib::VisitHelper {
+    [this, value](Lib::Leaf::Basic const& basic) { return this->lower_leaf (get_basic_getter (basic), value); },
+    [this, value](Lib::Leaf::StringType const&) { return this->lower_leaf (Glib::VariantDupString, value); },
+    [this, value](Lib::VF::Pointer const&) { return this->lower_leaf (Glib::VariantGetString, value); },
+    [this, value](Lib::Leaf::Variant const&) { return this->lower_leaf (Glib::VariantGetVariant, value); },
+    // "@type", "*", "?" and "r" give a new reference to the value.
+    [this, value](Lib::VF::AtVariantType const&) { return this->lower_leaf (Glib::VariantRef, value); },
+    [this, value](Lib::VF::Tuple const& tuple)
+    {
+      for (auto idx {0u}; idx < tuple.formats.size (); ++idx)
+      {
+        auto const& member {tuple.formats[idx]};
+        auto lower_member {[this, &member](tree child) { return this->lower (member, child); }};
+
+        if (!this->lower_child (value, idx, Lib::args_for_format (member).size (), lower_member))
+        {
+          return false;
+        }
+      }
+
+      return true;
+    },
+    [this, value](Lib::VF::Entry const& entry)
+    {
+      auto lower_key {[this, &entry](tree child) { return this->lower_entry_key (entry.key, child); }};
+      auto lower_value {[this, &entry](tree child) { return this->lower (entry.value, child); }};
+
+      return this->lower_child (value, 0u, 1u, lower_key) &&
+        this->lower_child (value, 1u, Lib::args_for_format (entry.value).size (), lower_value);
+    },
+    // Arrays take a GVariantIter, maybes and the convenience formats
+    // have their own rules - not worth it.
+    [](Lib::VT::Array const&) { return false; },
+    [](Lib::VF::Maybe const&) { return false; },
+    [](Lib::VF::Convenience const&) { return false; },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+auto
+GetLowering::lower_entry_key (Lib::VF::EntryKeyFormat const& key,
+                              tree value) -> bool
+{
+  auto vh {Lib::VisitHelper {
+    [this, value](Lib::Leaf::Basic const& basic) { return this->lower_leaf (get_basic_getter (basic), value); },
+    [this, value](Lib::Leaf::StringType const&) { return this->lower_leaf (Glib::VariantDupString, value); },
+    [this, value](Lib::VF::Pointer const&) { return this->lower_leaf (Glib::VariantGetString, value); },
+    [this, value](Lib::VF::AtEntryKeyType const&) { return this->lower_leaf (Glib::VariantRef, value); },
+  }};
+
+  return std::visit (vh, key.v);
+}
+
+auto
+GetLowering::lower_leaf (Glib getter,
+                         tree value) -> bool
+{
+  auto arg {this->take_out_arg ()};
+
+  if (arg == NULL_TREE)
+  {
+    return false;
+  }
+  if (integer_zerop (arg))
+  {
+    return true;
+  }
+  if (!out_arg_takes_type (arg, get_glib_return_type (getter)))
+  {
+    return false;
+  }
+
+  auto result {NULL_TREE};
+
+  // The string getters can also return the length of the string.
+  if (getter == Glib::VariantGetString || getter == Glib::VariantDupString)
+  {
+    result = this->emitter.call (getter, {value, null_pointer_node});
+  }
+  else
+  {
+    result = this->emitter.call (getter, {value});
+  }
+  this->emitter.store (arg, result);
+
+  return true;
+}
+
+// The child is not fetched at all if all the out parameters for it
+// are null.
+template <typename LowerMemberFunc>
+auto
+GetLowering::lower_child (tree value,
+                          std::size_t index,
+                          std::size_t args_count,
+                          LowerMemberFunc const& lower_member) -> bool
+{
+  if (this->next_arg + args_count > this->args.size ())
+  {
+    return false;
+  }
+
+  auto const first {this->args.cbegin () + this->next_arg};
+
+  if (std::all_of (first, first + args_count, [](tree arg) { return integer_zerop (arg); }))
+  {
+    this->next_arg += args_count;
+    return true;
+  }
+
+  auto child {this->emitter.call (Glib::VariantGetChildValue, {value, size_int (index)})};
+
+  if (!lower_member (child))
+  {
+    return false;
+  }
+  this->emitter.call (Glib::VariantUnref, {child});
+
+  return true;
+}
+
+auto
+GetLowering::lower_fixed (Lib::VariantFormat const& format,
+                          tree data,
+                          std::size_t offset) -> bool
+{
+  auto vh {Lib::VisitHelper {
+    [this, data, offset](Lib::Leaf::Basic const& basic) { return this->lower_fixed_leaf (basic, data, offset); },
+    [this, data, offset, &format](Lib::VF::Tuple const& tuple)
+    {
+      auto maybe_offsets {Lib::fixed_member_offsets (format.to_type ())};
+
+      if (!maybe_offsets)
+      {
+        return false;
+      }
+      for (auto idx {0u}; idx < tuple.formats.size (); ++idx)
+      {
+        if (!this->lower_fixed (tuple.formats[idx], data, offset + (*maybe_offsets)[idx]))
+        {
+          return false;
+        }
+      }
+
+      return true;
+    },
+    [this, data, offset, &format](Lib::VF::Entry const& entry)
+    {
+      auto maybe_offsets {Lib::fixed_member_offsets (format.to_type ())};
+      auto key {std::get_if<Lib::Leaf::Basic> (&entry.key.v)};
+
+      if (!maybe_offsets || key == nullptr)
+      {
+        return false;
+      }
+
+      return this->lower_fixed_leaf (*key, data, offset + (*maybe_offsets)[0]) &&
+        this->lower_fixed (entry.value, data, offset + (*maybe_offsets)[1]);
+    },
+    [](auto const&) { return false; },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+auto
+GetLowering::lower_fixed_leaf (Lib::Leaf::Basic const& basic,
+                               tree data,
+                               std::size_t offset) -> bool
+{
+  auto arg {this->take_out_arg ()};
+
+  if (arg == NULL_TREE)
+  {
+    return false;
+  }
+  if (integer_zerop (arg))
+  {
+    return true;
+  }
+
+  auto const getter {get_basic_getter (basic)};
+
+  if (!out_arg_takes_type (arg, get_glib_return_type (getter)))
+  {
+    return false;
+  }
+
+  // The serialized data may come from anywhere, so it is read
+  // through a pointer that aliases everything and makes no
+  // assumptions about the alignment.
+  auto const type {get_c_type (get_basic_serialized_type (basic))};
+  auto const access_type {build_aligned_type (type, BITS_PER_UNIT)};
+  auto const pointer_type {build_pointer_type_for_mode (access_type, ptr_mode, true)};
+  auto const ref {build2 (MEM_REF, access_type, data, build_int_cst (pointer_type, offset))};
+  auto loaded {create_tmp_var (type)};
+
+  this->emitter.emit (gimple_build_assign (loaded, ref));
+  // Like g_variant_get_boolean, anything but zero is true.
+  if (getter == Glib::VariantGetBoolean)
+  {
+    loaded = this->emitter.compute (NE_EXPR, get_glib_return_type (getter), loaded, build_zero_cst (type));
+  }
+  this->emitter.store (arg, loaded);
+
+  return true;
+}
+
+// Out parameters are either null constants or addresses of
+// variables - anything else might be null at runtime and the lowered
+// code would need to check it.
+auto
+GetLowering::take_out_arg () -> tree
+{
+  if (this->next_arg >= this->args.size ())
+  {
+    return NULL_TREE;
+  }
+
+  auto arg {this->args[this->next_arg]};
+
+  ++this->next_arg;
+  if (!POINTER_TYPE_P (TREE_TYPE (arg)))
+  {
+    return NULL_TREE;
+  }
+  if (!integer_zerop (arg) && TREE_CODE (arg) != ADDR_EXPR)
+  {
+    return NULL_TREE;
+  }
+
+  return arg;
+}
+
+// Makes the rest of the block after the statement run after either
+// the then or the else statements:
+//
+//   stmt; if (condition) then; else else; the rest of the block
+//
+// The then branch is expected to be taken almost always.
+auto
+insert_branch (gimple* stmt,
+               tree condition,
+               gimple_seq then_seq,
+               gimple_seq else_seq) -> void
+{
+  auto const bb {gimple_bb (stmt)};
+  auto gsi {gsi_for_stmt (stmt)};
+  auto const cond {gimple_build_cond (NE_EXPR, condition, build_zero_cst (TREE_TYPE (condition)), NULL_TREE, NULL_TREE)};
+
+  gimple_set_location (cond, gimple_location (stmt));
+  gsi_insert_after (&gsi, cond, GSI_NEW_STMT);
+
+  auto const rest_edge {split_block (bb, cond)};
+  auto const join_bb {rest_edge->dest};
+  auto const then_bb {create_empty_bb (bb)};
+  auto const else_bb {create_empty_bb (then_bb)};
+
+  remove_edge (rest_edge);
+
+  auto const then_edge {make_edge (bb, then_bb, EDGE_TRUE_VALUE)};
+  auto const else_edge {make_edge (bb, else_bb, EDGE_FALSE_VALUE)};
+
+  then_edge->probability = profile_probability::very_likely ();
+  else_edge->probability = then_edge->probability.invert ();
+  make_single_succ_edge (then_bb, join_bb, EDGE_FALLTHRU);
+  make_single_succ_edge (else_bb, join_bb, EDGE_FALLTHRU);
+  then_bb->count = bb->count.apply_probability (then_edge->probability);
+  else_bb->count = bb->count.apply_probability (else_edge->probability);
+  if (current_loops != nullptr)
+  {
+    add_bb_to_loop (then_bb, bb->loop_father);
+    add_bb_to_loop (else_bb, bb->loop_father);
+  }
+
+  auto then_gsi {gsi_start_bb (then_bb)};
+  auto else_gsi {gsi_start_bb (else_bb)};
+
+  gsi_insert_seq_after (&then_gsi, then_seq, GSI_NEW_STMT);
+  gsi_insert_seq_after (&else_gsi, else_seq, GSI_NEW_STMT);
+}
+
+// Makes the call only if the condition computed by the checks does
+// not hold:
+//
+//   checks; if (condition) fast; else the original call; epilogue
+//
+// The condition needs to be computed by the last of the checks.
+auto
+guard_call (gcall* call,
+            gimple_seq checks,
+            tree condition,
+            gimple_seq fast,
+            gimple_seq epilogue) -> void
+{
+  auto const last_check {gimple_seq_last_stmt (checks)};
+  auto gsi {gsi_for_stmt (call)};
+
+  gsi_insert_seq_before (&gsi, checks, GSI_SAME_STMT);
+  gsi_insert_seq_after (&gsi, epilogue, GSI_SAME_STMT);
+  gsi_remove (&gsi, false);
+  insert_branch (last_check, condition, fast, gimple_seq_alloc_with_stmt (call));
+}
+
+// The code reading the values of a GVariant, emitted by lower_get.
+struct LoweredGet
+{
+  // Whether the GVariant has the type described by the format,
+  // computed by the last of the checks.
+  tree condition;
+  // Fixed size containers are read straight from the serialized data
+  // only if it has the expected size. Otherwise they are read child by
+  // child, which gives default values for the members, like GLib does.
+  // The size check is the last of the fast statements, the branch is
+  // added by insert_size_branch once they are in place. All unset for
+  // other formats.
+  gimple* size_check;
+  tree has_size;
+  gimple_seq fixed;
+  gimple_seq children;
+};
+
+// Emits the code reading the values of a fixed size container to
+// fixed and the code checking its size to fast. Returns false for
+// other formats.
+auto
+lower_fixed_get (Emitter& fast,
+                 Lib::VariantFormat const& format,
+                 tree value,
+                 std::vector<tree> const& args,
+                 LoweredGet& lowered) -> bool
+{
+  if (!std::holds_alternative<Lib::VF::Tuple> (format.v) &&
+      !std::holds_alternative<Lib::VF::Entry> (format.v))
+  {
+    return false;
+  }
+
+  auto const maybe_layout {Lib::layout_of (format.to_type ())};
+
+  if (!maybe_layout || !maybe_layout->fixed_size)
+  {
+    return false;
+  }
+
+  Emitter fixed {fast.location, fast.block, nullptr};
+  GetLowering lowering {fixed, args, 0u};
+  auto const data {fixed.call (Glib::VariantGetData, {value})};
+
+  if (!lowering.lower_fixed (format, data, 0u) || lowering.next_arg != args.size ())
+  {
+    return false;
+  }
+
+  auto const size {fast.call (Glib::VariantGetSize, {value})};
+
+  lowered.has_size = fast.compute (EQ_EXPR, boolean_type_node, size, build_int_cst (TREE_TYPE (size), *maybe_layout->fixed_size));
+  lowered.size_check = gimple_seq_last_stmt (fast.seq);
+  lowered.fixed = fixed.seq;
+
+  return true;
+}
+
+// Emits the code reading the values into the out parameters to fast
+// and the code checking whether the GVariant has the type described
+// by the format to checks. The fast code runs only if the type
+// matches, so it may look at the GVariant, which may be null
+// otherwise. Returns nothing if the format or the parameters can't be
+// lowered.
+auto
+lower_get (Emitter& checks,
+           Emitter& fast,
+           Lib::VariantFormat const& format,
+           tree value,
+           std::vector<tree> const& args) -> std::optional<LoweredGet>
+{
+  auto const type_string {type_to_string (format.to_type ())};
+  auto const type_literal {build_string_literal (type_string.size () + 1, type_string.c_str ())};
+  auto const is_of_type {checks.call (Glib::VariantIsOfType, {value, type_literal})};
+  LoweredGet lowered {checks.compute (NE_EXPR, boolean_type_node, is_of_type, integer_zero_node),
+                      nullptr,
+                      NULL_TREE,
+                      nullptr,
+                      nullptr};
+  Emitter children {fast.location, fast.block, nullptr};
+  GetLowering lowering {children, args, 0u};
+
+  if (!lowering.lower (format, value) || lowering.next_arg != args.size ())
+  {
+    return {};
+  }
+  if (lower_fixed_get (fast, format, value, args, lowered))
+  {
+    lowered.children = children.seq;
+  }
+  else
+  {
+    gimple_seq_add_seq (&fast.seq, children.seq);
+  }
+
+  return {lowered};
+}
+
+auto
+insert_size_branch (LoweredGet const& lowered) -> void
+{
+  if (lowered.size_check != nullptr)
+  {
+    insert_branch (lowered.size_check, lowered.has_size, lowered.fixed, lowered.children);
+  }
+}
+
+// The values are read only if the GVariant has the type described by
+// the format. Otherwise the original call is made, so GLib reports
+// the problem the same way it always does.
+auto
+lower_get_call (VariantCall const& variant_call,
+                bool from_child) -> bool
+{
+  auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+  if (!maybe_format)
+  {
+    return false;
+  }
+
+  auto const call {variant_call.call};
+  auto const location {gimple_location (call)};
+  auto const block {gimple_block (call)};
+  Emitter checks {location, block, nullptr};
+  Emitter fast {location, block, nullptr};
+  Emitter epilogue {location, block, nullptr};
+  auto value {gimple_call_arg (call, 0)};
+
+  if (from_child)
+  {
+    // This is what g_variant_get_child does too, so the original
+    // call fetches the child again only when the types mismatch.
+    value = checks.call (Glib::VariantGetChildValue, {value, gimple_call_arg (call, 1)});
+    epilogue.call (Glib::VariantUnref, {value});
+  }
+
+  auto const lowered {lower_get (checks, fast, *maybe_format, value, variant_call.args)};
+
+  if (!lowered)
+  {
+    return false;
+  }
+
+  guard_call (call, checks.seq, lowered->condition, fast.seq, epilogue.seq);
+  insert_size_branch (*lowered);
+
+  return true;
+}
+
+// g_variant_iter_next takes the next child and reads it like
+// g_variant_get does, returning false when there are no more
+// children. The original call can't be the fallback, because the
+// child is already taken, so g_variant_get reports mismatched types
+// instead and the result is false, like in GLib. A child of the right
+// type is always read and the result is true, even if it is a fixed
+// size container with serialized data of a wrong size - GLib gives
+// default values then, and so do the child by child reads:
+//
+//   value = g_variant_iter_next_value (iter); result = 0;
+//   if (value != NULL)
+//     {
+//       if (is of type)
+//         {
+//           if (has the fixed size) read the serialized data;
+//           else read the children;
+//           result = 1;
+//         }
+//       else g_variant_get (value, format, ...);
+//       g_variant_unref (value);
+//     }
+auto
+lower_iter_next_call (VariantCall const& variant_call) -> bool
+{
+  auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+  if (!maybe_format)
+  {
+    return false;
+  }
+
+  auto const call {variant_call.call};
+  auto const location {gimple_location (call)};
+  auto const block {gimple_block (call)};
+  Emitter prologue {location, block, nullptr};
+  Emitter checks {location, block, nullptr};
+  Emitter fast {location, block, nullptr};
+  Emitter slow {location, block, nullptr};
+  Emitter epilogue {location, block, nullptr};
+  auto const value {prologue.call (Glib::VariantIterNextValue, {gimple_call_arg (call, 0)})};
+  auto const result {create_tmp_var (integer_type_node)};
+
+  prologue.emit (gimple_build_assign (result, integer_zero_node));
+
+  auto const has_value {prologue.compute (NE_EXPR, boolean_type_node, value, null_pointer_node)};
+  auto const lowered {lower_get (checks, fast, *maybe_format, value, variant_call.args)};
+
+  if (!lowered)
+  {
+    return false;
+  }
+
+  auto const last_prologue {gimple_seq_last_stmt (prologue.seq)};
+  auto const last_check {gimple_seq_last_stmt (checks.seq)};
+  std::vector<tree> slow_args {value, gimple_call_arg (call, 1)};
+
+  checks.call (Glib::VariantUnref, {value});
+  // After the size branch, so both of its sides set it.
+  fast.emit (gimple_build_assign (result, integer_one_node));
+  slow_args.insert (slow_args.end (), variant_call.args.cbegin (), variant_call.args.cend ());
+  slow.call (Glib::VariantGet, slow_args);
+  if (auto const lhs {gimple_call_lhs (call)}; lhs != NULL_TREE)
+  {
+    epilogue.emit (gimple_build_assign (lhs, epilogue.convert (result, TREE_TYPE (lhs))));
+  }
+
+  auto gsi {gsi_for_stmt (call)};
+
+  gsi_insert_seq_before (&gsi, prologue.seq, GSI_SAME_STMT);
+  gsi_insert_seq_after (&gsi, epilogue.seq, GSI_SAME_STMT);
+  gsi_remove (&gsi, true);
+  insert_branch (last_prologue, has_value, checks.seq, nullptr);
+  insert_branch (last_check, lowered->condition, fast.seq, slow.seq);
+  insert_size_branch (*lowered);
+
+  return true;
+}
+
+enum class Lowering
+{
+  New,
+  BuilderAdd,
+  Get,
+  GetChild,
+  IterNext,
+  NewParsed,
+};
+
+struct LoweredFunction
+{
+  // The 1-based indices of the format and the first formatted
+  // parameter.
+  FormatInfo info;
+  Lowering lowering;
+};
+
+// g_variant_iter_loop is not lowered - it keeps the previous child in
+// the private part of the iterator to free the values read from it
+// on the next call.
+std::map<std::string, LoweredFunction> const lowered_functions {
+  {"g_variant_new", {{FormatType::New, 1u, 2u}, Lowering::New}},
+  {"g_variant_builder_add", {{FormatType::New, 2u, 3u}, Lowering::BuilderAdd}},
+  {"g_variant_get", {{FormatType::Get, 2u, 3u}, Lowering::Get}},
+  {"g_variant_get_child", {{FormatType::Get, 3u, 4u}, Lowering::GetChild}},
+  {"g_variant_iter_next", {{FormatType::Get, 2u, 3u}, Lowering::IterNext}},
+  // The text is not a format, but it is taken from the same place.
+  {"g_variant_new_parsed", {{FormatType::New, 1u, 2u}, Lowering::NewParsed}},
+};
+
+// Returns whether the call was lowered.
+auto
+lower_call (VariantCall const& variant_call,
+            Lowering lowering) -> bool
+{
+  switch (lowering)
+  {
+  case Lowering::New:
+    return lower_new_call (variant_call);
+  case Lowering::BuilderAdd:
+    return lower_builder_add_call (variant_call);
+  case Lowering::Get:
+    return lower_get_call (variant_call, false);
+  case Lowering::GetChild:
+    return lower_get_call (variant_call, true);
+  case Lowering::IterNext:
+    return lower_iter_next_call (variant_call);
+  case Lowering::NewParsed:
+    return lower_new_parsed_call (variant_call);
+  }
+
+  gcc_unreachable ();
+}
+
+// Returns the address of the compiled format in .rodata or NULL_TREE
+// if libggp-rt can't run it.
+auto
+build_program_literal (Lib::VariantFormat const& format) -> tree
+{
+  if (!Lib::program_is_runnable (format))
+  {
+    return NULL_TREE;
+  }
+
+  auto const program {Lib::compile_program (format)};
+
+  return build_string_literal (program.size (), reinterpret_cast<char const*> (program.data ()));
+}
+
+// Redirects the call to libggp-rt, which runs the format compiled
+// into a program instead of parsing the format string. This is for
+// calls that are not rewritten into calls to functions that take no
+// format, because the code would be too large or it is not possible.
+// The formatted parameters are passed as they are.
+auto
+redirect_call_to_program (VariantCall const& variant_call,
+                          Lowering lowering) -> bool
+{
+  // There is no program for a text.
+  if (lowering == Lowering::NewParsed)
+  {
+    return false;
+  }
+
+  auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+  if (!maybe_format)
+  {
+    return false;
+  }
+  if (lowering == Lowering::New && std::holds_alternative<Lib::VF::AtVariantType> (maybe_format->v))
+  {
+    return false;
+  }
+
+  auto const program {build_program_literal (*maybe_format)};
+
+  if (program == NULL_TREE)
+  {
+    return false;
+  }
+
+  auto const call {variant_call.call};
+  Emitter emitter {gimple_location (call), gimple_block (call), nullptr};
+  std::vector<tree> args;
+
+  switch (lowering)
+  {
+  case Lowering::New:
+  case Lowering::BuilderAdd:
+    {
+      args.push_back (program);
+      args.insert (args.end (), variant_call.args.cbegin (), variant_call.args.cend ());
+
+      auto const value {emitter.call (Glib::GgpVariantNewProgram, args)};
+
+      if (lowering == Lowering::BuilderAdd)
+      {
+        emitter.call (Glib::VariantBuilderAddValue, {gimple_call_arg (call, 0), value});
+      }
+      else if (auto const lhs {gimple_call_lhs (call)}; lhs != NULL_TREE)
+      {
+        emitter.emit (gimple_build_assign (lhs, emitter.convert (value, TREE_TYPE (lhs))));
+      }
+      break;
+    }
+  case Lowering::Get:
+    args.push_back (gimple_call_arg (call, 0));
+    args.push_back (program);
+    args.insert (args.end (), variant_call.args.cbegin (), variant_call.args.cend ());
+    emitter.call (Glib::GgpVariantGetProgram, args);
+    break;
+  case Lowering::GetChild:
+    {
+      auto const child {emitter.call (Glib::VariantGetChildValue, {gimple_call_arg (call, 0), gimple_call_arg (call, 1)})};
+
+      args.push_back (child);
+      args.push_back (program);
+      args.insert (args.end (), variant_call.args.cbegin (), variant_call.args.cend ());
+      emitter.call (Glib::GgpVariantGetProgram, args);
+      emitter.call (Glib::VariantUnref, {child});
+      break;
+    }
+  case Lowering::IterNext:
+    // Needs the same branches as the lowering, so there is nothing
+    // to gain.
+    return false;
+  case Lowering::NewParsed:
+    // Handled above.
+    return false;
+  }
+
+  replace_call (call, emitter.seq);
+
+  return true;
+}
+
+// Lists the lowered calls with -fopt-info-optimized, the integration
+// tests and the benchmarks check them to make sure that they really
+// run the lowered code.
+auto
+report_lowered_call (location_t location,
+                     VariantCall const& variant_call,
+                     bool to_program) -> void
+{
+  if (dump_enabled_p ())
+  {
+    dump_printf_loc (MSG_OPTIMIZED_LOCATIONS,
+                     dump_user_location_t::from_location_t (location),
+                     "%s %s call with format \"%s\"%s\n",
+                     to_program ? "redirected" : "lowered",
+                     variant_call.name.c_str (),
+                     variant_call.format,
+                     to_program ? " to a format program" : "");
+  }
+}
+
+// Calls that may throw are left alone, removing them would need
+// fixing up the EH edges.
+auto
+may_be_lowered (gcall* call) -> bool
+{
+  return !flag_exceptions || gimple_call_nothrow_p (call);
+}
+
+const pass_data lw_cfg_pass_data =
+{
+  GIMPLE_PASS, /* type */
+  "lw_cfg", /* name */
+  OPTGROUP_OTHER, /* optinfo_flags */
+  TV_NONE, /* tv_id */
+  PROP_cfg, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class lw_cfg_pass : public gimple_opt_pass
+{
+public:
+  lw_cfg_pass(gcc::context *ctxt,
+              LowererOptions const& options)
+    : gimple_opt_pass(lw_cfg_pass_data, ctxt),
+      options {options}
+  {}
+
+  /* opt_pass methods: */
+  virtual unsigned int execute (function *) override;
+
+private:
+  LowererOptions options;
+};
+
+unsigned int
+lw_cfg_pass::execute (function* fn)
+{
+  std::vector<std::pair<VariantCall, Lowering>> calls;
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      auto call {dyn_cast<gcall*> (gsi_stmt (gsi))};
+
+      if (call == nullptr || !may_be_lowered (call))
+      {
+        continue;
+      }
+
+      auto const name {get_called_function_name (call)};
+
+      if (name == nullptr)
+      {
+        continue;
+      }
+      if (auto iter {lowered_functions.find (name)}; iter != lowered_functions.cend ())
+      {
+        if (auto maybe_call {make_variant_call (call, iter->second.info)};
+            maybe_call && maybe_call->format != nullptr)
+        {
+          calls.emplace_back (std::move (*maybe_call), iter->second.lowering);
+        }
+      }
+    }
+  }
+
+  if (calls.empty ())
+  {
+    return 0;
+  }
+
+  // Some lowerings add new blocks, the dominators are recomputed when
+  // needed and the loops are fixed up later.
+  free_dominance_info (CDI_DOMINATORS);
+
+  // Programs are much smaller than the lowered code, so they are
+  // preferred in functions optimized for size.
+  auto const prefer_programs {this->options.programs && optimize_function_for_size_p (fn)};
+
+  // Lowering changes the statements, so it can't be done while
+  // iterating them.
+  for (auto const& [variant_call, lowering] : calls)
+  {
+    // The call is gone after lowering it.
+    auto const location {gimple_location (variant_call.call)};
+
+    if (this->options.calls && !prefer_programs && lower_call (variant_call, lowering))
+    {
+      report_lowered_call (location, variant_call, false);
+      if (current_loops != nullptr)
+      {
+        loops_state_set (LOOPS_NEED_FIXUP);
+      }
+      continue;
+    }
+    if (this->options.programs && redirect_call_to_program (variant_call, lowering))
+    {
+      report_lowered_call (location, variant_call, true);
+    }
+  }
+
+  return 0;
+}
+
+std::unique_ptr<register_pass_info>
+get_register_lw_cfg_pass_info (LowererOptions const& options)
+{
+  // g - a global gcc::context
+  //
+  // Runs after the perf advisor, so it gets to see the calls before
+  // they are lowered.
+  register_pass_info pass_info { new lw_cfg_pass (g, options), "pa_cfg", 1, PASS_POS_INSERT_AFTER };
+  return std::make_unique<register_pass_info> (pass_info);
+}
+
+} // anonymous namespace
+
+Lowerer::Lowerer (struct plugin_name_args* plugin_info)
+  : name {subplugin_name (plugin_info, "lw")},
+    options {get_plugin_arg_bool (plugin_info, "lower", false),
+             get_plugin_arg_bool (plugin_info, "lower-programs", false)}
+{
+  if (!this->options.calls && !this->options.programs)
+  {
+    return;
+  }
+
+  // Nothing to unregister for the PLUGIN_REGISTER_GGC_ROOTS and
+  // PLUGIN_PASS_MANAGER_SETUP events - they take no callbacks.
+  ::register_callback (name.c_str (),
+                       PLUGIN_REGISTER_GGC_ROOTS,
+                       NULL,
+                       const_cast<ggc_root_tab*> (glib_function_decls_roots));
+
+  this->finish_decl.emplace (name, PLUGIN_FINISH_DECL, ggp_lw_finish_decl, nullptr);
+
+  auto reg_pass_info {get_register_lw_cfg_pass_info (this->options)};
+
+  ::register_callback (name.c_str (),
+                       PLUGIN_PASS_MANAGER_SETUP,
+                       NULL,
+                       reg_pass_info.get ());
+}
+
+} // namespace Ggp::Gcc
@@ -0,0 +1,62 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_LW_HH
+#define GGP_LW_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/util.hh"
+
+#include <optional>
+#include <string>
+
+namespace Ggp::Gcc
+{
+
+struct LowererOptions
+{
+  // Rewrite the calls into calls to functions that take no format.
+  bool calls;
+  // Redirect the calls to libggp-rt with the format compiled into a
+  // program. The code needs to be linked with libggp-rt then.
+  bool programs;
+};
+
+// Lowering - rewrites calls to GVariant functions taking a constant
+// format string into calls to functions that take no format, so the
+// format is not parsed again at runtime. Constant texts passed to
+// g_variant_new_parsed are built at compile time too. It is off by
+// default, -fplugin-arg-<plugin>-lower enables it.
+//
+// -fplugin-arg-<plugin>-lower-programs enables redirecting the calls
+// that are not rewritten, or all of them in functions optimized for
+// size, to libggp-rt.
+struct Lowerer
+{
+  Lowerer(struct plugin_name_args* plugin_info);
+
+  std::string name;
+  LowererOptions options;
+  // Set only if the lowering is enabled.
+  std::optional<CallbackRegistration> finish_decl;
+};
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_LW_HH */
@@ -16,10 +16,16 @@
  * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "ggp/gcc/filter.hh"
 #include "ggp/gcc/main.hh"
 #include "ggp/gcc/util.hh"
+#include "ggp/gcc/lw.hh"
+#include "ggp/gcc/pa.hh"
+#include "ggp/gcc/rc.hh"
+#include "ggp/gcc/sarif.hh"
 #include "ggp/gcc/tc.hh"
 #include "ggp/gcc/vc.hh"
+#include "ggp/gcc/wp.hh"
 
 namespace Ggp::Gcc
 {
@@ -31,8 +37,17 @@ struct Main
   Main (struct plugin_name_args* plugin_info);
 
   std::string name;
+  SourceFilter filter;
+  // Needs to come before the checkers, they record diagnostics in it
+  // until they are gone.
+  SarifLog sarif;
   VariantChecker vc;
   TupleChecker tc;
+  PerfAdvisor pa;
+  // Needs to come after pa, it puts its pass after the pa one.
+  Lowerer lw;
+  RuntimeChecker rc;
+  WholeProgramChecker wp;
   CallbackRegistration finish_unit;
 };
 
@@ -45,8 +60,14 @@ main_finish (void* /* gcc_data */,
 
 Main::Main (struct plugin_name_args* plugin_info)
   : name {subplugin_name (plugin_info, "main")},
-    vc {plugin_info},
+    filter {plugin_info},
+    sarif {plugin_info},
+    vc {plugin_info, filter, sarif},
     tc {plugin_info},
+    pa {plugin_info, filter},
+    lw {plugin_info},
+    rc {plugin_info},
+    wp {plugin_info, filter, sarif},
     finish_unit {name, PLUGIN_FINISH_UNIT, main_finish, this}
 {}
 
@@ -0,0 +1,2211 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/args.hh"
+#include "ggp/gcc/call.hh"
+#include "ggp/gcc/pa.hh"
+
+#include "ggp/gcc/generated/advice.hh"
+#include "ggp/gcc/generated/boxing.hh"
+#include "ggp/gcc/generated/cost.hh"
+#include "ggp/gcc/generated/index.hh"
+#include "ggp/gcc/generated/member-order.hh"
+#include "ggp/gcc/generated/serialize.hh"
+#include "ggp/gcc/generated/variant.hh"
+#include "ggp/gcc/generated/variant-print.hh"
+#include "ggp/gcc/generated/variant-text.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+namespace Ggp::Gcc
+{
+
+namespace {
+
+// Collects advice on the statements of a function. It is given
+// later, by the pa_profile pass, see give_advice.
+struct Advisor
+{
+  auto
+  advise (gimple* stmt, std::string const& message) -> void;
+
+  function* fn;
+  std::vector<PendingAdvice>& pending_advice;
+};
+
+auto
+get_location_string (gimple* stmt) -> std::string
+{
+  auto const location {expand_location (gimple_location (stmt))};
+  std::ostringstream oss;
+
+  oss << (location.file != nullptr ? location.file : "<unknown>") << ':'
+      << location.line << ':' << location.column;
+
+  return oss.str ();
+}
+
+auto
+Advisor::advise (gimple* stmt, std::string const& message) -> void
+{
+  this->pending_advice.push_back ({gimple_location (stmt),
+                                   {get_location_string (stmt),
+                                    function_name (this->fn),
+                                    {},
+                                    message}});
+}
+
+// Maps variables to statements that assign to them (or to their
+// parts).
+using Definitions = std::map<tree, std::vector<gimple*>>;
+
+auto
+collect_definitions (function* fn) -> Definitions
+{
+  Definitions definitions;
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      auto stmt {gsi_stmt (gsi)};
+      auto lhs {gimple_get_lhs (stmt)};
+
+      while (lhs != NULL_TREE && handled_component_p (lhs))
+      {
+        lhs = TREE_OPERAND (lhs, 0);
+      }
+      if (lhs != NULL_TREE && DECL_P (lhs))
+      {
+        definitions[lhs].push_back (stmt);
+      }
+    }
+  }
+
+  return definitions;
+}
+
+// Decides whether an operand has the same value on every iteration
+// of a loop. This runs before SSA, so it needs to look at the
+// assignments to variables by itself. It is conservative - variables
+// that may be changed through pointers, non-constant globals and
+// pointers to non-constant data are never invariant.
+struct InvarianceChecker
+{
+  auto
+  is_invariant (tree op) -> bool;
+
+  auto
+  decl_is_invariant (tree decl) -> bool;
+
+  class loop* loop;
+  Definitions const& definitions;
+  std::set<tree> visiting;
+};
+
+auto
+InvarianceChecker::is_invariant (tree op) -> bool
+{
+  if (op == NULL_TREE || CONSTANT_CLASS_P (op))
+  {
+    return true;
+  }
+
+  switch (TREE_CODE (op))
+  {
+  case ADDR_EXPR:
+    {
+      auto base {TREE_OPERAND (op, 0)};
+
+      while (handled_component_p (base))
+      {
+        base = TREE_OPERAND (base, 0);
+      }
+
+      return (TREE_CODE (base) == STRING_CST) ||
+        (VAR_P (base) && is_global_var (base) && TREE_READONLY (base));
+    }
+
+  case VAR_DECL:
+  case PARM_DECL:
+    return this->decl_is_invariant (op);
+
+  default:
+    return false;
+  }
+}
+
+auto
+InvarianceChecker::decl_is_invariant (tree decl) -> bool
+{
+  if (VAR_P (decl) && is_global_var (decl))
+  {
+    return TREE_READONLY (decl);
+  }
+  if (TREE_ADDRESSABLE (decl))
+  {
+    return false;
+  }
+  if (auto type {TREE_TYPE (decl)};
+      POINTER_TYPE_P (type) && !TYPE_READONLY (TREE_TYPE (type)))
+  {
+    return false;
+  }
+
+  auto iter {this->definitions.find (decl)};
+
+  if (iter == this->definitions.end ())
+  {
+    return true;
+  }
+
+  auto const& defs {iter->second};
+  auto const defined_in_loop {std::any_of (defs.cbegin (),
+                                           defs.cend (),
+                                           [this](gimple* def)
+                                           {
+                                             return flow_bb_inside_loop_p (this->loop, gimple_bb (def));
+                                           })};
+
+  if (!defined_in_loop)
+  {
+    return true;
+  }
+  // A variable assigned in the loop is still invariant if it is
+  // assigned only once in the whole function and the assigned value
+  // is invariant - this is what the gimplifier does with
+  // temporaries.
+  if (defs.size () != 1)
+  {
+    return false;
+  }
+
+  auto assign {dyn_cast<gassign*> (defs.front ())};
+
+  if (assign == nullptr)
+  {
+    return false;
+  }
+  if (auto [visiting_iter, inserted] {this->visiting.insert (decl)}; !inserted)
+  {
+    return false;
+  }
+
+  auto invariant {true};
+
+  for (auto idx {1u}; invariant && idx < gimple_num_ops (assign); ++idx)
+  {
+    invariant = this->is_invariant (gimple_op (assign, idx));
+  }
+  this->visiting.erase (decl);
+
+  return invariant;
+}
+
+// Functions that take a type string (usually through
+// G_VARIANT_TYPE) and validate it on each call. The number is the
+// 0-based index of the type string parameter.
+std::map<std::string, unsigned> const type_string_functions {
+  {"g_variant_type_new", 0u},
+  {"g_variant_type_checked_", 0u},
+};
+
+// Returns the outermost loop containing the call in which all the
+// call arguments are invariant or nullptr if there is no such loop.
+auto
+outermost_invariant_loop (gcall* call,
+                          Definitions const& definitions) -> class loop*
+{
+  class loop* outermost {nullptr};
+
+  for (auto loop {gimple_bb (call)->loop_father};
+       loop != nullptr && loop_depth (loop) > 0;
+       loop = loop_outer (loop))
+  {
+    InvarianceChecker checker {loop, definitions, {}};
+
+    for (auto idx {0u}; idx < gimple_call_num_args (call); ++idx)
+    {
+      if (!checker.is_invariant (gimple_call_arg (call, idx)))
+      {
+        return outermost;
+      }
+    }
+    outermost = loop;
+  }
+
+  return outermost;
+}
+
+auto
+advise_invariant_construction (Advisor& advisor,
+                               gcall* call,
+                               std::string const& what,
+                               Definitions const& definitions) -> void
+{
+  auto const loop {outermost_invariant_loop (call, definitions)};
+
+  if (loop == nullptr)
+  {
+    return;
+  }
+
+  auto const depth {loop_depth (gimple_bb (call)->loop_father)};
+  auto const levels {depth - loop_depth (loop) + 1};
+  std::ostringstream oss;
+
+  oss << what << " is redone on every iteration of a loop at nesting depth "
+      << depth << ", but its format and arguments are invariant in "
+      << levels << " enclosing loop(s); consider hoisting it out of the loop"
+      << " (with g_variant_ref_sink) or caching the value";
+  advisor.advise (call, oss.str ());
+}
+
+auto
+advise_loop_invariant_constructions (Advisor& advisor,
+                                     function* fn) -> void
+{
+  std::optional<Definitions> definitions;
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    if (bb->loop_father == nullptr || loop_depth (bb->loop_father) == 0)
+    {
+      continue;
+    }
+
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      auto const stmt {gsi_stmt (gsi)};
+      std::string what;
+
+      if (auto maybe_call {get_variant_call (stmt)}; maybe_call)
+      {
+        // Only the constructions - functions returning the built
+        // value.
+        if (maybe_call->info.type != FormatType::New ||
+            maybe_call->format == nullptr ||
+            !POINTER_TYPE_P (gimple_call_return_type (maybe_call->call)))
+        {
+          continue;
+        }
+        what = maybe_call->name + " (\"" + maybe_call->format + "\", ...)";
+      }
+      else if (auto call {dyn_cast<gcall*> (stmt)}; call != nullptr)
+      {
+        auto const name {get_called_function_name (call)};
+
+        if (name == nullptr)
+        {
+          continue;
+        }
+
+        auto iter {type_string_functions.find (name)};
+
+        if (iter == type_string_functions.cend () ||
+            iter->second >= gimple_call_num_args (call))
+        {
+          continue;
+        }
+
+        auto const type_string {get_string_literal (gimple_call_arg (call, iter->second))};
+
+        if (type_string == nullptr)
+        {
+          continue;
+        }
+        what = iter->first + " (\"" + type_string + "\")";
+      }
+      else
+      {
+        continue;
+      }
+
+      if (!definitions)
+      {
+        definitions = collect_definitions (fn);
+      }
+      advise_invariant_construction (advisor, as_a<gcall*> (stmt), what, *definitions);
+    }
+  }
+}
+
+auto
+find_decl (tree* tp, int* /* walk_subtrees */, void* data) -> tree
+{
+  return (*tp == static_cast<tree> (data)) ? *tp : NULL_TREE;
+}
+
+auto
+tree_mentions (tree expr, tree decl) -> bool
+{
+  return expr != NULL_TREE && walk_tree (&expr, find_decl, decl, nullptr) != NULL_TREE;
+}
+
+auto
+stmt_mentions (gimple* stmt, tree decl) -> bool
+{
+  for (auto idx {0u}; idx < gimple_num_ops (stmt); ++idx)
+  {
+    if (tree_mentions (gimple_op (stmt, idx), decl))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+auto
+statements_mentioning (function* fn, tree decl) -> std::vector<gimple*>
+{
+  std::vector<gimple*> stmts;
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      if (stmt_mentions (gsi_stmt (gsi), decl))
+      {
+        stmts.push_back (gsi_stmt (gsi));
+      }
+    }
+  }
+
+  return stmts;
+}
+
+// Whether the variable is a temporary introduced by the gimplifier.
+auto
+is_temporary (tree var) -> bool
+{
+  return VAR_P (var) &&
+    DECL_ARTIFICIAL (var) &&
+    !TREE_ADDRESSABLE (var) &&
+    !is_global_var (var);
+}
+
+// Returns the temporary the statement loads the variable into or
+// NULL_TREE.
+auto
+get_loaded_temporary (gimple* stmt, tree var) -> tree
+{
+  auto assign {dyn_cast<gassign*> (stmt)};
+
+  if (assign == nullptr ||
+      !gimple_assign_single_p (assign) ||
+      gimple_assign_rhs1 (assign) != var ||
+      !is_temporary (gimple_assign_lhs (assign)))
+  {
+    return NULL_TREE;
+  }
+
+  return gimple_assign_lhs (assign);
+}
+
+// Returns the local variable whose address is passed as an out
+// parameter or NULL_TREE.
+auto
+get_out_variable (tree arg) -> tree
+{
+  if (TREE_CODE (arg) != ADDR_EXPR)
+  {
+    return NULL_TREE;
+  }
+
+  auto var {TREE_OPERAND (arg, 0)};
+
+  if (!VAR_P (var) || is_global_var (var))
+  {
+    return NULL_TREE;
+  }
+
+  return var;
+}
+
+auto
+is_called (gcall* call, std::set<std::string> const& names) -> bool
+{
+  auto const name {get_called_function_name (call)};
+
+  return name != nullptr && names.find (name) != names.cend ();
+}
+
+// Functions taking a non-const pointer, but only reading through it.
+std::set<std::string> const read_only_functions {
+  "g_strv_length",
+};
+
+std::set<std::string> const freeing_functions {
+  "g_free",
+  "g_strfreev",
+};
+
+// Functions that may drop the last reference to the GVariant (or
+// the GVariantIter) the strings were taken from.
+std::set<std::string> const releasing_functions {
+  "g_clear_pointer",
+  "g_variant_iter_free",
+  "g_variant_unref",
+};
+
+// Follows the uses of a temporary holding a duplicated string (or a
+// pointer derived from it) and makes sure that it is only
+// read. Calls freeing the string are collected.
+struct ReadChecker
+{
+  auto
+  only_read (tree temp,
+             bool can_free) -> bool;
+
+  auto
+  call_only_reads (gcall* call,
+                   tree temp) -> bool;
+
+  function* fn;
+  std::vector<gcall*> frees;
+  std::set<tree> visited;
+};
+
+auto
+ReadChecker::only_read (tree temp,
+                        bool can_free) -> bool
+{
+  if (auto [visited_iter, inserted] {this->visited.insert (temp)}; !inserted)
+  {
+    return true;
+  }
+
+  auto defs {0u};
+
+  for (auto stmt : statements_mentioning (this->fn, temp))
+  {
+    auto const lhs {gimple_get_lhs (stmt)};
+
+    if (lhs == temp)
+    {
+      ++defs;
+      continue;
+    }
+    if (tree_mentions (lhs, temp))
+    {
+      return false;
+    }
+
+    switch (gimple_code (stmt))
+    {
+    case GIMPLE_COND:
+      break;
+
+    case GIMPLE_CALL:
+      {
+        auto call {as_a<gcall*> (stmt)};
+
+        if (can_free &&
+            is_called (call, freeing_functions) &&
+            gimple_call_num_args (call) == 1 &&
+            gimple_call_arg (call, 0) == temp)
+        {
+          this->frees.push_back (call);
+        }
+        else if (!this->call_only_reads (call, temp))
+        {
+          return false;
+        }
+      }
+      break;
+
+    case GIMPLE_ASSIGN:
+      // A copy of the pointer could outlive the GVariant, but
+      // loading the characters (or the strings in an array) is
+      // fine as long as they are only read too.
+      if (gimple_assign_single_p (stmt) && gimple_assign_rhs1 (stmt) == temp)
+      {
+        return false;
+      }
+      if (POINTER_TYPE_P (TREE_TYPE (lhs)) &&
+          (!is_temporary (lhs) || !this->only_read (lhs, false)))
+      {
+        return false;
+      }
+      break;
+
+    default:
+      return false;
+    }
+  }
+
+  return defs == 1;
+}
+
+auto
+ReadChecker::call_only_reads (gcall* call,
+                              tree temp) -> bool
+{
+  auto const fntype {gimple_call_fntype (call)};
+
+  if (gimple_call_internal_p (call) || fntype == NULL_TREE)
+  {
+    return false;
+  }
+  if (is_called (call, read_only_functions))
+  {
+    return true;
+  }
+
+  auto params {TYPE_ARG_TYPES (fntype)};
+
+  for (auto idx {0u}; idx < gimple_call_num_args (call); ++idx)
+  {
+    auto const param_type {params != NULL_TREE ? TREE_VALUE (params) : NULL_TREE};
+    auto const arg {gimple_call_arg (call, idx)};
+
+    if (params != NULL_TREE)
+    {
+      params = TREE_CHAIN (params);
+    }
+    if (!tree_mentions (arg, temp))
+    {
+      continue;
+    }
+    if (arg != temp)
+    {
+      return false;
+    }
+    if (param_type == NULL_TREE)
+    {
+      // Variadic parameters are only fine for printf-like
+      // functions.
+      if (lookup_attribute ("format", TYPE_ATTRIBUTES (fntype)) == NULL_TREE)
+      {
+        return false;
+      }
+    }
+    else if (!POINTER_TYPE_P (param_type) || !TYPE_READONLY (TREE_TYPE (param_type)))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Returns statements that may be executed after the from statement
+// and before the to statement. In case of loops it may return more.
+auto
+statements_between (gimple* from,
+                    gimple* to) -> std::vector<gimple*>
+{
+  std::vector<gimple*> stmts;
+  auto const from_bb {gimple_bb (from)};
+  auto const to_bb {gimple_bb (to)};
+  auto gsi {gsi_for_stmt (from)};
+
+  for (gsi_next (&gsi); !gsi_end_p (gsi); gsi_next (&gsi))
+  {
+    if (gsi_stmt (gsi) == to)
+    {
+      return stmts;
+    }
+    stmts.push_back (gsi_stmt (gsi));
+  }
+
+  auto reachable_blocks {[](basic_block start, bool forward)
+                         {
+                           std::set<basic_block> visited;
+                           std::vector<basic_block> queue {start};
+
+                           while (!queue.empty ())
+                           {
+                             auto bb {queue.back ()};
+                             edge e;
+                             edge_iterator ei;
+
+                             queue.pop_back ();
+                             FOR_EACH_EDGE (e, ei, forward ? bb->succs : bb->preds)
+                             {
+                               auto next {forward ? e->dest : e->src};
+
+                               if (visited.insert (next).second)
+                               {
+                                 queue.push_back (next);
+                               }
+                             }
+                           }
+
+                           return visited;
+                         }};
+  auto const after_from {reachable_blocks (from_bb, true)};
+  auto const before_to {reachable_blocks (to_bb, false)};
+
+  for (auto bb : after_from)
+  {
+    if (before_to.find (bb) == before_to.cend ())
+    {
+      continue;
+    }
+    for (auto bb_gsi {gsi_start_bb (bb)}; !gsi_end_p (bb_gsi); gsi_next (&bb_gsi))
+    {
+      stmts.push_back (gsi_stmt (bb_gsi));
+    }
+  }
+  for (auto bb_gsi {gsi_start_bb (to_bb)}; !gsi_end_p (bb_gsi) && gsi_stmt (bb_gsi) != to; gsi_next (&bb_gsi))
+  {
+    stmts.push_back (gsi_stmt (bb_gsi));
+  }
+
+  return stmts;
+}
+
+// Returns the variable holding the GVariant (or the GVariantIter)
+// passed as the first parameter of a call or NULL_TREE if it can't
+// be tracked.
+auto
+get_source_variable (gcall* call,
+                     Definitions const& definitions) -> tree
+{
+  auto source {gimple_call_arg (call, 0)};
+
+  if (is_temporary (source))
+  {
+    auto iter {definitions.find (source)};
+
+    if (iter == definitions.cend () || iter->second.size () != 1)
+    {
+      return NULL_TREE;
+    }
+
+    auto assign {dyn_cast<gassign*> (iter->second.front ())};
+
+    if (assign == nullptr || !gimple_assign_single_p (assign))
+    {
+      return NULL_TREE;
+    }
+    source = gimple_assign_rhs1 (assign);
+  }
+
+  if ((TREE_CODE (source) != VAR_DECL && TREE_CODE (source) != PARM_DECL) ||
+      TREE_ADDRESSABLE (source) ||
+      is_global_var (source))
+  {
+    return NULL_TREE;
+  }
+
+  return source;
+}
+
+auto
+source_may_be_released (gimple* from,
+                        gimple* to,
+                        tree source) -> bool
+{
+  for (auto stmt : statements_between (from, to))
+  {
+    if (gimple_get_lhs (stmt) == source)
+    {
+      return true;
+    }
+    if (auto call {dyn_cast<gcall*> (stmt)};
+        call != nullptr && is_called (call, releasing_functions))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Returns the borrowing counterpart of a duplicating format, like
+// "&s" for "s" or "^a&s" for "^as".
+auto
+get_borrowing_format (Lib::VariantFormat const& format) -> std::optional<Lib::VariantFormat>
+{
+  if (auto string_type {std::get_if<Lib::Leaf::StringType> (&format.v)};
+      string_type != nullptr)
+  {
+    return {{Lib::VF::Pointer {*string_type}}};
+  }
+  if (auto convenience {std::get_if<Lib::VF::Convenience> (&format.v)};
+      convenience != nullptr &&
+      std::holds_alternative<Lib::VF::Convenience::Kind::Duplicated> (convenience->kind.v))
+  {
+    return {{Lib::VF::Convenience {convenience->type, {Lib::VF::Convenience::Kind::constant}}}};
+  }
+
+  return {};
+}
+
+struct Duplication
+{
+  Lib::VariantFormat format;
+  std::string function;
+};
+
+// Returns the duplicating counterpart of a borrowing format, like "s"
+// for "&s", together with the function usually used to duplicate
+// the borrowed value.
+auto
+get_duplicating_format (Lib::VariantFormat const& format) -> std::optional<Duplication>
+{
+  if (auto pointer {std::get_if<Lib::VF::Pointer> (&format.v)};
+      pointer != nullptr)
+  {
+    return {{{{pointer->string_type}}, "g_strdup"}};
+  }
+  if (auto convenience {std::get_if<Lib::VF::Convenience> (&format.v)};
+      convenience != nullptr &&
+      std::holds_alternative<Lib::VF::Convenience::Kind::Constant> (convenience->kind.v) &&
+      (std::holds_alternative<Lib::VF::Convenience::Type::StringArray> (convenience->type.v) ||
+       std::holds_alternative<Lib::VF::Convenience::Type::ObjectPathArray> (convenience->type.v)))
+  {
+    return {{{{Lib::VF::Convenience {convenience->type, {Lib::VF::Convenience::Kind::duplicated}}}}, "g_strdupv"}};
+  }
+
+  return {};
+}
+
+auto
+format_to_string (Lib::VariantFormat const& format) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << format;
+
+  return oss.str ();
+}
+
+// Checks if a duplicated string is only read and freed while the
+// GVariant it came from is still alive.
+auto
+advise_borrowing (Advisor& advisor,
+                  VariantCall const& variant_call,
+                  tree var,
+                  Lib::VariantFormat const& format,
+                  Lib::VariantFormat const& borrowing_format,
+                  function* fn,
+                  Definitions const& definitions) -> void
+{
+  auto const source {get_source_variable (variant_call.call, definitions)};
+
+  if (source == NULL_TREE)
+  {
+    return;
+  }
+
+  ReadChecker checker {fn, {}, {}};
+
+  for (auto stmt : statements_mentioning (fn, var))
+  {
+    if (stmt == variant_call.call)
+    {
+      continue;
+    }
+
+    auto temp {get_loaded_temporary (stmt, var)};
+
+    if (temp == NULL_TREE || !checker.only_read (temp, true))
+    {
+      return;
+    }
+  }
+
+  if (checker.frees.empty ())
+  {
+    return;
+  }
+  for (auto free_call : checker.frees)
+  {
+    if (source_may_be_released (variant_call.call, free_call, source))
+    {
+      return;
+    }
+  }
+
+  std::ostringstream oss;
+
+  oss << "the value returned for \"" << format_to_string (format) << "\" in "
+      << variant_call.name << " (\"" << variant_call.format << "\", ...)"
+      << " is only read and then freed while the GVariant it comes from is"
+      << " still alive; consider using \"" << format_to_string (borrowing_format)
+      << "\" to borrow it instead of duplicating it";
+  if (std::holds_alternative<Lib::VF::Convenience> (format.v))
+  {
+    oss << " (the returned array itself still needs to be freed with g_free)";
+  }
+  advisor.advise (variant_call.call, oss.str ());
+}
+
+// Checks if a borrowed string is only used to make a copy of it.
+auto
+advise_duplicating (Advisor& advisor,
+                    VariantCall const& variant_call,
+                    tree var,
+                    Lib::VariantFormat const& format,
+                    Duplication const& duplication,
+                    function* fn) -> void
+{
+  auto loads {0u};
+
+  for (auto stmt : statements_mentioning (fn, var))
+  {
+    if (stmt == variant_call.call)
+    {
+      continue;
+    }
+
+    auto temp {get_loaded_temporary (stmt, var)};
+
+    if (temp == NULL_TREE)
+    {
+      return;
+    }
+    ++loads;
+
+    auto copies {0u};
+
+    for (auto use : statements_mentioning (fn, temp))
+    {
+      if (use == stmt)
+      {
+        continue;
+      }
+
+      auto call {dyn_cast<gcall*> (use)};
+
+      if (call == nullptr ||
+          !is_called (call, {duplication.function}) ||
+          gimple_call_num_args (call) != 1 ||
+          gimple_call_arg (call, 0) != temp)
+      {
+        return;
+      }
+      ++copies;
+    }
+    if (copies == 0)
+    {
+      return;
+    }
+  }
+
+  if (loads == 0)
+  {
+    return;
+  }
+
+  std::ostringstream oss;
+
+  oss << "the value borrowed with \"" << format_to_string (format) << "\" in "
+      << variant_call.name << " (\"" << variant_call.format << "\", ...)"
+      << " is only used to make a copy with " << duplication.function
+      << "; consider using \"" << format_to_string (duplication.format)
+      << "\" to get a copy directly";
+  advisor.advise (variant_call.call, oss.str ());
+}
+
+auto
+advise_string_ownership (Advisor& advisor,
+                         function* fn) -> void
+{
+  std::optional<Definitions> definitions;
+
+  for (auto const& variant_call : get_variant_calls (fn))
+  {
+    // g_variant_iter_loop frees the duplicated values by itself.
+    if (variant_call.info.type != FormatType::Get ||
+        variant_call.format == nullptr ||
+        variant_call.name == "g_variant_iter_loop" ||
+        gimple_call_num_args (variant_call.call) == 0)
+    {
+      continue;
+    }
+
+    auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+    if (!maybe_format)
+    {
+      continue;
+    }
+
+    auto const format_args {Lib::args_for_format (*maybe_format)};
+
+    if (format_args.size () != variant_call.args.size ())
+    {
+      continue;
+    }
+
+    for (auto idx {0u}; idx < format_args.size (); ++idx)
+    {
+      auto format {std::get_if<Lib::VariantFormat> (&format_args[idx].v)};
+      auto var {get_out_variable (variant_call.args[idx])};
+
+      if (format == nullptr || var == NULL_TREE)
+      {
+        continue;
+      }
+      if (auto borrowing_format {get_borrowing_format (*format)}; borrowing_format)
+      {
+        if (!definitions)
+        {
+          definitions = collect_definitions (fn);
+        }
+        advise_borrowing (advisor, variant_call, var, *format, *borrowing_format, fn, *definitions);
+      }
+      else if (auto duplication {get_duplicating_format (*format)}; duplication)
+      {
+        advise_duplicating (advisor, variant_call, var, *format, *duplication, fn);
+      }
+    }
+  }
+}
+
+// Functions returning a newly allocated string.
+std::set<std::string> const string_allocating_functions {
+  "g_strconcat",
+  "g_strdup",
+  "g_strdup_printf",
+  "g_strdup_vprintf",
+  "g_strjoin",
+  "g_strndup",
+};
+
+// Follows copies and casts of a local variable back to the call
+// that defined it. Returns nullptr if there is no single such call.
+auto
+get_defining_call (tree var,
+                   Definitions const& definitions) -> gcall*
+{
+  for (auto steps {0u}; steps < 8u; ++steps)
+  {
+    if (!VAR_P (var) || is_global_var (var) || TREE_ADDRESSABLE (var))
+    {
+      return nullptr;
+    }
+
+    auto iter {definitions.find (var)};
+
+    if (iter == definitions.cend () || iter->second.size () != 1)
+    {
+      return nullptr;
+    }
+
+    auto const def {iter->second.front ()};
+
+    if (auto call {dyn_cast<gcall*> (def)}; call != nullptr)
+    {
+      return (gimple_call_lhs (call) == var) ? call : nullptr;
+    }
+
+    auto assign {dyn_cast<gassign*> (def)};
+
+    if (assign == nullptr ||
+        gimple_assign_lhs (assign) != var ||
+        !(gimple_assign_single_p (assign) || CONVERT_EXPR_CODE_P (gimple_assign_rhs_code (assign))))
+    {
+      return nullptr;
+    }
+    var = gimple_assign_rhs1 (assign);
+  }
+
+  return nullptr;
+}
+
+// Whether the second statement comes after the first one in the
+// same basic block.
+auto
+follows_in_block (gimple* first,
+                  gimple* second) -> bool
+{
+  auto gsi {gsi_for_stmt (first)};
+
+  for (gsi_next (&gsi); !gsi_end_p (gsi); gsi_next (&gsi))
+  {
+    if (gsi_stmt (gsi) == second)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+auto
+get_variable_name (tree var,
+                   char const* fallback) -> std::string
+{
+  if (DECL_NAME (var) == NULL_TREE || DECL_ARTIFICIAL (var))
+  {
+    return fallback;
+  }
+
+  return IDENTIFIER_POINTER (DECL_NAME (var));
+}
+
+// Checks if a string passed for "s" was allocated just for the call
+// and is freed right after it.
+auto
+advise_taking_string (Advisor& advisor,
+                      VariantCall const& variant_call,
+                      tree arg,
+                      function* fn,
+                      Definitions const& definitions) -> void
+{
+  auto const alloc_call {get_defining_call (arg, definitions)};
+
+  if (alloc_call == nullptr || !is_called (alloc_call, string_allocating_functions))
+  {
+    return;
+  }
+
+  auto const passed {std::count (variant_call.args.cbegin (), variant_call.args.cend (), arg)};
+
+  if (passed != 1)
+  {
+    return;
+  }
+
+  auto frees {0u};
+
+  for (auto stmt : statements_mentioning (fn, arg))
+  {
+    if (stmt == variant_call.call || gimple_get_lhs (stmt) == arg)
+    {
+      continue;
+    }
+
+    auto call {dyn_cast<gcall*> (stmt)};
+
+    if (call == nullptr ||
+        !is_called (call, {"g_free"}) ||
+        gimple_call_num_args (call) != 1 ||
+        gimple_call_arg (call, 0) != arg ||
+        !follows_in_block (variant_call.call, call))
+    {
+      return;
+    }
+    ++frees;
+  }
+
+  if (frees == 0)
+  {
+    return;
+  }
+
+  auto const name {get_variable_name (arg, "str")};
+  std::ostringstream oss;
+
+  oss << "the string passed as " << name << " to " << variant_call.name
+      << " (\"" << variant_call.format << "\", ...) was allocated with "
+      << get_called_function_name (alloc_call)
+      << " and is freed right after the call, so copying it is wasted; ";
+  if (variant_call.name == "g_variant_new" && std::string_view {variant_call.format} == "s")
+  {
+    oss << "consider using g_variant_new_take_string (" << name << ") instead";
+  }
+  else
+  {
+    oss << "consider replacing \"s\" with \"@s\" and passing g_variant_new_take_string ("
+        << name << ") instead";
+  }
+  advisor.advise (variant_call.call, oss.str ());
+}
+
+auto
+advise_taking_strings (Advisor& advisor,
+                       function* fn,
+                       Definitions const& definitions) -> void
+{
+  for (auto const& variant_call : get_variant_calls (fn))
+  {
+    if (variant_call.info.type != FormatType::New ||
+        variant_call.format == nullptr)
+    {
+      continue;
+    }
+
+    auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+    if (!maybe_format)
+    {
+      continue;
+    }
+
+    auto const format_args {Lib::args_for_format (*maybe_format)};
+
+    if (format_args.size () != variant_call.args.size ())
+    {
+      continue;
+    }
+
+    for (auto idx {0u}; idx < format_args.size (); ++idx)
+    {
+      auto format {std::get_if<Lib::VariantFormat> (&format_args[idx].v)};
+
+      if (format == nullptr)
+      {
+        continue;
+      }
+      // g_variant_new_take_string can only create strings, not
+      // object paths or signatures.
+      if (auto string_type {std::get_if<Lib::Leaf::StringType> (&format->v)};
+          string_type != nullptr &&
+          std::holds_alternative<Lib::Leaf::String> (string_type->v))
+      {
+        advise_taking_string (advisor, variant_call, variant_call.args[idx], fn, definitions);
+      }
+    }
+  }
+}
+
+// Whether the value is a byte loaded from an array or through a
+// pointer inside the loop, following copies and conversions like the
+// promotion to int for varargs.
+auto
+is_byte_read_in_loop (tree var,
+                      class loop* loop,
+                      Definitions const& definitions) -> bool
+{
+  for (auto steps {0u}; steps < 8u; ++steps)
+  {
+    if (!VAR_P (var) || is_global_var (var) || TREE_ADDRESSABLE (var))
+    {
+      return false;
+    }
+
+    auto iter {definitions.find (var)};
+
+    if (iter == definitions.cend () || iter->second.size () != 1)
+    {
+      return false;
+    }
+
+    auto assign {dyn_cast<gassign*> (iter->second.front ())};
+
+    if (assign == nullptr || gimple_assign_lhs (assign) != var)
+    {
+      return false;
+    }
+
+    auto const rhs {gimple_assign_rhs1 (assign)};
+
+    if (gimple_assign_single_p (assign) &&
+        (TREE_CODE (rhs) == ARRAY_REF || TREE_CODE (rhs) == MEM_REF))
+    {
+      auto const type {TREE_TYPE (rhs)};
+
+      return INTEGRAL_TYPE_P (type) &&
+        TYPE_PRECISION (type) == BITS_PER_UNIT &&
+        flow_bb_inside_loop_p (loop, gimple_bb (assign));
+    }
+    if (!gimple_assign_single_p (assign) && !CONVERT_EXPR_CODE_P (gimple_assign_rhs_code (assign)))
+    {
+      return false;
+    }
+    var = rhs;
+  }
+
+  return false;
+}
+
+// Checks for byte arrays that are copied even though they could be
+// wrapped without copying.
+auto
+advise_byte_array_copies (Advisor& advisor,
+                          function* fn,
+                          Definitions const& definitions) -> void
+{
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      auto const stmt {gsi_stmt (gsi)};
+
+      if (auto maybe_call {get_variant_call (stmt)}; maybe_call)
+      {
+        // Only bytes copied from a buffer one by one, bytes computed
+        // in the loop have nothing to be wrapped.
+        if (maybe_call->name == "g_variant_builder_add" &&
+            maybe_call->format != nullptr &&
+            std::string_view {maybe_call->format} == "y" &&
+            maybe_call->args.size () == 1u &&
+            bb->loop_father != nullptr &&
+            loop_depth (bb->loop_father) > 0 &&
+            is_byte_read_in_loop (maybe_call->args.front (), bb->loop_father, definitions))
+        {
+          advisor.advise (stmt,
+                          "byte array is built by adding the bytes of a buffer one at a time"
+                          " with g_variant_builder_add (..., \"y\", ...); consider"
+                          " g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, buffer, length, 1)"
+                          " to copy the whole buffer at once, or g_variant_new_from_bytes if"
+                          " it is held by a GBytes");
+        }
+        continue;
+      }
+
+      auto call {dyn_cast<gcall*> (stmt)};
+
+      if (call == nullptr ||
+          !is_called (call, {"g_variant_new_fixed_array"}) ||
+          gimple_call_num_args (call) < 2)
+      {
+        continue;
+      }
+
+      auto data_call {get_defining_call (gimple_call_arg (call, 1), definitions)};
+
+      if (data_call != nullptr && is_called (data_call, {"g_bytes_get_data"}))
+      {
+        advisor.advise (stmt,
+                        "g_variant_new_fixed_array copies the data taken from a GBytes;"
+                        " consider g_variant_new_from_bytes to use the GBytes without copying");
+      }
+    }
+  }
+}
+
+// Functions scanning a dictionary on each call. The dictionary is
+// always the first parameter.
+std::set<std::string> const dictionary_lookup_functions {
+  "g_variant_lookup",
+  "g_variant_lookup_value",
+};
+
+auto
+is_defined_in_loop (tree var,
+                    class loop* loop,
+                    Definitions const& definitions) -> bool
+{
+  auto iter {definitions.find (var)};
+
+  if (iter == definitions.cend ())
+  {
+    return false;
+  }
+
+  return std::any_of (iter->second.cbegin (),
+                      iter->second.cend (),
+                      [loop](gimple* def)
+                      {
+                        return flow_bb_inside_loop_p (loop, gimple_bb (def));
+                      });
+}
+
+auto
+advise_repeated_lookups (Advisor& advisor,
+                         function* fn,
+                         Definitions const& definitions,
+                         unsigned threshold) -> void
+{
+  // Kept in the order of the first lookup, so the diagnostics come
+  // in a stable order.
+  std::vector<std::pair<tree, std::vector<gcall*>>> lookups;
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      auto call {dyn_cast<gcall*> (gsi_stmt (gsi))};
+
+      if (call == nullptr ||
+          !is_called (call, dictionary_lookup_functions) ||
+          gimple_call_num_args (call) == 0)
+      {
+        continue;
+      }
+
+      auto const dictionary {get_source_variable (call, definitions)};
+
+      if (dictionary == NULL_TREE)
+      {
+        continue;
+      }
+      if (auto loop {bb->loop_father};
+          loop != nullptr &&
+          loop_depth (loop) > 0 &&
+          !is_defined_in_loop (dictionary, loop, definitions))
+      {
+        std::ostringstream oss;
+
+        oss << get_called_function_name (call) << " scans the same dictionary"
+            << " on every iteration of a loop; consider a single pass over"
+            << " the dictionary with GVariantIter or a GVariantDict";
+        advisor.advise (call, oss.str ());
+      }
+
+      auto iter {std::find_if (lookups.begin (),
+                               lookups.end (),
+                               [dictionary](auto const& pair) { return pair.first == dictionary; })};
+
+      if (iter == lookups.end ())
+      {
+        lookups.push_back ({dictionary, {call}});
+      }
+      else
+      {
+        iter->second.push_back (call);
+      }
+    }
+  }
+
+  for (auto const& [dictionary, calls] : lookups)
+  {
+    if (calls.size () <= threshold)
+    {
+      continue;
+    }
+
+    std::ostringstream oss;
+
+    oss << "dictionary " << get_variable_name (dictionary, "value") << " is looked up "
+        << calls.size () << " times in this function and every lookup scans"
+        << " it; consider a single pass over the dictionary with GVariantIter"
+        << " or a GVariantDict";
+    advisor.advise (calls.front (), oss.str ());
+  }
+}
+
+// Checks the tuples in the formats for padding and framing offsets
+// that a different member order would avoid. Each value of such a
+// type pays them again, which adds up for the signals sent often.
+auto
+advise_member_orders (Advisor& advisor,
+                      function* fn,
+                      unsigned waste_percent) -> void
+{
+  for (auto const& variant_call : get_variant_calls (fn))
+  {
+    if (variant_call.format == nullptr)
+    {
+      continue;
+    }
+
+    auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+    if (!maybe_format)
+    {
+      continue;
+    }
+
+    for (auto const& advice : Lib::advise_member_orders (maybe_format->to_type ()))
+    {
+      auto const total {Lib::total_size (advice.size)};
+      auto const wasted {advice.size.padding + advice.size.framing};
+
+      if (wasted * 100u <= total * waste_percent)
+      {
+        continue;
+      }
+
+      std::ostringstream oss;
+
+      oss << "tuple type \"" << type_to_string (advice.tuple_type) << "\" in "
+          << variant_call.name << " (\"" << variant_call.format << "\", ...)"
+          << " spends " << wasted << " of its " << total << " bytes on padding"
+          << " and framing offsets (with the smallest member values); ordering"
+          << " the members as \"" << type_to_string (advice.suggested_type)
+          << "\" brings that down to "
+          << advice.suggested_size.padding + advice.suggested_size.framing << " bytes";
+      advisor.advise (variant_call.call, oss.str ());
+    }
+  }
+}
+
+// Functions creating a GVariant of a single type.
+std::map<std::string, char const*> const typed_constructors {
+  {"g_variant_new_boolean", "b"},
+  {"g_variant_new_byte", "y"},
+  {"g_variant_new_int16", "n"},
+  {"g_variant_new_uint16", "q"},
+  {"g_variant_new_int32", "i"},
+  {"g_variant_new_uint32", "u"},
+  {"g_variant_new_int64", "x"},
+  {"g_variant_new_uint64", "t"},
+  {"g_variant_new_handle", "h"},
+  {"g_variant_new_double", "d"},
+  {"g_variant_new_string", "s"},
+  {"g_variant_new_take_string", "s"},
+  {"g_variant_new_printf", "s"},
+  {"g_variant_new_object_path", "o"},
+  {"g_variant_new_signature", "g"},
+  {"g_variant_new_strv", "as"},
+  {"g_variant_new_objv", "ao"},
+  {"g_variant_new_bytestring", "ay"},
+  {"g_variant_new_bytestring_array", "aay"},
+};
+
+// Returns the type of the GVariant created by the call if it is
+// statically known - either from the function or from the literal
+// format passed to it.
+auto
+get_created_type (gcall* call) -> std::optional<Lib::VariantType>
+{
+  auto const name {get_called_function_name (call)};
+
+  if (name == nullptr)
+  {
+    return {};
+  }
+  if (auto iter {typed_constructors.find (name)}; iter != typed_constructors.cend ())
+  {
+    auto maybe_type {Lib::VariantType::from_string (iter->second)};
+
+    return {std::move (*maybe_type)};
+  }
+
+  auto maybe_call {get_variant_call (call)};
+
+  if (!maybe_call ||
+      maybe_call->info.type != FormatType::New ||
+      maybe_call->format == nullptr)
+  {
+    return {};
+  }
+
+  auto maybe_format {Lib::VariantFormat::from_string (maybe_call->format)};
+
+  if (!maybe_format)
+  {
+    return {};
+  }
+
+  auto type {maybe_format->to_type ()};
+
+  if (!type.is_definite ())
+  {
+    return {};
+  }
+
+  return {std::move (type)};
+}
+
+// Returns the type of the value boxed in the variant passed for "v"
+// (or for "@v", where the variant itself comes from
+// g_variant_new_variant) if it is statically known.
+auto
+get_boxed_type (tree arg,
+                Lib::VariantFormat const& format,
+                Definitions const& definitions) -> std::optional<Lib::VariantType>
+{
+  auto call {get_defining_call (arg, definitions)};
+
+  if (call != nullptr && std::holds_alternative<Lib::VF::AtVariantType> (format.v))
+  {
+    if (!is_called (call, {"g_variant_new_variant"}) || gimple_call_num_args (call) != 1)
+    {
+      return {};
+    }
+    call = get_defining_call (gimple_call_arg (call, 0), definitions);
+  }
+  if (call == nullptr)
+  {
+    return {};
+  }
+
+  auto maybe_type {get_created_type (call)};
+
+  // Unboxing a variant from a variant gains nothing.
+  if (!maybe_type || std::holds_alternative<Lib::Leaf::Variant> (maybe_type->v))
+  {
+    return {};
+  }
+
+  return maybe_type;
+}
+
+struct BoxedArg
+{
+  std::size_t index;
+  Lib::VariantType type;
+};
+
+// A call in a loop adding values of statically known types to a
+// container through variants.
+struct BoxingSite
+{
+  VariantCall const& variant_call;
+  Lib::VariantFormat format;
+  std::vector<BoxedArg> boxed_args;
+};
+
+// Returns the builder the call adds to or NULL_TREE if it can't be
+// tracked.
+auto
+get_builder_variable (gcall* call) -> tree
+{
+  auto const arg {gimple_call_arg (call, 0)};
+
+  if (auto var {get_out_variable (arg)}; var != NULL_TREE)
+  {
+    return var;
+  }
+  if ((TREE_CODE (arg) == VAR_DECL || TREE_CODE (arg) == PARM_DECL) && !is_global_var (arg))
+  {
+    return arg;
+  }
+
+  return NULL_TREE;
+}
+
+// Describes the values a call passes for variants, so calls adding
+// to the same builder can be compared. Empty if some type is not
+// known.
+auto
+get_boxing_signature (VariantCall const& variant_call,
+                      std::vector<BoxedArg> const& boxed_args,
+                      bool all_known) -> std::optional<std::string>
+{
+  if (!all_known)
+  {
+    return {};
+  }
+
+  std::string signature {variant_call.format};
+
+  for (auto const& boxed_arg : boxed_args)
+  {
+    signature += ' ' + std::to_string (boxed_arg.index) + ':' + type_to_string (boxed_arg.type);
+  }
+
+  return {std::move (signature)};
+}
+
+auto
+advise_boxing_site (Advisor& advisor,
+                    BoxingSite const& site) -> void
+{
+  auto const& variant_call {site.variant_call};
+
+  for (auto const& boxed_arg : site.boxed_args)
+  {
+    auto const maybe_overhead {Lib::boxing_overhead (boxed_arg.type)};
+    auto const maybe_unboxed {Lib::unbox_format_arg (site.format, boxed_arg.index, boxed_arg.type)};
+
+    if (!maybe_overhead || !maybe_unboxed)
+    {
+      continue;
+    }
+
+    auto const type_string {type_to_string (boxed_arg.type)};
+    std::ostringstream oss;
+
+    oss << "every value passed for a variant to " << variant_call.name
+        << " (\"" << variant_call.format << "\", ...) in this loop is of"
+        << " type \"" << type_string << "\", but each one is boxed, which costs "
+        << Lib::total_overhead (*maybe_overhead) << " more bytes per element ("
+        << maybe_overhead->framing << " for the type string and its zero byte,"
+        << " up to " << maybe_overhead->max_padding << " for alignment padding)"
+        << " and an extra GVariant allocation when building and when reading"
+        << " the value; consider \"" << format_to_string (*maybe_unboxed) << "\""
+        << " and updating the container type and the code reading the values";
+    advisor.advise (variant_call.call, oss.str ());
+  }
+}
+
+// Checks the calls in loops that box values of a statically known
+// type in variants, usually to build "av", "a{sv}" or "(v)". Calls
+// adding to a builder are only reported if all the calls adding to
+// it in the function pass the same types, so a dictionary of mixed
+// values is left alone.
+auto
+advise_boxing (Advisor& advisor,
+               function* fn,
+               Definitions const& definitions) -> void
+{
+  auto const variant_calls {get_variant_calls (fn)};
+  std::vector<BoxingSite> sites;
+  // Builders mapped to the signature of the calls adding to them,
+  // empty if they differ.
+  std::map<tree, std::optional<std::string>> builder_signatures;
+
+  for (auto const& variant_call : variant_calls)
+  {
+    auto const is_builder_add {variant_call.name == "g_variant_builder_add"};
+
+    if (variant_call.info.type != FormatType::New ||
+        variant_call.format == nullptr ||
+        (!is_builder_add && !POINTER_TYPE_P (gimple_call_return_type (variant_call.call))) ||
+        (is_builder_add && gimple_call_num_args (variant_call.call) == 0))
+    {
+      continue;
+    }
+
+    auto maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+    if (!maybe_format)
+    {
+      continue;
+    }
+
+    auto const format_args {Lib::args_for_format (*maybe_format)};
+
+    if (format_args.size () != variant_call.args.size ())
+    {
+      continue;
+    }
+
+    std::vector<BoxedArg> boxed_args;
+    auto all_known {true};
+
+    for (auto idx {0u}; idx < format_args.size (); ++idx)
+    {
+      auto format {std::get_if<Lib::VariantFormat> (&format_args[idx].v)};
+
+      if (format == nullptr || !Lib::takes_variant (*format))
+      {
+        continue;
+      }
+      if (auto maybe_type {get_boxed_type (variant_call.args[idx], *format, definitions)}; maybe_type)
+      {
+        boxed_args.push_back ({idx, std::move (*maybe_type)});
+      }
+      else
+      {
+        all_known = false;
+      }
+    }
+
+    if (is_builder_add)
+    {
+      auto const builder {get_builder_variable (variant_call.call)};
+
+      if (builder == NULL_TREE)
+      {
+        continue;
+      }
+
+      auto signature {get_boxing_signature (variant_call, boxed_args, all_known)};
+
+      if (auto [iter, inserted] {builder_signatures.insert ({builder, signature})};
+          !inserted && iter->second != signature)
+      {
+        iter->second.reset ();
+      }
+    }
+
+    auto const loop {gimple_bb (variant_call.call)->loop_father};
+
+    if (!all_known ||
+        boxed_args.empty () ||
+        loop == nullptr ||
+        loop_depth (loop) == 0)
+    {
+      continue;
+    }
+    sites.push_back ({variant_call, std::move (*maybe_format), std::move (boxed_args)});
+  }
+
+  for (auto const& site : sites)
+  {
+    if (site.variant_call.name == "g_variant_builder_add" &&
+        !builder_signatures[get_builder_variable (site.variant_call.call)])
+    {
+      continue;
+    }
+    advise_boxing_site (advisor, site);
+  }
+}
+
+// Checks the constant texts passed to g_variant_new_parsed. GLib
+// parses the text on every call and aborts if it is invalid, while
+// the value could be built at compile time. Texts followed by
+// positional parameters are left alone.
+auto
+advise_parsed_texts (Advisor& advisor,
+                     function* fn,
+                     bool lowering) -> void
+{
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      auto call {dyn_cast<gcall*> (gsi_stmt (gsi))};
+
+      if (call == nullptr ||
+          !is_called (call, {"g_variant_new_parsed"}) ||
+          gimple_call_num_args (call) != 1)
+      {
+        continue;
+      }
+
+      auto const text {get_string_literal (gimple_call_arg (call, 0))};
+
+      if (text == nullptr)
+      {
+        continue;
+      }
+
+      auto const maybe_value {Lib::parse_variant_text (text)};
+      std::ostringstream oss;
+
+      if (!maybe_value)
+      {
+        // The innermost error says what is wrong.
+        auto const& error {maybe_value.get_failure ().errors.front ()};
+
+        oss << "g_variant_new_parsed aborts on the text \"" << text << "\": "
+            << error.reason << " at offset " << error.offset;
+        // Not a missed optimization, so always a warning.
+        warning_at (gimple_location (call), 0, "%s", oss.str ().c_str ());
+        continue;
+      }
+      if (lowering)
+      {
+        continue;
+      }
+
+      auto const data {Lib::serialize (*maybe_value, Lib::ByteOrder::Little)};
+
+      oss << "g_variant_new_parsed parses the " << std::strlen (text)
+          << " characters of a constant text and builds "
+          << Lib::count_values (*maybe_value) << " value(s) on every call;"
+          << " the value of type \"" << type_to_string (maybe_value->type ())
+          << "\" can be built at compile time into " << data.size ()
+          << " bytes of static data wrapped in a single GVariant, which"
+          << " -fplugin-arg-<plugin>-lower does";
+      advisor.advise (call, oss.str ());
+    }
+  }
+}
+
+auto
+get_arg_types_string (VariantCall const& variant_call) -> std::string
+{
+  std::string arg_types;
+
+  for (auto const& arg : variant_call.args)
+  {
+    auto const type_string {print_generic_expr_to_str (TREE_TYPE (arg))};
+
+    if (!arg_types.empty ())
+    {
+      arg_types += ';';
+    }
+    arg_types += type_string;
+    free (type_string);
+  }
+
+  return arg_types;
+}
+
+// Attaches the estimated cost to every call taking a constant format,
+// together with its loop depth, for the cost report and the call
+// site index of the translation unit. Either can be nullptr. The
+// execution counts of the cost sites are filled in by the pa_profile
+// pass.
+auto
+collect_call_sites (function* fn,
+                    std::vector<Lib::CostSite>* cost_sites,
+                    std::vector<Lib::IndexSite>* index_sites) -> void
+{
+  std::string const function {function_name (fn)};
+
+  for (auto const& variant_call : get_variant_calls (fn))
+  {
+    if (variant_call.format == nullptr)
+    {
+      continue;
+    }
+
+    auto const maybe_format {Lib::VariantFormat::from_string (variant_call.format)};
+
+    if (!maybe_format)
+    {
+      continue;
+    }
+
+    auto const use {variant_call.info.type == FormatType::New ? Lib::FormatUse::New : Lib::FormatUse::Get};
+    auto const loop {gimple_bb (variant_call.call)->loop_father};
+    auto const depth {loop != nullptr ? loop_depth (loop) : 0u};
+    auto const cost {Lib::format_cost (*maybe_format, use)};
+
+    if (cost_sites != nullptr)
+    {
+      cost_sites->push_back ({get_location_string (variant_call.call),
+                              function,
+                              variant_call.name,
+                              variant_call.format,
+                              depth,
+                              {},
+                              cost});
+    }
+    if (index_sites != nullptr)
+    {
+      auto const location {expand_location (gimple_location (variant_call.call))};
+
+      index_sites->push_back ({location.file != nullptr ? location.file : "<unknown>",
+                               static_cast<std::uint32_t> (location.line),
+                               static_cast<std::uint32_t> (location.column),
+                               function,
+                               variant_call.name,
+                               variant_call.format,
+                               use,
+                               get_arg_types_string (variant_call),
+                               depth,
+                               cost});
+    }
+  }
+}
+
+const pass_data pa_cfg_pass_data =
+{
+  GIMPLE_PASS, /* type */
+  "pa_cfg", /* name */
+  // Plugins can't add optgroups, this one is included in
+  // -fopt-info-missed and -fopt-info-all.
+  OPTGROUP_OTHER, /* optinfo_flags */
+  TV_NONE, /* tv_id */
+  PROP_cfg, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class pa_cfg_pass : public gimple_opt_pass
+{
+public:
+  pa_cfg_pass(gcc::context *ctxt,
+              SourceFilter const& filter,
+              PerfAdvisorOptions const& options,
+              std::vector<PendingAdvice>& pending_advice,
+              std::vector<Lib::CostSite>* cost_sites,
+              std::vector<Lib::IndexSite>* index_sites)
+    : gimple_opt_pass(pa_cfg_pass_data, ctxt),
+      filter {filter},
+      options {options},
+      pending_advice {pending_advice},
+      cost_sites {cost_sites},
+      index_sites {index_sites}
+  {}
+
+  /* opt_pass methods: */
+  virtual bool gate (function* fn) override;
+  virtual unsigned int execute (function *) override;
+
+private:
+  SourceFilter const& filter;
+  PerfAdvisorOptions options;
+  std::vector<PendingAdvice>& pending_advice;
+  // nullptr if no cost report is written.
+  std::vector<Lib::CostSite>* cost_sites;
+  // nullptr if no call site index is written.
+  std::vector<Lib::IndexSite>* index_sites;
+};
+
+bool
+pa_cfg_pass::gate (function* fn)
+{
+  return this->filter.wants_function (fn->decl);
+}
+
+unsigned int
+pa_cfg_pass::execute (function* fn)
+{
+  // The cfg pass sets up the loop tree, but be careful anyway.
+  auto const own_loops {current_loops == nullptr};
+
+  if (own_loops)
+  {
+    loop_optimizer_init (AVOID_CFG_MODIFICATIONS);
+  }
+
+  Advisor advisor {fn, this->pending_advice};
+
+  advise_loop_invariant_constructions (advisor, fn);
+  advise_string_ownership (advisor, fn);
+
+  auto const definitions {collect_definitions (fn)};
+
+  advise_taking_strings (advisor, fn, definitions);
+  advise_byte_array_copies (advisor, fn, definitions);
+  advise_repeated_lookups (advisor, fn, definitions, this->options.lookup_threshold);
+  advise_member_orders (advisor, fn, this->options.padding_waste_percent);
+  if (this->options.boxing)
+  {
+    advise_boxing (advisor, fn, definitions);
+  }
+  advise_parsed_texts (advisor, fn, this->options.lowering);
+  if (this->cost_sites != nullptr || this->index_sites != nullptr)
+  {
+    collect_call_sites (fn, this->cost_sites, this->index_sites);
+  }
+
+  if (own_loops)
+  {
+    loop_optimizer_finalize ();
+  }
+
+  return 0;
+}
+
+// Gathers the execution counts of all the statements in the
+// translation unit. Empty without profile feedback.
+auto
+gather_execution_counts () -> Lib::ExecutionCounts
+{
+  Lib::ExecutionCounts counts;
+  cgraph_node* node;
+
+  FOR_EACH_FUNCTION_WITH_GIMPLE_BODY (node)
+  {
+    auto const fn {node->get_fun ()};
+
+    if (fn == nullptr || profile_status_for_fn (fn) != PROFILE_READ)
+    {
+      continue;
+    }
+
+    std::string const function {function_name (fn)};
+    basic_block bb;
+
+    FOR_EACH_BB_FN (bb, fn)
+    {
+      auto const count {bb->count.ipa ()};
+
+      if (!count.initialized_p ())
+      {
+        continue;
+      }
+      for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+      {
+        if (gimple_location (gsi_stmt (gsi)) == UNKNOWN_LOCATION)
+        {
+          continue;
+        }
+        Lib::add_execution_count (counts,
+                                  function,
+                                  get_location_string (gsi_stmt (gsi)),
+                                  static_cast<std::uint64_t> (count.to_gcov_type ()));
+      }
+    }
+  }
+
+  return counts;
+}
+
+// Gives the advice as missed optimizations, so it shows up with
+// -fopt-info-missed and in -fsave-optimization-record, and
+// optionally as warnings too. With profile feedback, the advice says
+// how many times the statement ran and is dropped for statements
+// that ran too few times.
+auto
+give_advice (PendingAdvice const& pending,
+             Lib::ExecutionCounts const& counts,
+             PerfAdvisorOptions const& options,
+             std::vector<Lib::AdviceSite>* advice_sites) -> void
+{
+  auto site {pending.site};
+
+  site.execution_count = Lib::find_execution_count (counts, site.function, site.location);
+  if (site.execution_count && *site.execution_count < options.min_count)
+  {
+    return;
+  }
+
+  auto const text {Lib::advice_text (site)};
+
+  if (dump_enabled_p ())
+  {
+    dump_printf_loc (MSG_MISSED_OPTIMIZATION,
+                     dump_user_location_t::from_location_t (pending.location),
+                     "%s\n",
+                     text.c_str ());
+  }
+  if (options.warnings)
+  {
+    warning_at (pending.location, 0, "%s", text.c_str ());
+  }
+  if (advice_sites != nullptr)
+  {
+    advice_sites->push_back (std::move (site));
+  }
+}
+
+const pass_data pa_profile_pass_data =
+{
+  SIMPLE_IPA_PASS, /* type */
+  "pa_profile", /* name */
+  // Same as pa_cfg.
+  OPTGROUP_OTHER, /* optinfo_flags */
+  TV_NONE, /* tv_id */
+  0, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+// Runs after the profile pass, which reads the profile feedback, and
+// gives the advice found by the pa_cfg pass with the execution
+// counts.
+class pa_profile_pass : public simple_ipa_opt_pass
+{
+public:
+  pa_profile_pass(gcc::context *ctxt,
+                  PerfAdvisorOptions const& options,
+                  std::vector<PendingAdvice>& pending_advice,
+                  std::vector<Lib::CostSite>* cost_sites,
+                  std::vector<Lib::AdviceSite>* advice_sites)
+    : simple_ipa_opt_pass(pa_profile_pass_data, ctxt),
+      options {options},
+      pending_advice {pending_advice},
+      cost_sites {cost_sites},
+      advice_sites {advice_sites}
+  {}
+
+  /* opt_pass methods: */
+  virtual bool gate (function*) override;
+  virtual unsigned int execute (function *) override;
+
+private:
+  PerfAdvisorOptions options;
+  std::vector<PendingAdvice>& pending_advice;
+  // nullptr if no cost report is written.
+  std::vector<Lib::CostSite>* cost_sites;
+  // nullptr if no advice report is written.
+  std::vector<Lib::AdviceSite>* advice_sites;
+};
+
+bool
+pa_profile_pass::gate (function*)
+{
+  return !this->pending_advice.empty () || (this->cost_sites != nullptr && !this->cost_sites->empty ());
+}
+
+unsigned int
+pa_profile_pass::execute (function*)
+{
+  auto const counts {gather_execution_counts ()};
+
+  for (auto const& pending : this->pending_advice)
+  {
+    give_advice (pending, counts, this->options, this->advice_sites);
+  }
+  this->pending_advice.clear ();
+  if (this->cost_sites != nullptr)
+  {
+    for (auto& site : *this->cost_sites)
+    {
+      site.execution_count = Lib::find_execution_count (counts, site.function, site.location);
+    }
+  }
+
+  return 0;
+}
+
+std::unique_ptr<register_pass_info>
+get_register_pa_cfg_pass_info (SourceFilter const& filter,
+                               PerfAdvisorOptions const& options,
+                               std::vector<PendingAdvice>& pending_advice,
+                               std::vector<Lib::CostSite>* cost_sites,
+                               std::vector<Lib::IndexSite>* index_sites)
+{
+  // g - a global gcc::context
+  register_pass_info pass_info { new pa_cfg_pass (g, filter, options, pending_advice, cost_sites, index_sites), "cfg", 1, PASS_POS_INSERT_AFTER };
+  return std::make_unique<register_pass_info> (pass_info);
+}
+
+std::unique_ptr<register_pass_info>
+get_register_pa_profile_pass_info (PerfAdvisorOptions const& options,
+                                   std::vector<PendingAdvice>& pending_advice,
+                                   std::vector<Lib::CostSite>* cost_sites,
+                                   std::vector<Lib::AdviceSite>* advice_sites)
+{
+  // g - a global gcc::context
+  register_pass_info pass_info { new pa_profile_pass (g, options, pending_advice, cost_sites, advice_sites), "profile", 1, PASS_POS_INSERT_AFTER };
+  return std::make_unique<register_pass_info> (pass_info);
+}
+
+} // anonymous namespace
+
+PerfAdvisor::PerfAdvisor (struct plugin_name_args* plugin_info,
+                          SourceFilter const& filter)
+  : name {subplugin_name (plugin_info, "pa")},
+    options {get_plugin_arg_uint (plugin_info, "pa-lookup-threshold", 3u),
+             get_plugin_arg_uint (plugin_info, "pa-padding-waste", 25u),
+             get_plugin_arg_bool (plugin_info, "pa-boxing", false),
+             get_plugin_arg_bool (plugin_info, "lower", false),
+             get_plugin_arg (plugin_info, "pa-cost-report"),
+             get_plugin_arg_uint (plugin_info, "pa-min-count", 0u),
+             get_plugin_arg (plugin_info, "pa-advice-report"),
+             get_plugin_arg_bool (plugin_info, "pa-warn", false),
+             get_plugin_arg (plugin_info, "pa-index")},
+    cost_sites {},
+    pending_advice {},
+    advice_sites {},
+    index_sites {}
+{
+  auto cfg_pass_info {get_register_pa_cfg_pass_info (filter,
+                                                     this->options,
+                                                     this->pending_advice,
+                                                     this->options.cost_report ? &this->cost_sites : nullptr,
+                                                     this->options.index ? &this->index_sites : nullptr)};
+  auto profile_pass_info {get_register_pa_profile_pass_info (this->options,
+                                                             this->pending_advice,
+                                                             this->options.cost_report ? &this->cost_sites : nullptr,
+                                                             this->options.advice_report ? &this->advice_sites : nullptr)};
+  // Nothing to unregister for the PLUGIN_PASS_MANAGER_SETUP events -
+  // they take no callbacks.
+  ::register_callback (name.c_str (),
+                       PLUGIN_PASS_MANAGER_SETUP,
+                       NULL,
+                       cfg_pass_info.get ());
+  ::register_callback (name.c_str (),
+                       PLUGIN_PASS_MANAGER_SETUP,
+                       NULL,
+                       profile_pass_info.get ());
+}
+
+PerfAdvisor::~PerfAdvisor ()
+{
+  if (this->options.cost_report)
+  {
+    write_report (*this->options.cost_report,
+                  Lib::cost_report_to_string (this->cost_sites),
+                  "GVariant cost");
+  }
+  if (this->options.advice_report)
+  {
+    write_report (*this->options.advice_report,
+                  Lib::advice_report_to_string (this->advice_sites),
+                  "GVariant advice");
+  }
+  if (this->options.index)
+  {
+    auto path {*this->options.index};
+
+    if (path.empty ())
+    {
+      path = std::string {dump_base_name} + ".ggp-idx";
+    }
+    write_report (path,
+                  Lib::index_to_bytes (this->index_sites),
+                  "call site index");
+  }
+}
+
+} // namespace Ggp::Gcc
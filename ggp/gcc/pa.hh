@@ -0,0 +1,107 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_PA_HH
+#define GGP_PA_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/filter.hh"
+#include "ggp/gcc/util.hh"
+
+#include "ggp/gcc/generated/advice.hh"
+#include "ggp/gcc/generated/cost.hh"
+#include "ggp/gcc/generated/index.hh"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Ggp::Gcc
+{
+
+struct PerfAdvisorOptions
+{
+  // How many times the same dictionary can be looked up in one
+  // function before it is reported.
+  unsigned lookup_threshold;
+  // How many percent of the bytes of a tuple can go to padding and
+  // framing offsets before a better member order is suggested.
+  unsigned padding_waste_percent;
+  // Whether to point out variants boxing values of a statically
+  // known type in loops.
+  bool boxing;
+  // Whether the lowering is enabled, so the advice to enable it is
+  // left out.
+  bool lowering;
+  // Where to write the cost report of the translation unit, empty
+  // for stderr. No report is written if unset.
+  std::optional<std::string> cost_report;
+  // With profile feedback, advice on statements that ran fewer times
+  // is dropped.
+  unsigned min_count;
+  // Where to write the advice given in the translation unit, ranked
+  // by execution counts, empty for stderr. No report is written if
+  // unset.
+  std::optional<std::string> advice_report;
+  // Whether to give the advice as warnings too, besides the missed
+  // optimization remarks.
+  bool warnings;
+  // Where to write the binary call site index of the translation
+  // unit, see ggp/lib/index.hh, empty for the dump base name with the
+  // .ggp-idx suffix. No index is written if unset.
+  std::optional<std::string> index;
+};
+
+// A piece of advice found by the pa_cfg pass, waiting for the
+// execution counts.
+struct PendingAdvice
+{
+  location_t location;
+  Lib::AdviceSite site;
+};
+
+// Performance advisor - looks at the GIMPLE of functions and points
+// out GVariant code that does needless work. The pa_cfg pass finds
+// the advice right after the CFG is built, but the profile feedback
+// is read later, so the advice is given as missed optimization
+// remarks of the pa_profile IPA pass, which runs after the profile
+// pass, see -fopt-info.
+struct PerfAdvisor
+{
+  PerfAdvisor(struct plugin_name_args* plugin_info,
+              SourceFilter const& filter);
+  // Writes the reports.
+  ~PerfAdvisor();
+
+  std::string name;
+  PerfAdvisorOptions options;
+  // Calls taking constant formats seen in the translation unit, for
+  // the cost report.
+  std::vector<Lib::CostSite> cost_sites;
+  // Advice found by the pa_cfg pass, not given yet.
+  std::vector<PendingAdvice> pending_advice;
+  // Advice given in the translation unit, for the advice report.
+  std::vector<Lib::AdviceSite> advice_sites;
+  // Calls taking constant formats, for the call site index.
+  std::vector<Lib::IndexSite> index_sites;
+};
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_PA_HH */
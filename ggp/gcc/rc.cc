@@ -0,0 +1,177 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/rc.hh"
+
+#include "ggp/gcc/call.hh"
+
+#include <memory>
+#include <sstream>
+
+namespace Ggp::Gcc
+{
+
+namespace
+{
+
+// Created on demand and reused in all the functions, so the garbage
+// collector needs to know about it.
+tree check_format_decl;
+
+ggc_root_tab const check_format_decl_roots[] = {
+  {&check_format_decl, 1, sizeof (tree), &gt_ggc_mx_tree_node, &gt_pch_nx_tree_node},
+  LAST_GGC_ROOT_TAB
+};
+
+auto
+get_check_format_decl () -> tree
+{
+  if (check_format_decl == NULL_TREE)
+  {
+    auto const type {build_function_type_list (void_type_node,
+                                               const_ptr_type_node,
+                                               integer_type_node,
+                                               const_ptr_type_node,
+                                               const_ptr_type_node,
+                                               NULL_TREE)};
+
+    check_format_decl = build_fn_decl ("ggp_rt_check_format", type);
+    TREE_NOTHROW (check_format_decl) = 1;
+  }
+
+  return check_format_decl;
+}
+
+auto
+get_location_string (location_t location) -> std::string
+{
+  auto const expanded {expand_location (location)};
+  std::ostringstream oss;
+
+  oss << (expanded.file != nullptr ? expanded.file : "<unknown>") << ':' << expanded.line << ':' << expanded.column;
+
+  return oss.str ();
+}
+
+auto
+build_c_string_literal (std::string const& str) -> tree
+{
+  return build_string_literal (str.size () + 1, str.c_str ());
+}
+
+auto
+insert_check (VariantCall const& variant_call) -> void
+{
+  auto const call {variant_call.call};
+  auto const format {gimple_call_arg (call, variant_call.info.string_index - 1)};
+  auto const use {variant_call.info.type == FormatType::Get ? 1 : 0};
+  std::string arg_kinds;
+
+  for (auto const arg : variant_call.args)
+  {
+    arg_kinds.push_back (get_arg_kind (arg));
+  }
+
+  auto const stmt {gimple_build_call (get_check_format_decl (),
+                                      4,
+                                      format,
+                                      build_int_cst (integer_type_node, use),
+                                      build_c_string_literal (arg_kinds),
+                                      build_c_string_literal (get_location_string (gimple_location (call))))};
+  auto gsi {gsi_for_stmt (call)};
+
+  gimple_set_location (stmt, gimple_location (call));
+  gimple_set_block (stmt, gimple_block (call));
+  gimple_call_set_nothrow (stmt, true);
+  gsi_insert_before (&gsi, stmt, GSI_SAME_STMT);
+}
+
+const pass_data rc_cfg_pass_data =
+{
+  GIMPLE_PASS, /* type */
+  "rc_cfg", /* name */
+  OPTGROUP_NONE, /* optinfo_flags */
+  TV_NONE, /* tv_id */
+  PROP_cfg, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class rc_cfg_pass : public gimple_opt_pass
+{
+public:
+  rc_cfg_pass(gcc::context *ctxt)
+    : gimple_opt_pass(rc_cfg_pass_data, ctxt)
+  {}
+
+  /* opt_pass methods: */
+  virtual unsigned int execute (function *) override;
+};
+
+unsigned int
+rc_cfg_pass::execute (function* fn)
+{
+  // The checks are inserted before the calls, which does not disturb
+  // the collected calls.
+  for (auto const& variant_call : get_variant_calls (fn))
+  {
+    if (variant_call.format == nullptr)
+    {
+      insert_check (variant_call);
+    }
+  }
+
+  return 0;
+}
+
+std::unique_ptr<register_pass_info>
+get_register_rc_cfg_pass_info ()
+{
+  // g - a global gcc::context
+  register_pass_info pass_info { new rc_cfg_pass (g), "cfg", 1, PASS_POS_INSERT_AFTER };
+  return std::make_unique<register_pass_info> (pass_info);
+}
+
+} // anonymous namespace
+
+RuntimeChecker::RuntimeChecker (struct plugin_name_args* plugin_info)
+  : name {subplugin_name (plugin_info, "rc")}
+{
+  if (!get_plugin_arg_bool (plugin_info, "check-dynamic-formats", false))
+  {
+    return;
+  }
+
+  // Nothing to unregister for the PLUGIN_REGISTER_GGC_ROOTS and
+  // PLUGIN_PASS_MANAGER_SETUP events - they take no callbacks.
+  ::register_callback (name.c_str (),
+                       PLUGIN_REGISTER_GGC_ROOTS,
+                       NULL,
+                       const_cast<ggc_root_tab*> (check_format_decl_roots));
+
+  auto reg_pass_info {get_register_rc_cfg_pass_info ()};
+
+  ::register_callback (name.c_str (),
+                       PLUGIN_PASS_MANAGER_SETUP,
+                       NULL,
+                       reg_pass_info.get ());
+}
+
+} // namespace Ggp::Gcc
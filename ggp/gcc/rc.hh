@@ -0,0 +1,43 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_RC_HH
+#define GGP_RC_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/util.hh"
+
+namespace Ggp::Gcc
+{
+
+// Runtime checker - inserts calls to ggp_rt_check_format from
+// libggp-rt before the GVariant calls with formats that are not
+// string literals, so they can be checked when the program runs. It
+// is off by default, -fplugin-arg-<plugin>-check-dynamic-formats
+// enables it. The code needs to be linked with libggp-rt then.
+struct RuntimeChecker
+{
+  RuntimeChecker(struct plugin_name_args* plugin_info);
+
+  std::string name;
+};
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_RC_HH */
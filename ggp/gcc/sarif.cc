@@ -0,0 +1,58 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/gcc/args.hh"
+#include "ggp/gcc/sarif.hh"
+#include "ggp/gcc/util.hh"
+
+namespace Ggp::Gcc
+{
+
+SarifLog::SarifLog (struct plugin_name_args* plugin_info)
+  : path {get_plugin_arg (plugin_info, "sarif")},
+    diagnostics {}
+{}
+
+SarifLog::~SarifLog ()
+{
+  if (!this->path)
+  {
+    return;
+  }
+
+  auto path {*this->path};
+
+  if (path.empty ())
+  {
+    path = std::string {dump_base_name} + ".sarif";
+  }
+  write_report (path,
+                Lib::diagnostics_to_sarif (this->diagnostics),
+                "SARIF");
+}
+
+auto
+SarifLog::add (Lib::Diagnostic const& diagnostic) -> void
+{
+  if (this->path)
+  {
+    this->diagnostics.push_back (diagnostic);
+  }
+}
+
+} // namespace Ggp::Gcc
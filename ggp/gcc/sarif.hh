@@ -0,0 +1,55 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_GCC_SARIF_HH
+#define GGP_GCC_SARIF_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/generated/sarif.hh"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Ggp::Gcc
+{
+
+// Collects the diagnostics of the checkers in the translation unit
+// and writes them as a SARIF log when the unit is finished, so the
+// log file is opened and written once. It is enabled with
+// -fplugin-arg-<plugin>-sarif[=<file>], the file defaults to the dump
+// base name with the .sarif suffix.
+struct SarifLog
+{
+  SarifLog (struct plugin_name_args* plugin_info);
+  // Writes the log.
+  ~SarifLog ();
+
+  // Records the diagnostic if the log is enabled.
+  auto
+  add (Lib::Diagnostic const& diagnostic) -> void;
+
+  // Empty for the default file. No log is written if unset.
+  std::optional<std::string> path;
+  std::vector<Lib::Diagnostic> diagnostics;
+};
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_GCC_SARIF_HH */
@@ -18,6 +18,8 @@
 
 #include "ggp/gcc/util.hh"
 
+#include <fstream>
+
 namespace Ggp::Gcc
 {
 
@@ -67,6 +69,28 @@ subplugin_name (struct plugin_name_args* plugin_info,
   return subplugin_name;
 }
 
+auto
+write_report (std::string const& path,
+              std::string const& report,
+              char const* what) -> void
+{
+  if (path.empty ())
+  {
+    // Not std::fwrite, system.h may turn it into the fwrite_unlocked
+    // macro.
+    fwrite (report.data (), 1, report.size (), stderr);
+    return;
+  }
+
+  std::ofstream file {path, std::ios::binary};
+
+  file.write (report.data (), report.size ());
+  if (!file)
+  {
+    error ("failed to write the %s report to %qs", what, path.c_str ());
+  }
+}
+
 CallbackRegistration::CallbackRegistration (const std::string& plugin_name,
                                             int event,
                                             plugin_callback_func callback,
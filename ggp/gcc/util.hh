@@ -21,6 +21,9 @@
 
 #include "ggp/gcc/gcc.hh"
 
+#include <sstream>
+#include <string>
+
 namespace Ggp::Gcc
 {
 
@@ -28,6 +31,27 @@ std::string
 subplugin_name (struct plugin_name_args* plugin_info,
                 const char* suffix);
 
+// Writes the report to the file at the path with a single write, or
+// to stderr if the path is empty. What describes the report in the
+// error message if writing fails.
+auto
+write_report (std::string const& path,
+              std::string const& report,
+              char const* what) -> void;
+
+// Prints the type, like a Lib::VariantType or a Lib::Type, the same
+// way as in the format strings and in the diagnostics.
+template <typename TypeT>
+auto
+type_to_string (TypeT const& type) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << type;
+
+  return oss.str ();
+}
+
 struct CallbackRegistration
 {
   CallbackRegistration (const std::string& plugin_name,
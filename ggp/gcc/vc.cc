@@ -16,157 +16,58 @@
  * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "ggp/gcc/args.hh"
+#include "ggp/gcc/format.hh"
 #include "ggp/gcc/tree.hh"
 #include "ggp/gcc/vc.hh"
 
+#include "ggp/gcc/generated/check-store.hh"
 #include "ggp/gcc/generated/type.hh"
+#include "ggp/gcc/generated/type-print.hh"
 #include "ggp/gcc/generated/variant.hh"
 
+// Not in gcc.hh, plugin-version.h includes it too and it has no
+// include guard.
+#include "configargs.h"
+
+#include <cstring>
+#include <fstream>
 #include <optional>
+#include <sstream>
 
 namespace Ggp::Gcc
 {
 
 namespace {
 
-std::optional<unsigned HOST_WIDE_INT>
-get_int (tree expr)
-{
-  if (tree_fits_uhwi_p (expr))
-  {
-    return {TREE_INT_CST_LOW (expr)};
-  }
-
-  return {};
-}
-
-unsigned HOST_WIDE_INT
-must_get_int (tree expr)
+// Adds the glib_variant attribute to the declarations of known
+// functions that their headers do not mark, like the GLib ones.
+void
+ggp_vc_finish_decl (void* gcc_data,
+                    void* user_data)
 {
-  auto maybe_int {get_int (expr)};
-
-  gcc_assert (maybe_int.has_value ());
-
-  return maybe_int.value ();
-}
+  auto const& checker = *static_cast<VariantChecker*> (user_data);
+  auto decl {static_cast<tree> (gcc_data)};
 
-std::optional<std::string>
-get_string (tree expr)
-{
-  if (expr != NULL_TREE &&
-      TREE_CODE (expr) == STRING_CST)
+  if (TREE_CODE (decl) != FUNCTION_DECL ||
+      DECL_NAME (decl) == NULL_TREE ||
+      get_glib_variant_attribute (decl) != NULL_TREE)
   {
-    return {TREE_STRING_POINTER (expr)};
+    return;
   }
 
-  return {};
-}
-
-std::string
-must_get_string (tree expr)
-{
-  auto maybe_string {get_string (expr)};
-
-  gcc_assert (maybe_string.has_value ());
+  auto maybe_format_info {checker.known_functions.get_format_info (IDENTIFIER_POINTER (DECL_NAME (decl)))};
 
-  return maybe_string.value ();
-}
-
-enum class FormatType
-{
-  New,
-  Get
-};
-
-std::optional<FormatType>
-get_format_type (std::string const& type_string)
-{
-  if (type_string == "new")
+  if (!maybe_format_info)
   {
-    return {FormatType::New};
+    return;
   }
 
-  if (type_string == "get")
-  {
-    return {FormatType::Get};
-  }
+  auto attribute {tree_cons (get_identifier ("glib_variant"),
+                             build_glib_variant_attribute_args (*maybe_format_info),
+                             NULL_TREE)};
 
-  return {};
-}
-
-FormatType
-must_get_format_type (std::string const& type_string)
-{
-  auto maybe_format_type {get_format_type (type_string)};
-
-  gcc_assert (maybe_format_type.has_value ());
-
-  return maybe_format_type.value ();
-}
-
-struct FormatInfo {
-  FormatType type;
-  unsigned HOST_WIDE_INT string_index;
-  unsigned HOST_WIDE_INT args_index;
-};
-
-std::optional<FormatInfo>
-get_format_info_from_args (tree attribute_args)
-{
-  auto maybe_format_type_string = get_string (TREE_VALUE (attribute_args));
-  if (!maybe_format_type_string.has_value ())
-  {
-    error ("expected a string as a first parameter");
-    return {};
-  }
-
-  auto maybe_format_type = get_format_type (maybe_format_type_string.value ());
-  if (!maybe_format_type.has_value ())
-  {
-    error ("expected either \"get\" or \"set\" as a format type");
-    return {};
-  }
-
-  auto maybe_string_index = get_int (TREE_VALUE (TREE_CHAIN (attribute_args)));
-  if (!maybe_string_index.has_value ())
-  {
-    error("expected an integer as a second parameter");
-    return {};
-  }
-
-  auto maybe_args_index = get_int (TREE_VALUE (TREE_CHAIN (TREE_CHAIN (attribute_args))));
-  if (!maybe_args_index.has_value ())
-  {
-    error("expected an integer as a second parameter");
-    return {};
-  }
-
-  if (maybe_string_index.value() >= maybe_args_index.value())
-  {
-    error("format string should come before formating arguments");
-    return {};
-  }
-
-  return {FormatInfo {maybe_format_type.value(), maybe_string_index.value(), maybe_args_index.value()}};
-}
-
-FormatInfo
-must_get_format_info_from_args (tree attribute_args)
-{
-  auto format_type_string = must_get_string (TREE_VALUE (attribute_args));
-  auto format_type = must_get_format_type (format_type_string);
-  auto string_index = must_get_int (TREE_VALUE (TREE_CHAIN (attribute_args)));
-  auto args_index = must_get_int (TREE_VALUE (TREE_CHAIN (TREE_CHAIN (attribute_args))));
-
-  return FormatInfo {format_type, string_index, args_index};
-}
-
-void
-ggp_vc_finish_decl (void* /* gcc_data */,
-                    void* /* user_data */)
-{
-  //tree tr = static_cast<tree> (gcc_data);
-  //dump_tree (tr, "  ", 1);
+  decl_attributes (&decl, attribute, 0);
 }
 
 void
@@ -315,7 +216,6 @@ type_tree_to_type (tree gcc_type) -> Lib::Type
           // precision in bytes larger than UINT8_MAX?
           (precision > 2047))
       {
-        warning (0, "weird precision %d", precision);
         builder.add_meh ();
       }
       else
@@ -348,7 +248,6 @@ type_tree_to_type (tree gcc_type) -> Lib::Type
           // precision in bytes larger than UINT8_MAX?
           (precision > 2047))
       {
-        warning (0, "weird precision %d", precision);
         builder.add_meh ();
       }
       else
@@ -379,9 +278,6 @@ type_tree_to_type (tree gcc_type) -> Lib::Type
 
 auto
 tree_to_type (tree arg) -> TypeFromTree {
-  warning (0, "dump of a parameter");
-  dump_node (arg, TDF_ADDRESS, stderr);
-
   if (DECL_P (arg))
   {
     return {{type_tree_to_type (TREE_TYPE (arg))}};
@@ -427,40 +323,83 @@ tree_to_type (tree arg) -> TypeFromTree {
   return {{builder.build_type ()}};
 }
 
-void
-ggp_vc_finish_parse_function (void* gcc_data,
-                              void* /* user_data */)
+struct FormatCall
 {
-  auto function_decl = static_cast<tree> (gcc_data);
-  gcc_assert (TREE_CODE (function_decl) == FUNCTION_DECL);
-  // warning (0, "Tree dump of %s",
-  //          IDENTIFIER_POINTER (DECL_NAME (function_decl)));
-  // dump_node (function_decl, TDF_ADDRESS, stderr);
+  std::string name;
+  location_t location;
+  FormatArgs args;
+};
 
+auto
+get_format_calls (tree function_decl) -> std::vector<FormatCall>
+{
+  std::vector<FormatCall> format_calls;
 
   for (auto const& call_site : get_call_sites (function_decl))
   {
-    auto maybe_format_args {get_format_args (call_site)};
-
-    if (!maybe_format_args)
+    if (auto maybe_format_args {get_format_args (call_site)}; maybe_format_args)
     {
-      continue;
+      format_calls.push_back ({call_site.name,
+                               EXPR_LOCATION (call_site.call_expr),
+                               std::move (*maybe_format_args)});
     }
+  }
+
+  return format_calls;
+}
+
+auto
+make_diagnostic (location_t location,
+                 char const* rule,
+                 std::string message,
+                 char const* format,
+                 std::optional<std::uint32_t> arg_index,
+                 std::string expected_type,
+                 std::string actual_type) -> Lib::Diagnostic
+{
+  auto const xloc {expand_location (location)};
+
+  return {rule,
+          std::move (message),
+          (xloc.file != nullptr) ? xloc.file : "",
+          static_cast<std::uint32_t> (xloc.line),
+          static_cast<std::uint32_t> (xloc.column),
+          format,
+          arg_index,
+          std::move (expected_type),
+          std::move (actual_type)};
+}
+
+// Checks the calls, the diagnostics are returned instead of being
+// reported, so they can be stored.
+auto
+check_format_calls (std::vector<FormatCall> const& format_calls) -> std::vector<Lib::Diagnostic>
+{
+  std::vector<Lib::Diagnostic> diagnostics;
 
-    warning (0, "calling function %s", call_site.name.c_str ());
-    auto const mvf = Lib::VariantFormat::from_string (maybe_format_args->format);
+  for (auto const& format_call : format_calls)
+  {
+    auto const& format_args {format_call.args};
+    auto const location {format_call.location};
+    auto const format {format_args.format};
+
+    auto const mvf = Lib::VariantFormat::from_string (format);
     if (!mvf)
     {
-      warning (0, "invalid variant format");
+      diagnostics.push_back (make_diagnostic (location, "vc-invalid-format", "invalid variant format", format, {}, {}, {}));
       continue;
     }
     auto const types = Lib::expected_types_for_format (*mvf);
-    if (types.size() != maybe_format_args->args.size())
+    if (types.size() != format_args.args.size())
     {
-      warning (0,
-               "expected %lu parameters, got %lu",
-               types.size(),
-               maybe_format_args->args.size());
+      diagnostics.push_back (make_diagnostic (location,
+                                              "vc-args-count",
+                                              "expected " + std::to_string (types.size ()) +
+                                              " parameters, got " + std::to_string (format_args.args.size ()),
+                                              format,
+                                              {},
+                                              {},
+                                              {}));
     }
     auto pick_type {
       [](FormatType type) -> Lib::Type const& (*)(Lib::Types const&)
@@ -481,21 +420,27 @@ ggp_vc_finish_parse_function (void* gcc_data,
               return types.for_get;
             };
         }
-      }(maybe_format_args->type)
+      }(format_args.type)
     };
 
     for (auto idx {0u}; idx < types.size (); ++idx)
     {
       auto picked_type {pick_type (types[idx])};
       auto vh { Lib::VisitHelper {
-        [&picked_type, idx](Lib::Type const& type)
+        [&picked_type, idx, &diagnostics, location, format](Lib::Type const& type)
         {
           if (!Lib::type_is_convertible_to_type (type, picked_type))
           {
-            warning (0, "invalid arg %u", idx);
+            diagnostics.push_back (make_diagnostic (location,
+                                                    "vc-arg-type",
+                                                    "invalid arg " + std::to_string (idx),
+                                                    format,
+                                                    {idx},
+                                                    type_to_string (picked_type),
+                                                    type_to_string (type)));
           }
         },
-        [&picked_type, idx](Cast const& /*cast*/)
+        [&picked_type, idx, &diagnostics, location, format](Cast const& /*cast*/)
         {
           // TODO: this implies that int is 32 bits, make it generic
           // perhaps?
@@ -530,12 +475,245 @@ ggp_vc_finish_parse_function (void* gcc_data,
           // flag to nop_expr and nop_expr cascade like:
           //
           // nop(implicit, int, nop(explicit, gint32, guchar))
-          warning (0, "not handling the casts yet in %d", idx);
+          diagnostics.push_back (make_diagnostic (location,
+                                                  "vc-unhandled-cast",
+                                                  "not handling the casts yet in " + std::to_string (idx),
+                                                  format,
+                                                  {idx},
+                                                  type_to_string (picked_type),
+                                                  {}));
         }
       }};
 
-      std::visit (vh, tree_to_type (maybe_format_args->args[idx]).v);
+      std::visit (vh, tree_to_type (format_args.args[idx]).v);
+    }
+  }
+
+  return diagnostics;
+}
+
+auto
+report_diagnostics (VariantChecker& checker,
+                    std::vector<Lib::Diagnostic> const& diagnostics) -> void
+{
+  for (auto const& diagnostic : diagnostics)
+  {
+    if (!checker.filter.wants_diagnostic (diagnostic))
+    {
+      continue;
     }
+    warning (0, "%s", diagnostic.message.c_str ());
+    checker.sarif.add (diagnostic);
+  }
+}
+
+auto
+hash_type (std::uint64_t hash,
+           tree type) -> std::uint64_t
+{
+  if (type == NULL_TREE)
+  {
+    return Lib::hash_text (hash, "");
+  }
+
+  // The printed name ends up in the diagnostics, but it stays the same
+  // when a typedef changes, so the canonical type is hashed too. Its
+  // precision and signedness depend on the target and on flags like
+  // -funsigned-char.
+  auto const canonical {(TYPE_CANONICAL (type) != NULL_TREE) ? TYPE_CANONICAL (type) : TYPE_MAIN_VARIANT (type)};
+
+  for (auto const hashed : {type, canonical})
+  {
+    auto const type_string {print_generic_expr_to_str (hashed)};
+
+    hash = Lib::hash_text (hash, type_string);
+    free (type_string);
+  }
+  for (auto pointee {canonical}; pointee != NULL_TREE; pointee = POINTER_TYPE_P (pointee) ? TREE_TYPE (pointee) : NULL_TREE)
+  {
+    hash = Lib::hash_text (hash, std::to_string (TYPE_PRECISION (pointee)));
+    hash = Lib::hash_text (hash, TYPE_UNSIGNED (pointee) ? "unsigned" : "signed");
+  }
+
+  return hash;
+}
+
+// Whatever could change the diagnostics of the same code: the
+// compiler version, its configuration including the target, the
+// language standard and the target options like -m32. The checks run
+// before any optimization, so the optimization options don't matter.
+auto
+hash_compiler (std::uint64_t hash) -> std::uint64_t
+{
+  hash = Lib::hash_text (hash, version_string);
+  hash = Lib::hash_text (hash, configuration_arguments);
+  hash = Lib::hash_text (hash, lang_hooks.name);
+  for (auto idx {0u}; idx < save_decoded_options_count; ++idx)
+  {
+    auto const& option {save_decoded_options[idx]};
+
+    if (option.opt_index < cl_options_count &&
+        (cl_options[option.opt_index].flags & CL_TARGET) != 0 &&
+        option.orig_option_with_args_text != nullptr)
+    {
+      hash = Lib::hash_text (hash, option.orig_option_with_args_text);
+    }
+  }
+
+  return hash;
+}
+
+// The key covers everything the checks look at: the compiler and its
+// options, the called functions, the formats and the types of the
+// arguments, including the implicit conversions. The locations of the
+// calls are there too, they end up in the diagnostics.
+auto
+get_check_key (tree function_decl,
+               std::vector<FormatCall> const& format_calls) -> Lib::CheckKey
+{
+  static auto const compiler_hash {hash_compiler (Lib::hash_seed)};
+  auto const xloc {expand_location (DECL_SOURCE_LOCATION (function_decl))};
+  auto hash {compiler_hash};
+
+  for (auto const& format_call : format_calls)
+  {
+    auto const call_xloc {expand_location (format_call.location)};
+
+    hash = Lib::hash_text (hash, format_call.name);
+    hash = Lib::hash_text (hash, std::to_string (call_xloc.line));
+    hash = Lib::hash_text (hash, std::to_string (call_xloc.column));
+    hash = Lib::hash_text (hash, (format_call.args.type == FormatType::New) ? "new" : "get");
+    hash = Lib::hash_text (hash, format_call.args.format);
+    for (auto arg : format_call.args.args)
+    {
+      hash = Lib::hash_text (hash, get_tree_code_name (TREE_CODE (arg)));
+      hash = hash_type (hash, TREE_TYPE (arg));
+      if (TREE_CODE (arg) == NOP_EXPR)
+      {
+        hash = hash_type (hash, TREE_TYPE (TREE_OPERAND (arg, 0)));
+      }
+    }
+  }
+
+  return {(xloc.file != nullptr) ? xloc.file : "",
+          static_cast<std::uint32_t> (xloc.line),
+          static_cast<std::uint32_t> (xloc.column),
+          hash};
+}
+
+auto
+load_check_record (std::string const& store,
+                   Lib::CheckKey const& key) -> std::optional<Lib::CheckRecord>
+{
+  std::ifstream file {store + '/' + Lib::check_file_name (key), std::ios::binary};
+
+  if (!file)
+  {
+    return {};
+  }
+
+  std::ostringstream contents;
+
+  contents << file.rdbuf ();
+
+  auto record {Lib::parse_check_record (contents.str ())};
+
+  // A digest collision or a stale record from an older version.
+  if (!record || record->key != key)
+  {
+    return {};
+  }
+
+  return record;
+}
+
+// Several compilers may store the same record at once, so it is
+// written to a file private to this process and renamed into place.
+auto
+store_check_record (std::string const& store,
+                    Lib::CheckRecord const& record) -> void
+{
+  auto const path {store + '/' + Lib::check_file_name (record.key)};
+  auto const temporary_path {path + '.' + std::to_string (getpid ())};
+
+  {
+    std::ofstream file {temporary_path, std::ios::binary};
+
+    file << Lib::check_record_to_string (record);
+    if (!file)
+    {
+      // The store is only a cache, so it is not an error.
+      warning (0, "failed to write the check record %qs", temporary_path.c_str ());
+      unlink (temporary_path.c_str ());
+      return;
+    }
+  }
+  if (rename (temporary_path.c_str (), path.c_str ()) != 0)
+  {
+    unlink (temporary_path.c_str ());
+  }
+}
+
+// Functions from the main file are only checked once anyway.
+auto
+is_in_header (tree function_decl) -> bool
+{
+  auto const file {DECL_SOURCE_FILE (function_decl)};
+
+  return file != nullptr && main_input_filename != nullptr &&
+    std::strcmp (file, main_input_filename) != 0;
+}
+
+void
+ggp_vc_finish_parse_function (void* gcc_data,
+                              void* user_data)
+{
+  auto& checker = *static_cast<VariantChecker*> (user_data);
+  auto function_decl = static_cast<tree> (gcc_data);
+  gcc_assert (TREE_CODE (function_decl) == FUNCTION_DECL);
+  // warning (0, "Tree dump of %s",
+  //          IDENTIFIER_POINTER (DECL_NAME (function_decl)));
+  // dump_node (function_decl, TDF_ADDRESS, stderr);
+
+  if (!checker.filter.wants_function (function_decl))
+  {
+    return;
+  }
+
+  auto const format_calls {get_format_calls (function_decl)};
+
+  if (format_calls.empty ())
+  {
+    return;
+  }
+
+  auto const key {get_check_key (function_decl, format_calls)};
+
+  // In C++ every instantiation of a template gets here after the
+  // template itself. If the types of the arguments do not depend on
+  // the template parameters, the check of the template covered it.
+  if (!checker.checked.insert (Lib::check_key_digest (key)).second)
+  {
+    return;
+  }
+
+  auto const use_store {checker.store && is_in_header (function_decl)};
+
+  if (use_store)
+  {
+    if (auto const record {load_check_record (*checker.store, key)}; record)
+    {
+      report_diagnostics (checker, record->diagnostics);
+      return;
+    }
+  }
+
+  auto diagnostics {check_format_calls (format_calls)};
+
+  report_diagnostics (checker, diagnostics);
+  if (use_store)
+  {
+    store_check_record (*checker.store, {key, std::move (diagnostics)});
   }
 }
 
@@ -695,8 +873,15 @@ get_register_vc_cfg_pass_info ()
 
 } // anonymous namespace
 
-VariantChecker::VariantChecker (struct plugin_name_args* plugin_info)
+VariantChecker::VariantChecker (struct plugin_name_args* plugin_info,
+                                SourceFilter const& filter,
+                                SarifLog& sarif)
   : name {subplugin_name (plugin_info, "vc")},
+    filter {filter},
+    sarif {sarif},
+    known_functions {plugin_info},
+    store {get_plugin_arg (plugin_info, "vc-store")},
+    checked {},
     finish_decl {name, PLUGIN_FINISH_DECL, ggp_vc_finish_decl, this},
     start_parse_function {name, PLUGIN_START_PARSE_FUNCTION, ggp_vc_start_parse_function, this},
     finish_parse_function {name, PLUGIN_FINISH_PARSE_FUNCTION, ggp_vc_finish_parse_function, this},
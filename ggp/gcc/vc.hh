@@ -21,16 +21,39 @@
 
 #include "ggp/gcc/gcc.hh"
 
+#include "ggp/gcc/filter.hh"
+#include "ggp/gcc/format.hh"
+#include "ggp/gcc/sarif.hh"
 #include "ggp/gcc/util.hh"
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
 namespace Ggp::Gcc
 {
 
 struct VariantChecker
 {
-  VariantChecker(struct plugin_name_args* plugin_info);
+  VariantChecker(struct plugin_name_args* plugin_info,
+                 SourceFilter const& filter,
+                 SarifLog& sarif);
 
   std::string name;
+  SourceFilter const& filter;
+  // Gets the diagnostics too.
+  SarifLog& sarif;
+  // Gets the glib_variant attribute added to their declarations.
+  KnownFunctions known_functions;
+  // Directory keeping the results of checking functions from headers
+  // across translation units, so a header function is checked once
+  // per build. Set with -fplugin-arg-<plugin>-vc-store=<dir>, the
+  // directory needs to exist.
+  std::optional<std::string> store;
+  // Digests of the check keys of functions checked in the translation
+  // unit, see ggp/lib/check-store.hh.
+  std::unordered_set<std::uint64_t> checked;
   CallbackRegistration finish_decl;
   CallbackRegistration start_parse_function;
   CallbackRegistration finish_parse_function;
@@ -0,0 +1,513 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/gcc/wp.hh"
+
+#include "ggp/gcc/args.hh"
+#include "ggp/gcc/call.hh"
+#include "ggp/gcc/format.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Ggp::Gcc
+{
+
+namespace
+{
+
+// Static variable keeping the summary of a translation unit in its
+// LTO object. Plugins can't add their own LTO sections, but variables
+// get streamed with their initializers.
+char const summary_variable_name[] {"__ggp_wp_summary"};
+
+// The IPA pass hooks take no user data.
+WholeProgramChecker* active_checker {nullptr};
+
+// Names of the functions local to the translation unit get the name
+// of the main input file appended, so they don't clash with the ones
+// in other units.
+auto
+get_summary_name (tree function_decl) -> std::string
+{
+  std::string name {IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (function_decl))};
+
+  if (!TREE_PUBLIC (function_decl) && main_input_filename != nullptr)
+  {
+    name += '@';
+    name += main_input_filename;
+  }
+
+  return name;
+}
+
+// The GVariant functions taking their arguments in a va_list lack the
+// glib_variant attribute - they have no varargs to check.
+auto
+get_va_list_sink (char const* name) -> std::optional<Lib::FormatSink>
+{
+  if (std::strcmp (name, "g_variant_new_va") == 0)
+  {
+    return {{name, Lib::FormatUse::New, 1u, 0u, true}};
+  }
+  if (std::strcmp (name, "g_variant_get_va") == 0)
+  {
+    return {{name, Lib::FormatUse::Get, 2u, 0u, true}};
+  }
+
+  return {};
+}
+
+auto
+get_sink (tree function_decl,
+          std::string const& name) -> std::optional<Lib::FormatSink>
+{
+  if (auto const attribute {get_glib_variant_attribute (function_decl)}; attribute != NULL_TREE)
+  {
+    auto const info {must_get_format_info_from_args (TREE_VALUE (attribute))};
+
+    return {{name,
+             (info.type == FormatType::New) ? Lib::FormatUse::New : Lib::FormatUse::Get,
+             static_cast<std::uint32_t> (info.string_index),
+             static_cast<std::uint32_t> (info.args_index),
+             false}};
+  }
+  if (DECL_NAME (function_decl) == NULL_TREE)
+  {
+    return {};
+  }
+
+  return get_va_list_sink (IDENTIFIER_POINTER (DECL_NAME (function_decl)));
+}
+
+// Returns the 1-based index of the parameter or 0 if the argument is
+// not a parameter of the function.
+auto
+get_param_index (tree function_decl,
+                 tree arg) -> std::uint32_t
+{
+  if (TREE_CODE (arg) != PARM_DECL)
+  {
+    return 0u;
+  }
+
+  auto idx {1u};
+
+  for (auto param {DECL_ARGUMENTS (function_decl)}; param != NULL_TREE; param = DECL_CHAIN (param), ++idx)
+  {
+    if (param == arg)
+    {
+      return idx;
+    }
+  }
+
+  return 0u;
+}
+
+auto
+summarize_call (tree function_decl,
+                gcall const* call,
+                Lib::FunctionSummary& function,
+                std::vector<Lib::FormatSink>& sinks) -> void
+{
+  auto const callee_decl {gimple_call_fndecl (call)};
+
+  // Builtins like printf take no GVariant formats.
+  if (callee_decl == NULL_TREE || DECL_NAME (callee_decl) == NULL_TREE || fndecl_built_in_p (callee_decl))
+  {
+    return;
+  }
+
+  auto const callee {get_summary_name (callee_decl)};
+  auto const args_count {gimple_call_num_args (call)};
+  std::string arg_kinds;
+
+  if (auto sink {get_sink (callee_decl, callee)}; sink)
+  {
+    sinks.push_back (std::move (*sink));
+  }
+  for (auto idx {0u}; idx < args_count; ++idx)
+  {
+    arg_kinds.push_back (get_arg_kind (gimple_call_arg (call, idx)));
+  }
+  for (auto idx {0u}; idx < args_count; ++idx)
+  {
+    auto const arg {gimple_call_arg (call, idx)};
+
+    if (auto const param {get_param_index (function_decl, arg)}; param != 0u)
+    {
+      function.passes.push_back ({param, callee, idx + 1u});
+    }
+    else if (auto const literal {get_string_literal (arg)}; literal != nullptr)
+    {
+      auto const xloc {expand_location (gimple_location (call))};
+
+      function.calls.push_back ({callee,
+                                 idx + 1u,
+                                 literal,
+                                 (xloc.file != nullptr) ? xloc.file : "",
+                                 static_cast<std::uint32_t> (xloc.line),
+                                 static_cast<std::uint32_t> (xloc.column),
+                                 arg_kinds});
+    }
+  }
+}
+
+auto
+summarize_function (function* fn,
+                    Lib::UnitSummary& summary) -> void
+{
+  auto const function_decl {fn->decl};
+  auto params_count {0u};
+
+  for (auto param {DECL_ARGUMENTS (function_decl)}; param != NULL_TREE; param = DECL_CHAIN (param))
+  {
+    ++params_count;
+  }
+
+  Lib::FunctionSummary function {get_summary_name (function_decl),
+                                 params_count,
+                                 stdarg_p (TREE_TYPE (function_decl)),
+                                 {},
+                                 {}};
+  basic_block bb;
+
+  FOR_EACH_BB_FN (bb, fn)
+  {
+    for (auto gsi {gsi_start_bb (bb)}; !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      if (auto const call {dyn_cast<gcall*> (gsi_stmt (gsi))}; call != nullptr)
+      {
+        summarize_call (function_decl, call, function, summary.sinks);
+      }
+    }
+  }
+  // Functions calling nothing of interest would only make the
+  // summary bigger.
+  if (!function.passes.empty () || !function.calls.empty ())
+  {
+    summary.functions.push_back (std::move (function));
+  }
+}
+
+// Stores the summary in a static variable, so it gets streamed into
+// the LTO object. The variable is only meant for the LTO IL, see
+// wp_ipa_pass::execute.
+auto
+store_summary (Lib::UnitSummary const& summary) -> void
+{
+  auto const contents {Lib::summary_to_string (summary)};
+  auto const length {contents.size () + 1u};
+  auto const type {build_array_type_nelts (char_type_node, length)};
+  auto const init {build_string (length, contents.c_str ())};
+  auto const decl {build_decl (UNKNOWN_LOCATION, VAR_DECL, get_identifier (summary_variable_name), type)};
+
+  TREE_TYPE (init) = type;
+  TREE_CONSTANT (init) = 1;
+  TREE_READONLY (init) = 1;
+  TREE_STATIC (init) = 1;
+  TREE_STATIC (decl) = 1;
+  TREE_READONLY (decl) = 1;
+  TREE_PUBLIC (decl) = 0;
+  DECL_ARTIFICIAL (decl) = 1;
+  // Nothing refers to the variable, keep it anyway.
+  DECL_PRESERVE_P (decl) = 1;
+  DECL_INITIAL (decl) = init;
+  varpool_node::add (decl);
+}
+
+auto
+find_summary_nodes () -> std::vector<varpool_node*>
+{
+  std::vector<varpool_node*> nodes;
+  varpool_node* node;
+
+  FOR_EACH_VARIABLE (node)
+  {
+    auto const name {DECL_NAME (node->decl)};
+
+    if (name != NULL_TREE && id_equal (name, summary_variable_name))
+    {
+      nodes.push_back (node);
+    }
+  }
+
+  return nodes;
+}
+
+// Reads the summaries of all the translation units at the WPA stage
+// and removes their variables, so they don't end up in the program.
+auto
+load_summaries () -> std::vector<Lib::UnitSummary>
+{
+  std::vector<Lib::UnitSummary> summaries;
+
+  for (auto const summary_node : find_summary_nodes ())
+  {
+    auto const init {summary_node->get_constructor ()};
+
+    if (init != NULL_TREE && TREE_CODE (init) == STRING_CST && TREE_STRING_LENGTH (init) > 0)
+    {
+      auto summary {Lib::parse_summary ({TREE_STRING_POINTER (init),
+                                         static_cast<std::size_t> (TREE_STRING_LENGTH (init) - 1)})};
+
+      if (summary)
+      {
+        summaries.push_back (std::move (*summary));
+      }
+      else
+      {
+        warning (0, "ignoring a malformed or outdated GVariant format summary");
+      }
+    }
+    summary_node->remove ();
+  }
+
+  return summaries;
+}
+
+// The line maps of the compile stage are gone at the WPA stage, so
+// the location is added to the line map the same way the LTO streamer
+// adds the locations it reads.
+auto
+make_location (std::string const& file,
+               std::uint32_t line,
+               std::uint32_t column) -> location_t
+{
+  if (file.empty ())
+  {
+    return UNKNOWN_LOCATION;
+  }
+
+  // The line map keeps the file name.
+  linemap_add (line_table, LC_ENTER, false, xstrdup (file.c_str ()), line);
+  linemap_line_start (line_table, line, column + 1u);
+
+  auto const location {linemap_position_for_column (line_table, column)};
+
+  linemap_add (line_table, LC_LEAVE, false, nullptr, 0);
+
+  return location;
+}
+
+auto
+check_summaries (WholeProgramChecker const& checker,
+                 std::vector<Lib::UnitSummary> const& summaries) -> void
+{
+  auto const summary {Lib::merge_summaries (summaries)};
+  auto const wrappers {Lib::find_wrappers (summary)};
+
+  for (auto const& diagnostic : Lib::check_wrapper_calls (summary, wrappers))
+  {
+    if (!checker.filter.wants_diagnostic (diagnostic))
+    {
+      continue;
+    }
+
+    // The C family options like -Wformat don't exist at the WPA
+    // stage, this one is common to all the compilers.
+    warning_at (make_location (diagnostic.file, diagnostic.line, diagnostic.column),
+                OPT_Wlto_type_mismatch,
+                "%s",
+                diagnostic.message.c_str ());
+    checker.sarif.add (diagnostic);
+  }
+  if (checker.report)
+  {
+    write_report (*checker.report,
+                  Lib::wpa_report_to_string (summary, wrappers),
+                  "whole program GVariant");
+  }
+}
+
+const pass_data wp_cfg_pass_data =
+{
+  GIMPLE_PASS, /* type */
+  "wp_cfg", /* name */
+  OPTGROUP_NONE, /* optinfo_flags */
+  TV_NONE, /* tv_id */
+  PROP_cfg, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class wp_cfg_pass : public gimple_opt_pass
+{
+public:
+  wp_cfg_pass(gcc::context* ctxt,
+              WholeProgramChecker& checker)
+    : gimple_opt_pass(wp_cfg_pass_data, ctxt),
+      checker {checker}
+  {}
+
+  /* opt_pass methods: */
+  virtual unsigned int execute (function *) override;
+
+private:
+  WholeProgramChecker& checker;
+};
+
+// Every function gets summarized, whether the source filter wants it
+// or not, otherwise the calls through the wrappers it defines would go
+// unchecked.
+unsigned int
+wp_cfg_pass::execute (function* fn)
+{
+  summarize_function (fn, this->checker.summary);
+
+  return 0;
+}
+
+const pass_data wp_ipa_pass_data =
+{
+  IPA_PASS, /* type */
+  "wp_ipa", /* name */
+  OPTGROUP_NONE, /* optinfo_flags */
+  TV_NONE, /* tv_id */
+  0, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+// Runs when the whole program is compiled, after the lowering, so the
+// summary of the translation unit is complete.
+void
+wp_generate_summary ()
+{
+  auto& summary {active_checker->summary};
+
+  // Sinks are recorded for every call.
+  summary = Lib::merge_summaries ({summary});
+  if (flag_generate_lto)
+  {
+    store_summary (summary);
+  }
+}
+
+class wp_ipa_pass : public ipa_opt_pass_d
+{
+public:
+  wp_ipa_pass(gcc::context* ctxt)
+    : ipa_opt_pass_d(wp_ipa_pass_data,
+                     ctxt,
+                     wp_generate_summary, /* generate_summary */
+                     NULL, /* write_summary */
+                     NULL, /* read_summary */
+                     NULL, /* write_optimization_summary */
+                     NULL, /* read_optimization_summary */
+                     NULL, /* stmt_fixup */
+                     0, /* function_transform_todo_flags_start */
+                     NULL, /* function_transform */
+                     NULL) /* variable_transform */
+  {}
+
+  /* opt_pass methods: */
+  virtual unsigned int execute (function *) override;
+};
+
+unsigned int
+wp_ipa_pass::execute (function*)
+{
+  if (in_lto_p)
+  {
+    check_summaries (*active_checker, load_summaries ());
+  }
+  // Fat LTO objects get checked at the WPA stage too.
+  else if (!flag_generate_lto)
+  {
+    check_summaries (*active_checker, {active_checker->summary});
+  }
+  // The LTO IL is already written when the code of a fat LTO object
+  // is compiled, so the summary can go, it would only end up in the
+  // object file and in programs linked without -flto.
+  else
+  {
+    for (auto const summary_node : find_summary_nodes ())
+    {
+      summary_node->remove ();
+    }
+  }
+
+  return 0;
+}
+
+std::unique_ptr<register_pass_info>
+get_register_wp_cfg_pass_info (WholeProgramChecker& checker)
+{
+  // g - a global gcc::context
+  register_pass_info pass_info { new wp_cfg_pass (g, checker), "cfg", 1, PASS_POS_INSERT_AFTER };
+  return std::make_unique<register_pass_info> (pass_info);
+}
+
+std::unique_ptr<register_pass_info>
+get_register_wp_ipa_pass_info ()
+{
+  // g - a global gcc::context
+  register_pass_info pass_info { new wp_ipa_pass (g), "inline", 1, PASS_POS_INSERT_AFTER };
+  return std::make_unique<register_pass_info> (pass_info);
+}
+
+} // anonymous namespace
+
+WholeProgramChecker::WholeProgramChecker (struct plugin_name_args* plugin_info,
+                                          SourceFilter const& filter,
+                                          SarifLog& sarif)
+  : name {subplugin_name (plugin_info, "wp")},
+    filter {filter},
+    sarif {sarif},
+    report {get_plugin_arg (plugin_info, "wpa-report")},
+    summary {}
+{
+  if (!get_plugin_arg_bool (plugin_info, "wpa", false))
+  {
+    return;
+  }
+
+  active_checker = this;
+
+  auto cfg_pass_info {get_register_wp_cfg_pass_info (*this)};
+  auto ipa_pass_info {get_register_wp_ipa_pass_info ()};
+
+  // Nothing to unregister for the PLUGIN_PASS_MANAGER_SETUP events -
+  // they take no callbacks.
+  ::register_callback (name.c_str (),
+                       PLUGIN_PASS_MANAGER_SETUP,
+                       NULL,
+                       cfg_pass_info.get ());
+  ::register_callback (name.c_str (),
+                       PLUGIN_PASS_MANAGER_SETUP,
+                       NULL,
+                       ipa_pass_info.get ());
+}
+
+WholeProgramChecker::~WholeProgramChecker ()
+{
+  if (active_checker == this)
+  {
+    active_checker = nullptr;
+  }
+}
+
+} // namespace Ggp::Gcc
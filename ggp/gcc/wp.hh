@@ -0,0 +1,74 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GGP_WP_HH
+#define GGP_WP_HH
+
+#include "ggp/gcc/gcc.hh"
+
+#include "ggp/gcc/filter.hh"
+#include "ggp/gcc/sarif.hh"
+#include "ggp/gcc/util.hh"
+
+#include "ggp/gcc/generated/summary.hh"
+
+#include <optional>
+#include <string>
+
+namespace Ggp::Gcc
+{
+
+// Whole program checker - checks the formats passed to wrappers of
+// the GVariant functions, also when the wrappers are defined in other
+// translation units. It is off by default,
+// -fplugin-arg-<plugin>-wpa enables it.
+//
+// The calls in the functions are summarized, see
+// ggp/lib/summary.hh. With -flto the summary of each translation unit
+// is stored in the object file and the summaries of the whole program
+// are checked at the WPA stage, so the plugin needs to be passed to
+// the link too. Without -flto only the wrappers in the translation
+// unit are seen. All the functions are summarized, the source filter
+// only applies to the diagnostics.
+//
+// Plugins can't add warning options, so the diagnostics are given
+// under -Wlto-type-mismatch, which is about mismatches between
+// translation units too, see check_summaries.
+//
+// -fplugin-arg-<plugin>-wpa-report[=<file>] writes the numbers of
+// functions, wrappers and format calls seen by the check, see
+// Lib::wpa_report_to_string, empty for stderr.
+struct WholeProgramChecker
+{
+  WholeProgramChecker (struct plugin_name_args* plugin_info,
+                       SourceFilter const& filter,
+                       SarifLog& sarif);
+  ~WholeProgramChecker ();
+
+  std::string name;
+  SourceFilter const& filter;
+  // Gets the diagnostics too.
+  SarifLog& sarif;
+  // No report is written if unset.
+  std::optional<std::string> report;
+  // Summary of the translation unit.
+  Lib::UnitSummary summary;
+};
+
+} // namespace Ggp::Gcc
+
+#endif /* GGP_WP_HH */
@@ -0,0 +1,482 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Merges the call site indices written by the plugin with
+// -fplugin-arg-<plugin>-pa-index (see ggp/lib/index.hh) and answers
+// queries about them:
+//
+//   ggp-index [--jobs=N] top-formats [--top=N] FILE…
+//     formats sorted by the number of call sites using them
+//   ggp-index [--jobs=N] sites FORMAT FILE…
+//     every call site using the format
+//   ggp-index [--jobs=N] replay [--rounds=N] FILE…
+//     runs the format checks on every call site again and reports
+//     how long it took, for benchmarking the checks offline
+//
+// An argument starting with "@" names a file listing more index
+// files, one per line. The files are mapped into memory and parsed
+// by several threads in parallel.
+
+#include "ggp/index/generated/index.hh"
+#include "ggp/index/generated/type.hh"
+#include "ggp/index/generated/variant.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+using namespace Ggp::Lib;
+
+// A read only mapping of a whole file.
+struct MappedFile
+{
+  MappedFile () = default;
+  MappedFile (MappedFile const&) = delete;
+  MappedFile (MappedFile&& other);
+  ~MappedFile ();
+
+  auto
+  operator= (MappedFile const&) -> MappedFile& = delete;
+  auto
+  operator= (MappedFile&& other) -> MappedFile&;
+
+  // Empty if the file can't be mapped.
+  static auto
+  map (std::string const& path) -> std::optional<MappedFile>;
+
+  auto
+  data () const -> std::string_view;
+
+private:
+  void* address {nullptr};
+  std::size_t size {0u};
+};
+
+MappedFile::MappedFile (MappedFile&& other)
+  : address {std::exchange (other.address, nullptr)},
+    size {std::exchange (other.size, 0u)}
+{}
+
+auto
+MappedFile::operator= (MappedFile&& other) -> MappedFile&
+{
+  std::swap (this->address, other.address);
+  std::swap (this->size, other.size);
+
+  return *this;
+}
+
+MappedFile::~MappedFile ()
+{
+  if (this->address != nullptr)
+  {
+    munmap (this->address, this->size);
+  }
+}
+
+auto
+MappedFile::map (std::string const& path) -> std::optional<MappedFile>
+{
+  auto const fd {open (path.c_str (), O_RDONLY | O_CLOEXEC)};
+
+  if (fd < 0)
+  {
+    return {};
+  }
+
+  struct stat st;
+  std::optional<MappedFile> mapped;
+
+  if (fstat (fd, &st) == 0 && st.st_size > 0)
+  {
+    auto const size {static_cast<std::size_t> (st.st_size)};
+    auto const address {mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+
+    if (address != MAP_FAILED)
+    {
+      mapped.emplace ();
+      mapped->address = address;
+      mapped->size = size;
+    }
+  }
+  close (fd);
+
+  return mapped;
+}
+
+auto
+MappedFile::data () const -> std::string_view
+{
+  return {static_cast<char const*> (this->address), this->size};
+}
+
+struct LoadedIndex
+{
+  MappedFile file;
+  std::vector<IndexSiteView> sites;
+};
+
+// Maps and parses the files with the given number of threads. The
+// indices come in the order of the paths, files that failed to load
+// are reported and left empty.
+auto
+load_indices (std::vector<std::string> const& paths,
+              unsigned jobs) -> std::vector<std::optional<LoadedIndex>>
+{
+  std::vector<std::optional<LoadedIndex>> indices (paths.size ());
+  std::atomic<std::size_t> next {0u};
+  auto worker {
+    [&paths, &indices, &next]()
+    {
+      for (auto idx {next++}; idx < paths.size (); idx = next++)
+      {
+        auto maybe_file {MappedFile::map (paths[idx])};
+
+        if (!maybe_file)
+        {
+          continue;
+        }
+
+        auto maybe_sites {parse_index (maybe_file->data ())};
+
+        if (!maybe_sites)
+        {
+          continue;
+        }
+        indices[idx] = LoadedIndex {std::move (*maybe_file), std::move (*maybe_sites)};
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+
+  for (auto idx {0u}; idx < std::max (jobs, 1u); ++idx)
+  {
+    threads.emplace_back (worker);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join ();
+  }
+  for (std::size_t idx {0u}; idx < paths.size (); ++idx)
+  {
+    if (!indices[idx])
+    {
+      std::cerr << "ggp-index: " << paths[idx] << " is not a readable call site index\n";
+    }
+  }
+
+  return indices;
+}
+
+auto
+location_string (IndexSiteView const& site) -> std::string
+{
+  return std::string {site.file} + ':' + std::to_string (site.line) + ':' + std::to_string (site.column);
+}
+
+auto
+top_formats (std::vector<std::optional<LoadedIndex>> const& indices,
+             std::size_t top) -> void
+{
+  std::unordered_map<std::string_view, std::size_t> counts;
+
+  for (auto const& maybe_index : indices)
+  {
+    if (!maybe_index)
+    {
+      continue;
+    }
+    for (auto const& site : maybe_index->sites)
+    {
+      ++counts[site.format];
+    }
+  }
+
+  std::vector<std::pair<std::string_view, std::size_t>> sorted {counts.cbegin (), counts.cend ()};
+
+  std::sort (sorted.begin (),
+             sorted.end (),
+             [](auto const& lhs, auto const& rhs)
+             {
+               if (lhs.second != rhs.second)
+               {
+                 return lhs.second > rhs.second;
+               }
+               return lhs.first < rhs.first;
+             });
+  if (sorted.size () > top)
+  {
+    sorted.resize (top);
+  }
+  for (auto const& [format, count] : sorted)
+  {
+    std::cout << count << '\t' << format << '\n';
+  }
+}
+
+auto
+sites_with_format (std::vector<std::optional<LoadedIndex>> const& indices,
+                   std::string_view format) -> void
+{
+  for (auto const& maybe_index : indices)
+  {
+    if (!maybe_index)
+    {
+      continue;
+    }
+    for (auto const& site : maybe_index->sites)
+    {
+      if (site.format != format)
+      {
+        continue;
+      }
+      std::cout << location_string (site) << '\t'
+                << site.function << '\t'
+                << site.callee << '\t'
+                << site.loop_depth << '\t'
+                << site.arg_types << '\n';
+    }
+  }
+}
+
+// Does what the variant checker does for each call - parses the
+// format and works out the expected types of the arguments.
+auto
+replay (std::vector<std::optional<LoadedIndex>> const& indices,
+        unsigned rounds) -> void
+{
+  std::size_t sites_count {0u};
+  std::size_t invalid_formats {0u};
+  std::size_t mismatched_args {0u};
+  auto const start {std::chrono::steady_clock::now ()};
+
+  for (auto round {0u}; round < rounds; ++round)
+  {
+    for (auto const& maybe_index : indices)
+    {
+      if (!maybe_index)
+      {
+        continue;
+      }
+      for (auto const& site : maybe_index->sites)
+      {
+        auto const maybe_format {VariantFormat::from_string (site.format)};
+
+        if (round == 0u)
+        {
+          ++sites_count;
+        }
+        if (!maybe_format)
+        {
+          invalid_formats += round == 0u;
+          continue;
+        }
+
+        auto const types {expected_types_for_format (*maybe_format)};
+
+        if (round == 0u && types.size () != split_arg_types (site.arg_types).size ())
+        {
+          ++mismatched_args;
+        }
+      }
+    }
+  }
+
+  auto const elapsed {std::chrono::steady_clock::now () - start};
+  auto const nanoseconds {std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()};
+  auto const checks {sites_count * rounds};
+
+  std::cout << "sites\t" << sites_count << '\n'
+            << "invalid formats\t" << invalid_formats << '\n'
+            << "mismatched argument counts\t" << mismatched_args << '\n'
+            << "rounds\t" << rounds << '\n'
+            << "nanoseconds\t" << nanoseconds << '\n'
+            << "nanoseconds per check\t" << (checks > 0u ? nanoseconds / checks : 0u) << '\n';
+}
+
+// Expands the "@" arguments. Returns false if a list can't be read.
+auto
+collect_paths (std::vector<std::string_view> const& args,
+               std::vector<std::string>& paths) -> bool
+{
+  for (auto const& arg : args)
+  {
+    if (arg.empty () || arg.front () != '@')
+    {
+      paths.emplace_back (arg);
+      continue;
+    }
+
+    std::ifstream list {std::string {arg.substr (1u)}};
+
+    if (!list)
+    {
+      std::cerr << "ggp-index: failed to read the list " << arg.substr (1u) << '\n';
+      return false;
+    }
+    for (std::string line; std::getline (list, line);)
+    {
+      if (!line.empty ())
+      {
+        paths.push_back (std::move (line));
+      }
+    }
+  }
+
+  return true;
+}
+
+// Parses --name=N options at the front of the arguments.
+auto
+take_number_option (std::vector<std::string_view>& args,
+                    std::string_view name,
+                    unsigned& value) -> bool
+{
+  if (args.empty () || args.front ().substr (0u, name.size ()) != name)
+  {
+    return true;
+  }
+
+  auto const number {std::string {args.front ().substr (name.size ())}};
+  char* end {nullptr};
+  auto const parsed {std::strtoul (number.c_str (), &end, 10)};
+
+  if (number.empty () || *end != '\0' || parsed == 0u)
+  {
+    std::cerr << "ggp-index: expected a positive number in " << args.front () << '\n';
+    return false;
+  }
+  value = static_cast<unsigned> (parsed);
+  args.erase (args.begin ());
+
+  return true;
+}
+
+auto
+usage () -> int
+{
+  std::cerr << "usage: ggp-index [--jobs=N] top-formats [--top=N] FILE…\n"
+            << "       ggp-index [--jobs=N] sites FORMAT FILE…\n"
+            << "       ggp-index [--jobs=N] replay [--rounds=N] FILE…\n";
+
+  return 2;
+}
+
+} // anonymous namespace
+
+int
+main (int argc,
+      char** argv)
+{
+  std::vector<std::string_view> args {argv + 1, argv + argc};
+  unsigned jobs {std::max (std::thread::hardware_concurrency (), 1u)};
+
+  if (!take_number_option (args, "--jobs=", jobs))
+  {
+    return 2;
+  }
+  if (args.empty ())
+  {
+    return usage ();
+  }
+
+  auto const command {args.front ()};
+  unsigned top {20u};
+  unsigned rounds {1u};
+  std::string_view format;
+
+  args.erase (args.begin ());
+  if (command == "top-formats")
+  {
+    if (!take_number_option (args, "--top=", top))
+    {
+      return 2;
+    }
+  }
+  else if (command == "sites")
+  {
+    if (args.empty ())
+    {
+      return usage ();
+    }
+    format = args.front ();
+    args.erase (args.begin ());
+  }
+  else if (command == "replay")
+  {
+    if (!take_number_option (args, "--rounds=", rounds))
+    {
+      return 2;
+    }
+  }
+  else
+  {
+    return usage ();
+  }
+
+  std::vector<std::string> paths;
+
+  if (!collect_paths (args, paths))
+  {
+    return 1;
+  }
+  if (paths.empty ())
+  {
+    return usage ();
+  }
+
+  auto const indices {load_indices (paths, jobs)};
+
+  if (command == "top-formats")
+  {
+    top_formats (indices, top);
+  }
+  else if (command == "sites")
+  {
+    sites_with_format (indices, format);
+  }
+  else
+  {
+    replay (indices, rounds);
+  }
+
+  auto const all_loaded {std::all_of (indices.cbegin (),
+                                      indices.cend (),
+                                      [](auto const& maybe_index) { return maybe_index.has_value (); })};
+
+  return all_loaded ? 0 : 1;
+}
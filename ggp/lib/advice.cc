@@ -0,0 +1,109 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: advice.hh >*/
+/*< stl: algorithm >*/
+/*< stl: sstream >*/
+
+namespace Ggp::Lib
+{
+
+auto
+add_execution_count (ExecutionCounts& counts,
+                     std::string const& function,
+                     std::string const& location,
+                     std::uint64_t count) -> void
+{
+  auto [iter, inserted] {counts.emplace (std::make_pair (function, location), count)};
+
+  if (!inserted)
+  {
+    iter->second = std::max (iter->second, count);
+  }
+}
+
+auto
+find_execution_count (ExecutionCounts const& counts,
+                      std::string const& function,
+                      std::string const& location) -> std::optional<std::uint64_t>
+{
+  auto const iter {counts.find (std::make_pair (function, location))};
+
+  if (iter == counts.cend ())
+  {
+    return {};
+  }
+
+  return {iter->second};
+}
+
+auto
+advice_text (AdviceSite const& site) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << site.message;
+  if (site.execution_count)
+  {
+    oss << " [executed " << *site.execution_count << " time(s)]";
+  }
+
+  return oss.str ();
+}
+
+auto
+rank_advice (std::vector<AdviceSite> const& sites) -> std::vector<AdviceSite>
+{
+  auto ranked {sites};
+
+  std::stable_sort (ranked.begin (),
+                    ranked.end (),
+                    [](AdviceSite const& lhs, AdviceSite const& rhs)
+                    {
+                      // Empty optionals compare less than any value.
+                      return lhs.execution_count > rhs.execution_count;
+                    });
+
+  return ranked;
+}
+
+auto
+advice_report_to_string (std::vector<AdviceSite> const& sites) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << "ggp-advice-report\n";
+  for (auto const& site : rank_advice (sites))
+  {
+    if (site.execution_count)
+    {
+      oss << *site.execution_count;
+    }
+    else
+    {
+      oss << '-';
+    }
+    oss << '\t'
+        << site.location << '\t'
+        << site.function << '\t'
+        << site.message << '\n';
+  }
+
+  return oss.str ();
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,95 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_ADVICE_HH_CHECK >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: map >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: utility >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_ADVICE_HH
+#define GGP_LIB_ADVICE_HH
+
+#define GGP_LIB_ADVICE_HH_CHECK_VALUE GGP_LIB_ADVICE_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// A piece of advice given by the performance advisor.
+GGP_LIB_STRUCT (AdviceSite,
+                // file:line:column of the statement.
+                std::string, location,
+                // The function containing the statement.
+                std::string, function,
+                // How many times the statement ran, from profile
+                // feedback. Empty without it.
+                std::optional<std::uint64_t>, execution_count,
+                std::string, message);
+
+// Execution counts of statements from profile feedback, by the
+// function and the file:line:column of the statement. The profile is
+// read well after the advice is found, so the counts are gathered
+// separately and matched with the advice by the location.
+using ExecutionCounts = std::map<std::pair<std::string, std::string>, std::uint64_t>;
+
+// Statements sharing a location keep the highest count.
+auto
+add_execution_count (ExecutionCounts& counts,
+                     std::string const& function,
+                     std::string const& location,
+                     std::uint64_t count) -> void;
+
+// Empty if no statement at the location has a count.
+auto
+find_execution_count (ExecutionCounts const& counts,
+                      std::string const& function,
+                      std::string const& location) -> std::optional<std::uint64_t>;
+
+// The message of the advice together with the execution count, if
+// known.
+auto
+advice_text (AdviceSite const& site) -> std::string;
+
+// Advice sorted by the execution count, the most executed first and
+// the ones with unknown counts last. Advice with the same count keeps
+// its order.
+auto
+rank_advice (std::vector<AdviceSite> const& sites) -> std::vector<AdviceSite>;
+
+// The report is a text file:
+//
+//   ggp-advice-report
+//   <count>\t<location>\t<function>\t<message>
+//   …
+//
+// The count is "-" if unknown. The advice is ranked with
+// rank_advice.
+auto
+advice_report_to_string (std::vector<AdviceSite> const& sites) -> std::string;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_ADVICE_HH_CHECK_VALUE != GGP_LIB_ADVICE_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_ADVICE_HH */
@@ -0,0 +1,307 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: api.hh >*/
+/*< stl: algorithm >*/
+/*< stl: charconv >*/
+/*< stl: cstddef >*/
+/*< stl: unordered_map >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+// Seed of the hash putting the keys in buckets.
+constexpr std::uint32_t bucket_seed {0u};
+constexpr std::uint32_t max_seed {1u << 16};
+
+// FNV-1a with a final mix, the seed makes an independent function.
+auto
+hash_key (std::string_view key,
+          std::uint32_t seed) -> std::uint64_t
+{
+  std::uint64_t hash {14695981039346656037ull ^ (seed * 0x9e3779b97f4a7c15ull)};
+
+  for (auto c : key)
+  {
+    hash ^= static_cast<unsigned char> (c);
+    hash *= 1099511628211ull;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+
+  return hash;
+}
+
+// Tries to place all the keys in the given number of slots. Empty if
+// some bucket did not fit.
+auto
+try_make_perfect_hash (std::vector<std::string_view> const& keys,
+                       std::size_t slots_count) -> std::optional<PerfectHash>
+{
+  auto const buckets_count {std::max (std::size_t {1u}, keys.size () / 2u)};
+  std::vector<std::vector<std::uint32_t>> buckets (buckets_count);
+
+  for (auto idx {0u}; idx < keys.size (); ++idx)
+  {
+    buckets[hash_key (keys[idx], bucket_seed) % buckets_count].push_back (idx);
+  }
+
+  // The biggest buckets are the hardest to place, so they go first,
+  // when most slots are free.
+  std::vector<std::uint32_t> order (buckets_count);
+
+  for (auto idx {0u}; idx < buckets_count; ++idx)
+  {
+    order[idx] = idx;
+  }
+  std::stable_sort (order.begin (),
+                    order.end (),
+                    [&buckets](std::uint32_t lhs, std::uint32_t rhs)
+                    {
+                      return buckets[lhs].size () > buckets[rhs].size ();
+                    });
+
+  PerfectHash hash {std::vector<std::uint32_t> (buckets_count, 0u),
+                    std::vector<std::uint32_t> (slots_count, no_key_index)};
+  std::vector<std::size_t> bucket_slots;
+
+  for (auto bucket_idx : order)
+  {
+    auto const& bucket {buckets[bucket_idx]};
+
+    if (bucket.empty ())
+    {
+      break;
+    }
+
+    auto seed {1u};
+
+    for (; seed < max_seed; ++seed)
+    {
+      bucket_slots.clear ();
+      for (auto key_idx : bucket)
+      {
+        auto const slot {hash_key (keys[key_idx], seed) % slots_count};
+
+        if (hash.slots[slot] != no_key_index ||
+            std::find (bucket_slots.begin (), bucket_slots.end (), slot) != bucket_slots.end ())
+        {
+          break;
+        }
+        bucket_slots.push_back (slot);
+      }
+      if (bucket_slots.size () == bucket.size ())
+      {
+        break;
+      }
+    }
+    if (seed == max_seed)
+    {
+      return {};
+    }
+    hash.seeds[bucket_idx] = seed;
+    for (auto idx {0u}; idx < bucket.size (); ++idx)
+    {
+      hash.slots[bucket_slots[idx]] = bucket[idx];
+    }
+  }
+
+  return {std::move (hash)};
+}
+
+auto
+parse_index (std::string_view str) -> std::optional<std::uint32_t>
+{
+  std::uint32_t number {};
+  auto const end {str.data () + str.size ()};
+  auto const [ptr, ec] {std::from_chars (str.data (), end, number)};
+
+  if (str.empty () || ec != std::errc {} || ptr != end || number == 0u)
+  {
+    return {};
+  }
+
+  return {number};
+}
+
+auto
+split_words (std::string_view line) -> std::vector<std::string_view>
+{
+  std::vector<std::string_view> words;
+
+  for (;;)
+  {
+    auto const start {line.find_first_not_of (" \t\r")};
+
+    if (start == std::string_view::npos)
+    {
+      break;
+    }
+    line.remove_prefix (start);
+
+    auto const end {line.find_first_of (" \t\r")};
+
+    words.push_back (line.substr (0, end));
+    line.remove_prefix ((end == std::string_view::npos) ? line.size () : end);
+  }
+
+  return words;
+}
+
+} // anonymous namespace
+
+auto
+make_perfect_hash (std::vector<std::string_view> const& keys) -> PerfectHash
+{
+  // Failing to place the keys with so many seeds is unlikely, but
+  // more slots make it easier.
+  for (auto slots_count {std::max (std::size_t {1u}, keys.size ())};; slots_count += slots_count / 8u + 1u)
+  {
+    if (auto hash {try_make_perfect_hash (keys, slots_count)}; hash)
+    {
+      return std::move (*hash);
+    }
+  }
+}
+
+auto
+perfect_hash_lookup (PerfectHash const& hash,
+                     std::string_view key) -> std::uint32_t
+{
+  auto const seed {hash.seeds[hash_key (key, bucket_seed) % hash.seeds.size ()]};
+
+  return hash.slots[hash_key (key, seed) % hash.slots.size ()];
+}
+
+auto
+make_api_table (std::vector<ApiFunction> const& functions) -> ApiTable
+{
+  std::vector<ApiFunction> unique_functions;
+  std::unordered_map<std::string_view, std::size_t> indices;
+
+  for (auto const& function : functions)
+  {
+    if (auto const iter {indices.find (function.name)}; iter != indices.end ())
+    {
+      unique_functions[iter->second] = function;
+      continue;
+    }
+    indices.emplace (function.name, unique_functions.size ());
+    unique_functions.push_back (function);
+  }
+
+  std::vector<std::string_view> names;
+
+  for (auto const& function : unique_functions)
+  {
+    names.push_back (function.name);
+  }
+
+  auto hash {make_perfect_hash (names)};
+
+  return {std::move (unique_functions), std::move (hash)};
+}
+
+auto
+find_api_function (ApiTable const& table,
+                   std::string_view name) -> ApiFunction const*
+{
+  auto const idx {perfect_hash_lookup (table.hash, name)};
+
+  if (idx == no_key_index || table.functions[idx].name != name)
+  {
+    return nullptr;
+  }
+
+  return &table.functions[idx];
+}
+
+auto
+glib_api_functions () -> std::vector<ApiFunction>
+{
+  return {
+    // GLib
+    {"g_variant_new", FormatUse::New, 1u, 2u},
+    {"g_variant_get", FormatUse::Get, 2u, 3u},
+    {"g_variant_get_child", FormatUse::Get, 3u, 4u},
+    {"g_variant_builder_add", FormatUse::New, 2u, 3u},
+    {"g_variant_iter_next", FormatUse::Get, 2u, 3u},
+    {"g_variant_iter_loop", FormatUse::Get, 2u, 3u},
+    {"g_variant_lookup", FormatUse::Get, 3u, 4u},
+    {"g_variant_dict_lookup", FormatUse::Get, 3u, 4u},
+    {"g_variant_dict_insert", FormatUse::New, 3u, 4u},
+    // GIO
+    {"g_settings_get", FormatUse::Get, 3u, 4u},
+    {"g_settings_set", FormatUse::New, 3u, 4u},
+    {"g_menu_item_get_attribute", FormatUse::Get, 3u, 4u},
+    {"g_menu_item_set_attribute", FormatUse::New, 3u, 4u},
+    {"g_menu_model_get_item_attribute", FormatUse::Get, 4u, 5u},
+  };
+}
+
+auto
+parse_api_spec (std::string_view contents) -> std::optional<std::vector<ApiFunction>>
+{
+  std::vector<ApiFunction> functions;
+
+  while (!contents.empty ())
+  {
+    auto const newline {contents.find ('\n')};
+    auto const line {contents.substr (0, newline)};
+
+    contents.remove_prefix ((newline == std::string_view::npos) ? contents.size () : newline + 1u);
+
+    auto const words {split_words (line)};
+
+    if (words.empty () || words.front ().front () == '#')
+    {
+      continue;
+    }
+    if (words.size () != 4u)
+    {
+      return {};
+    }
+
+    auto const string_index {parse_index (words[2])};
+    auto const args_index {parse_index (words[3])};
+
+    if (!string_index || !args_index || *args_index <= *string_index)
+    {
+      return {};
+    }
+    if (words[1] == "new")
+    {
+      functions.push_back ({words[0], FormatUse::New, *string_index, *args_index});
+    }
+    else if (words[1] == "get")
+    {
+      functions.push_back ({words[0], FormatUse::Get, *string_index, *args_index});
+    }
+    else
+    {
+      return {};
+    }
+  }
+
+  return {std::move (functions)};
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,106 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_API_HH_CHECK >*/
+/*< lib: arg-kind.hh >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_API_HH
+#define GGP_LIB_API_HH
+
+#define GGP_LIB_API_HH_CHECK_VALUE GGP_LIB_API_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// A function taking a GVariant format string followed by varargs.
+GGP_LIB_STRUCT (ApiFunction,
+                std::string_view, name,
+                FormatUse, use,
+                // 1-based indices of the format string and of the
+                // first vararg, like in the glib_variant attribute.
+                std::uint32_t, string_index,
+                std::uint32_t, args_index);
+
+// Minimal perfect hash built with hash and displace - the keys are
+// put in buckets by their hash, then every bucket gets a seed for a
+// second hash spreading its keys over free slots. A lookup hashes the
+// key twice and compares it with the only candidate.
+GGP_LIB_STRUCT (PerfectHash,
+                // One per bucket.
+                std::vector<std::uint32_t>, seeds,
+                // Indices of the keys, one per slot. Usually there are
+                // as many slots as keys, the free ones hold
+                // no_key_index.
+                std::vector<std::uint32_t>, slots);
+
+inline constexpr std::uint32_t no_key_index {UINT32_MAX};
+
+// The keys need to be unique.
+auto
+make_perfect_hash (std::vector<std::string_view> const& keys) -> PerfectHash;
+
+// Returns the index of the only key that may be equal to the given
+// one, or no_key_index.
+auto
+perfect_hash_lookup (PerfectHash const& hash,
+                     std::string_view key) -> std::uint32_t;
+
+GGP_LIB_STRUCT (ApiTable,
+                std::vector<ApiFunction>, functions,
+                PerfectHash, hash);
+
+// If several functions have the same name, the last one is taken, so
+// spec files can override the built-in functions.
+auto
+make_api_table (std::vector<ApiFunction> const& functions) -> ApiTable;
+
+// nullptr if the table has no function with the name.
+auto
+find_api_function (ApiTable const& table,
+                   std::string_view name) -> ApiFunction const*;
+
+// GLib and GIO functions taking GVariant format strings. GLib headers
+// do not mark them with the glib_variant attribute.
+auto
+glib_api_functions () -> std::vector<ApiFunction>;
+
+// Parses a spec file of functions taking GVariant format strings:
+//
+//   # comment
+//   <function> <new|get> <format string index> <first vararg index>
+//   …
+//
+// The fields are separated with spaces or tabs and the indices are
+// 1-based. The names are views of the contents. Empty if the
+// contents are malformed.
+auto
+parse_api_spec (std::string_view contents) -> std::optional<std::vector<ApiFunction>>;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_API_HH_CHECK_VALUE != GGP_LIB_API_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_API_HH */
@@ -0,0 +1,135 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< lib: arg-kind.hh >*/
+/*< lib: type.hh >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto
+plain_type_arg_kind (PlainType const& plain_type) -> std::optional<ArgKind>
+{
+  auto vh {VisitHelper {
+    [](Integral const& integral) -> std::optional<ArgKind>
+    {
+      if (integral.size_in_bytes <= sizeof (int))
+      {
+        return {ArgKind::Int};
+      }
+      if (integral.size_in_bytes == 8u)
+      {
+        return {ArgKind::Int64};
+      }
+      return {};
+    },
+    // float is promoted to double.
+    [](Real const& real) -> std::optional<ArgKind>
+    {
+      if (real.size_in_bytes <= 8u)
+      {
+        return {ArgKind::Double};
+      }
+      return {};
+    },
+    // GVariant, GVariantBuilder and such are only passed by pointers.
+    [](VariantTyped const&) -> std::optional<ArgKind> { return {}; },
+  }};
+
+  return std::visit (vh, plain_type.v);
+}
+
+} // anonymous namespace
+
+auto
+arg_kind_for_type (Type const& type) -> std::optional<ArgKind>
+{
+  auto vh {VisitHelper {
+    [](Const const& const_)
+    {
+      auto const_vh {VisitHelper {
+        [](Value<Pointer> const&) -> std::optional<ArgKind> { return {ArgKind::Pointer}; },
+        [](PlainType const& plain_type) { return plain_type_arg_kind (plain_type); },
+      }};
+
+      return std::visit (const_vh, const_.v);
+    },
+    [](Pointer const&) -> std::optional<ArgKind> { return {ArgKind::Pointer}; },
+    [](PlainType const& plain_type) { return plain_type_arg_kind (plain_type); },
+    [](NullPointer const&) -> std::optional<ArgKind> { return {ArgKind::Pointer}; },
+    [](Meh const&) -> std::optional<ArgKind> { return {}; },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+auto
+arg_kinds_for_format (VariantFormat const& format,
+                      FormatUse use) -> std::optional<std::string>
+{
+  std::string kinds;
+
+  for (auto const& types : expected_types_for_format (format))
+  {
+    auto maybe_kind {arg_kind_for_type (use == FormatUse::New ? types.for_new : types.for_get)};
+
+    if (!maybe_kind)
+    {
+      return {};
+    }
+    kinds.push_back (static_cast<char> (*maybe_kind));
+  }
+
+  return {std::move (kinds)};
+}
+
+auto
+arg_kind_matches (char expected,
+                  char actual) -> bool
+{
+  if (actual == static_cast<char> (ArgKind::Zero))
+  {
+    return expected == static_cast<char> (ArgKind::Int64) || expected == static_cast<char> (ArgKind::Pointer);
+  }
+
+  return expected == actual;
+}
+
+auto
+arg_kinds_match (std::string_view expected,
+                 std::string_view actual) -> bool
+{
+  if (expected.size () != actual.size ())
+  {
+    return false;
+  }
+  for (auto idx {std::size_t {0u}}; idx < expected.size (); ++idx)
+  {
+    if (!arg_kind_matches (expected[idx], actual[idx]))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,88 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< check: GGP_LIB_ARG_KIND_HH_CHECK >*/
+/*< lib: type.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+
+#ifndef GGP_LIB_ARG_KIND_HH
+#define GGP_LIB_ARG_KIND_HH
+
+#define GGP_LIB_ARG_KIND_HH_CHECK_VALUE GGP_LIB_ARG_KIND_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// How a parameter is passed through varargs, after the default
+// argument promotions. The values are the characters used in the
+// kind strings.
+enum class ArgKind : char
+{
+  Int = 'i',
+  Int64 = 'x',
+  Double = 'd',
+  Pointer = 'p',
+  // A literal zero of the size of a pointer, like NULL defined as an
+  // integer. Never expected by a format, but matches both Int64 and
+  // Pointer.
+  Zero = '0',
+};
+
+enum class FormatUse
+{
+  // g_variant_new and the like.
+  New,
+  // g_variant_get and the like.
+  Get,
+};
+
+// Empty for types that can't be passed through varargs.
+auto
+arg_kind_for_type (Type const& type) -> std::optional<ArgKind>;
+
+// Returns a string with a kind for each parameter the format takes,
+// so the parameters of a call can be checked with a single
+// comparison. Empty if some parameter can't be passed through
+// varargs.
+auto
+arg_kinds_for_format (VariantFormat const& format,
+                      FormatUse use) -> std::optional<std::string>;
+
+// Whether a parameter of the actual kind can be passed where the
+// expected kind is. Both are characters of kind strings.
+auto
+arg_kind_matches (char expected,
+                  char actual) -> bool;
+
+// Whether the kind strings match character by character.
+auto
+arg_kinds_match (std::string_view expected,
+                 std::string_view actual) -> bool;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_ARG_KIND_HH_CHECK_VALUE != GGP_LIB_ARG_KIND_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_ARG_KIND_HH */
@@ -0,0 +1,148 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: boxing.hh >*/
+/*< lib: layout.hh >*/
+/*< stl: utility >*/
+/*< stl: vector >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+constexpr std::size_t variant_alignment {8u};
+
+auto
+unboxed_format (VariantType const& type) -> VariantFormat
+{
+  auto vh {VisitHelper {
+    [](Leaf::Basic const& basic) { return VariantFormat {{basic}}; },
+    [](Leaf::StringType const& string_type) { return VariantFormat {{string_type}}; },
+    [&type](auto const&) { return VariantFormat {{VF::AtVariantType {type}}}; },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+// Walks the format in the same order as args_for_format, counting
+// the arguments on the way.
+struct Unboxer
+{
+  auto
+  unbox (VariantFormat const& format) -> VariantFormat;
+
+  std::size_t arg_index;
+  VariantFormat const& replacement;
+  std::size_t seen_args;
+  bool replaced;
+};
+
+auto
+Unboxer::unbox (VariantFormat const& format) -> VariantFormat
+{
+  auto vh {VisitHelper {
+    [this](VF::Tuple const& tuple)
+    {
+      std::vector<VariantFormat> formats;
+
+      for (auto const& member : tuple.formats)
+      {
+        formats.push_back (this->unbox (member));
+      }
+
+      return VariantFormat {{VF::Tuple {std::move (formats)}}};
+    },
+    [this](VF::Entry const& entry)
+    {
+      // The key always takes a single argument.
+      ++this->seen_args;
+
+      auto value {this->unbox (entry.value)};
+
+      return VariantFormat {{VF::Entry {entry.key, std::move (value)}}};
+    },
+    [this, &format](auto const&)
+    {
+      auto const first_arg {this->seen_args};
+
+      this->seen_args += args_for_format (format).size ();
+      if (first_arg == this->arg_index && takes_variant (format))
+      {
+        this->replaced = true;
+        return this->replacement;
+      }
+
+      return format;
+    },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+} // anonymous namespace
+
+auto
+total_overhead (BoxingOverhead const& overhead) -> std::size_t
+{
+  return overhead.framing + overhead.max_padding;
+}
+
+auto
+boxing_overhead (VariantType const& type) -> std::optional<BoxingOverhead>
+{
+  auto const maybe_layout {layout_of (type)};
+
+  if (!maybe_layout)
+  {
+    return {};
+  }
+
+  return {{variant_size (type, 0u).framing, variant_alignment - maybe_layout->alignment}};
+}
+
+auto
+takes_variant (VariantFormat const& format) -> bool
+{
+  auto vh {VisitHelper {
+    [](Leaf::Variant const&) { return true; },
+    [](VF::AtVariantType const& at) { return std::holds_alternative<Leaf::Variant> (at.type.v); },
+    [](auto const&) { return false; },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+auto
+unbox_format_arg (VariantFormat const& format,
+                  std::size_t arg_index,
+                  VariantType const& type) -> std::optional<VariantFormat>
+{
+  auto const replacement {unboxed_format (type)};
+  Unboxer unboxer {arg_index, replacement, 0u, false};
+  auto unboxed {unboxer.unbox (format)};
+
+  if (!unboxer.replaced)
+  {
+    return {};
+  }
+
+  return {std::move (unboxed)};
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,72 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_BOXING_HH_CHECK >*/
+/*< lib: util.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: cstddef >*/
+/*< stl: optional >*/
+
+#ifndef GGP_LIB_BOXING_HH
+#define GGP_LIB_BOXING_HH
+
+#define GGP_LIB_BOXING_HH_CHECK_VALUE GGP_LIB_BOXING_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// What a value pays in the serialized form for being boxed in a
+// variant.
+GGP_LIB_STRUCT (BoxingOverhead,
+                // The zero byte and the type string.
+                std::size_t, framing,
+                // Variants are aligned to 8 bytes, so a variant may
+                // need up to this many more bytes of padding than
+                // the value alone.
+                std::size_t, max_padding);
+
+auto
+total_overhead (BoxingOverhead const& overhead) -> std::size_t;
+
+// Empty for indefinite types.
+auto
+boxing_overhead (VariantType const& type) -> std::optional<BoxingOverhead>;
+
+// Whether the format takes a GVariant holding a variant, with "v" or
+// "@v".
+auto
+takes_variant (VariantFormat const& format) -> bool;
+
+// Returns the format with the variant taken for the argument at the
+// index (as counted by args_for_format) replaced by a value of the
+// definite type - values of basic types and strings are taken
+// directly, values of other types as GVariants with "@". Empty if
+// the argument is not taken for a variant.
+auto
+unbox_format_arg (VariantFormat const& format,
+                  std::size_t arg_index,
+                  VariantType const& type) -> std::optional<VariantFormat>;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_BOXING_HH_CHECK_VALUE != GGP_LIB_BOXING_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_BOXING_HH */
@@ -0,0 +1,373 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: check-store.hh >*/
+/*< stl: charconv >*/
+/*< stl: cstddef >*/
+/*< stl: sstream >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto const check_magic {std::string_view {"ggp-check "}};
+
+constexpr std::uint64_t fnv_prime {1099511628211ull};
+
+auto
+parse_number (std::string_view str,
+              int base) -> std::optional<std::uint64_t>
+{
+  std::uint64_t number {};
+  auto const end {str.data () + str.size ()};
+  auto const [ptr, ec] {std::from_chars (str.data (), end, number, base)};
+
+  if (str.empty () || ec != std::errc {} || ptr != end)
+  {
+    return {};
+  }
+
+  return {number};
+}
+
+auto
+parse_u32 (std::string_view str) -> std::optional<std::uint32_t>
+{
+  auto const number {parse_number (str, 10)};
+
+  if (!number || *number > UINT32_MAX)
+  {
+    return {};
+  }
+
+  return {static_cast<std::uint32_t> (*number)};
+}
+
+// Takes the next line without the newline, all lines need to end
+// with one.
+auto
+next_line (std::string_view& contents) -> std::optional<std::string_view>
+{
+  auto const newline {contents.find ('\n')};
+
+  if (newline == std::string_view::npos)
+  {
+    return {};
+  }
+
+  auto const line {contents.substr (0, newline)};
+
+  contents.remove_prefix (newline + 1);
+
+  return {line};
+}
+
+// Splits the line into exactly count fields, still escaped.
+auto
+split_fields (std::string_view line,
+              std::size_t count) -> std::optional<std::vector<std::string_view>>
+{
+  std::vector<std::string_view> fields;
+
+  for (;;)
+  {
+    auto const tab {line.find ('\t')};
+
+    fields.push_back (line.substr (0, tab));
+    if (tab == std::string_view::npos)
+    {
+      break;
+    }
+    line.remove_prefix (tab + 1);
+  }
+  if (fields.size () != count)
+  {
+    return {};
+  }
+
+  return {std::move (fields)};
+}
+
+auto
+escape (std::string_view text) -> std::string
+{
+  std::string escaped;
+
+  escaped.reserve (text.size ());
+  for (auto c : text)
+  {
+    switch (c)
+    {
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    default:
+      escaped += c;
+      break;
+    }
+  }
+
+  return escaped;
+}
+
+auto
+unescape (std::string_view text) -> std::optional<std::string>
+{
+  std::string unescaped;
+
+  unescaped.reserve (text.size ());
+  for (auto idx {0u}; idx < text.size (); ++idx)
+  {
+    if (text[idx] != '\\')
+    {
+      unescaped += text[idx];
+      continue;
+    }
+    if (++idx == text.size ())
+    {
+      return {};
+    }
+    switch (text[idx])
+    {
+    case '\\':
+      unescaped += '\\';
+      break;
+    case 't':
+      unescaped += '\t';
+      break;
+    case 'n':
+      unescaped += '\n';
+      break;
+    default:
+      return {};
+    }
+  }
+
+  return {std::move (unescaped)};
+}
+
+auto
+parse_key (std::string_view line) -> std::optional<CheckKey>
+{
+  auto const fields {split_fields (line, 4u)};
+
+  if (!fields)
+  {
+    return {};
+  }
+
+  auto file {unescape ((*fields)[0])};
+  auto const key_line {parse_u32 ((*fields)[1])};
+  auto const column {parse_u32 ((*fields)[2])};
+  auto const calls_hash {parse_number ((*fields)[3], 16)};
+
+  if (!file || !key_line || !column || !calls_hash)
+  {
+    return {};
+  }
+
+  return {{std::move (*file), *key_line, *column, *calls_hash}};
+}
+
+auto
+parse_diagnostic (std::string_view line) -> std::optional<Diagnostic>
+{
+  auto const fields {split_fields (line, 9u)};
+
+  if (!fields)
+  {
+    return {};
+  }
+
+  auto rule {unescape ((*fields)[0])};
+  auto message {unescape ((*fields)[1])};
+  auto file {unescape ((*fields)[2])};
+  auto const diagnostic_line {parse_u32 ((*fields)[3])};
+  auto const column {parse_u32 ((*fields)[4])};
+  auto expected_type {unescape ((*fields)[6])};
+  auto actual_type {unescape ((*fields)[7])};
+  auto format {unescape ((*fields)[8])};
+
+  if (!rule || !message || !file || !diagnostic_line || !column ||
+      !expected_type || !actual_type || !format)
+  {
+    return {};
+  }
+
+  std::optional<std::uint32_t> arg_index {};
+
+  if ((*fields)[5] != "-")
+  {
+    arg_index = parse_u32 ((*fields)[5]);
+    if (!arg_index)
+    {
+      return {};
+    }
+  }
+
+  return {{std::move (*rule),
+           std::move (*message),
+           std::move (*file),
+           *diagnostic_line,
+           *column,
+           std::move (*format),
+           arg_index,
+           std::move (*expected_type),
+           std::move (*actual_type)}};
+}
+
+} // anonymous namespace
+
+auto
+hash_text (std::uint64_t hash,
+           std::string_view text) -> std::uint64_t
+{
+  for (auto c : text)
+  {
+    hash ^= static_cast<unsigned char> (c);
+    hash *= fnv_prime;
+  }
+  // The terminating NUL.
+  hash *= fnv_prime;
+
+  return hash;
+}
+
+auto
+check_key_digest (CheckKey const& key) -> std::uint64_t
+{
+  auto hash {hash_text (hash_seed, key.file)};
+
+  hash = hash_text (hash, std::to_string (key.line));
+  hash = hash_text (hash, std::to_string (key.column));
+  hash = hash_text (hash, std::to_string (key.calls_hash));
+
+  return hash;
+}
+
+auto
+check_file_name (CheckKey const& key) -> std::string
+{
+  constexpr char const* digits {"0123456789abcdef"};
+  auto const digest {check_key_digest (key)};
+  std::string name;
+
+  for (auto shift {60}; shift >= 0; shift -= 4)
+  {
+    name += digits[(digest >> shift) & 0xfu];
+  }
+  name += ".ggp-check";
+
+  return name;
+}
+
+auto
+check_record_to_string (CheckRecord const& record) -> std::string
+{
+  std::ostringstream oss;
+  auto const& key {record.key};
+
+  oss << check_magic << check_store_version << '\n';
+  oss << escape (key.file) << '\t'
+      << key.line << '\t'
+      << key.column << '\t'
+      << std::hex << key.calls_hash << std::dec << '\n';
+  for (auto const& diagnostic : record.diagnostics)
+  {
+    oss << escape (diagnostic.rule) << '\t'
+        << escape (diagnostic.message) << '\t'
+        << escape (diagnostic.file) << '\t'
+        << diagnostic.line << '\t'
+        << diagnostic.column << '\t';
+    if (diagnostic.arg_index)
+    {
+      oss << *diagnostic.arg_index;
+    }
+    else
+    {
+      oss << '-';
+    }
+    oss << '\t'
+        << escape (diagnostic.expected_type) << '\t'
+        << escape (diagnostic.actual_type) << '\t'
+        << escape (diagnostic.format) << '\n';
+  }
+
+  return oss.str ();
+}
+
+auto
+parse_check_record (std::string_view contents) -> std::optional<CheckRecord>
+{
+  auto const header {next_line (contents)};
+
+  if (!header || header->substr (0, check_magic.size ()) != check_magic)
+  {
+    return {};
+  }
+  if (auto const version {parse_number (header->substr (check_magic.size ()), 10)};
+      !version || *version != check_store_version)
+  {
+    return {};
+  }
+
+  auto const key_line {next_line (contents)};
+
+  if (!key_line)
+  {
+    return {};
+  }
+
+  auto key {parse_key (*key_line)};
+
+  if (!key)
+  {
+    return {};
+  }
+
+  CheckRecord record {std::move (*key), {}};
+
+  while (!contents.empty ())
+  {
+    auto const line {next_line (contents)};
+
+    if (!line)
+    {
+      return {};
+    }
+
+    auto diagnostic {parse_diagnostic (*line)};
+
+    if (!diagnostic)
+    {
+      return {};
+    }
+    record.diagnostics.push_back (std::move (*diagnostic));
+  }
+
+  return {std::move (record)};
+}
+
+} // namespace Ggp::Lib
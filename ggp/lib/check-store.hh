@@ -0,0 +1,100 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_CHECK_STORE_HH_CHECK >*/
+/*< lib: sarif.hh >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_CHECK_STORE_HH
+#define GGP_LIB_CHECK_STORE_HH
+
+#define GGP_LIB_CHECK_STORE_HH_CHECK_VALUE GGP_LIB_CHECK_STORE_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// Needs to be bumped on every incompatible change of the record
+// format or of what goes into the calls hash.
+inline constexpr unsigned check_store_version {2u};
+
+inline constexpr std::uint64_t hash_seed {14695981039346656037ull};
+
+// Mixes the text into the hash with FNV-1a. A NUL is mixed in after
+// the text, so consecutive texts do not run into each other.
+auto
+hash_text (std::uint64_t hash,
+           std::string_view text) -> std::uint64_t;
+
+// Identifies the checks of a function body. The same function
+// checked twice with the same calls gives the same diagnostics, be
+// it a header function in another translation unit or a C++
+// template instantiated with types not affecting the calls.
+GGP_LIB_STRUCT (CheckKey,
+                // Where the function is defined.
+                std::string, file,
+                std::uint32_t, line,
+                std::uint32_t, column,
+                // Hash of the checked calls in the function body,
+                // with their formats and argument types, and of the
+                // compiler, its target and the options that affect
+                // the checks.
+                std::uint64_t, calls_hash);
+
+auto
+check_key_digest (CheckKey const& key) -> std::uint64_t;
+
+// Name of the file in the store directory holding the results of the
+// checks with the key - the digest in hex with the .ggp-check suffix.
+auto
+check_file_name (CheckKey const& key) -> std::string;
+
+GGP_LIB_STRUCT (CheckRecord,
+                CheckKey, key,
+                std::vector<Diagnostic>, diagnostics);
+
+// The record is a text file:
+//
+//   ggp-check <version>
+//   <file>\t<line>\t<column>\t<calls hash>
+//   <rule>\t<message>\t<file>\t<line>\t<column>\t<argument index>\t<expected type>\t<actual type>\t<format>
+//   …
+//
+// The calls hash is hexadecimal, the other numbers are decimal. The
+// argument index is "-" if unset. Backslashes, tabs and newlines in
+// the texts are escaped with a backslash, as "\\", "\t" and "\n".
+auto
+check_record_to_string (CheckRecord const& record) -> std::string;
+
+// Empty if the record is malformed or was written by a different
+// version.
+auto
+parse_check_record (std::string_view contents) -> std::optional<CheckRecord>;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_CHECK_STORE_HH_CHECK_VALUE != GGP_LIB_CHECK_STORE_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_CHECK_STORE_HH */
@@ -0,0 +1,397 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: cost.hh >*/
+/*< lib: layout.hh >*/
+/*< lib: member-order.hh >*/
+/*< stl: algorithm >*/
+/*< stl: limits >*/
+/*< stl: sstream >*/
+/*< stl: string_view >*/
+/*< stl: utility >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+constexpr std::string_view cost_report_magic {"ggp-cost-report "};
+
+// Rough costs of an allocation and a string copy relative to a
+// serialized byte.
+constexpr std::uint64_t allocation_weight {64u};
+constexpr std::uint64_t string_copy_weight {16u};
+
+auto
+saturating_multiply (std::uint64_t lhs,
+                     std::uint64_t rhs) -> std::uint64_t
+{
+  if (rhs != 0u && lhs > std::numeric_limits<std::uint64_t>::max () / rhs)
+  {
+    return std::numeric_limits<std::uint64_t>::max ();
+  }
+
+  return lhs * rhs;
+}
+
+auto
+add_cost (Cost& to,
+          Cost const& from) -> void
+{
+  to.allocations += from.allocations;
+  to.string_copies += from.string_copies;
+  to.serialized_bytes += from.serialized_bytes;
+}
+
+struct CostEstimator
+{
+  auto
+  estimate (VariantFormat const& format) -> void;
+
+  // Only for FormatUse::Get - GLib allocates an instance for every
+  // child it reads from a serialized container.
+  auto
+  estimate_child (VariantFormat const& format) -> void;
+
+  auto
+  estimate_key (VF::EntryKeyFormat const& key) -> void;
+
+  auto
+  estimate_maybe (VF::Maybe const& maybe) -> void;
+
+  auto
+  estimate_convenience (VF::Convenience const& convenience) -> void;
+
+  auto
+  building () const -> bool;
+
+  FormatUse use;
+  Cost fixed;
+  Cost per_element;
+};
+
+auto
+CostEstimator::estimate (VariantFormat const& format) -> void
+{
+  auto vh {VisitHelper {
+    [this](Leaf::Basic const&)
+    {
+      if (this->building ())
+      {
+        ++this->fixed.allocations;
+      }
+    },
+    [this](Leaf::StringType const&)
+    {
+      if (this->building ())
+      {
+        ++this->fixed.allocations;
+      }
+      // g_variant_new_string or g_variant_dup_string.
+      ++this->fixed.string_copies;
+    },
+    [this](VF::Pointer const&)
+    {
+      // g_variant_new ignores the "&".
+      if (this->building ())
+      {
+        ++this->fixed.allocations;
+        ++this->fixed.string_copies;
+      }
+    },
+    [this](Leaf::Variant const&)
+    {
+      // Either the variant boxing the passed child or the child
+      // read from the variant.
+      ++this->fixed.allocations;
+    },
+    [this](VT::Array const&)
+    {
+      // The array ending the builder or the iterator.
+      ++this->fixed.allocations;
+    },
+    // The instance is passed or handed out with a new reference.
+    [](VF::AtVariantType const&) {},
+    [this](VF::Convenience const& convenience) { this->estimate_convenience (convenience); },
+    [this](VF::Maybe const& maybe) { this->estimate_maybe (maybe); },
+    [this](VF::Tuple const& tuple)
+    {
+      if (this->building ())
+      {
+        ++this->fixed.allocations;
+      }
+      for (auto const& member : tuple.formats)
+      {
+        this->estimate_child (member);
+      }
+    },
+    [this](VF::Entry const& entry)
+    {
+      // The entry being built or the key being read.
+      ++this->fixed.allocations;
+      this->estimate_key (entry.key);
+      this->estimate_child (entry.value);
+    },
+  }};
+
+  std::visit (vh, format.v);
+}
+
+auto
+CostEstimator::estimate_child (VariantFormat const& format) -> void
+{
+  if (!this->building ())
+  {
+    ++this->fixed.allocations;
+  }
+  this->estimate (format);
+}
+
+auto
+CostEstimator::estimate_key (VF::EntryKeyFormat const& key) -> void
+{
+  auto vh {VisitHelper {
+    [this](Leaf::Basic const& basic) { this->estimate ({{basic}}); },
+    [this](Leaf::StringType const& string_type) { this->estimate ({{string_type}}); },
+    [this](VF::Pointer const& pointer) { this->estimate ({{pointer}}); },
+    [](VF::AtEntryKeyType const&) {},
+  }};
+
+  std::visit (vh, key.v);
+}
+
+auto
+CostEstimator::estimate_maybe (VF::Maybe const& maybe) -> void
+{
+  auto pointer_vh {VisitHelper {
+    [](VT::Array const& array) { return VariantFormat {{array}}; },
+    [](Leaf::StringType const& string_type) { return VariantFormat {{string_type}}; },
+    [](Leaf::Variant const& variant) { return VariantFormat {{variant}}; },
+    [](VF::AtVariantType const& at_variant_type) { return VariantFormat {{at_variant_type}}; },
+    [](VF::Pointer const& pointer) { return VariantFormat {{pointer}}; },
+    [](VF::Convenience const& convenience) { return VariantFormat {{convenience}}; },
+  }};
+  auto bool_vh {VisitHelper {
+    [](Leaf::Basic const& basic) { return VariantFormat {{basic}}; },
+    [](VF::Entry const& entry) { return VariantFormat {{entry}}; },
+    [](VF::Tuple const& tuple) { return VariantFormat {{tuple}}; },
+    [](VF::Maybe const& maybe) { return VariantFormat {{maybe}}; },
+  }};
+  auto vh {VisitHelper {
+    [&pointer_vh](VF::MaybePointer const& mp) { return std::visit (pointer_vh, mp.v); },
+    [&bool_vh](VF::MaybeBool const& mb) { return std::visit (bool_vh, mb.v); },
+  }};
+
+  // g_variant_new_maybe or g_variant_get_maybe.
+  ++this->fixed.allocations;
+  this->estimate (std::visit (vh, maybe.v));
+}
+
+auto
+CostEstimator::estimate_convenience (VF::Convenience const& convenience) -> void
+{
+  auto const duplicated {std::holds_alternative<VF::Convenience::Kind::Duplicated> (convenience.kind.v)};
+  auto const copies {this->building () || duplicated};
+  auto vh {VisitHelper {
+    [this, copies](VF::Convenience::Type::ByteString const&)
+    {
+      // g_variant_new_bytestring, g_variant_get_bytestring or
+      // g_variant_dup_bytestring.
+      if (this->building ())
+      {
+        ++this->fixed.allocations;
+      }
+      if (copies)
+      {
+        ++this->fixed.string_copies;
+      }
+    },
+    // The string vectors and the arrays of byte strings are built
+    // from or read into an instance per element.
+    [this, copies](auto const&)
+    {
+      ++this->fixed.allocations;
+      ++this->per_element.allocations;
+      if (copies)
+      {
+        ++this->per_element.string_copies;
+      }
+    },
+  }};
+
+  std::visit (vh, convenience.type.v);
+}
+
+auto
+CostEstimator::building () const -> bool
+{
+  return this->use == FormatUse::New;
+}
+
+// Serialized bytes each element adds to the arrays in the type,
+// leaving out the arrays nested in the elements.
+auto
+array_element_bytes (VariantType const& type) -> std::size_t
+{
+  auto vh {VisitHelper {
+    [](VT::Array const& array) -> std::size_t
+    {
+      VariantType const& element_type = array.element_type;
+      auto const maybe_layout {layout_of (element_type)};
+      auto const maybe_size {minimal_size (element_type)};
+
+      if (!maybe_layout || !maybe_size)
+      {
+        return 0u;
+      }
+      if (maybe_layout->fixed_size)
+      {
+        return *maybe_size;
+      }
+
+      auto const alignment {maybe_layout->alignment};
+      // Variable size elements are aligned and need a framing
+      // offset each.
+      return (*maybe_size + alignment - 1u) / alignment * alignment + 1u;
+    },
+    [](VT::Maybe const& maybe) { return array_element_bytes (maybe.pointed_type); },
+    [](VT::Tuple const& tuple)
+    {
+      std::size_t bytes {0u};
+
+      for (auto const& member_type : tuple.types)
+      {
+        bytes += array_element_bytes (member_type);
+      }
+
+      return bytes;
+    },
+    [](VT::Entry const& entry) { return array_element_bytes (entry.value); },
+    [](auto const&) -> std::size_t { return 0u; },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+} // anonymous namespace
+
+auto
+format_cost (VariantFormat const& format,
+             FormatUse use) -> FormatCost
+{
+  CostEstimator estimator {use, {0u, 0u, 0u}, {0u, 0u, 0u}};
+
+  estimator.estimate (format);
+
+  auto const type {format.to_type ()};
+  auto const maybe_layout {layout_of (type)};
+
+  estimator.fixed.serialized_bytes = minimal_size (type).value_or (0u);
+  estimator.per_element.serialized_bytes = array_element_bytes (type);
+
+  return {estimator.fixed, estimator.per_element, maybe_layout && maybe_layout->fixed_size};
+}
+
+auto
+evaluate_cost (FormatCost const& cost,
+               std::size_t elements) -> Cost
+{
+  auto total {cost.fixed};
+
+  add_cost (total,
+            {cost.per_element.allocations * elements,
+             cost.per_element.string_copies * elements,
+             cost.per_element.serialized_bytes * elements});
+
+  return total;
+}
+
+auto
+cost_score (Cost const& cost) -> std::uint64_t
+{
+  return cost.allocations * allocation_weight +
+    cost.string_copies * string_copy_weight +
+    cost.serialized_bytes;
+}
+
+auto
+site_score (CostSite const& site) -> std::uint64_t
+{
+  auto score {cost_score (evaluate_cost (site.cost, assumed_elements))};
+
+  if (site.execution_count)
+  {
+    return saturating_multiply (score, *site.execution_count);
+  }
+  for (std::size_t depth {0u}; depth < site.loop_depth; ++depth)
+  {
+    score = saturating_multiply (score, assumed_iterations);
+  }
+
+  return score;
+}
+
+auto
+cost_report_to_string (std::vector<CostSite> const& sites) -> std::string
+{
+  std::vector<std::pair<std::uint64_t, CostSite const*>> scored;
+
+  for (auto const& site : sites)
+  {
+    scored.push_back ({site_score (site), &site});
+  }
+  std::stable_sort (scored.begin (),
+                    scored.end (),
+                    [](auto const& lhs, auto const& rhs)
+                    {
+                      return lhs.first > rhs.first;
+                    });
+
+  std::ostringstream oss;
+
+  oss << cost_report_magic << assumed_elements << ' ' << assumed_iterations << '\n';
+  for (auto const& [score, site] : scored)
+  {
+    auto const& fixed {site->cost.fixed};
+    auto const& per_element {site->cost.per_element};
+
+    oss << score << '\t'
+        << site->location << '\t'
+        << site->function << '\t'
+        << site->call << '\t'
+        << site->loop_depth << '\t';
+    if (site->execution_count)
+    {
+      oss << *site->execution_count;
+    }
+    else
+    {
+      oss << '-';
+    }
+    oss << '\t'
+        << fixed.allocations << '+' << per_element.allocations << '\t'
+        << fixed.string_copies << '+' << per_element.string_copies << '\t'
+        << fixed.serialized_bytes << '+' << per_element.serialized_bytes << '\t'
+        << (site->cost.fixed_size ? "fixed" : "variable") << '\t'
+        << site->format << '\n';
+  }
+
+  return oss.str ();
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,126 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_COST_HH_CHECK >*/
+/*< lib: arg-kind.hh >*/
+/*< lib: util.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: cstddef >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_COST_HH
+#define GGP_LIB_COST_HH
+
+#define GGP_LIB_COST_HH_CHECK_VALUE GGP_LIB_COST_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// Work done by GLib in a single call taking a format.
+GGP_LIB_STRUCT (Cost,
+                // GVariant instances, iterators and string vectors.
+                std::size_t, allocations,
+                // Strings and byte strings copied into their own
+                // memory.
+                std::size_t, string_copies,
+                // Size of the serialized value, with strings and
+                // nested arrays counted as empty.
+                std::size_t, serialized_bytes);
+
+// The cost of a call as a function of the array lengths - the fixed
+// part plus the per element part for each element of the arrays in
+// the format.
+GGP_LIB_STRUCT (FormatCost,
+                Cost, fixed,
+                Cost, per_element,
+                // Whether the value has a fixed size. GLib serializes
+                // those without framing offsets, reads their members
+                // at offsets computed once per type and hands out
+                // arrays of them with g_variant_get_fixed_array.
+                bool, fixed_size);
+
+// Estimates the cost of building (FormatUse::New) or reading
+// (FormatUse::Get) a value with the format. Values read are assumed
+// to be serialized, like the ones coming from D-Bus or files, so
+// GLib allocates an instance for every child it reads. Maybes are
+// assumed to hold a value. Arrays passed as builders or iterators
+// are counted as single allocations, their elements are paid for by
+// the calls adding or reading them.
+auto
+format_cost (VariantFormat const& format,
+             FormatUse use) -> FormatCost;
+
+// The cost for the given number of elements in each array.
+auto
+evaluate_cost (FormatCost const& cost,
+               std::size_t elements) -> Cost;
+
+// A single figure to sort costs by. Allocations weigh the most,
+// then string copies, then serialized bytes.
+auto
+cost_score (Cost const& cost) -> std::uint64_t;
+
+// A call site in the per translation unit cost report.
+GGP_LIB_STRUCT (CostSite,
+                // file:line:column of the call.
+                std::string, location,
+                // The function doing the call.
+                std::string, function,
+                // The called function, like g_variant_new.
+                std::string, call,
+                std::string, format,
+                std::size_t, loop_depth,
+                // From profile feedback, empty without it.
+                std::optional<std::uint64_t>, execution_count,
+                FormatCost, cost);
+
+// Each array is assumed to have this many elements when scoring call
+// sites, and each loop to run this many iterations if the execution
+// count is unknown.
+inline constexpr std::size_t assumed_elements {8u};
+inline constexpr std::size_t assumed_iterations {10u};
+
+// The score of the call evaluated for assumed_elements, multiplied
+// by the execution count or by assumed_iterations for every loop
+// around it.
+auto
+site_score (CostSite const& site) -> std::uint64_t;
+
+// The report is a text file:
+//
+//   ggp-cost-report <elements> <iterations>
+//   <score>\t<location>\t<function>\t<call>\t<loop depth>\t<count>\t<allocations>+<per element>\t<string copies>+<per element>\t<bytes>+<per element>\t<fixed|variable>\t<format>
+//   …
+//
+// The count is "-" if unknown. The sites are sorted by their score,
+// the most expensive first.
+// Sites with the same score keep their order.
+auto
+cost_report_to_string (std::vector<CostSite> const& sites) -> std::string;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_COST_HH_CHECK_VALUE != GGP_LIB_COST_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_COST_HH */
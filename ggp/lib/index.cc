@@ -0,0 +1,276 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: index.hh >*/
+/*< stl: algorithm >*/
+/*< stl: cstddef >*/
+/*< stl: limits >*/
+/*< stl: unordered_map >*/
+/*< stl: utility >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+constexpr std::string_view index_magic {"GGPIDX\0\0", 8u};
+constexpr std::size_t header_size {32u};
+constexpr std::size_t site_size {64u};
+constexpr std::size_t site_fields_count {site_size / 4u};
+
+constexpr std::uint32_t fixed_size_flag {1u};
+constexpr std::uint32_t get_flag {2u};
+
+auto
+saturate (std::size_t value) -> std::uint32_t
+{
+  return static_cast<std::uint32_t> (std::min<std::size_t> (value, std::numeric_limits<std::uint32_t>::max ()));
+}
+
+auto
+append_u32 (std::string& bytes,
+            std::uint32_t value) -> void
+{
+  for (auto shift {0u}; shift < 32u; shift += 8u)
+  {
+    bytes += static_cast<char> ((value >> shift) & 0xffu);
+  }
+}
+
+auto
+append_u64 (std::string& bytes,
+            std::uint64_t value) -> void
+{
+  append_u32 (bytes, static_cast<std::uint32_t> (value & 0xffffffffu));
+  append_u32 (bytes, static_cast<std::uint32_t> (value >> 32u));
+}
+
+// The offset needs to be in bounds.
+auto
+read_u32 (std::string_view data,
+          std::size_t offset) -> std::uint32_t
+{
+  std::uint32_t value {0u};
+
+  for (auto idx {0u}; idx < 4u; ++idx)
+  {
+    value |= static_cast<std::uint32_t> (static_cast<unsigned char> (data[offset + idx])) << (idx * 8u);
+  }
+
+  return value;
+}
+
+auto
+read_u64 (std::string_view data,
+          std::size_t offset) -> std::uint64_t
+{
+  return read_u32 (data, offset) | (std::uint64_t {read_u32 (data, offset + 4u)} << 32u);
+}
+
+// Gives each distinct string an index, in the order of first use.
+struct StringInterner
+{
+  auto
+  intern (std::string const& string) -> std::uint32_t;
+
+  std::unordered_map<std::string, std::uint32_t> indices;
+  std::vector<std::string const*> strings;
+};
+
+auto
+StringInterner::intern (std::string const& string) -> std::uint32_t
+{
+  auto const [iter, inserted] {this->indices.insert ({string, saturate (this->strings.size ())})};
+
+  if (inserted)
+  {
+    this->strings.push_back (&iter->first);
+  }
+
+  return iter->second;
+}
+
+} // anonymous namespace
+
+auto
+index_to_bytes (std::vector<IndexSite> const& sites) -> std::string
+{
+  StringInterner interner;
+  std::string site_bytes;
+
+  for (auto const& site : sites)
+  {
+    auto const& cost {site.cost};
+    std::uint32_t flags {0u};
+
+    if (cost.fixed_size)
+    {
+      flags |= fixed_size_flag;
+    }
+    if (site.use == FormatUse::Get)
+    {
+      flags |= get_flag;
+    }
+
+    std::uint32_t const fields[site_fields_count] {
+      interner.intern (site.file),
+      site.line,
+      site.column,
+      interner.intern (site.function),
+      interner.intern (site.callee),
+      interner.intern (site.format),
+      interner.intern (site.arg_types),
+      site.loop_depth,
+      saturate (cost.fixed.allocations),
+      saturate (cost.fixed.string_copies),
+      saturate (cost.fixed.serialized_bytes),
+      saturate (cost.per_element.allocations),
+      saturate (cost.per_element.string_copies),
+      saturate (cost.per_element.serialized_bytes),
+      flags,
+      0u,
+    };
+
+    for (auto field : fields)
+    {
+      append_u32 (site_bytes, field);
+    }
+  }
+
+  std::string offset_bytes;
+  std::string string_data;
+
+  for (auto string : interner.strings)
+  {
+    append_u32 (offset_bytes, saturate (string_data.size ()));
+    string_data += *string;
+    string_data += '\0';
+  }
+
+  std::string bytes {index_magic};
+
+  append_u32 (bytes, index_version);
+  append_u32 (bytes, saturate (sites.size ()));
+  append_u32 (bytes, saturate (interner.strings.size ()));
+  append_u32 (bytes, 0u);
+  append_u64 (bytes, string_data.size ());
+  bytes += site_bytes;
+  bytes += offset_bytes;
+  bytes += string_data;
+
+  return bytes;
+}
+
+auto
+parse_index (std::string_view data) -> std::optional<std::vector<IndexSiteView>>
+{
+  if (data.size () < header_size ||
+      data.substr (0u, index_magic.size ()) != index_magic ||
+      read_u32 (data, 8u) != index_version)
+  {
+    return {};
+  }
+
+  std::size_t const sites_count {read_u32 (data, 12u)};
+  std::size_t const strings_count {read_u32 (data, 16u)};
+  auto const string_data_size {read_u64 (data, 24u)};
+  auto const sites_offset {header_size};
+  auto const offsets_offset {sites_offset + sites_count * site_size};
+  auto const string_data_offset {offsets_offset + strings_count * 4u};
+
+  if (string_data_offset > data.size () ||
+      data.size () - string_data_offset != string_data_size)
+  {
+    return {};
+  }
+
+  auto const string_data {data.substr (string_data_offset)};
+  std::vector<std::string_view> strings;
+
+  for (std::size_t idx {0u}; idx < strings_count; ++idx)
+  {
+    std::size_t const offset {read_u32 (data, offsets_offset + idx * 4u)};
+    auto const end {string_data.find ('\0', offset)};
+
+    if (offset >= string_data.size () || end == std::string_view::npos)
+    {
+      return {};
+    }
+    strings.push_back (string_data.substr (offset, end - offset));
+  }
+
+  std::vector<IndexSiteView> sites;
+
+  for (std::size_t idx {0u}; idx < sites_count; ++idx)
+  {
+    std::uint32_t fields[site_fields_count];
+
+    for (std::size_t field {0u}; field < site_fields_count; ++field)
+    {
+      fields[field] = read_u32 (data, sites_offset + idx * site_size + field * 4u);
+    }
+    for (auto string_field : {0u, 3u, 4u, 5u, 6u})
+    {
+      if (fields[string_field] >= strings.size ())
+      {
+        return {};
+      }
+    }
+
+    auto const flags {fields[14]};
+
+    sites.push_back ({strings[fields[0]],
+                      fields[1],
+                      fields[2],
+                      strings[fields[3]],
+                      strings[fields[4]],
+                      strings[fields[5]],
+                      (flags & get_flag) != 0u ? FormatUse::Get : FormatUse::New,
+                      strings[fields[6]],
+                      fields[7],
+                      {{fields[8], fields[9], fields[10]},
+                       {fields[11], fields[12], fields[13]},
+                       (flags & fixed_size_flag) != 0u}});
+  }
+
+  return {std::move (sites)};
+}
+
+auto
+split_arg_types (std::string_view arg_types) -> std::vector<std::string_view>
+{
+  std::vector<std::string_view> types;
+
+  if (arg_types.empty ())
+  {
+    return types;
+  }
+  for (;;)
+  {
+    auto const separator {arg_types.find (';')};
+
+    types.push_back (arg_types.substr (0u, separator));
+    if (separator == std::string_view::npos)
+    {
+      return types;
+    }
+    arg_types.remove_prefix (separator + 1u);
+  }
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,110 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_INDEX_HH_CHECK >*/
+/*< lib: arg-kind.hh >*/
+/*< lib: cost.hh >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_INDEX_HH
+#define GGP_LIB_INDEX_HH
+
+#define GGP_LIB_INDEX_HH_CHECK_VALUE GGP_LIB_INDEX_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// Call site indices written by the plugin next to each object, for
+// project wide queries with ggp-index. An index is a binary file
+// that can be used straight from mmap, all numbers are little
+// endian:
+//
+//   header, 32 bytes:
+//     "GGPIDX\0\0", u32 version, u32 sites count, u32 strings count,
+//     u32 zero, u64 size of the string data
+//   sites, 64 bytes each:
+//     u32 file, u32 line, u32 column, u32 function, u32 callee,
+//     u32 format, u32 argument types, u32 loop depth,
+//     u32 allocations, u32 string copies, u32 serialized bytes,
+//     u32 allocations, string copies and serialized bytes per
+//     element, u32 flags (1 - fixed size, 2 - get), u32 zero
+//   string offsets, u32 each, relative to the string data
+//   string data, zero terminated strings
+//
+// Strings in sites are indices into the string offsets, so each
+// distinct string (file, format, …) is stored once per index.
+// Numbers too big for u32 are saturated.
+//
+// Needs to be bumped on every incompatible change.
+inline constexpr std::uint32_t index_version {1u};
+
+GGP_LIB_STRUCT (IndexSite,
+                std::string, file,
+                std::uint32_t, line,
+                std::uint32_t, column,
+                // The function doing the call.
+                std::string, function,
+                // The called function, like g_variant_new.
+                std::string, callee,
+                std::string, format,
+                FormatUse, use,
+                // Types of the arguments passed after the format, as
+                // printed by the compiler, separated with ";".
+                std::string, arg_types,
+                std::uint32_t, loop_depth,
+                FormatCost, cost);
+
+// Like IndexSite, but the strings point into the index data.
+GGP_LIB_STRUCT (IndexSiteView,
+                std::string_view, file,
+                std::uint32_t, line,
+                std::uint32_t, column,
+                std::string_view, function,
+                std::string_view, callee,
+                std::string_view, format,
+                FormatUse, use,
+                std::string_view, arg_types,
+                std::uint32_t, loop_depth,
+                FormatCost, cost);
+
+auto
+index_to_bytes (std::vector<IndexSite> const& sites) -> std::string;
+
+// Empty if the data is not an index of the current version or is
+// truncated or otherwise malformed. The views are valid as long as
+// the data is.
+auto
+parse_index (std::string_view data) -> std::optional<std::vector<IndexSiteView>>;
+
+// Splits the argument types of a site.
+auto
+split_arg_types (std::string_view arg_types) -> std::vector<std::string_view>;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_INDEX_HH_CHECK_VALUE != GGP_LIB_INDEX_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_INDEX_HH */
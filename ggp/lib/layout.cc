@@ -0,0 +1,397 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< lib: layout.hh >*/
+/*< lib: variant-print.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: algorithm >*/
+/*< stl: cassert >*/
+/*< stl: cstdint >*/
+/*< stl: sstream >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto
+round_up (std::size_t offset, std::size_t alignment) -> std::size_t
+{
+  return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+auto
+basic_layout (Leaf::Basic const& basic) -> Layout
+{
+  auto vh {VisitHelper {
+    [](Leaf::Bool const&) { return Layout {1u, {1u}}; },
+    [](Leaf::Byte const&) { return Layout {1u, {1u}}; },
+    [](Leaf::I16 const&) { return Layout {2u, {2u}}; },
+    [](Leaf::U16 const&) { return Layout {2u, {2u}}; },
+    [](Leaf::I32 const&) { return Layout {4u, {4u}}; },
+    [](Leaf::U32 const&) { return Layout {4u, {4u}}; },
+    [](Leaf::I64 const&) { return Layout {8u, {8u}}; },
+    [](Leaf::U64 const&) { return Layout {8u, {8u}}; },
+    [](Leaf::Handle const&) { return Layout {4u, {4u}}; },
+    [](Leaf::Double const&) { return Layout {8u, {8u}}; },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+// Strings are aligned to bytes and variants to 8 bytes, but they
+// never have a fixed size.
+auto
+string_type_layout () -> Layout
+{
+  return {1u, {}};
+}
+
+auto
+variant_layout () -> Layout
+{
+  return {8u, {}};
+}
+
+// Arrays and maybes take the alignment of their element type, even
+// if they are empty or nothing.
+auto
+element_container_layout (VariantType const& element_type) -> std::optional<Layout>
+{
+  auto maybe_layout {layout_of (element_type)};
+
+  if (!maybe_layout)
+  {
+    return {};
+  }
+
+  return {{maybe_layout->alignment, {}}};
+}
+
+auto
+entry_key_type_to_type (VT::EntryKeyType const& key) -> VariantType
+{
+  return repackage<VariantType> (key);
+}
+
+// Lays out the members of a tuple or a dict entry one after another,
+// each at an offset aligned to the member's alignment. The offsets
+// are only collected while all the members so far have fixed size.
+auto
+members_layout (std::vector<VariantType> const& types,
+                std::vector<std::size_t>& offsets) -> std::optional<Layout>
+{
+  std::size_t alignment {1u};
+  std::size_t offset {0u};
+  bool fixed {true};
+
+  for (auto const& type : types)
+  {
+    auto maybe_layout {layout_of (type)};
+
+    if (!maybe_layout)
+    {
+      return {};
+    }
+
+    alignment = std::max (alignment, maybe_layout->alignment);
+    if (fixed && maybe_layout->fixed_size)
+    {
+      offset = round_up (offset, maybe_layout->alignment);
+      offsets.push_back (offset);
+      offset += *maybe_layout->fixed_size;
+    }
+    else
+    {
+      fixed = false;
+    }
+  }
+
+  if (!fixed)
+  {
+    return {{alignment, {}}};
+  }
+  // The unit type is serialized as a single zero byte.
+  if (types.empty ())
+  {
+    return {{alignment, {1u}}};
+  }
+
+  return {{alignment, {round_up (offset, alignment)}}};
+}
+
+auto
+member_types (VariantType const& type) -> std::optional<std::vector<VariantType>>
+{
+  auto vh {VisitHelper {
+    [](VT::Tuple const& tuple) -> std::optional<std::vector<VariantType>> { return {tuple.types}; },
+    [](VT::Entry const& entry) -> std::optional<std::vector<VariantType>>
+    {
+      return {{entry_key_type_to_type (entry.key), entry.value}};
+    },
+    [](auto const&) -> std::optional<std::vector<VariantType>> { return {}; },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+auto
+must_get_layout (VariantType const& type) -> Layout
+{
+  auto maybe_layout {layout_of (type)};
+
+  assert (maybe_layout);
+
+  return *maybe_layout;
+}
+
+auto
+members_size (std::vector<VariantType> const& types,
+              std::vector<std::size_t> const& child_sizes) -> std::optional<ContainerSize>
+{
+  if (types.size () != child_sizes.size ())
+  {
+    return {};
+  }
+
+  std::vector<Layout> layouts;
+
+  layouts.reserve (types.size ());
+  for (auto const& type : types)
+  {
+    layouts.push_back (must_get_layout (type));
+  }
+
+  return {members_size (layouts, child_sizes)};
+}
+
+// Elements of fixed size are just put one after another. Otherwise
+// each element is aligned and the end offsets of all the elements
+// follow them.
+auto
+array_size (VariantType const& element_type,
+            std::vector<std::size_t> const& child_sizes) -> ContainerSize
+{
+  auto const layout {must_get_layout (element_type)};
+  ContainerSize size {0u, 0u, 0u};
+  std::size_t offset {0u};
+
+  for (auto child_size : child_sizes)
+  {
+    auto const aligned {round_up (offset, layout.alignment)};
+
+    size.padding += aligned - offset;
+    size.children += child_size;
+    offset = aligned + child_size;
+  }
+  if (!layout.fixed_size)
+  {
+    size.framing = child_sizes.size () * framing_offset_size (offset, child_sizes.size ());
+  }
+
+  return size;
+}
+
+// Nothing is empty. Just is the child, followed by a zero byte if the
+// child has variable size.
+auto
+maybe_size (VariantType const& pointed_type,
+            std::vector<std::size_t> const& child_sizes) -> std::optional<ContainerSize>
+{
+  if (child_sizes.size () > 1u)
+  {
+    return {};
+  }
+  if (child_sizes.empty ())
+  {
+    return {{0u, 0u, 0u}};
+  }
+
+  return {{child_sizes.front (), 0u, must_get_layout (pointed_type).fixed_size ? 0u : 1u}};
+}
+
+} // anonymous namespace
+
+auto
+layout_of (VariantType const& type) -> std::optional<Layout>
+{
+  if (auto maybe_types {member_types (type)}; maybe_types)
+  {
+    std::vector<std::size_t> offsets;
+
+    return members_layout (*maybe_types, offsets);
+  }
+
+  auto vh {VisitHelper {
+    [](Leaf::Basic const& basic) -> std::optional<Layout> { return {basic_layout (basic)}; },
+    [](Leaf::AnyBasic const&) -> std::optional<Layout> { return {}; },
+    [](Leaf::StringType const&) -> std::optional<Layout> { return {string_type_layout ()}; },
+    [](VT::Maybe const& maybe) { return element_container_layout (maybe.pointed_type); },
+    [](VT::Array const& array) { return element_container_layout (array.element_type); },
+    [](Leaf::Variant const&) -> std::optional<Layout> { return {variant_layout ()}; },
+    [](Leaf::AnyTuple const&) -> std::optional<Layout> { return {}; },
+    [](Leaf::AnyType const&) -> std::optional<Layout> { return {}; },
+    // Handled above.
+    [](VT::Tuple const&) -> std::optional<Layout> { return {}; },
+    [](VT::Entry const&) -> std::optional<Layout> { return {}; },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+auto
+fixed_member_offsets (VariantType const& type) -> std::optional<std::vector<std::size_t>>
+{
+  auto maybe_types {member_types (type)};
+
+  if (!maybe_types)
+  {
+    return {};
+  }
+
+  std::vector<std::size_t> offsets;
+  auto maybe_layout {members_layout (*maybe_types, offsets)};
+
+  if (!maybe_layout || !maybe_layout->fixed_size)
+  {
+    return {};
+  }
+
+  return {std::move (offsets)};
+}
+
+// Like gvs_calculate_total_size and gvs_get_offset_size in GLib.
+auto
+framing_offset_size (std::size_t body_size,
+                     std::size_t offsets_count) -> std::size_t
+{
+  if (body_size + offsets_count == 0u)
+  {
+    return 0u;
+  }
+
+  std::size_t const sizes[] {1u, 2u, 4u};
+
+  for (auto size : sizes)
+  {
+    auto const max {(std::uint64_t {1u} << (size * 8u)) - 1u};
+
+    if (body_size + size * offsets_count <= max)
+    {
+      return size;
+    }
+  }
+
+  return 8u;
+}
+
+auto
+total_size (ContainerSize const& size) -> std::size_t
+{
+  return size.children + size.padding + size.framing;
+}
+
+// Like Serializer::write_members - the children are aligned, the end
+// offsets of the children of variable size, except the last one,
+// follow them. A container of fixed size is padded to its alignment
+// instead.
+auto
+members_size (std::vector<Layout> const& layouts,
+              std::vector<std::size_t> const& child_sizes) -> ContainerSize
+{
+  ContainerSize size {0u, 0u, 0u};
+  std::size_t alignment {1u};
+  std::size_t offset {0u};
+  std::size_t offsets_count {0u};
+  bool fixed {true};
+
+  for (auto idx {std::size_t {0u}}; idx < layouts.size (); ++idx)
+  {
+    auto const& layout {layouts[idx]};
+    auto const aligned {round_up (offset, layout.alignment)};
+
+    alignment = std::max (alignment, layout.alignment);
+    size.padding += aligned - offset;
+    size.children += child_sizes[idx];
+    offset = aligned + child_sizes[idx];
+    if (!layout.fixed_size)
+    {
+      fixed = false;
+      if (idx + 1u != layouts.size ())
+      {
+        ++offsets_count;
+      }
+    }
+  }
+
+  if (fixed)
+  {
+    // The unit type is a single zero byte.
+    if (layouts.empty ())
+    {
+      size.framing = 1u;
+      offset = 1u;
+    }
+    size.padding += round_up (offset, alignment) - offset;
+  }
+  else
+  {
+    size.framing = offsets_count * framing_offset_size (offset, offsets_count);
+  }
+
+  return size;
+}
+
+auto
+container_size (VariantType const& type,
+                std::vector<std::size_t> const& child_sizes) -> std::optional<ContainerSize>
+{
+  if (!type.is_definite ())
+  {
+    return {};
+  }
+  if (auto maybe_types {member_types (type)}; maybe_types)
+  {
+    return members_size (*maybe_types, child_sizes);
+  }
+
+  auto vh {VisitHelper {
+    [&child_sizes](VT::Maybe const& maybe) { return maybe_size (maybe.pointed_type, child_sizes); },
+    [&child_sizes](VT::Array const& array) -> std::optional<ContainerSize>
+    {
+      return {array_size (array.element_type, child_sizes)};
+    },
+    [](auto const&) -> std::optional<ContainerSize> { return {}; },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+auto
+variant_size (VariantType const& child_type,
+              std::size_t child_size) -> ContainerSize
+{
+  std::ostringstream oss;
+
+  oss << child_type;
+
+  return {child_size, 0u, 1u + oss.str ().size ()};
+}
+
+} // namespace Ggp::Lib
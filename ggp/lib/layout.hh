@@ -0,0 +1,102 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< check: GGP_LIB_LAYOUT_HH_CHECK >*/
+/*< lib: util.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: cstddef >*/
+/*< stl: optional >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_LAYOUT_HH
+#define GGP_LIB_LAYOUT_HH
+
+#define GGP_LIB_LAYOUT_HH_CHECK_VALUE GGP_LIB_LAYOUT_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// How a value of a definite type is laid out in the serialized form,
+// as described in the GVariant specification.
+GGP_LIB_STRUCT (Layout,
+                std::size_t, alignment,
+                // Empty for types with variable size - strings,
+                // arrays, maybes, variants and containers of those.
+                std::optional<std::size_t>, fixed_size);
+
+// Empty for indefinite types.
+auto
+layout_of (VariantType const& type) -> std::optional<Layout>;
+
+// Offsets of the members of a fixed size tuple or dict entry,
+// relative to the start of the container. Empty for other types.
+auto
+fixed_member_offsets (VariantType const& type) -> std::optional<std::vector<std::size_t>>;
+
+// Size of each framing offset of a container with the given size of
+// its body (children and padding) and offsets count - the smallest
+// of 1, 2, 4 and 8 bytes that can address the whole container. Zero
+// for an empty container.
+auto
+framing_offset_size (std::size_t body_size,
+                     std::size_t offsets_count) -> std::size_t;
+
+// How a serialized container is made up.
+GGP_LIB_STRUCT (ContainerSize,
+                // The serialized children.
+                std::size_t, children,
+                // Zero bytes aligning the children and the end of
+                // fixed size tuples and dict entries.
+                std::size_t, padding,
+                // Framing offsets, the zero byte of the unit type and
+                // of maybes of variable size, the zero byte and the
+                // type string in variants.
+                std::size_t, framing);
+
+auto
+total_size (ContainerSize const& size) -> std::size_t;
+
+// Size of a serialized tuple, dict entry, array or maybe of a
+// definite type, given the sizes of its serialized children -
+// members, elements or the value of a maybe (none for nothing). The
+// overhead over the children depends on their sizes and count only.
+// Empty for other types or if the children don't fit the type.
+auto
+container_size (VariantType const& type,
+                std::vector<std::size_t> const& child_sizes) -> std::optional<ContainerSize>;
+
+// Like container_size for a tuple or dict entry with members of the
+// given layouts, in this order. The sizes need to match the layouts.
+auto
+members_size (std::vector<Layout> const& layouts,
+              std::vector<std::size_t> const& child_sizes) -> ContainerSize;
+
+// Size of a serialized variant holding a child of the given type.
+auto
+variant_size (VariantType const& child_type,
+              std::size_t child_size) -> ContainerSize;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_LAYOUT_HH_CHECK_VALUE != GGP_LIB_LAYOUT_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_LAYOUT_HH */
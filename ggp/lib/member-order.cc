@@ -0,0 +1,297 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< lib: member-order.hh >*/
+/*< stl: algorithm >*/
+/*< stl: numeric >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+// Trying all the orders is cheap for the usual tuples.
+constexpr std::size_t max_permuted_members {8u};
+
+auto
+waste (ContainerSize const& size) -> std::size_t
+{
+  return size.padding + size.framing;
+}
+
+auto
+minimal_string_size (Leaf::StringType const& string_type) -> std::size_t
+{
+  auto vh {VisitHelper {
+    // "/" and a zero byte.
+    [](Leaf::ObjectPath const&) { return std::size_t {2u}; },
+    // Just a zero byte.
+    [](auto const&) { return std::size_t {1u}; },
+  }};
+
+  return std::visit (vh, string_type.v);
+}
+
+auto
+minimal_members_size (VariantType const& type,
+                      std::vector<VariantType> const& types) -> std::optional<std::size_t>
+{
+  std::vector<std::size_t> child_sizes;
+
+  for (auto const& member_type : types)
+  {
+    auto const maybe_size {minimal_size (member_type)};
+
+    if (!maybe_size)
+    {
+      return {};
+    }
+    child_sizes.push_back (*maybe_size);
+  }
+
+  auto const maybe_container_size {container_size (type, child_sizes)};
+
+  if (!maybe_container_size)
+  {
+    return {};
+  }
+
+  return {total_size (*maybe_container_size)};
+}
+
+struct MemberOrder
+{
+  std::vector<std::size_t> indices;
+  ContainerSize size;
+};
+
+// The layouts and the sizes of the members, in the original order.
+struct Members
+{
+  std::vector<Layout> layouts;
+  std::vector<std::size_t> child_sizes;
+};
+
+auto
+get_members (std::vector<VariantType> const& types,
+             std::vector<std::size_t> const& child_sizes) -> std::optional<Members>
+{
+  Members members {{}, child_sizes};
+
+  for (auto const& type : types)
+  {
+    auto const maybe_layout {layout_of (type)};
+
+    if (!maybe_layout)
+    {
+      return {};
+    }
+    members.layouts.push_back (*maybe_layout);
+  }
+
+  return {std::move (members)};
+}
+
+// Reorders the members into the scratch ones, which keep their
+// storage across the calls.
+auto
+order_size (Members const& members,
+            std::vector<std::size_t> const& indices,
+            Members& scratch) -> ContainerSize
+{
+  scratch.layouts.clear ();
+  scratch.child_sizes.clear ();
+  for (auto idx : indices)
+  {
+    scratch.layouts.push_back (members.layouts[idx]);
+    scratch.child_sizes.push_back (members.child_sizes[idx]);
+  }
+
+  return members_size (scratch.layouts, scratch.child_sizes);
+}
+
+// Fixed size members by decreasing alignment need no padding between
+// them, variable size members by decreasing alignment after them
+// need the least, and only the last one goes without a framing
+// offset.
+auto
+heuristic_order (std::vector<Layout> const& layouts) -> std::vector<std::size_t>
+{
+  std::vector<std::size_t> indices (layouts.size ());
+
+  std::iota (indices.begin (), indices.end (), std::size_t {0u});
+  std::stable_sort (indices.begin (),
+                    indices.end (),
+                    [&layouts](std::size_t lhs, std::size_t rhs)
+                    {
+                      auto const lhs_fixed {layouts[lhs].fixed_size.has_value ()};
+                      auto const rhs_fixed {layouts[rhs].fixed_size.has_value ()};
+
+                      if (lhs_fixed != rhs_fixed)
+                      {
+                        return lhs_fixed;
+                      }
+
+                      return layouts[lhs].alignment > layouts[rhs].alignment;
+                    });
+
+  return indices;
+}
+
+// An order replaces the current best one only if it pays less, so
+// the members are moved only when it helps. Only the indices are
+// permuted, the layouts are computed once.
+auto
+best_order (Members const& members) -> MemberOrder
+{
+  std::vector<std::size_t> indices (members.layouts.size ());
+  Members scratch {};
+
+  std::iota (indices.begin (), indices.end (), std::size_t {0u});
+
+  MemberOrder best {indices, order_size (members, indices, scratch)};
+  auto const consider {[&best, &members, &scratch](std::vector<std::size_t> const& candidate)
+  {
+    auto const size {order_size (members, candidate, scratch)};
+
+    if (waste (size) < waste (best.size))
+    {
+      best = {candidate, size};
+    }
+  }};
+
+  // Many orders often pay the same, the heuristic one reads best.
+  consider (heuristic_order (members.layouts));
+  if (indices.size () <= max_permuted_members)
+  {
+    while (std::next_permutation (indices.begin (), indices.end ()))
+    {
+      consider (indices);
+    }
+  }
+
+  return best;
+}
+
+auto
+advise_tuple (VT::Tuple const& tuple,
+              std::vector<MemberOrderAdvice>& advices) -> void
+{
+  std::vector<std::size_t> child_sizes;
+
+  for (auto const& type : tuple.types)
+  {
+    child_sizes.push_back (*minimal_size (type));
+  }
+
+  auto const maybe_members {get_members (tuple.types, child_sizes)};
+
+  if (!maybe_members)
+  {
+    return;
+  }
+
+  auto const order {best_order (*maybe_members)};
+  std::vector<std::size_t> identity (tuple.types.size ());
+  Members scratch {};
+
+  std::iota (identity.begin (), identity.end (), std::size_t {0u});
+  if (order.indices == identity)
+  {
+    return;
+  }
+
+  std::vector<VariantType> suggested_types;
+
+  for (auto idx : order.indices)
+  {
+    suggested_types.push_back (tuple.types[idx]);
+  }
+  advices.push_back ({{tuple},
+                      order_size (*maybe_members, identity, scratch),
+                      {VT::Tuple {std::move (suggested_types)}},
+                      order.size});
+}
+
+auto
+collect_advices (VariantType const& type,
+                 std::vector<MemberOrderAdvice>& advices) -> void
+{
+  auto vh {VisitHelper {
+    [&advices](VT::Tuple const& tuple)
+    {
+      advise_tuple (tuple, advices);
+      for (auto const& member_type : tuple.types)
+      {
+        collect_advices (member_type, advices);
+      }
+    },
+    // The key of a dict entry is basic and needs to come first, so
+    // only the value can be improved.
+    [&advices](VT::Entry const& entry) { collect_advices (entry.value, advices); },
+    [&advices](VT::Array const& array) { collect_advices (array.element_type, advices); },
+    [&advices](VT::Maybe const& maybe) { collect_advices (maybe.pointed_type, advices); },
+    [](auto const&) {},
+  }};
+
+  std::visit (vh, type.v);
+}
+
+} // anonymous namespace
+
+auto
+minimal_size (VariantType const& type) -> std::optional<std::size_t>
+{
+  if (!type.is_definite ())
+  {
+    return {};
+  }
+
+  auto vh {VisitHelper {
+    [&type](Leaf::Basic const&) -> std::optional<std::size_t> { return layout_of (type)->fixed_size; },
+    [](Leaf::StringType const& string_type) -> std::optional<std::size_t> { return {minimal_string_size (string_type)}; },
+    // A unit, a zero byte and "()".
+    [](Leaf::Variant const&) -> std::optional<std::size_t> { return {4u}; },
+    [](VT::Array const&) -> std::optional<std::size_t> { return {0u}; },
+    [](VT::Maybe const&) -> std::optional<std::size_t> { return {0u}; },
+    [&type](VT::Tuple const& tuple) { return minimal_members_size (type, tuple.types); },
+    [&type](VT::Entry const& entry)
+    {
+      return minimal_members_size (type, {repackage<VariantType> (entry.key), entry.value});
+    },
+    [](auto const&) -> std::optional<std::size_t> { return {}; },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+auto
+advise_member_orders (VariantType const& type) -> std::vector<MemberOrderAdvice>
+{
+  std::vector<MemberOrderAdvice> advices;
+
+  if (type.is_definite ())
+  {
+    collect_advices (type, advices);
+  }
+
+  return advices;
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,64 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< check: GGP_LIB_MEMBER_ORDER_HH_CHECK >*/
+/*< lib: layout.hh >*/
+/*< lib: util.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: cstddef >*/
+/*< stl: optional >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_MEMBER_ORDER_HH
+#define GGP_LIB_MEMBER_ORDER_HH
+
+#define GGP_LIB_MEMBER_ORDER_HH_CHECK_VALUE GGP_LIB_MEMBER_ORDER_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// Size of the smallest serialized value of a definite type - empty
+// strings, arrays and maybes, variants holding a unit. Empty for
+// indefinite types.
+auto
+minimal_size (VariantType const& type) -> std::optional<std::size_t>;
+
+// The padding and framing a tuple pays depend on the order of its
+// members. They are compared with all the members at their minimal
+// size, so the figures are exact for the fixed size members and a
+// lower bound otherwise.
+GGP_LIB_STRUCT (MemberOrderAdvice,
+                VariantType, tuple_type,
+                ContainerSize, size,
+                VariantType, suggested_type,
+                ContainerSize, suggested_size);
+
+// Advice for each tuple in the definite type, including the nested
+// ones, for which some member order pays less padding and framing.
+auto
+advise_member_orders (VariantType const& type) -> std::vector<MemberOrderAdvice>;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_MEMBER_ORDER_HH_CHECK_VALUE != GGP_LIB_MEMBER_ORDER_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_MEMBER_ORDER_HH */
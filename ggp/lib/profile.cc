@@ -0,0 +1,248 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< lib: profile.hh >*/
+/*< stl: algorithm >*/
+/*< stl: charconv >*/
+/*< stl: map >*/
+/*< stl: sstream >*/
+/*< stl: tuple >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto const profile_magic {std::string_view {"ggp-profile "}};
+auto const dropped_prefix {std::string_view {"dropped "}};
+
+auto
+parse_number (std::string_view str,
+              int base) -> std::optional<std::uint64_t>
+{
+  std::uint64_t number {};
+  auto const end {str.data () + str.size ()};
+  auto const [ptr, ec] {std::from_chars (str.data (), end, number, base)};
+
+  if (str.empty () || ec != std::errc {} || ptr != end)
+  {
+    return {};
+  }
+
+  return {number};
+}
+
+// Takes the next line without the newline, all lines need to end
+// with one.
+auto
+next_line (std::string_view& contents) -> std::optional<std::string_view>
+{
+  auto const newline {contents.find ('\n')};
+
+  if (newline == std::string_view::npos)
+  {
+    return {};
+  }
+
+  auto const line {contents.substr (0, newline)};
+
+  contents.remove_prefix (newline + 1);
+
+  return {line};
+}
+
+auto
+next_field (std::string_view& line) -> std::optional<std::string_view>
+{
+  auto const tab {line.find ('\t')};
+
+  if (tab == std::string_view::npos)
+  {
+    return {};
+  }
+
+  auto const field {line.substr (0, tab)};
+
+  line.remove_prefix (tab + 1);
+
+  return {field};
+}
+
+auto
+parse_entry (std::string_view line) -> std::optional<ProfileEntry>
+{
+  auto const function {next_field (line)};
+  auto const module {next_field (line)};
+  auto const offset {next_field (line)};
+  auto const calls {next_field (line)};
+  auto const nanoseconds {next_field (line)};
+  auto const bytes {next_field (line)};
+
+  if (!bytes || function->empty ())
+  {
+    return {};
+  }
+
+  auto const offset_number {parse_number (*offset, 16)};
+  auto const calls_number {parse_number (*calls, 10)};
+  auto const nanoseconds_number {parse_number (*nanoseconds, 10)};
+  auto const bytes_number {parse_number (*bytes, 10)};
+
+  if (!offset_number || !calls_number || !nanoseconds_number || !bytes_number)
+  {
+    return {};
+  }
+
+  return {{{std::string {*function}, std::string {*module}, *offset_number, std::string {line}},
+           {*calls_number, *nanoseconds_number, *bytes_number}}};
+}
+
+using SiteKey = std::tuple<std::string const&, std::string const&, std::uint64_t const&, std::string const&>;
+
+auto
+site_key (ProfileSite const& site) -> SiteKey
+{
+  return std::tie (site.function, site.module, site.offset, site.format);
+}
+
+} // anonymous namespace
+
+auto
+parse_profile (std::string_view contents) -> std::optional<Profile>
+{
+  auto const header {next_line (contents)};
+
+  if (!header || header->substr (0, profile_magic.size ()) != profile_magic)
+  {
+    return {};
+  }
+  if (auto const version {parse_number (header->substr (profile_magic.size ()), 10)};
+      !version || *version != profile_version)
+  {
+    return {};
+  }
+
+  auto const dropped {next_line (contents)};
+
+  if (!dropped || dropped->substr (0, dropped_prefix.size ()) != dropped_prefix)
+  {
+    return {};
+  }
+
+  auto const dropped_calls {parse_number (dropped->substr (dropped_prefix.size ()), 10)};
+
+  if (!dropped_calls)
+  {
+    return {};
+  }
+
+  Profile profile {*dropped_calls, {}};
+
+  while (!contents.empty ())
+  {
+    auto const line {next_line (contents)};
+
+    if (!line)
+    {
+      return {};
+    }
+
+    auto entry {parse_entry (*line)};
+
+    if (!entry)
+    {
+      return {};
+    }
+    profile.entries.push_back (std::move (*entry));
+  }
+
+  return {std::move (profile)};
+}
+
+auto
+profile_to_string (Profile const& profile) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << profile_magic << profile_version << '\n';
+  oss << dropped_prefix << profile.dropped_calls << '\n';
+  for (auto const& entry : profile.entries)
+  {
+    auto const& site {entry.site};
+    auto const& counters {entry.counters};
+
+    oss << site.function << '\t'
+        << site.module << '\t'
+        << std::hex << site.offset << std::dec << '\t'
+        << counters.calls << '\t'
+        << counters.nanoseconds << '\t'
+        << counters.bytes << '\t'
+        << site.format << '\n';
+  }
+
+  return oss.str ();
+}
+
+auto
+merge_profiles (std::vector<Profile> const& profiles) -> Profile
+{
+  Profile merged {0u, {}};
+  // The keys refer to the sites in the passed profiles.
+  std::map<SiteKey, std::size_t> indices;
+
+  for (auto const& profile : profiles)
+  {
+    merged.dropped_calls += profile.dropped_calls;
+    for (auto const& entry : profile.entries)
+    {
+      auto const [iter, inserted] {indices.emplace (site_key (entry.site), merged.entries.size ())};
+
+      if (inserted)
+      {
+        merged.entries.push_back (entry);
+        continue;
+      }
+
+      auto& counters {merged.entries[iter->second].counters};
+
+      counters.calls += entry.counters.calls;
+      counters.nanoseconds += entry.counters.nanoseconds;
+      counters.bytes += entry.counters.bytes;
+    }
+  }
+
+  return merged;
+}
+
+auto
+rank_profile_entries (Profile const& profile) -> std::vector<ProfileEntry>
+{
+  auto entries {profile.entries};
+
+  std::stable_sort (entries.begin (),
+                    entries.end (),
+                    [](ProfileEntry const& lhs, ProfileEntry const& rhs)
+                    {
+                      return lhs.counters.nanoseconds > rhs.counters.nanoseconds;
+                    });
+
+  return entries;
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,103 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< check: GGP_LIB_PROFILE_HH_CHECK >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_PROFILE_HH
+#define GGP_LIB_PROFILE_HH
+
+#define GGP_LIB_PROFILE_HH_CHECK_VALUE GGP_LIB_PROFILE_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// Profiles written by the profiler shim (ggp/prof). A profile is a
+// text file:
+//
+//   ggp-profile <version>
+//   dropped <calls>
+//   <function>\t<module>\t<offset>\t<calls>\t<nanoseconds>\t<bytes>\t<format>
+//   …
+//
+// The offset is hexadecimal, the other numbers are decimal. The
+// format is the rest of the line, so it is the only field that may
+// contain tabs.
+//
+// Needs to be bumped on every incompatible change, together with
+// GGP_PROF_VERSION in ggp/prof/ggp-prof.c.
+inline constexpr unsigned profile_version {1u};
+
+// A call site seen by the profiler.
+GGP_LIB_STRUCT (ProfileSite,
+                // The intercepted function, like g_variant_new.
+                std::string, function,
+                // Path of the module doing the call and the offset of
+                // the return address in it. addr2line turns the offset
+                // minus one into the source location of the call.
+                std::string, module,
+                std::uint64_t, offset,
+                std::string, format);
+
+GGP_LIB_STRUCT (ProfileCounters,
+                std::uint64_t, calls,
+                std::uint64_t, nanoseconds,
+                // Size of the serialized values built or read.
+                std::uint64_t, bytes);
+
+GGP_LIB_STRUCT (ProfileEntry,
+                ProfileSite, site,
+                ProfileCounters, counters);
+
+GGP_LIB_STRUCT (Profile,
+                // Calls that did not fit into the profiler tables.
+                std::uint64_t, dropped_calls,
+                std::vector<ProfileEntry>, entries);
+
+// Empty if the profile is malformed or was written by a different
+// version of the profiler.
+auto
+parse_profile (std::string_view contents) -> std::optional<Profile>;
+
+auto
+profile_to_string (Profile const& profile) -> std::string;
+
+// Sums up the counters of entries with the same site, so profiles of
+// several runs can be concatenated.
+auto
+merge_profiles (std::vector<Profile> const& profiles) -> Profile;
+
+// Entries sorted by the time spent in them, the most expensive
+// first, so the call sites worth optimizing come up front.
+auto
+rank_profile_entries (Profile const& profile) -> std::vector<ProfileEntry>;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_PROFILE_HH_CHECK_VALUE != GGP_LIB_PROFILE_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_PROFILE_HH */
@@ -0,0 +1,726 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< lib: program.hh >*/
+/*< lib: variant-print.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: sstream >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+using Code = std::vector<std::uint8_t>;
+
+auto
+emit_char (Code& code, char c) -> void
+{
+  code.push_back (static_cast<std::uint8_t> (c));
+}
+
+auto
+emit_op (Code& code, ProgramOp op) -> void
+{
+  code.push_back (static_cast<std::uint8_t> (op));
+}
+
+// ULEB128, so small counts take a single byte.
+auto
+emit_count (Code& code, std::size_t count) -> void
+{
+  do
+  {
+    auto byte {static_cast<std::uint8_t> (count & 0x7fu)};
+
+    count >>= 7u;
+    if (count != 0u)
+    {
+      byte |= 0x80u;
+    }
+    code.push_back (byte);
+  } while (count != 0u);
+}
+
+auto
+basic_char (Leaf::Basic const& basic) -> char
+{
+  auto vh {VisitHelper {
+    [](Leaf::Bool const&) { return 'b'; },
+    [](Leaf::Byte const&) { return 'y'; },
+    [](Leaf::I16 const&) { return 'n'; },
+    [](Leaf::U16 const&) { return 'q'; },
+    [](Leaf::I32 const&) { return 'i'; },
+    [](Leaf::U32 const&) { return 'u'; },
+    [](Leaf::I64 const&) { return 'x'; },
+    [](Leaf::U64 const&) { return 't'; },
+    [](Leaf::Handle const&) { return 'h'; },
+    [](Leaf::Double const&) { return 'd'; },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+auto
+string_type_char (Leaf::StringType const& string_type) -> char
+{
+  auto vh {VisitHelper {
+    [](Leaf::String const&) { return 's'; },
+    [](Leaf::ObjectPath const&) { return 'o'; },
+    [](Leaf::Signature const&) { return 'g'; },
+  }};
+
+  return std::visit (vh, string_type.v);
+}
+
+auto
+convenience_byte (VF::Convenience const& convenience) -> ProgramConvenience
+{
+  using ConType = VF::Convenience::Type;
+  using ConKind = VF::Convenience::Kind;
+  auto vh {VisitHelper {
+    [](ConType::StringArray const&, ConKind::Constant const&) { return ProgramConvenience::ConstStringArray; },
+    [](ConType::StringArray const&, ConKind::Duplicated const&) { return ProgramConvenience::StringArray; },
+    [](ConType::ObjectPathArray const&, ConKind::Constant const&) { return ProgramConvenience::ConstObjectPathArray; },
+    [](ConType::ObjectPathArray const&, ConKind::Duplicated const&) { return ProgramConvenience::ObjectPathArray; },
+    [](ConType::ByteString const&, ConKind::Constant const&) { return ProgramConvenience::ConstByteString; },
+    [](ConType::ByteString const&, ConKind::Duplicated const&) { return ProgramConvenience::ByteString; },
+    [](ConType::ByteStringArray const&, ConKind::Constant const&) { return ProgramConvenience::ConstByteStringArray; },
+    [](ConType::ByteStringArray const&, ConKind::Duplicated const&) { return ProgramConvenience::ByteStringArray; },
+  }};
+
+  return std::visit (vh, convenience.type.v, convenience.kind.v);
+}
+
+auto
+compile_type (Code& code, VariantType const& type) -> void;
+
+auto
+compile_entry_key_type (Code& code, VT::EntryKeyType const& key) -> void
+{
+  auto vh {VisitHelper {
+    [&code](Leaf::Basic const& basic) { emit_char (code, basic_char (basic)); },
+    [&code](Leaf::StringType const& string_type) { emit_char (code, string_type_char (string_type)); },
+    [&code](Leaf::AnyBasic const&) { emit_char (code, '?'); },
+  }};
+
+  std::visit (vh, key.v);
+}
+
+auto
+compile_type (Code& code, VariantType const& type) -> void
+{
+  auto vh {VisitHelper {
+    [&code](Leaf::Basic const& basic) { emit_char (code, basic_char (basic)); },
+    [&code](Leaf::AnyBasic const&) { emit_char (code, '?'); },
+    [&code](Leaf::StringType const& string_type) { emit_char (code, string_type_char (string_type)); },
+    [&code](VT::Maybe const& maybe)
+    {
+      emit_op (code, ProgramOp::Maybe);
+      compile_type (code, maybe.pointed_type);
+    },
+    [&code](VT::Tuple const& tuple)
+    {
+      emit_op (code, ProgramOp::Tuple);
+      emit_count (code, tuple.types.size ());
+      for (auto const& member : tuple.types)
+      {
+        compile_type (code, member);
+      }
+    },
+    [&code](VT::Array const& array)
+    {
+      emit_op (code, ProgramOp::Array);
+      compile_type (code, array.element_type);
+    },
+    [&code](VT::Entry const& entry)
+    {
+      emit_op (code, ProgramOp::Entry);
+      compile_entry_key_type (code, entry.key);
+      compile_type (code, entry.value);
+    },
+    [&code](Leaf::Variant const&) { emit_char (code, 'v'); },
+    [&code](Leaf::AnyTuple const&) { emit_char (code, 'r'); },
+    [&code](Leaf::AnyType const&) { emit_char (code, '*'); },
+  }};
+
+  std::visit (vh, type.v);
+}
+
+auto
+compile_format (Code& code, VariantFormat const& format) -> void;
+
+auto
+compile_entry_key_format (Code& code, VF::EntryKeyFormat const& key) -> void
+{
+  auto vh {VisitHelper {
+    [&code](Leaf::Basic const& basic) { emit_char (code, basic_char (basic)); },
+    [&code](Leaf::StringType const& string_type) { emit_char (code, string_type_char (string_type)); },
+    [&code](VF::AtEntryKeyType const& at)
+    {
+      emit_op (code, ProgramOp::AtType);
+      compile_entry_key_type (code, at.entry_key_type);
+    },
+    [&code](VF::Pointer const& pointer)
+    {
+      emit_op (code, ProgramOp::Pointer);
+      emit_char (code, string_type_char (pointer.string_type));
+    },
+  }};
+
+  std::visit (vh, key.v);
+}
+
+// Everything a maybe can point to is also a format on its own.
+auto
+compile_maybe (Code& code, VF::Maybe const& maybe) -> void
+{
+  auto vh {VisitHelper {
+    [&code](VF::MaybePointer const& maybe_pointer) { compile_format (code, repackage<VariantFormat> (maybe_pointer)); },
+    [&code](VF::MaybeBool const& maybe_bool) { compile_format (code, repackage<VariantFormat> (maybe_bool)); },
+  }};
+
+  emit_op (code, ProgramOp::Maybe);
+  std::visit (vh, maybe.v);
+}
+
+auto
+compile_format (Code& code, VariantFormat const& format) -> void
+{
+  auto vh {VisitHelper {
+    [&code](Leaf::Basic const& basic) { emit_char (code, basic_char (basic)); },
+    [&code](Leaf::StringType const& string_type) { emit_char (code, string_type_char (string_type)); },
+    [&code](Leaf::Variant const&) { emit_char (code, 'v'); },
+    [&code](VT::Array const& array) { compile_type (code, {{array}}); },
+    [&code](VF::AtVariantType const& at)
+    {
+      emit_op (code, ProgramOp::AtType);
+      compile_type (code, at.type);
+    },
+    [&code](VF::Pointer const& pointer)
+    {
+      emit_op (code, ProgramOp::Pointer);
+      emit_char (code, string_type_char (pointer.string_type));
+    },
+    [&code](VF::Convenience const& convenience)
+    {
+      emit_op (code, ProgramOp::Convenience);
+      code.push_back (static_cast<std::uint8_t> (convenience_byte (convenience)));
+    },
+    [&code](VF::Maybe const& maybe) { compile_maybe (code, maybe); },
+    [&code](VF::Tuple const& tuple)
+    {
+      emit_op (code, ProgramOp::Tuple);
+      emit_count (code, tuple.formats.size ());
+      for (auto const& member : tuple.formats)
+      {
+        compile_format (code, member);
+      }
+    },
+    [&code](VF::Entry const& entry)
+    {
+      emit_op (code, ProgramOp::Entry);
+      compile_entry_key_format (code, entry.key);
+      compile_format (code, entry.value);
+    },
+  }};
+
+  std::visit (vh, format.v);
+}
+
+auto
+basic_from_byte (std::uint8_t byte) -> std::optional<Leaf::Basic>
+{
+  switch (byte)
+  {
+  case 'b':
+    return {{Leaf::bool_}};
+  case 'y':
+    return {{Leaf::byte_}};
+  case 'n':
+    return {{Leaf::i16}};
+  case 'q':
+    return {{Leaf::u16}};
+  case 'i':
+    return {{Leaf::i32}};
+  case 'u':
+    return {{Leaf::u32}};
+  case 'x':
+    return {{Leaf::i64}};
+  case 't':
+    return {{Leaf::u64}};
+  case 'h':
+    return {{Leaf::handle}};
+  case 'd':
+    return {{Leaf::double_}};
+  }
+
+  return {};
+}
+
+auto
+string_type_from_byte (std::uint8_t byte) -> std::optional<Leaf::StringType>
+{
+  switch (byte)
+  {
+  case 's':
+    return {{Leaf::string_}};
+  case 'o':
+    return {{Leaf::object_path}};
+  case 'g':
+    return {{Leaf::signature}};
+  }
+
+  return {};
+}
+
+auto
+convenience_from_byte (std::uint8_t byte) -> std::optional<VF::Convenience>
+{
+  using ConType = VF::Convenience::Type;
+  using ConKind = VF::Convenience::Kind;
+
+  switch (static_cast<ProgramConvenience> (byte))
+  {
+  case ProgramConvenience::StringArray:
+    return {{{ConType::string_array}, {ConKind::duplicated}}};
+  case ProgramConvenience::ConstStringArray:
+    return {{{ConType::string_array}, {ConKind::constant}}};
+  case ProgramConvenience::ObjectPathArray:
+    return {{{ConType::object_path_array}, {ConKind::duplicated}}};
+  case ProgramConvenience::ConstObjectPathArray:
+    return {{{ConType::object_path_array}, {ConKind::constant}}};
+  case ProgramConvenience::ByteString:
+    return {{{ConType::byte_string}, {ConKind::duplicated}}};
+  case ProgramConvenience::ConstByteString:
+    return {{{ConType::byte_string}, {ConKind::constant}}};
+  case ProgramConvenience::ByteStringArray:
+    return {{{ConType::byte_string_array}, {ConKind::duplicated}}};
+  case ProgramConvenience::ConstByteStringArray:
+    return {{{ConType::byte_string_array}, {ConKind::constant}}};
+  }
+
+  return {};
+}
+
+auto
+maybe_from_format (VariantFormat const& format) -> VF::Maybe
+{
+  auto vh {VisitHelper {
+    [](Leaf::Basic const& basic) { return VF::Maybe {{VF::MaybeBool {{basic}}}}; },
+    [](Leaf::StringType const& string_type) { return VF::Maybe {{VF::MaybePointer {{string_type}}}}; },
+    [](Leaf::Variant const& variant) { return VF::Maybe {{VF::MaybePointer {{variant}}}}; },
+    [](VT::Array const& array) { return VF::Maybe {{VF::MaybePointer {{array}}}}; },
+    [](VF::AtVariantType const& at) { return VF::Maybe {{VF::MaybePointer {{at}}}}; },
+    [](VF::Pointer const& pointer) { return VF::Maybe {{VF::MaybePointer {{pointer}}}}; },
+    [](VF::Convenience const& convenience) { return VF::Maybe {{VF::MaybePointer {{convenience}}}}; },
+    [](VF::Maybe const& maybe) { return VF::Maybe {{VF::MaybeBool {{maybe}}}}; },
+    [](VF::Tuple const& tuple) { return VF::Maybe {{VF::MaybeBool {{tuple}}}}; },
+    [](VF::Entry const& entry) { return VF::Maybe {{VF::MaybeBool {{entry}}}}; },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+struct ProgramReader
+{
+  auto
+  read_byte () -> std::optional<std::uint8_t>;
+
+  auto
+  read_count () -> std::optional<std::size_t>;
+
+  auto
+  read_entry_key_type () -> std::optional<VT::EntryKeyType>;
+
+  auto
+  read_type () -> std::optional<VariantType>;
+
+  auto
+  read_entry_key_format () -> std::optional<VF::EntryKeyFormat>;
+
+  auto
+  read_format () -> std::optional<VariantFormat>;
+
+  std::vector<std::uint8_t> const& program;
+  std::size_t pos;
+};
+
+auto
+ProgramReader::read_byte () -> std::optional<std::uint8_t>
+{
+  if (this->pos >= this->program.size ())
+  {
+    return {};
+  }
+
+  return {this->program[this->pos++]};
+}
+
+auto
+ProgramReader::read_count () -> std::optional<std::size_t>
+{
+  std::size_t count {0u};
+
+  for (auto shift {0u}; shift < sizeof (std::size_t) * 8u; shift += 7u)
+  {
+    auto maybe_byte {this->read_byte ()};
+
+    if (!maybe_byte)
+    {
+      return {};
+    }
+    count |= static_cast<std::size_t> (*maybe_byte & 0x7fu) << shift;
+    if ((*maybe_byte & 0x80u) == 0u)
+    {
+      return {count};
+    }
+  }
+
+  return {};
+}
+
+auto
+ProgramReader::read_entry_key_type () -> std::optional<VT::EntryKeyType>
+{
+  auto maybe_byte {this->read_byte ()};
+
+  if (!maybe_byte)
+  {
+    return {};
+  }
+  if (auto maybe_basic {basic_from_byte (*maybe_byte)}; maybe_basic)
+  {
+    return {{*maybe_basic}};
+  }
+  if (auto maybe_string_type {string_type_from_byte (*maybe_byte)}; maybe_string_type)
+  {
+    return {{*maybe_string_type}};
+  }
+  if (*maybe_byte == '?')
+  {
+    return {{Leaf::any_basic}};
+  }
+
+  return {};
+}
+
+auto
+ProgramReader::read_type () -> std::optional<VariantType>
+{
+  auto maybe_byte {this->read_byte ()};
+
+  if (!maybe_byte)
+  {
+    return {};
+  }
+  if (auto maybe_basic {basic_from_byte (*maybe_byte)}; maybe_basic)
+  {
+    return {{*maybe_basic}};
+  }
+  if (auto maybe_string_type {string_type_from_byte (*maybe_byte)}; maybe_string_type)
+  {
+    return {{*maybe_string_type}};
+  }
+
+  switch (*maybe_byte)
+  {
+  case 'v':
+    return {{Leaf::variant}};
+  case '*':
+    return {{Leaf::any_type}};
+  case '?':
+    return {{Leaf::any_basic}};
+  case 'r':
+    return {{Leaf::any_tuple}};
+  case static_cast<std::uint8_t> (ProgramOp::Maybe):
+    if (auto maybe_type {this->read_type ()}; maybe_type)
+    {
+      return {{VT::Maybe {std::move (*maybe_type)}}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Array):
+    if (auto maybe_type {this->read_type ()}; maybe_type)
+    {
+      return {{VT::Array {std::move (*maybe_type)}}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Tuple):
+    if (auto maybe_count {this->read_count ()}; maybe_count)
+    {
+      std::vector<VariantType> types;
+
+      for (auto idx {std::size_t {0u}}; idx < *maybe_count; ++idx)
+      {
+        auto maybe_type {this->read_type ()};
+
+        if (!maybe_type)
+        {
+          return {};
+        }
+        types.push_back (std::move (*maybe_type));
+      }
+
+      return {{VT::Tuple {std::move (types)}}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Entry):
+    if (auto maybe_key {this->read_entry_key_type ()}; maybe_key)
+    {
+      if (auto maybe_value {this->read_type ()}; maybe_value)
+      {
+        return {{VT::Entry {std::move (*maybe_key), std::move (*maybe_value)}}};
+      }
+    }
+    return {};
+  }
+
+  return {};
+}
+
+auto
+ProgramReader::read_entry_key_format () -> std::optional<VF::EntryKeyFormat>
+{
+  auto maybe_byte {this->read_byte ()};
+
+  if (!maybe_byte)
+  {
+    return {};
+  }
+  if (auto maybe_basic {basic_from_byte (*maybe_byte)}; maybe_basic)
+  {
+    return {{*maybe_basic}};
+  }
+  if (auto maybe_string_type {string_type_from_byte (*maybe_byte)}; maybe_string_type)
+  {
+    return {{*maybe_string_type}};
+  }
+
+  switch (*maybe_byte)
+  {
+  case static_cast<std::uint8_t> (ProgramOp::AtType):
+    if (auto maybe_key {this->read_entry_key_type ()}; maybe_key)
+    {
+      return {{VF::AtEntryKeyType {std::move (*maybe_key)}}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Pointer):
+    if (auto maybe_byte {this->read_byte ()}; maybe_byte)
+    {
+      if (auto maybe_string_type {string_type_from_byte (*maybe_byte)}; maybe_string_type)
+      {
+        return {{VF::Pointer {*maybe_string_type}}};
+      }
+    }
+    return {};
+  }
+
+  return {};
+}
+
+auto
+ProgramReader::read_format () -> std::optional<VariantFormat>
+{
+  auto const start {this->pos};
+  auto maybe_byte {this->read_byte ()};
+
+  if (!maybe_byte)
+  {
+    return {};
+  }
+  if (auto maybe_basic {basic_from_byte (*maybe_byte)}; maybe_basic)
+  {
+    return {{*maybe_basic}};
+  }
+  if (auto maybe_string_type {string_type_from_byte (*maybe_byte)}; maybe_string_type)
+  {
+    return {{*maybe_string_type}};
+  }
+
+  switch (*maybe_byte)
+  {
+  case 'v':
+    return {{Leaf::variant}};
+  case '*':
+    return {{VF::AtVariantType {{Leaf::any_type}}}};
+  case '?':
+    return {{VF::AtVariantType {{Leaf::any_basic}}}};
+  case 'r':
+    return {{VF::AtVariantType {{Leaf::any_tuple}}}};
+  case static_cast<std::uint8_t> (ProgramOp::Array):
+    // Arrays in formats are just types.
+    this->pos = start;
+    if (auto maybe_type {this->read_type ()}; maybe_type)
+    {
+      return {{std::get<VT::Array> (maybe_type->v)}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::AtType):
+    if (auto maybe_type {this->read_type ()}; maybe_type)
+    {
+      return {{VF::AtVariantType {std::move (*maybe_type)}}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Pointer):
+    if (auto maybe_byte {this->read_byte ()}; maybe_byte)
+    {
+      if (auto maybe_string_type {string_type_from_byte (*maybe_byte)}; maybe_string_type)
+      {
+        return {{VF::Pointer {*maybe_string_type}}};
+      }
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Convenience):
+    if (auto maybe_byte {this->read_byte ()}; maybe_byte)
+    {
+      if (auto maybe_convenience {convenience_from_byte (*maybe_byte)}; maybe_convenience)
+      {
+        return {{*maybe_convenience}};
+      }
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Maybe):
+    if (auto maybe_format {this->read_format ()}; maybe_format)
+    {
+      return {{maybe_from_format (*maybe_format)}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Tuple):
+    if (auto maybe_count {this->read_count ()}; maybe_count)
+    {
+      std::vector<VariantFormat> formats;
+
+      for (auto idx {std::size_t {0u}}; idx < *maybe_count; ++idx)
+      {
+        auto maybe_format {this->read_format ()};
+
+        if (!maybe_format)
+        {
+          return {};
+        }
+        formats.push_back (std::move (*maybe_format));
+      }
+
+      return {{VF::Tuple {std::move (formats)}}};
+    }
+    return {};
+  case static_cast<std::uint8_t> (ProgramOp::Entry):
+    if (auto maybe_key {this->read_entry_key_format ()}; maybe_key)
+    {
+      if (auto maybe_value {this->read_format ()}; maybe_value)
+      {
+        return {{VF::Entry {std::move (*maybe_key), std::move (*maybe_value)}}};
+      }
+    }
+    return {};
+  }
+
+  return {};
+}
+
+} // anonymous namespace
+
+auto
+compile_program (VariantFormat const& format) -> std::vector<std::uint8_t>
+{
+  std::ostringstream oss;
+  Code code {program_version};
+
+  oss << format.to_type ();
+  for (auto c : oss.str ())
+  {
+    emit_char (code, c);
+  }
+  code.push_back (0u);
+  compile_format (code, format);
+
+  return code;
+}
+
+auto
+decompile_program (std::vector<std::uint8_t> const& program) -> std::optional<VariantFormat>
+{
+  ProgramReader reader {program, 0u};
+
+  if (reader.read_byte () != std::optional<std::uint8_t> {program_version})
+  {
+    return {};
+  }
+
+  std::string type_string;
+
+  for (auto maybe_byte {reader.read_byte ()}; maybe_byte != std::optional<std::uint8_t> {0u}; maybe_byte = reader.read_byte ())
+  {
+    if (!maybe_byte)
+    {
+      return {};
+    }
+    type_string.push_back (static_cast<char> (*maybe_byte));
+  }
+
+  auto maybe_format {reader.read_format ()};
+
+  if (!maybe_format || reader.pos != program.size ())
+  {
+    return {};
+  }
+
+  // The type string is redundant, but the runtime library relies on
+  // it.
+  std::ostringstream oss;
+
+  oss << maybe_format->to_type ();
+  if (oss.str () != type_string)
+  {
+    return {};
+  }
+
+  return maybe_format;
+}
+
+auto
+program_is_runnable (VariantFormat const& format) -> bool
+{
+  auto vh {VisitHelper {
+    [](Leaf::Basic const&) { return true; },
+    [](Leaf::StringType const&) { return true; },
+    [](Leaf::Variant const&) { return true; },
+    [](VT::Array const&) { return false; },
+    [](VF::AtVariantType const&) { return true; },
+    [](VF::Pointer const&) { return true; },
+    [](VF::Convenience const&) { return false; },
+    [](VF::Maybe const&) { return false; },
+    [](VF::Tuple const& tuple)
+    {
+      for (auto const& member : tuple.formats)
+      {
+        if (!program_is_runnable (member))
+        {
+          return false;
+        }
+      }
+      return true;
+    },
+    [](VF::Entry const& entry) { return program_is_runnable (entry.value); },
+  }};
+
+  return std::visit (vh, format.v);
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,103 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< check: GGP_LIB_PROGRAM_HH_CHECK >*/
+/*< lib: variant.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_PROGRAM_HH
+#define GGP_LIB_PROGRAM_HH
+
+#define GGP_LIB_PROGRAM_HH_CHECK_VALUE GGP_LIB_PROGRAM_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// A format compiled into a bytecode program, so the runtime library
+// (ggp/rt) does not need to parse the format string. A program is:
+//
+//   the version byte,
+//   the type string of the format, terminated with a zero byte,
+//   the code.
+//
+// The code describes the format in prefix order. Basic types, string
+// types and "v" are encoded with their format characters, the rest
+// with the opcodes below followed by their operands. In formats "*",
+// "?" and "r" stand for GVariant pointers, like "@*", so they are
+// encoded as AtType followed by the character. Types are encoded the
+// same way, without the format-only opcodes, so "*", "?" and "r" in
+// them are just the characters.
+//
+// Needs to be bumped on every incompatible change, together with
+// GGP_RT_PROGRAM_VERSION in ggp/rt/ggp-rt.h.
+inline constexpr std::uint8_t program_version {1u};
+
+enum class ProgramOp : std::uint8_t
+{
+  // Followed by the string type.
+  Pointer = 0x80u,
+  // Followed by the type.
+  AtType,
+  // Followed by the member count as ULEB128 and the members.
+  Tuple,
+  // Followed by the key and the value.
+  Entry,
+  // Followed by the element type.
+  Array,
+  // Followed by the pointed format or type.
+  Maybe,
+  // Followed by the ProgramConvenience byte.
+  Convenience,
+};
+
+enum class ProgramConvenience : std::uint8_t
+{
+  StringArray, // ^as
+  ConstStringArray, // ^a&s
+  ObjectPathArray, // ^ao
+  ConstObjectPathArray, // ^a&o
+  ByteString, // ^ay
+  ConstByteString, // ^&ay
+  ByteStringArray, // ^aay
+  ConstByteStringArray, // ^a&ay
+};
+
+auto
+compile_program (VariantFormat const& format) -> std::vector<std::uint8_t>;
+
+// Empty if the program is malformed or was compiled for a different
+// version.
+auto
+decompile_program (std::vector<std::uint8_t> const& program) -> std::optional<VariantFormat>;
+
+// Whether the runtime library can run the program of the format.
+// Arrays, maybes and the convenience formats are not supported.
+auto
+program_is_runnable (VariantFormat const& format) -> bool;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_PROGRAM_HH_CHECK_VALUE != GGP_LIB_PROGRAM_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_PROGRAM_HH */
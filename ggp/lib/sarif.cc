@@ -0,0 +1,162 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: sarif.hh >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto
+append_string (std::string& out, std::string_view text) -> void
+{
+  out += '"';
+  out += json_escape (text);
+  out += '"';
+}
+
+auto
+append_result (std::string& out, Diagnostic const& diagnostic) -> void
+{
+  out += "        {\n"
+         "          \"ruleId\": ";
+  append_string (out, diagnostic.rule);
+  out += ",\n"
+         "          \"level\": \"warning\",\n"
+         "          \"message\": {\"text\": ";
+  append_string (out, diagnostic.message);
+  out += "},\n"
+         "          \"locations\": [{\"physicalLocation\": {\"artifactLocation\": {\"uri\": ";
+  append_string (out, diagnostic.file);
+  out += '}';
+  // SARIF lines and columns start at 1, so unknown ones are left
+  // out.
+  if (diagnostic.line > 0u)
+  {
+    out += ", \"region\": {\"startLine\": ";
+    out += std::to_string (diagnostic.line);
+    if (diagnostic.column > 0u)
+    {
+      out += ", \"startColumn\": ";
+      out += std::to_string (diagnostic.column);
+    }
+    out += '}';
+  }
+  out += "}}],\n"
+         "          \"properties\": {\"format\": ";
+  append_string (out, diagnostic.format);
+  if (diagnostic.arg_index)
+  {
+    out += ", \"argumentIndex\": ";
+    out += std::to_string (*diagnostic.arg_index);
+  }
+  if (!diagnostic.expected_type.empty ())
+  {
+    out += ", \"expectedType\": ";
+    append_string (out, diagnostic.expected_type);
+  }
+  if (!diagnostic.actual_type.empty ())
+  {
+    out += ", \"actualType\": ";
+    append_string (out, diagnostic.actual_type);
+  }
+  out += "}\n"
+         "        }";
+}
+
+} // anonymous namespace
+
+auto
+json_escape (std::string_view text) -> std::string
+{
+  std::string escaped;
+
+  escaped.reserve (text.size ());
+  for (auto c : text)
+  {
+    switch (c)
+    {
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    case '\r':
+      escaped += "\\r";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char> (c) < 0x20u)
+      {
+        constexpr char const* digits {"0123456789abcdef"};
+        auto const code {static_cast<unsigned char> (c)};
+
+        escaped += "\\u00";
+        escaped += digits[code >> 4];
+        escaped += digits[code & 0xfu];
+      }
+      else
+      {
+        // Other bytes, including the UTF-8 sequences, are fine in
+        // JSON strings as they are.
+        escaped += c;
+      }
+      break;
+    }
+  }
+
+  return escaped;
+}
+
+auto
+diagnostics_to_sarif (std::vector<Diagnostic> const& diagnostics) -> std::string
+{
+  std::string out;
+
+  out += "{\n"
+         "  \"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\",\n"
+         "  \"version\": \"2.1.0\",\n"
+         "  \"runs\": [\n"
+         "    {\n"
+         "      \"tool\": {\"driver\": {\"name\": \"glib-gcc-plugin\"}},\n"
+         "      \"results\": [";
+  for (auto idx {0u}; idx < diagnostics.size (); ++idx)
+  {
+    out += (idx > 0u) ? ",\n" : "\n";
+    append_result (out, diagnostics[idx]);
+  }
+  if (!diagnostics.empty ())
+  {
+    out += "\n      ";
+  }
+  out += "]\n"
+         "    }\n"
+         "  ]\n"
+         "}\n";
+
+  return out;
+}
+
+} // namespace Ggp::Lib
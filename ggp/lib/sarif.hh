@@ -0,0 +1,73 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_SARIF_HH_CHECK >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_SARIF_HH
+#define GGP_LIB_SARIF_HH
+
+#define GGP_LIB_SARIF_HH_CHECK_VALUE GGP_LIB_SARIF_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// A diagnostic of the variant or the tuple checker.
+GGP_LIB_STRUCT (Diagnostic,
+                // Kind of the diagnostic, like "vc-arg-type".
+                std::string, rule,
+                std::string, message,
+                std::string, file,
+                // Zero if unknown.
+                std::uint32_t, line,
+                // Zero if unknown.
+                std::uint32_t, column,
+                // The format string of the call, empty if unknown.
+                std::string, format,
+                // 0-based index of the argument after the format
+                // string. Empty if the diagnostic is about the whole
+                // call.
+                std::optional<std::uint32_t>, arg_index,
+                // Printed types, empty if they do not matter for the
+                // diagnostic.
+                std::string, expected_type,
+                std::string, actual_type);
+
+// Escapes the text for use inside a JSON string literal.
+auto
+json_escape (std::string_view text) -> std::string;
+
+// Makes a SARIF 2.1.0 log with a single run holding the diagnostics
+// as results. The format, argument index and types go to the
+// properties of the results.
+auto
+diagnostics_to_sarif (std::vector<Diagnostic> const& diagnostics) -> std::string;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_SARIF_HH_CHECK_VALUE != GGP_LIB_SARIF_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_SARIF_HH */
@@ -0,0 +1,286 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< lib: layout.hh >*/
+/*< lib: serialize.hh >*/
+/*< lib: variant-print.hh >*/
+/*< lib: variant-value.hh >*/
+/*< stl: algorithm >*/
+/*< stl: cassert >*/
+/*< stl: cstring >*/
+/*< stl: sstream >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+using Bytes = std::vector<std::uint8_t>;
+
+auto
+must_get_layout (VariantType const& type) -> Layout
+{
+  auto maybe_layout {layout_of (type)};
+
+  assert (maybe_layout);
+
+  return *maybe_layout;
+}
+
+auto
+pad (Bytes& bytes, std::size_t alignment) -> void
+{
+  while (bytes.size () % alignment != 0u)
+  {
+    bytes.push_back (0u);
+  }
+}
+
+auto
+append_bytes (Bytes& bytes, Bytes const& other) -> void
+{
+  bytes.insert (bytes.end (), other.cbegin (), other.cend ());
+}
+
+struct Serializer
+{
+  auto
+  write (VariantValue const& value) -> Bytes;
+
+  auto
+  write_basic (VV::Basic const& basic) -> Bytes;
+
+  auto
+  write_number (std::uint64_t number, std::size_t size) -> Bytes;
+
+  auto
+  write_offsets (Bytes& bytes, std::vector<std::size_t> const& offsets) -> void;
+
+  auto
+  write_array (VV::Array const& array) -> Bytes;
+
+  auto
+  write_members (std::vector<VariantValue const*> const& members) -> Bytes;
+
+  ByteOrder order;
+};
+
+auto
+Serializer::write_number (std::uint64_t number, std::size_t size) -> Bytes
+{
+  Bytes bytes (size);
+
+  for (auto idx {std::size_t {0u}}; idx < size; ++idx)
+  {
+    auto const shift {(this->order == ByteOrder::Little ? idx : size - 1u - idx) * 8u};
+
+    bytes[idx] = static_cast<std::uint8_t> ((number >> shift) & 0xffu);
+  }
+
+  return bytes;
+}
+
+auto
+Serializer::write_basic (VV::Basic const& basic) -> Bytes
+{
+  auto vh {VisitHelper {
+    [this](VV::Bool const& b) { return this->write_number (b.value ? 1u : 0u, 1u); },
+    [this](VV::Byte const& y) { return this->write_number (y.value, 1u); },
+    [this](VV::I16 const& n) { return this->write_number (static_cast<std::uint16_t> (n.value), 2u); },
+    [this](VV::U16 const& q) { return this->write_number (q.value, 2u); },
+    [this](VV::I32 const& i) { return this->write_number (static_cast<std::uint32_t> (i.value), 4u); },
+    [this](VV::U32 const& u) { return this->write_number (u.value, 4u); },
+    [this](VV::I64 const& x) { return this->write_number (static_cast<std::uint64_t> (x.value), 8u); },
+    [this](VV::U64 const& t) { return this->write_number (t.value, 8u); },
+    [this](VV::Handle const& h) { return this->write_number (static_cast<std::uint32_t> (h.value), 4u); },
+    [this](VV::Double const& d)
+    {
+      std::uint64_t bits;
+
+      static_assert (sizeof (bits) == sizeof (d.value));
+      std::memcpy (&bits, &d.value, sizeof (bits));
+
+      return this->write_number (bits, 8u);
+    },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+auto
+Serializer::write_offsets (Bytes& bytes, std::vector<std::size_t> const& offsets) -> void
+{
+  auto const size {framing_offset_size (bytes.size (), offsets.size ())};
+
+  for (auto offset : offsets)
+  {
+    append_bytes (bytes, this->write_number (offset, size));
+  }
+}
+
+// Elements of fixed size are just put one after another. Otherwise
+// each element is aligned and the end offsets of all the elements
+// follow them.
+auto
+Serializer::write_array (VV::Array const& array) -> Bytes
+{
+  auto const layout {must_get_layout (array.element_type)};
+  Bytes bytes;
+  std::vector<std::size_t> offsets;
+
+  for (auto const& element : array.elements)
+  {
+    pad (bytes, layout.alignment);
+    append_bytes (bytes, this->write (element));
+    offsets.push_back (bytes.size ());
+  }
+  if (!layout.fixed_size)
+  {
+    this->write_offsets (bytes, offsets);
+  }
+
+  return bytes;
+}
+
+// Members are aligned. The end offsets of the members of variable
+// size, except the last member, follow them in the reverse order. A
+// container of fixed size is padded to its alignment instead.
+auto
+Serializer::write_members (std::vector<VariantValue const*> const& members) -> Bytes
+{
+  Bytes bytes;
+  std::vector<std::size_t> offsets;
+  std::size_t alignment {1u};
+  bool fixed {true};
+
+  for (auto const* member : members)
+  {
+    auto const layout {must_get_layout (member->type ())};
+
+    alignment = std::max (alignment, layout.alignment);
+    pad (bytes, layout.alignment);
+    append_bytes (bytes, this->write (*member));
+    if (!layout.fixed_size)
+    {
+      fixed = false;
+      if (member != members.back ())
+      {
+        offsets.insert (offsets.begin (), bytes.size ());
+      }
+    }
+  }
+
+  if (fixed)
+  {
+    // The unit type is a single zero byte.
+    if (members.empty ())
+    {
+      bytes.push_back (0u);
+    }
+    pad (bytes, alignment);
+  }
+  else
+  {
+    this->write_offsets (bytes, offsets);
+  }
+
+  return bytes;
+}
+
+auto
+Serializer::write (VariantValue const& value) -> Bytes
+{
+  auto vh {VisitHelper {
+    [this](VV::Basic const& basic) { return this->write_basic (basic); },
+    [](VV::String const& string)
+    {
+      Bytes bytes {string.value.cbegin (), string.value.cend ()};
+
+      bytes.push_back (0u);
+
+      return bytes;
+    },
+    // The child, a zero byte and the type string of the child.
+    [this](VV::Variant const& variant)
+    {
+      std::ostringstream oss;
+      auto bytes {this->write (variant.value)};
+
+      oss << variant.value->type ();
+      bytes.push_back (0u);
+      for (auto c : oss.str ())
+      {
+        bytes.push_back (static_cast<std::uint8_t> (c));
+      }
+
+      return bytes;
+    },
+    // Nothing is empty. Just is the child, followed by a zero byte if
+    // the child has variable size.
+    [this](VV::Maybe const& maybe)
+    {
+      Bytes bytes;
+
+      if (maybe.value)
+      {
+        bytes = this->write (*maybe.value);
+        if (!must_get_layout (maybe.pointed_type).fixed_size)
+        {
+          bytes.push_back (0u);
+        }
+      }
+
+      return bytes;
+    },
+    [this](VV::Array const& array) { return this->write_array (array); },
+    [this](VV::Tuple const& tuple)
+    {
+      std::vector<VariantValue const*> members;
+
+      for (auto const& member : tuple.values)
+      {
+        members.push_back (&member);
+      }
+
+      return this->write_members (members);
+    },
+    [this](VV::Entry const& entry)
+    {
+      VariantValue const& key = entry.key;
+      VariantValue const& value = entry.value;
+
+      return this->write_members ({&key, &value});
+    },
+  }};
+
+  return std::visit (vh, value.v);
+}
+
+} // anonymous namespace
+
+auto
+serialize (VariantValue const& value,
+           ByteOrder order) -> std::vector<std::uint8_t>
+{
+  Serializer serializer {order};
+
+  return serializer.write (value);
+}
+
+} // namespace Ggp::Lib
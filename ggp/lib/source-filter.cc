@@ -0,0 +1,394 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: source-filter.hh >*/
+/*< stl: algorithm >*/
+/*< stl: charconv >*/
+/*< stl: iterator >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto
+add_prefix (PathFilter& filter,
+            std::string_view prefix,
+            bool include) -> void
+{
+  auto node_idx {std::uint32_t {0u}};
+
+  for (auto byte : prefix)
+  {
+    auto& bytes {filter.nodes[node_idx].bytes};
+    auto const iter {std::lower_bound (bytes.begin (), bytes.end (), byte)};
+    auto const child_offset {std::distance (bytes.begin (), iter)};
+
+    if (iter != bytes.end () && *iter == byte)
+    {
+      node_idx = filter.nodes[node_idx].children[child_offset];
+      continue;
+    }
+
+    auto const child_idx {static_cast<std::uint32_t> (filter.nodes.size ())};
+
+    bytes.insert (iter, byte);
+    filter.nodes[node_idx].children.insert (filter.nodes[node_idx].children.begin () + child_offset, child_idx);
+    // Invalidates the references to the nodes.
+    filter.nodes.push_back ({});
+    node_idx = child_idx;
+  }
+  filter.nodes[node_idx].include = include;
+}
+
+auto
+parse_number (std::string_view str) -> std::optional<std::uint32_t>
+{
+  std::uint32_t number {};
+  auto const end {str.data () + str.size ()};
+  auto const [ptr, ec] {std::from_chars (str.data (), end, number)};
+
+  if (str.empty () || ec != std::errc {} || ptr != end)
+  {
+    return {};
+  }
+
+  return {number};
+}
+
+// Takes the next line without the newline, the last one may lack it.
+auto
+next_line (std::string_view& contents) -> std::string_view
+{
+  auto const newline {contents.find ('\n')};
+  auto const line {contents.substr (0, newline)};
+
+  contents.remove_prefix ((newline == std::string_view::npos) ? contents.size () : newline + 1);
+
+  return line;
+}
+
+auto
+starts_with (std::string_view str,
+             std::string_view prefix) -> bool
+{
+  return str.substr (0, prefix.size ()) == prefix;
+}
+
+auto
+add_lines (LineFilter& filter,
+           std::string const& path,
+           LineRange range) -> void
+{
+  auto& ranges {filter[path]};
+
+  ranges.push_back (range);
+}
+
+// Sorts the ranges and merges the overlapping and adjacent ones.
+auto
+normalize (LineFilter& filter) -> void
+{
+  for (auto& [path, ranges] : filter)
+  {
+    std::vector<LineRange> merged;
+
+    std::sort (ranges.begin (),
+               ranges.end (),
+               [](LineRange const& lhs, LineRange const& rhs)
+               {
+                 return lhs.first < rhs.first;
+               });
+    for (auto const& range : ranges)
+    {
+      if (!merged.empty () && range.first <= merged.back ().last + 1u)
+      {
+        merged.back ().last = std::max (merged.back ().last, range.last);
+      }
+      else
+      {
+        merged.push_back (range);
+      }
+    }
+    ranges = std::move (merged);
+  }
+}
+
+// Parses "<start>[,<count>]" of a hunk header.
+auto
+parse_hunk_range (std::string_view str) -> std::optional<LineRange>
+{
+  auto const comma {str.find (',')};
+  auto const start {parse_number (str.substr (0, comma))};
+  auto const count {(comma == std::string_view::npos) ?
+                    std::optional<std::uint32_t> {1u} :
+                    parse_number (str.substr (comma + 1))};
+
+  if (!start || !count)
+  {
+    return {};
+  }
+
+  // Not a real range, the count is kept in the last member.
+  return {{*start, *count}};
+}
+
+} // anonymous namespace
+
+auto
+make_path_filter (std::vector<std::string> const& includes,
+                  std::vector<std::string> const& excludes) -> PathFilter
+{
+  PathFilter filter {{{}}, !includes.empty ()};
+
+  for (auto const& prefix : includes)
+  {
+    add_prefix (filter, prefix, true);
+  }
+  for (auto const& prefix : excludes)
+  {
+    add_prefix (filter, prefix, false);
+  }
+
+  return filter;
+}
+
+auto
+path_is_wanted (PathFilter const& filter,
+                std::string_view path) -> bool
+{
+  auto node {&filter.nodes.front ()};
+  auto wanted {node->include.value_or (!filter.has_includes)};
+
+  for (auto idx {0u}; idx < path.size (); ++idx)
+  {
+    auto const byte {path[idx]};
+    auto const iter {std::lower_bound (node->bytes.begin (), node->bytes.end (), byte)};
+
+    if (iter == node->bytes.end () || *iter != byte)
+    {
+      break;
+    }
+    node = &filter.nodes[node->children[std::distance (node->bytes.begin (), iter)]];
+
+    // The prefix needs to end at a path component boundary.
+    auto const at_boundary {byte == '/' || idx + 1u == path.size () || path[idx + 1u] == '/'};
+
+    if (node->include && at_boundary)
+    {
+      wanted = *node->include;
+    }
+  }
+
+  return wanted;
+}
+
+auto
+parse_unified_diff (std::string_view contents) -> std::optional<LineFilter>
+{
+  LineFilter filter;
+  // Empty while outside of a file or in a deleted one.
+  std::optional<std::string> path;
+  auto old_left {0u};
+  auto new_left {0u};
+  auto new_line {0u};
+
+  while (!contents.empty ())
+  {
+    auto const line {next_line (contents)};
+
+    if (old_left > 0u || new_left > 0u)
+    {
+      auto const kind {line.empty () ? ' ' : line.front ()};
+
+      switch (kind)
+      {
+      case ' ':
+        if (old_left == 0u || new_left == 0u)
+        {
+          return {};
+        }
+        --old_left;
+        --new_left;
+        ++new_line;
+        break;
+      case '-':
+        if (old_left == 0u)
+        {
+          return {};
+        }
+        --old_left;
+        break;
+      case '+':
+        if (new_left == 0u)
+        {
+          return {};
+        }
+        if (path)
+        {
+          add_lines (filter, *path, {new_line, new_line});
+        }
+        --new_left;
+        ++new_line;
+        break;
+      case '\\':
+        // "\ No newline at end of file"
+        break;
+      default:
+        return {};
+      }
+      continue;
+    }
+
+    if (starts_with (line, "+++ "))
+    {
+      auto name {line.substr (4u)};
+
+      // Some diffs put a timestamp after the path.
+      name = name.substr (0, name.find ('\t'));
+      if (name == "/dev/null")
+      {
+        path.reset ();
+        continue;
+      }
+      if (starts_with (name, "b/"))
+      {
+        name.remove_prefix (2u);
+      }
+      path = std::string {name};
+    }
+    else if (starts_with (line, "@@ -"))
+    {
+      auto const plus {line.find (" +", 4u)};
+      auto const end {line.find (" @@", 4u)};
+
+      if (plus == std::string_view::npos || end == std::string_view::npos || end < plus)
+      {
+        return {};
+      }
+
+      auto const old_range {parse_hunk_range (line.substr (4u, plus - 4u))};
+      auto const new_range {parse_hunk_range (line.substr (plus + 2u, end - plus - 2u))};
+
+      if (!old_range || !new_range)
+      {
+        return {};
+      }
+      old_left = old_range->last;
+      new_left = new_range->last;
+      new_line = new_range->first;
+    }
+    // Other lines, like "diff --git" or "index", do not matter.
+  }
+  if (old_left > 0u || new_left > 0u)
+  {
+    return {};
+  }
+  normalize (filter);
+
+  return {std::move (filter)};
+}
+
+auto
+parse_line_ranges (std::string_view contents) -> std::optional<LineFilter>
+{
+  LineFilter filter;
+
+  while (!contents.empty ())
+  {
+    auto const line {next_line (contents)};
+
+    if (line.empty ())
+    {
+      continue;
+    }
+
+    // Paths may contain colons, the lines may not.
+    auto const colon {line.rfind (':')};
+
+    if (colon == std::string_view::npos || colon == 0u)
+    {
+      return {};
+    }
+
+    auto const lines {line.substr (colon + 1u)};
+    auto const dash {lines.find ('-')};
+    auto const first {parse_number (lines.substr (0, dash))};
+    auto const last {(dash == std::string_view::npos) ? first : parse_number (lines.substr (dash + 1u))};
+
+    if (!first || !last || *first > *last)
+    {
+      return {};
+    }
+    add_lines (filter, std::string {line.substr (0, colon)}, {*first, *last});
+  }
+  normalize (filter);
+
+  return {std::move (filter)};
+}
+
+auto
+parse_line_filter (std::string_view contents) -> std::optional<LineFilter>
+{
+  if (starts_with (contents, "diff ") || starts_with (contents, "--- "))
+  {
+    return parse_unified_diff (contents);
+  }
+
+  return parse_line_ranges (contents);
+}
+
+auto
+lines_are_wanted (LineFilter const& filter,
+                  std::string_view path,
+                  std::uint32_t first,
+                  std::uint32_t last) -> bool
+{
+  auto const ranges_wanted {
+    [first, last](std::vector<LineRange> const& ranges)
+    {
+      auto const iter {std::lower_bound (ranges.begin (),
+                                         ranges.end (),
+                                         first,
+                                         [](LineRange const& range, std::uint32_t line)
+                                         {
+                                           return range.last < line;
+                                         })};
+
+      return iter != ranges.end () && iter->first <= last;
+    }
+  };
+
+  for (auto tail {path};;)
+  {
+    if (auto const iter {filter.find (std::string {tail})}; iter != filter.end ())
+    {
+      return ranges_wanted (iter->second);
+    }
+
+    auto const slash {tail.find ('/')};
+
+    if (slash == std::string_view::npos)
+    {
+      return false;
+    }
+    tail.remove_prefix (slash + 1u);
+  }
+}
+
+} // namespace Ggp::Lib
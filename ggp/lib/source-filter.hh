@@ -0,0 +1,109 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_SOURCE_FILTER_HH_CHECK >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: map >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_SOURCE_FILTER_HH
+#define GGP_LIB_SOURCE_FILTER_HH
+
+#define GGP_LIB_SOURCE_FILTER_HH_CHECK_VALUE GGP_LIB_SOURCE_FILTER_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+GGP_LIB_STRUCT (PathTrieNode,
+                // Bytes leading to the children, sorted, and the
+                // indices of the children in the same order.
+                std::vector<char>, bytes,
+                std::vector<std::uint32_t>, children,
+                // Set if a prefix ends here, true for an include one.
+                std::optional<bool>, include);
+
+// Include and exclude path prefixes in a trie, so matching a path
+// takes one walk over its bytes, however many prefixes there are.
+GGP_LIB_STRUCT (PathFilter,
+                // The first node is the root.
+                std::vector<PathTrieNode>, nodes,
+                bool, has_includes);
+
+// A prefix given both as an include and as an exclude one is an
+// exclude one.
+auto
+make_path_filter (std::vector<std::string> const& includes,
+                  std::vector<std::string> const& excludes) -> PathFilter;
+
+// The longest prefix matching the path decides. If none matches, the
+// path is wanted only if there are no include prefixes. Prefixes
+// match whole path components, so "src" matches "src" and "src/a.c",
+// but not "src2/a.c".
+auto
+path_is_wanted (PathFilter const& filter,
+                std::string_view path) -> bool;
+
+GGP_LIB_STRUCT (LineRange,
+                std::uint32_t, first,
+                std::uint32_t, last);
+
+// Sorted, non-overlapping ranges of the lines of interest, by file.
+using LineFilter = std::map<std::string, std::vector<LineRange>>;
+
+// Takes the lines added or changed by a unified diff, as made by
+// diff -u or git diff. The "b/" prefix git puts on the paths is
+// dropped. Empty if the diff is malformed.
+auto
+parse_unified_diff (std::string_view contents) -> std::optional<LineFilter>;
+
+// Parses lines like:
+//
+//   <path>:<line>
+//   <path>:<first line>-<last line>
+//
+// Empty lines are skipped. Empty if the contents are malformed.
+auto
+parse_line_ranges (std::string_view contents) -> std::optional<LineFilter>;
+
+// Parses a unified diff if the contents look like one, otherwise the
+// line ranges.
+auto
+parse_line_filter (std::string_view contents) -> std::optional<LineFilter>;
+
+// Whether any line from first to last in the file is of interest.
+// Paths in the filter are usually relative to the top of the
+// project, so they match the path if they are equal to it or to its
+// tail following a slash.
+auto
+lines_are_wanted (LineFilter const& filter,
+                  std::string_view path,
+                  std::uint32_t first,
+                  std::uint32_t last) -> bool;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_SOURCE_FILTER_HH_CHECK_VALUE != GGP_LIB_SOURCE_FILTER_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_SOURCE_FILTER_HH */
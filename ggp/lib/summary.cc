@@ -0,0 +1,748 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: summary.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: algorithm >*/
+/*< stl: charconv >*/
+/*< stl: cstddef >*/
+/*< stl: iterator >*/
+/*< stl: map >*/
+/*< stl: sstream >*/
+/*< stl: string >*/
+/*< stl: unordered_map >*/
+/*< stl: utility >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto const summary_magic {std::string_view {"ggp-summary "}};
+
+auto
+parse_number (std::string_view str) -> std::optional<std::uint32_t>
+{
+  std::uint32_t number {};
+  auto const end {str.data () + str.size ()};
+  auto const [ptr, ec] {std::from_chars (str.data (), end, number)};
+
+  if (str.empty () || ec != std::errc {} || ptr != end)
+  {
+    return {};
+  }
+
+  return {number};
+}
+
+auto
+parse_flag (std::string_view str) -> std::optional<bool>
+{
+  if (str == "0")
+  {
+    return {false};
+  }
+  if (str == "1")
+  {
+    return {true};
+  }
+
+  return {};
+}
+
+auto
+parse_use (std::string_view str) -> std::optional<FormatUse>
+{
+  if (str == "new")
+  {
+    return {FormatUse::New};
+  }
+  if (str == "get")
+  {
+    return {FormatUse::Get};
+  }
+
+  return {};
+}
+
+// Takes the next line without the newline, all lines need to end
+// with one.
+auto
+next_line (std::string_view& contents) -> std::optional<std::string_view>
+{
+  auto const newline {contents.find ('\n')};
+
+  if (newline == std::string_view::npos)
+  {
+    return {};
+  }
+
+  auto const line {contents.substr (0, newline)};
+
+  contents.remove_prefix (newline + 1);
+
+  return {line};
+}
+
+auto
+split_fields (std::string_view line) -> std::vector<std::string_view>
+{
+  std::vector<std::string_view> fields;
+
+  for (;;)
+  {
+    auto const tab {line.find ('\t')};
+
+    fields.push_back (line.substr (0, tab));
+    if (tab == std::string_view::npos)
+    {
+      break;
+    }
+    line.remove_prefix (tab + 1);
+  }
+
+  return fields;
+}
+
+auto
+escape (std::string_view text) -> std::string
+{
+  std::string escaped;
+
+  escaped.reserve (text.size ());
+  for (auto c : text)
+  {
+    switch (c)
+    {
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    default:
+      escaped += c;
+      break;
+    }
+  }
+
+  return escaped;
+}
+
+auto
+unescape (std::string_view text) -> std::optional<std::string>
+{
+  std::string unescaped;
+
+  unescaped.reserve (text.size ());
+  for (auto idx {0u}; idx < text.size (); ++idx)
+  {
+    if (text[idx] != '\\')
+    {
+      unescaped += text[idx];
+      continue;
+    }
+    if (++idx == text.size ())
+    {
+      return {};
+    }
+    switch (text[idx])
+    {
+    case '\\':
+      unescaped += '\\';
+      break;
+    case 't':
+      unescaped += '\t';
+      break;
+    case 'n':
+      unescaped += '\n';
+      break;
+    default:
+      return {};
+    }
+  }
+
+  return {std::move (unescaped)};
+}
+
+auto
+parse_sink (std::vector<std::string_view> const& fields) -> std::optional<FormatSink>
+{
+  if (fields.size () != 6u)
+  {
+    return {};
+  }
+
+  auto function {unescape (fields[1])};
+  auto const use {parse_use (fields[2])};
+  auto const string_index {parse_number (fields[3])};
+  auto const args_index {parse_number (fields[4])};
+  auto const va_list {parse_flag (fields[5])};
+
+  if (!function || !use || !string_index || !args_index || !va_list)
+  {
+    return {};
+  }
+
+  return {{std::move (*function), *use, *string_index, *args_index, *va_list}};
+}
+
+auto
+parse_function (std::vector<std::string_view> const& fields) -> std::optional<FunctionSummary>
+{
+  if (fields.size () != 4u)
+  {
+    return {};
+  }
+
+  auto name {unescape (fields[1])};
+  auto const params_count {parse_number (fields[2])};
+  auto const variadic {parse_flag (fields[3])};
+
+  if (!name || !params_count || !variadic)
+  {
+    return {};
+  }
+
+  return {{std::move (*name), *params_count, *variadic, {}, {}}};
+}
+
+auto
+parse_pass (std::vector<std::string_view> const& fields) -> std::optional<ParamPass>
+{
+  if (fields.size () != 4u)
+  {
+    return {};
+  }
+
+  auto const param {parse_number (fields[1])};
+  auto callee {unescape (fields[2])};
+  auto const position {parse_number (fields[3])};
+
+  if (!param || !callee || !position)
+  {
+    return {};
+  }
+
+  return {{*param, std::move (*callee), *position}};
+}
+
+auto
+parse_call (std::vector<std::string_view> const& fields) -> std::optional<LiteralCall>
+{
+  if (fields.size () != 8u)
+  {
+    return {};
+  }
+
+  auto callee {unescape (fields[1])};
+  auto const position {parse_number (fields[2])};
+  auto file {unescape (fields[3])};
+  auto const line {parse_number (fields[4])};
+  auto const column {parse_number (fields[5])};
+  auto arg_kinds {unescape (fields[6])};
+  auto literal {unescape (fields[7])};
+
+  if (!callee || !position || !file || !line || !column || !arg_kinds || !literal)
+  {
+    return {};
+  }
+
+  return {{std::move (*callee),
+           *position,
+           std::move (*literal),
+           std::move (*file),
+           *line,
+           *column,
+           std::move (*arg_kinds)}};
+}
+
+auto
+use_string (FormatUse use) -> char const*
+{
+  return (use == FormatUse::New) ? "new" : "get";
+}
+
+auto
+kind_name (char kind) -> char const*
+{
+  switch (kind)
+  {
+  case 'i':
+    return "int";
+  case 'x':
+    return "64-bit integer";
+  case 'd':
+    return "double";
+  case 'p':
+    return "pointer";
+  case '0':
+    return "literal zero";
+  default:
+    return "unknown";
+  }
+}
+
+using SinksByFunction = std::unordered_map<std::string_view, std::vector<FormatSink const*>>;
+
+auto
+index_sinks (std::vector<FormatSink> const& sinks,
+             SinksByFunction& by_function) -> void
+{
+  for (auto const& sink : sinks)
+  {
+    by_function[sink.function].push_back (&sink);
+  }
+}
+
+auto
+find_sink (SinksByFunction const& by_function,
+           std::string_view function,
+           std::uint32_t string_index) -> FormatSink const*
+{
+  auto const iter {by_function.find (function)};
+
+  if (iter == by_function.end ())
+  {
+    return nullptr;
+  }
+  for (auto sink : iter->second)
+  {
+    if (sink->string_index == string_index)
+    {
+      return sink;
+    }
+  }
+
+  return nullptr;
+}
+
+auto
+check_wrapper_call (LiteralCall const& call,
+                    FormatSink const& wrapper,
+                    std::vector<Diagnostic>& diagnostics) -> void
+{
+  auto const make_diagnostic {
+    [&call](char const* rule,
+            std::string message,
+            std::optional<std::uint32_t> arg_index,
+            std::string expected_type,
+            std::string actual_type) -> Diagnostic
+    {
+      return {rule,
+              std::move (message),
+              call.file,
+              call.line,
+              call.column,
+              call.literal,
+              arg_index,
+              std::move (expected_type),
+              std::move (actual_type)};
+    }
+  };
+  auto const format {VariantFormat::from_string (call.literal)};
+
+  if (!format)
+  {
+    diagnostics.push_back (make_diagnostic ("wpa-invalid-format",
+                                            "invalid variant format passed to " + call.callee,
+                                            {},
+                                            {},
+                                            {}));
+    return;
+  }
+  if (wrapper.args_index == 0u)
+  {
+    return;
+  }
+
+  auto const expected {arg_kinds_for_format (*format, wrapper.use)};
+
+  if (!expected)
+  {
+    return;
+  }
+
+  auto const args_offset {std::min (std::size_t {wrapper.args_index - 1u}, call.arg_kinds.size ())};
+  auto const actual {std::string_view {call.arg_kinds}.substr (args_offset)};
+
+  if (expected->size () != actual.size ())
+  {
+    diagnostics.push_back (make_diagnostic ("wpa-args-count",
+                                            "expected " + std::to_string (expected->size ()) +
+                                            " parameters for " + call.callee +
+                                            ", got " + std::to_string (actual.size ()),
+                                            {},
+                                            {},
+                                            {}));
+    return;
+  }
+  for (auto idx {0u}; idx < actual.size (); ++idx)
+  {
+    if (!arg_kind_matches ((*expected)[idx], actual[idx]))
+    {
+      diagnostics.push_back (make_diagnostic ("wpa-arg-kind",
+                                              "invalid arg " + std::to_string (idx) + " for " + call.callee,
+                                              {idx},
+                                              kind_name ((*expected)[idx]),
+                                              kind_name (actual[idx])));
+    }
+  }
+}
+
+} // anonymous namespace
+
+auto
+summary_to_string (UnitSummary const& summary) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << summary_magic << summary_version << '\n';
+  for (auto const& sink : summary.sinks)
+  {
+    oss << "sink\t"
+        << escape (sink.function) << '\t'
+        << use_string (sink.use) << '\t'
+        << sink.string_index << '\t'
+        << sink.args_index << '\t'
+        << (sink.va_list ? 1 : 0) << '\n';
+  }
+  for (auto const& function : summary.functions)
+  {
+    oss << "function\t"
+        << escape (function.name) << '\t'
+        << function.params_count << '\t'
+        << (function.variadic ? 1 : 0) << '\n';
+    for (auto const& pass : function.passes)
+    {
+      oss << "pass\t"
+          << pass.param << '\t'
+          << escape (pass.callee) << '\t'
+          << pass.position << '\n';
+    }
+    for (auto const& call : function.calls)
+    {
+      oss << "call\t"
+          << escape (call.callee) << '\t'
+          << call.position << '\t'
+          << escape (call.file) << '\t'
+          << call.line << '\t'
+          << call.column << '\t'
+          << escape (call.arg_kinds) << '\t'
+          << escape (call.literal) << '\n';
+    }
+  }
+
+  return oss.str ();
+}
+
+auto
+parse_summary (std::string_view contents) -> std::optional<UnitSummary>
+{
+  auto const header {next_line (contents)};
+
+  if (!header || header->substr (0, summary_magic.size ()) != summary_magic)
+  {
+    return {};
+  }
+  if (auto const version {parse_number (header->substr (summary_magic.size ()))};
+      !version || *version != summary_version)
+  {
+    return {};
+  }
+
+  UnitSummary summary;
+
+  while (!contents.empty ())
+  {
+    auto const line {next_line (contents)};
+
+    if (!line)
+    {
+      return {};
+    }
+
+    auto const fields {split_fields (*line)};
+    auto const& tag {fields.front ()};
+
+    if (tag == "sink")
+    {
+      auto sink {parse_sink (fields)};
+
+      if (!sink)
+      {
+        return {};
+      }
+      summary.sinks.push_back (std::move (*sink));
+    }
+    else if (tag == "function")
+    {
+      auto function {parse_function (fields)};
+
+      if (!function)
+      {
+        return {};
+      }
+      summary.functions.push_back (std::move (*function));
+    }
+    else if (tag == "pass")
+    {
+      auto pass {parse_pass (fields)};
+
+      if (!pass || summary.functions.empty ())
+      {
+        return {};
+      }
+      summary.functions.back ().passes.push_back (std::move (*pass));
+    }
+    else if (tag == "call")
+    {
+      auto call {parse_call (fields)};
+
+      if (!call || summary.functions.empty ())
+      {
+        return {};
+      }
+      summary.functions.back ().calls.push_back (std::move (*call));
+    }
+    else
+    {
+      return {};
+    }
+  }
+
+  return {std::move (summary)};
+}
+
+auto
+merge_summaries (std::vector<UnitSummary> const& summaries) -> UnitSummary
+{
+  UnitSummary merged;
+  std::map<std::pair<std::string_view, std::uint32_t>, std::size_t> sink_indices;
+  std::unordered_map<std::string_view, std::size_t> function_indices;
+
+  for (auto const& summary : summaries)
+  {
+    for (auto const& sink : summary.sinks)
+    {
+      if (sink_indices.emplace (std::make_pair (std::string_view {sink.function}, sink.string_index),
+                                merged.sinks.size ()).second)
+      {
+        merged.sinks.push_back (sink);
+      }
+    }
+    for (auto const& function : summary.functions)
+    {
+      // Inline functions are emitted in every unit using them.
+      if (function_indices.emplace (function.name, merged.functions.size ()).second)
+      {
+        merged.functions.push_back (function);
+      }
+    }
+  }
+
+  return merged;
+}
+
+auto
+find_wrappers (UnitSummary const& summary) -> std::vector<FormatSink>
+{
+  enum class Visit
+  {
+    InProgress,
+    Done,
+  };
+
+  std::unordered_map<std::string_view, FunctionSummary const*> functions;
+  SinksByFunction sinks;
+  std::unordered_map<std::string_view, std::vector<FormatSink>> found;
+  std::vector<std::string_view> found_order;
+  std::unordered_map<std::string_view, Visit> visits;
+
+  for (auto const& function : summary.functions)
+  {
+    functions.emplace (function.name, &function);
+  }
+  index_sinks (summary.sinks, sinks);
+
+  auto const find_any_sink {
+    [&sinks, &found](std::string_view function,
+                     std::uint32_t string_index) -> FormatSink const*
+    {
+      if (auto const sink {find_sink (sinks, function, string_index)}; sink != nullptr)
+      {
+        return sink;
+      }
+      if (auto const iter {found.find (function)}; iter != found.end ())
+      {
+        for (auto const& wrapper : iter->second)
+        {
+          if (wrapper.string_index == string_index)
+          {
+            return &wrapper;
+          }
+        }
+      }
+
+      return nullptr;
+    }
+  };
+  auto const derive_wrappers {
+    [&find_any_sink, &found, &found_order](FunctionSummary const& function)
+    {
+      for (auto const& pass : function.passes)
+      {
+        auto const callee_sink {find_any_sink (pass.callee, pass.position)};
+
+        if (callee_sink == nullptr || find_any_sink (function.name, pass.param) != nullptr)
+        {
+          continue;
+        }
+
+        auto const args_index {(callee_sink->va_list && function.variadic) ? function.params_count + 1u : 0u};
+        auto& function_wrappers {found[function.name]};
+
+        if (function_wrappers.empty ())
+        {
+          found_order.push_back (function.name);
+        }
+        function_wrappers.push_back ({function.name, callee_sink->use, pass.param, args_index, false});
+      }
+    }
+  };
+
+  for (auto const& root : summary.functions)
+  {
+    if (visits.count (root.name) > 0u)
+    {
+      continue;
+    }
+
+    // Iterative depth first search, the stack holds the functions
+    // and the indices of their next passes to follow.
+    std::vector<std::pair<FunctionSummary const*, std::size_t>> stack {{&root, 0u}};
+
+    visits[root.name] = Visit::InProgress;
+    while (!stack.empty ())
+    {
+      auto& [function, next_pass] {stack.back ()};
+
+      if (next_pass < function->passes.size ())
+      {
+        auto const& callee {function->passes[next_pass++].callee};
+        auto const iter {functions.find (callee)};
+
+        // Functions in progress are on a cycle, their wrappers are
+        // not known yet.
+        if (iter != functions.end () && visits.count (callee) == 0u)
+        {
+          visits[callee] = Visit::InProgress;
+          stack.push_back ({iter->second, 0u});
+        }
+        continue;
+      }
+      derive_wrappers (*function);
+      visits[function->name] = Visit::Done;
+      stack.pop_back ();
+    }
+  }
+
+  std::vector<FormatSink> wrappers;
+
+  for (auto const& name : found_order)
+  {
+    auto& function_wrappers {found[name]};
+
+    std::move (function_wrappers.begin (), function_wrappers.end (), std::back_inserter (wrappers));
+  }
+
+  return wrappers;
+}
+
+auto
+check_wrapper_calls (UnitSummary const& summary,
+                     std::vector<FormatSink> const& wrappers) -> std::vector<Diagnostic>
+{
+  SinksByFunction by_function;
+  std::vector<Diagnostic> diagnostics;
+
+  index_sinks (wrappers, by_function);
+  for (auto const& function : summary.functions)
+  {
+    for (auto const& call : function.calls)
+    {
+      if (auto const wrapper {find_sink (by_function, call.callee, call.position)}; wrapper != nullptr)
+      {
+        check_wrapper_call (call, *wrapper, diagnostics);
+      }
+    }
+  }
+
+  return diagnostics;
+}
+
+auto
+wpa_report_to_string (UnitSummary const& summary,
+                      std::vector<FormatSink> const& wrappers) -> std::string
+{
+  SinksByFunction by_function;
+  std::map<std::string_view, std::uint64_t> format_counts;
+  std::uint64_t format_calls {0u};
+
+  index_sinks (summary.sinks, by_function);
+  index_sinks (wrappers, by_function);
+  for (auto const& function : summary.functions)
+  {
+    for (auto const& call : function.calls)
+    {
+      if (find_sink (by_function, call.callee, call.position) != nullptr)
+      {
+        ++format_counts[call.literal];
+        ++format_calls;
+      }
+    }
+  }
+
+  std::vector<std::pair<std::string_view, std::uint64_t>> ranked (format_counts.begin (), format_counts.end ());
+
+  // Formats with the same count stay sorted.
+  std::stable_sort (ranked.begin (),
+                    ranked.end (),
+                    [](auto const& lhs, auto const& rhs)
+                    {
+                      return lhs.second > rhs.second;
+                    });
+
+  std::ostringstream oss;
+
+  oss << "ggp-wpa-report\n"
+      << "functions\t" << summary.functions.size () << '\n'
+      << "wrappers\t" << wrappers.size () << '\n'
+      << "format calls\t" << format_calls << '\n';
+  for (auto const& [format, count] : ranked)
+  {
+    oss << count << '\t' << format << '\n';
+  }
+
+  return oss.str ();
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,159 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_SUMMARY_HH_CHECK >*/
+/*< lib: arg-kind.hh >*/
+/*< lib: sarif.hh >*/
+/*< lib: util.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_SUMMARY_HH
+#define GGP_LIB_SUMMARY_HH
+
+#define GGP_LIB_SUMMARY_HH_CHECK_VALUE GGP_LIB_SUMMARY_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// Summaries of the calls in the functions of translation units, so
+// formats passed through wrapper functions defined in other
+// translation units can be checked when the whole program is seen.
+
+// Needs to be bumped on every incompatible change of the summary
+// format.
+inline constexpr unsigned summary_version {1u};
+
+// A function taking a format string - known from its glib_variant
+// attribute or found to pass its parameter on to the format
+// parameter of another such function, which makes it a wrapper.
+GGP_LIB_STRUCT (FormatSink,
+                std::string, function,
+                FormatUse, use,
+                // 1-based indices of the format string and of the
+                // first vararg. The args index is 0 if the arguments
+                // for the format can't be checked.
+                std::uint32_t, string_index,
+                std::uint32_t, args_index,
+                // Whether the arguments come in a va_list, like in
+                // g_variant_new_va.
+                bool, va_list);
+
+// The function passes its parameter on to another function.
+GGP_LIB_STRUCT (ParamPass,
+                // 1-based index of the parameter.
+                std::uint32_t, param,
+                std::string, callee,
+                // 1-based index of the argument in the call.
+                std::uint32_t, position);
+
+// A call passing a string literal.
+GGP_LIB_STRUCT (LiteralCall,
+                std::string, callee,
+                // 1-based index of the literal in the call.
+                std::uint32_t, position,
+                std::string, literal,
+                std::string, file,
+                std::uint32_t, line,
+                std::uint32_t, column,
+                // A kind for each argument of the call, like in
+                // arg_kinds_for_format, '?' for the ones that can't
+                // be passed through varargs.
+                std::string, arg_kinds);
+
+GGP_LIB_STRUCT (FunctionSummary,
+                // Names of functions local to a translation unit are
+                // made unique by the plugin.
+                std::string, name,
+                std::uint32_t, params_count,
+                bool, variadic,
+                std::vector<ParamPass>, passes,
+                std::vector<LiteralCall>, calls);
+
+GGP_LIB_STRUCT (UnitSummary,
+                // The sinks called in the unit.
+                std::vector<FormatSink>, sinks,
+                std::vector<FunctionSummary>, functions);
+
+// The summary is a text:
+//
+//   ggp-summary <version>
+//   sink\t<function>\t<new|get>\t<string index>\t<args index>\t<va_list 0|1>
+//   function\t<name>\t<params count>\t<variadic 0|1>
+//   pass\t<param>\t<callee>\t<position>
+//   call\t<callee>\t<position>\t<file>\t<line>\t<column>\t<arg kinds>\t<literal>
+//   …
+//
+// The pass and call lines belong to the function before them.
+// Backslashes, tabs and newlines in the texts are escaped with a
+// backslash, as "\\", "\t" and "\n".
+auto
+summary_to_string (UnitSummary const& summary) -> std::string;
+
+// Empty if the summary is malformed or was written by a different
+// version.
+auto
+parse_summary (std::string_view contents) -> std::optional<UnitSummary>;
+
+// Sinks and functions seen in several units are kept once.
+auto
+merge_summaries (std::vector<UnitSummary> const& summaries) -> UnitSummary;
+
+// Finds the wrappers of the sinks, including the wrappers of other
+// wrappers. The callees are handled before their callers, so a
+// single bottom-up pass over the call graph resolves whole chains.
+// Cycles of recursive functions are cut. A wrapper gets arguments to
+// check only if it is variadic and hands its varargs over to a sink
+// taking a va_list.
+auto
+find_wrappers (UnitSummary const& summary) -> std::vector<FormatSink>;
+
+// Checks the string literals passed as formats to the wrappers. The
+// direct calls of the sinks are left out, the variant checker has
+// seen them.
+auto
+check_wrapper_calls (UnitSummary const& summary,
+                     std::vector<FormatSink> const& wrappers) -> std::vector<Diagnostic>;
+
+// The report is a text file:
+//
+//   ggp-wpa-report
+//   functions\t<count>
+//   wrappers\t<count>
+//   format calls\t<count>
+//   <count>\t<format>
+//   …
+//
+// The format calls pass string literals as formats to the sinks or
+// to the wrappers. The formats are listed by how many calls pass
+// them, the most used first.
+auto
+wpa_report_to_string (UnitSummary const& summary,
+                      std::vector<FormatSink> const& wrappers) -> std::string;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_SUMMARY_HH_CHECK_VALUE != GGP_LIB_SUMMARY_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_SUMMARY_HH */
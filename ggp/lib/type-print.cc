@@ -180,6 +180,14 @@ print_types (std::ostream& os, Types const& types) -> void
 
 } // anonymous namespace
 
+auto
+operator<< (std::ostream& os, Type const& type) -> std::ostream&
+{
+  print_type (os, type);
+
+  return os;
+}
+
 auto
 operator<< (std::ostream& os, Types const& types) -> std::ostream&
 {
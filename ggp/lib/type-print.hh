@@ -27,8 +27,12 @@
 namespace Ggp::Lib
 {
 
+class Type;
 class Types;
 
+auto
+operator<< (std::ostream& os, Type const& type) -> std::ostream&;
+
 auto
 operator<< (std::ostream& os, Types const& types) -> std::ostream&;
 
@@ -0,0 +1,1637 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< lib: util.hh >*/
+/*< lib: value.hh >*/
+/*< lib: variant-print.hh >*/
+/*< lib: variant-text.hh >*/
+/*< stl: cerrno >*/
+/*< stl: cstdint >*/
+/*< stl: cstdlib >*/
+/*< stl: limits >*/
+/*< stl: map >*/
+/*< stl: optional >*/
+/*< stl: sstream >*/
+/*< stl: string >*/
+/*< stl: utility >*/
+/*< stl: variant >*/
+/*< stl: vector >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+struct TextNode;
+
+// text node - a parsed value with its type not known yet
+namespace TN
+{
+
+// Kept as text, the type decides how to read it.
+struct Number
+{
+  std::string token;
+};
+
+struct String
+{
+  std::string value;
+};
+
+struct Bool
+{
+  bool value;
+};
+
+// Without the terminating zero byte.
+struct ByteString
+{
+  std::string bytes;
+};
+
+struct Nothing
+{};
+
+struct Just
+{
+  Value<TextNode> node;
+};
+
+struct Array
+{
+  std::vector<TextNode> nodes;
+};
+
+struct Tuple
+{
+  std::vector<TextNode> nodes;
+};
+
+struct Dictionary
+{
+  std::vector<TextNode> keys;
+  std::vector<TextNode> values;
+};
+
+struct Entry
+{
+  Value<TextNode> key;
+  Value<TextNode> value;
+};
+
+// A value in angle brackets.
+struct Boxed
+{
+  Value<TextNode> node;
+};
+
+// A value after "@type" or a type keyword.
+struct Typed
+{
+  VariantType type;
+  Value<TextNode> node;
+};
+
+} // namespace TN
+
+struct TextNode
+{
+  using V = std::variant
+  <
+  TN::Number,
+  TN::String,
+  TN::Bool,
+  TN::ByteString,
+  TN::Nothing,
+  TN::Just,
+  TN::Array,
+  TN::Tuple,
+  TN::Dictionary,
+  TN::Entry,
+  TN::Boxed,
+  TN::Typed
+  >;
+
+  V v;
+  // Where the value starts in the text.
+  std::size_t offset;
+};
+
+auto
+error_at (std::size_t offset,
+          std::string reason) -> VariantParseErrorCascade
+{
+  return {{{{offset, std::move (reason)}}}};
+}
+
+auto
+error_at (std::size_t offset,
+          std::string reason,
+          VariantParseErrorCascade& error) -> VariantParseErrorCascade
+{
+  VariantParseErrorCascade e;
+
+  e.errors.swap (error.errors);
+  e.errors.push_back ({offset, std::move (reason)});
+
+  return e;
+}
+
+auto
+is_whitespace (char c) -> bool
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+auto
+is_word_char (char c) -> bool
+{
+  return (c >= 'a' && c <= 'z') ||
+    (c >= 'A' && c <= 'Z') ||
+    (c >= '0' && c <= '9') ||
+    c == '_' || c == '+' || c == '-' || c == '.';
+}
+
+struct TextState
+{
+  // Skips the whitespace and returns the next character without
+  // taking it.
+  auto
+  peek () -> std::optional<char>;
+  auto
+  take_one () -> std::optional<char>;
+  auto
+  take_word () -> std::string_view;
+  auto
+  get_rest () const -> std::string_view;
+
+  auto
+  error (std::string reason) const -> VariantParseErrorCascade;
+  auto
+  error (std::string reason, VariantParseErrorCascade& error) const -> VariantParseErrorCascade;
+
+  std::string_view string;
+  std::size_t offset;
+};
+
+auto
+TextState::peek () -> std::optional<char>
+{
+  while (this->offset < this->string.size () && is_whitespace (this->string[this->offset]))
+  {
+    ++this->offset;
+  }
+  if (this->offset < this->string.size ())
+  {
+    return {this->string[this->offset]};
+  }
+
+  return {};
+}
+
+auto
+TextState::take_one () -> std::optional<char>
+{
+  if (this->offset < this->string.size ())
+  {
+    auto c {this->string[this->offset]};
+
+    ++this->offset;
+
+    return {c};
+  }
+
+  return {};
+}
+
+auto
+TextState::take_word () -> std::string_view
+{
+  auto const start {this->offset};
+
+  while (this->offset < this->string.size () && is_word_char (this->string[this->offset]))
+  {
+    ++this->offset;
+  }
+
+  return this->string.substr (start, this->offset - start);
+}
+
+auto
+TextState::get_rest () const -> std::string_view
+{
+  if (this->offset < this->string.size ())
+  {
+    return this->string.substr (this->offset);
+  }
+
+  return {};
+}
+
+auto
+TextState::error (std::string reason) const -> VariantParseErrorCascade
+{
+  return error_at (this->offset, std::move (reason));
+}
+
+auto
+TextState::error (std::string reason, VariantParseErrorCascade& error) const -> VariantParseErrorCascade
+{
+  return error_at (this->offset, std::move (reason), error);
+}
+
+template <typename ParsedP>
+struct ParseResult
+{
+  ParsedP parsed;
+  TextState state;
+};
+
+auto
+type_to_string (VariantType const& type) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << type;
+
+  return oss.str ();
+}
+
+// The type keywords, like in "uint64 5".
+std::map<std::string_view, char const*> const type_keywords {
+  {"boolean", "b"},
+  {"byte", "y"},
+  {"int16", "n"},
+  {"uint16", "q"},
+  {"int32", "i"},
+  {"uint32", "u"},
+  {"int64", "x"},
+  {"uint64", "t"},
+  {"handle", "h"},
+  {"double", "d"},
+  {"string", "s"},
+  {"objectpath", "o"},
+  {"signature", "g"},
+};
+
+auto
+append_utf8 (std::string& string,
+             std::uint32_t code_point) -> void
+{
+  if (code_point < 0x80u)
+  {
+    string += static_cast<char> (code_point);
+  }
+  else if (code_point < 0x800u)
+  {
+    string += static_cast<char> (0xc0u | (code_point >> 6));
+    string += static_cast<char> (0x80u | (code_point & 0x3fu));
+  }
+  else if (code_point < 0x10000u)
+  {
+    string += static_cast<char> (0xe0u | (code_point >> 12));
+    string += static_cast<char> (0x80u | ((code_point >> 6) & 0x3fu));
+    string += static_cast<char> (0x80u | (code_point & 0x3fu));
+  }
+  else
+  {
+    string += static_cast<char> (0xf0u | (code_point >> 18));
+    string += static_cast<char> (0x80u | ((code_point >> 12) & 0x3fu));
+    string += static_cast<char> (0x80u | ((code_point >> 6) & 0x3fu));
+    string += static_cast<char> (0x80u | (code_point & 0x3fu));
+  }
+}
+
+auto
+digit_value (char c) -> unsigned
+{
+  if (c >= '0' && c <= '9')
+  {
+    return static_cast<unsigned> (c - '0');
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return static_cast<unsigned> (c - 'a' + 10);
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return static_cast<unsigned> (c - 'A' + 10);
+  }
+
+  return 16u;
+}
+
+using ParseStringResult = ParseResult<std::string>;
+
+// Strings take the "\u" and "\U" escapes, byte strings take octal
+// ones instead. Other escaped characters stand for themselves.
+auto
+parse_string (TextState state,
+              bool bytes) -> VariantResult<ParseStringResult>
+{
+  auto const quote {*state.take_one ()};
+  std::string value;
+
+  for (;;)
+  {
+    auto maybe_c {state.take_one ()};
+
+    if (!maybe_c)
+    {
+      return {{state.error ("unterminated string constant")}};
+    }
+    if (*maybe_c == quote)
+    {
+      return {{ParseStringResult {std::move (value), state}}};
+    }
+    if (*maybe_c != '\\')
+    {
+      value += *maybe_c;
+      continue;
+    }
+
+    auto maybe_escaped {state.take_one ()};
+
+    if (!maybe_escaped)
+    {
+      return {{state.error ("unterminated string constant")}};
+    }
+
+    switch (*maybe_escaped)
+    {
+    case 'u':
+    case 'U':
+      if (!bytes)
+      {
+        auto const digits {(*maybe_escaped == 'u') ? 4u : 8u};
+        std::uint32_t code_point {0u};
+
+        for (auto idx {0u}; idx < digits; ++idx)
+        {
+          auto maybe_digit {state.take_one ()};
+
+          if (!maybe_digit || digit_value (*maybe_digit) >= 16u)
+          {
+            return {{state.error ("invalid unicode escape")}};
+          }
+          code_point = (code_point << 4) | digit_value (*maybe_digit);
+        }
+        if (code_point > 0x10ffffu || (code_point >= 0xd800u && code_point < 0xe000u))
+        {
+          return {{state.error ("invalid unicode escape")}};
+        }
+        append_utf8 (value, code_point);
+      }
+      else
+      {
+        value += *maybe_escaped;
+      }
+      break;
+    case 'a':
+      value += '\a';
+      break;
+    case 'b':
+      value += '\b';
+      break;
+    case 'f':
+      value += '\f';
+      break;
+    case 'n':
+      value += '\n';
+      break;
+    case 'r':
+      value += '\r';
+      break;
+    case 't':
+      value += '\t';
+      break;
+    case 'v':
+      value += '\v';
+      break;
+    default:
+      if (bytes && *maybe_escaped >= '0' && *maybe_escaped <= '7')
+      {
+        unsigned byte {digit_value (*maybe_escaped)};
+
+        for (auto idx {0u}; idx < 2u; ++idx)
+        {
+          auto maybe_digit {state.take_one ()};
+
+          if (!maybe_digit || *maybe_digit < '0' || *maybe_digit > '7')
+          {
+            if (maybe_digit)
+            {
+              --state.offset;
+            }
+            break;
+          }
+          byte = (byte << 3) | digit_value (*maybe_digit);
+        }
+        value += static_cast<char> (byte & 0xffu);
+      }
+      else
+      {
+        value += *maybe_escaped;
+      }
+      break;
+    }
+  }
+}
+
+using ParseNodeResult = ParseResult<TextNode>;
+
+auto
+parse_value (TextState state) -> VariantResult<ParseNodeResult>;
+
+using ParseNodesResult = ParseResult<std::vector<TextNode>>;
+
+// Parses comma separated values up to the closing character. A tuple
+// with a single value needs a comma after it, like "(1,)".
+auto
+parse_list (TextState state,
+            char close,
+            bool tuple) -> VariantResult<ParseNodesResult>
+{
+  std::vector<TextNode> nodes;
+
+  if (state.peek () == close)
+  {
+    state.take_one ();
+    return {{ParseNodesResult {std::move (nodes), state}}};
+  }
+
+  for (;;)
+  {
+    auto maybe_result {parse_value (state)};
+
+    if (!maybe_result)
+    {
+      std::ostringstream oss;
+
+      oss << "failed to parse value number " << nodes.size () + 1;
+      return {{state.error (oss.str (), maybe_result.get_failure ())}};
+    }
+    state = maybe_result->state;
+    nodes.push_back (std::move (maybe_result->parsed));
+
+    auto maybe_c {state.peek ()};
+
+    if (maybe_c == ',')
+    {
+      state.take_one ();
+      if (tuple && nodes.size () == 1u && state.peek () == close)
+      {
+        state.take_one ();
+        return {{ParseNodesResult {std::move (nodes), state}}};
+      }
+      continue;
+    }
+    if (maybe_c == close)
+    {
+      if (tuple && nodes.size () == 1u)
+      {
+        return {{state.error ("expected ',' after the only tuple member")}};
+      }
+      state.take_one ();
+      return {{ParseNodesResult {std::move (nodes), state}}};
+    }
+
+    std::ostringstream oss;
+
+    oss << "expected ',' or '" << close << "'";
+    return {{state.error (oss.str ())}};
+  }
+}
+
+// Parses what comes after '{' - an empty dictionary, a dictionary
+// with "key: value" pairs or a single "key, value" entry.
+auto
+parse_dictionary (TextState state,
+                  std::size_t offset) -> VariantResult<ParseNodeResult>
+{
+  if (state.peek () == '}')
+  {
+    state.take_one ();
+    return {{ParseNodeResult {{TN::Dictionary {{}, {}}, offset}, state}}};
+  }
+
+  std::vector<TextNode> keys;
+  std::vector<TextNode> values;
+
+  for (;;)
+  {
+    auto maybe_key {parse_value (state)};
+
+    if (!maybe_key)
+    {
+      return {{state.error ("failed to parse a dictionary key", maybe_key.get_failure ())}};
+    }
+    state = maybe_key->state;
+
+    auto maybe_c {state.peek ()};
+
+    if (keys.empty () && maybe_c == ',')
+    {
+      state.take_one ();
+
+      auto maybe_value {parse_value (state)};
+
+      if (!maybe_value)
+      {
+        return {{state.error ("failed to parse a dictionary entry value", maybe_value.get_failure ())}};
+      }
+      state = maybe_value->state;
+      if (state.peek () != '}')
+      {
+        return {{state.error ("expected '}' after a dictionary entry value")}};
+      }
+      state.take_one ();
+      return {{ParseNodeResult {{TN::Entry {std::move (maybe_key->parsed), std::move (maybe_value->parsed)}, offset}, state}}};
+    }
+    if (maybe_c != ':')
+    {
+      return {{state.error ("expected ':' after a dictionary key")}};
+    }
+    state.take_one ();
+
+    auto maybe_value {parse_value (state)};
+
+    if (!maybe_value)
+    {
+      return {{state.error ("failed to parse a dictionary value", maybe_value.get_failure ())}};
+    }
+    state = maybe_value->state;
+    keys.push_back (std::move (maybe_key->parsed));
+    values.push_back (std::move (maybe_value->parsed));
+
+    maybe_c = state.peek ();
+    if (maybe_c == '}')
+    {
+      state.take_one ();
+      return {{ParseNodeResult {{TN::Dictionary {std::move (keys), std::move (values)}, offset}, state}}};
+    }
+    if (maybe_c != ',')
+    {
+      return {{state.error ("expected ',' or '}' after a dictionary value")}};
+    }
+    state.take_one ();
+  }
+}
+
+// Length of the type string at the start of the text, which may be
+// followed by other things.
+auto
+type_string_size (std::string_view text) -> std::size_t
+{
+  std::size_t depth {0u};
+
+  for (auto idx {0u}; idx < text.size (); ++idx)
+  {
+    switch (text[idx])
+    {
+    case 'a':
+    case 'm':
+      continue;
+    case '(':
+    case '{':
+      ++depth;
+      continue;
+    case ')':
+    case '}':
+      if (depth == 0u)
+      {
+        return idx;
+      }
+      --depth;
+      break;
+    default:
+      break;
+    }
+    if (depth == 0u)
+    {
+      return idx + 1u;
+    }
+  }
+
+  return text.size ();
+}
+
+using ParseTypedResult = ParseResult<TN::Typed>;
+
+auto
+parse_typed_value (TextState state,
+                   VariantType type) -> VariantResult<ParseTypedResult>
+{
+  auto maybe_result {parse_value (state)};
+
+  if (!maybe_result)
+  {
+    return {{state.error ("failed to parse a value after its type", maybe_result.get_failure ())}};
+  }
+
+  return {{ParseTypedResult {TN::Typed {std::move (type), std::move (maybe_result->parsed)}, maybe_result->state}}};
+}
+
+auto
+parse_value (TextState state) -> VariantResult<ParseNodeResult>
+{
+  auto maybe_c {state.peek ()};
+
+  if (!maybe_c)
+  {
+    return {{state.error ("expected a value, got premature end of a text")}};
+  }
+
+  auto const offset {state.offset};
+  auto const rest {state.get_rest ()};
+
+  switch (*maybe_c)
+  {
+  case '(':
+  case '[':
+    {
+      auto const is_tuple {*maybe_c == '('};
+
+      state.take_one ();
+
+      auto maybe_result {parse_list (state, is_tuple ? ')' : ']', is_tuple)};
+
+      if (!maybe_result)
+      {
+        return {{state.error (is_tuple ? "failed to parse a tuple" : "failed to parse an array", maybe_result.get_failure ())}};
+      }
+      if (is_tuple)
+      {
+        return {{ParseNodeResult {{TN::Tuple {std::move (maybe_result->parsed)}, offset}, maybe_result->state}}};
+      }
+      return {{ParseNodeResult {{TN::Array {std::move (maybe_result->parsed)}, offset}, maybe_result->state}}};
+    }
+  case '{':
+    state.take_one ();
+    return parse_dictionary (state, offset);
+  case '<':
+    {
+      state.take_one ();
+
+      auto maybe_result {parse_value (state)};
+
+      if (!maybe_result)
+      {
+        return {{state.error ("failed to parse a variant", maybe_result.get_failure ())}};
+      }
+      state = maybe_result->state;
+      if (state.peek () != '>')
+      {
+        return {{state.error ("expected '>' after a variant value")}};
+      }
+      state.take_one ();
+      return {{ParseNodeResult {{TN::Boxed {std::move (maybe_result->parsed)}, offset}, state}}};
+    }
+  case '@':
+    {
+      auto const type_string {rest.substr (1u, type_string_size (rest.substr (1u)))};
+      auto maybe_type {VariantType::from_string (type_string)};
+
+      if (!maybe_type)
+      {
+        return {{state.error ("failed to parse a type after '@'", maybe_type.get_failure ())}};
+      }
+      state.offset += 1u + type_string.size ();
+
+      auto maybe_result {parse_typed_value (state, std::move (*maybe_type))};
+
+      if (!maybe_result)
+      {
+        return {{std::move (maybe_result.get_failure ())}};
+      }
+      return {{ParseNodeResult {{std::move (maybe_result->parsed), offset}, maybe_result->state}}};
+    }
+  case '\'':
+  case '"':
+    {
+      auto maybe_result {parse_string (state, false)};
+
+      if (!maybe_result)
+      {
+        return {{std::move (maybe_result.get_failure ())}};
+      }
+      return {{ParseNodeResult {{TN::String {std::move (maybe_result->parsed)}, offset}, maybe_result->state}}};
+    }
+  case '%':
+    return {{state.error ("positional parameters are not supported")}};
+  default:
+    break;
+  }
+
+  if (*maybe_c == 'b' && rest.size () > 1u && (rest[1] == '\'' || rest[1] == '"'))
+  {
+    state.take_one ();
+
+    auto maybe_result {parse_string (state, true)};
+
+    if (!maybe_result)
+    {
+      return {{std::move (maybe_result.get_failure ())}};
+    }
+    return {{ParseNodeResult {{TN::ByteString {std::move (maybe_result->parsed)}, offset}, maybe_result->state}}};
+  }
+
+  auto const word {state.take_word ()};
+
+  if (word.empty ())
+  {
+    std::ostringstream oss;
+
+    oss << "expected a value, got " << *maybe_c;
+    return {{state.error (oss.str ())}};
+  }
+  if (word == "true" || word == "false")
+  {
+    return {{ParseNodeResult {{TN::Bool {word == "true"}, offset}, state}}};
+  }
+  if (word == "nothing")
+  {
+    return {{ParseNodeResult {{TN::Nothing {}, offset}, state}}};
+  }
+  if (word == "just")
+  {
+    auto maybe_result {parse_value (state)};
+
+    if (!maybe_result)
+    {
+      return {{state.error ("failed to parse a value after 'just'", maybe_result.get_failure ())}};
+    }
+    return {{ParseNodeResult {{TN::Just {std::move (maybe_result->parsed)}, offset}, maybe_result->state}}};
+  }
+  if (auto iter {type_keywords.find (word)}; iter != type_keywords.cend ())
+  {
+    auto maybe_result {parse_typed_value (state, *VariantType::from_string (iter->second))};
+
+    if (!maybe_result)
+    {
+      return {{std::move (maybe_result.get_failure ())}};
+    }
+    return {{ParseNodeResult {{std::move (maybe_result->parsed), offset}, maybe_result->state}}};
+  }
+
+  auto digits {word};
+
+  if (digits.front () == '-' || digits.front () == '+')
+  {
+    digits.remove_prefix (1u);
+  }
+  if (!digits.empty () &&
+      ((digits.front () >= '0' && digits.front () <= '9') ||
+       digits.front () == '.' ||
+       digits == "inf" ||
+       digits == "nan"))
+  {
+    return {{ParseNodeResult {{TN::Number {std::string {word}}, offset}, state}}};
+  }
+
+  std::ostringstream oss;
+
+  oss << "unknown keyword " << word;
+  return {{error_at (offset, oss.str ())}};
+}
+
+// The patterns describe the types a value may have, following GLib:
+// the type string characters stand for themselves, '*' for any type,
+// 'N' for any number type, 'S' for any string type and 'M' for an
+// optional maybe - a value of a maybe type can be written without
+// "just".
+
+auto
+number_is_float (std::string_view token) -> bool
+{
+  if (token.find ("inf") != token.npos || token.find ("nan") != token.npos)
+  {
+    return true;
+  }
+  if (token.find ("0x") != token.npos || token.find ("0X") != token.npos)
+  {
+    return false;
+  }
+
+  return token.find_first_of (".eE") != token.npos;
+}
+
+// Returns the position right after the complete type starting at the
+// position.
+auto
+pattern_end (std::string_view pattern,
+             std::size_t pos) -> std::size_t
+{
+  while (pos < pattern.size () && (pattern[pos] == 'a' || pattern[pos] == 'm' || pattern[pos] == 'M'))
+  {
+    ++pos;
+  }
+  if (pos >= pattern.size ())
+  {
+    return pos;
+  }
+  if (pattern[pos] != '(' && pattern[pos] != '{')
+  {
+    return pos + 1u;
+  }
+
+  std::size_t depth {0u};
+
+  for (; pos < pattern.size (); ++pos)
+  {
+    if (pattern[pos] == '(' || pattern[pos] == '{')
+    {
+      ++depth;
+    }
+    else if (pattern[pos] == ')' || pattern[pos] == '}')
+    {
+      --depth;
+      if (depth == 0u)
+      {
+        return pos + 1u;
+      }
+    }
+  }
+
+  return pos;
+}
+
+// Merges two patterns into one that describes the types matching
+// both. Empty if there are no such types.
+auto
+coalesce_patterns (std::string_view left,
+                   std::string_view right) -> std::optional<std::string>
+{
+  std::string result;
+  std::size_t left_pos {0u};
+  std::size_t right_pos {0u};
+  auto step {[&result](std::string_view one,
+                       std::size_t& one_pos,
+                       std::string_view other,
+                       std::size_t& other_pos)
+             {
+               auto const one_c {one[one_pos]};
+               auto const other_c {other[other_pos]};
+
+               if (one_c == '*' && other_c != ')')
+               {
+                 auto const end {pattern_end (other, other_pos)};
+
+                 result += other.substr (other_pos, end - other_pos);
+                 other_pos = end;
+                 ++one_pos;
+                 return true;
+               }
+               if (one_c == 'M' && other_c == 'm')
+               {
+                 result += other_c;
+                 ++other_pos;
+                 return true;
+               }
+               if (one_c == 'M' && other_c != '*')
+               {
+                 ++one_pos;
+                 return true;
+               }
+               if ((one_c == 'N' && std::string_view {"ynqiuxthd"}.find (other_c) != std::string_view::npos) ||
+                   (one_c == 'S' && std::string_view {"sog"}.find (other_c) != std::string_view::npos))
+               {
+                 result += other_c;
+                 ++one_pos;
+                 ++other_pos;
+                 return true;
+               }
+
+               return false;
+             }};
+
+  while (left_pos < left.size () && right_pos < right.size ())
+  {
+    if (left[left_pos] == right[right_pos])
+    {
+      result += left[left_pos];
+      ++left_pos;
+      ++right_pos;
+    }
+    else if (!step (left, left_pos, right, right_pos) &&
+             !step (right, right_pos, left, left_pos))
+    {
+      return {};
+    }
+  }
+  if (left_pos < left.size () || right_pos < right.size ())
+  {
+    return {};
+  }
+
+  return {std::move (result)};
+}
+
+auto
+get_pattern (TextNode const& node) -> VariantResult<std::string>;
+
+auto
+coalesce_nodes (std::vector<TextNode> const& nodes) -> VariantResult<std::string>
+{
+  std::string pattern {"*"};
+
+  for (auto const& node : nodes)
+  {
+    auto maybe_pattern {get_pattern (node)};
+
+    if (!maybe_pattern)
+    {
+      return maybe_pattern;
+    }
+
+    auto maybe_coalesced {coalesce_patterns (pattern, *maybe_pattern)};
+
+    if (!maybe_coalesced)
+    {
+      return {{error_at (node.offset, "the value does not have a type in common with the ones before it")}};
+    }
+    pattern = std::move (*maybe_coalesced);
+  }
+
+  return {std::move (pattern)};
+}
+
+// Dictionary keys need a basic type, and they are never maybes.
+auto
+get_key_pattern (std::vector<TextNode> const& keys) -> VariantResult<std::string>
+{
+  auto maybe_pattern {coalesce_nodes (keys)};
+
+  if (!maybe_pattern)
+  {
+    return maybe_pattern;
+  }
+
+  std::string_view pattern {*maybe_pattern};
+
+  if (!pattern.empty () && pattern.front () == 'M')
+  {
+    pattern.remove_prefix (1u);
+  }
+  if (pattern.size () != 1u || std::string_view {"bynqiuxthdsogNS*"}.find (pattern.front ()) == std::string_view::npos)
+  {
+    return {{error_at (keys.front ().offset, "dictionary keys need a basic type")}};
+  }
+
+  return {std::string {pattern}};
+}
+
+auto
+get_pattern (TextNode const& node) -> VariantResult<std::string>
+{
+  auto vh {VisitHelper {
+    [](TN::Number const& number) -> VariantResult<std::string> { return {number_is_float (number.token) ? "Md" : "MN"}; },
+    [](TN::String const&) -> VariantResult<std::string> { return {"MS"}; },
+    [](TN::Bool const&) -> VariantResult<std::string> { return {"Mb"}; },
+    [](TN::ByteString const&) -> VariantResult<std::string> { return {"May"}; },
+    [](TN::Nothing const&) -> VariantResult<std::string> { return {"m*"}; },
+    [](TN::Just const& just) -> VariantResult<std::string>
+    {
+      auto maybe_pattern {get_pattern (just.node)};
+
+      if (!maybe_pattern)
+      {
+        return maybe_pattern;
+      }
+      return {"m" + *maybe_pattern};
+    },
+    [](TN::Array const& array) -> VariantResult<std::string>
+    {
+      auto maybe_pattern {coalesce_nodes (array.nodes)};
+
+      if (!maybe_pattern)
+      {
+        return maybe_pattern;
+      }
+      return {"Ma" + *maybe_pattern};
+    },
+    [](TN::Tuple const& tuple) -> VariantResult<std::string>
+    {
+      std::string pattern {"M("};
+
+      for (auto const& child : tuple.nodes)
+      {
+        auto maybe_pattern {get_pattern (child)};
+
+        if (!maybe_pattern)
+        {
+          return maybe_pattern;
+        }
+        pattern += *maybe_pattern;
+      }
+      return {pattern + ")"};
+    },
+    [](TN::Dictionary const& dictionary) -> VariantResult<std::string>
+    {
+      if (dictionary.keys.empty ())
+      {
+        return {"Ma{**}"};
+      }
+
+      auto maybe_key_pattern {get_key_pattern (dictionary.keys)};
+
+      if (!maybe_key_pattern)
+      {
+        return maybe_key_pattern;
+      }
+
+      // Unlike the keys, GLib infers the values from the first one only.
+      auto maybe_value_pattern {get_pattern (dictionary.values.front ())};
+
+      if (!maybe_value_pattern)
+      {
+        return maybe_value_pattern;
+      }
+      return {"Ma{" + *maybe_key_pattern + *maybe_value_pattern + "}"};
+    },
+    [](TN::Entry const& entry) -> VariantResult<std::string>
+    {
+      auto maybe_key_pattern {get_key_pattern ({entry.key})};
+
+      if (!maybe_key_pattern)
+      {
+        return maybe_key_pattern;
+      }
+
+      auto maybe_value_pattern {get_pattern (entry.value)};
+
+      if (!maybe_value_pattern)
+      {
+        return maybe_value_pattern;
+      }
+      return {"M{" + *maybe_key_pattern + *maybe_value_pattern + "}"};
+    },
+    [](TN::Boxed const&) -> VariantResult<std::string> { return {"Mv"}; },
+    [](TN::Typed const& typed) -> VariantResult<std::string> { return {type_to_string (typed.type)}; },
+  }};
+
+  return std::visit (vh, node.v);
+}
+
+// Picks the default types for what the pattern leaves open - no
+// maybes where they are optional, "s" for strings and "i" for
+// numbers.
+auto
+pattern_to_type (std::string_view pattern,
+                 std::size_t offset) -> VariantResult<VariantType>
+{
+  std::string type_string;
+
+  for (auto c : pattern)
+  {
+    switch (c)
+    {
+    case 'M':
+      break;
+    case 'S':
+      type_string += 's';
+      break;
+    case 'N':
+      type_string += 'i';
+      break;
+    default:
+      type_string += c;
+      break;
+    }
+  }
+
+  auto maybe_type {VariantType::from_string (type_string)};
+
+  if (!maybe_type || !maybe_type->is_definite ())
+  {
+    return {{error_at (offset, "unable to infer the type of the value")}};
+  }
+
+  return maybe_type;
+}
+
+auto
+mismatch (TextNode const& node,
+          char const* what,
+          VariantType const& type) -> VariantParseErrorCascade
+{
+  std::ostringstream oss;
+
+  oss << what << " can't be a value of type " << type;
+  return error_at (node.offset, oss.str ());
+}
+
+// Reads the absolute value of an integer like strtoull with base 0
+// does - hexadecimal after "0x", octal after "0".
+auto
+parse_unsigned (std::string_view digits) -> std::optional<std::uint64_t>
+{
+  auto base {10u};
+
+  if (digits.size () > 1u && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))
+  {
+    base = 16u;
+    digits.remove_prefix (2u);
+  }
+  else if (digits.size () > 1u && digits[0] == '0')
+  {
+    base = 8u;
+    digits.remove_prefix (1u);
+  }
+  if (digits.empty ())
+  {
+    return {};
+  }
+
+  std::uint64_t value {0u};
+
+  for (auto c : digits)
+  {
+    auto const digit {digit_value (c)};
+
+    if (digit >= base || value > (std::numeric_limits<std::uint64_t>::max () - digit) / base)
+    {
+      return {};
+    }
+    value = value * base + digit;
+  }
+
+  return {value};
+}
+
+auto
+get_number_value (TextNode const& node,
+                  TN::Number const& number,
+                  VariantType const& type) -> VariantResult<VariantValue>
+{
+  auto const basic {std::get_if<Leaf::Basic> (&type.v)};
+
+  if (basic == nullptr || std::holds_alternative<Leaf::Bool> (basic->v))
+  {
+    return {{mismatch (node, "a number", type)}};
+  }
+  if (std::holds_alternative<Leaf::Double> (basic->v))
+  {
+    char* end {nullptr};
+
+    errno = 0;
+
+    auto const value {std::strtod (number.token.c_str (), &end)};
+
+    if (*end != '\0')
+    {
+      return {{error_at (node.offset, "invalid floating point number")}};
+    }
+    // Like in GLib, numbers too big for a double are rejected, the
+    // ones rounded to zero are fine.
+    if (value != 0.0 && errno == ERANGE)
+    {
+      return {{error_at (node.offset, "number too big for any type")}};
+    }
+    return {{VariantValue {{VV::Basic {VV::Double {value}}}}}};
+  }
+  if (number_is_float (number.token))
+  {
+    return {{mismatch (node, "a floating point number", type)}};
+  }
+
+  std::string_view digits {number.token};
+  auto negative {digits.front () == '-'};
+
+  if (digits.front () == '-' || digits.front () == '+')
+  {
+    digits.remove_prefix (1u);
+  }
+
+  auto const maybe_abs {parse_unsigned (digits)};
+
+  if (!maybe_abs)
+  {
+    return {{error_at (node.offset, "invalid number")}};
+  }
+
+  auto const abs {*maybe_abs};
+
+  negative = negative && abs != 0u;
+
+  auto const value {negative ? static_cast<std::int64_t> (0u - abs) : static_cast<std::int64_t> (abs)};
+  auto fits {[abs, negative](std::uint64_t max_positive, std::uint64_t max_negative)
+             {
+               return abs <= (negative ? max_negative : max_positive);
+             }};
+  auto vh {VisitHelper {
+    [&](Leaf::Byte const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (0xffu, 0u))
+      {
+        return {};
+      }
+      return {{VV::Byte {static_cast<std::uint8_t> (abs)}}};
+    },
+    [&](Leaf::I16 const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (0x7fffu, 0x8000u))
+      {
+        return {};
+      }
+      return {{VV::I16 {static_cast<std::int16_t> (value)}}};
+    },
+    [&](Leaf::U16 const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (0xffffu, 0u))
+      {
+        return {};
+      }
+      return {{VV::U16 {static_cast<std::uint16_t> (abs)}}};
+    },
+    [&](Leaf::I32 const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (0x7fffffffu, 0x80000000u))
+      {
+        return {};
+      }
+      return {{VV::I32 {static_cast<std::int32_t> (value)}}};
+    },
+    [&](Leaf::U32 const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (0xffffffffu, 0u))
+      {
+        return {};
+      }
+      return {{VV::U32 {static_cast<std::uint32_t> (abs)}}};
+    },
+    [&](Leaf::I64 const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (0x7fffffffffffffffu, 0x8000000000000000u))
+      {
+        return {};
+      }
+      return {{VV::I64 {value}}};
+    },
+    [&](Leaf::U64 const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (std::numeric_limits<std::uint64_t>::max (), 0u))
+      {
+        return {};
+      }
+      return {{VV::U64 {abs}}};
+    },
+    [&](Leaf::Handle const&) -> std::optional<VV::Basic>
+    {
+      if (!fits (0x7fffffffu, 0x80000000u))
+      {
+        return {};
+      }
+      return {{VV::Handle {static_cast<std::int32_t> (value)}}};
+    },
+    // Handled above.
+    [](auto const&) -> std::optional<VV::Basic> { return {}; },
+  }};
+  auto maybe_basic {std::visit (vh, basic->v)};
+
+  if (!maybe_basic)
+  {
+    std::ostringstream oss;
+
+    oss << "number out of range for type " << type;
+    return {{error_at (node.offset, oss.str ())}};
+  }
+
+  return {{VariantValue {{std::move (*maybe_basic)}}}};
+}
+
+auto
+get_value (TextNode const& node,
+           VariantType const& type) -> VariantResult<VariantValue>;
+
+auto
+resolve (TextNode const& node) -> VariantResult<VariantValue>
+{
+  auto maybe_pattern {get_pattern (node)};
+
+  if (!maybe_pattern)
+  {
+    return {{std::move (maybe_pattern.get_failure ())}};
+  }
+
+  auto maybe_type {pattern_to_type (*maybe_pattern, node.offset)};
+
+  if (!maybe_type)
+  {
+    return {{std::move (maybe_type.get_failure ())}};
+  }
+
+  return get_value (node, *maybe_type);
+}
+
+auto
+get_values (std::vector<TextNode> const& nodes,
+            std::vector<VariantType> const& types) -> VariantResult<std::vector<VariantValue>>
+{
+  std::vector<VariantValue> values;
+
+  for (auto idx {0u}; idx < nodes.size (); ++idx)
+  {
+    auto maybe_value {get_value (nodes[idx], types[idx])};
+
+    if (!maybe_value)
+    {
+      return {{std::move (maybe_value.get_failure ())}};
+    }
+    values.push_back (std::move (*maybe_value));
+  }
+
+  return {std::move (values)};
+}
+
+auto
+get_entry_value (TextNode const& key,
+                 TextNode const& value,
+                 VT::Entry const& entry_type) -> VariantResult<VariantValue>
+{
+  auto maybe_values {get_values ({key, value}, {repackage<VariantType> (entry_type.key), entry_type.value})};
+
+  if (!maybe_values)
+  {
+    return {{std::move (maybe_values.get_failure ())}};
+  }
+
+  auto& values {*maybe_values};
+
+  return {{VariantValue {{VV::Entry {std::move (values[0]), std::move (values[1])}}}}};
+}
+
+auto
+get_value (TextNode const& node,
+           VariantType const& type) -> VariantResult<VariantValue>
+{
+  if (auto typed {std::get_if<TN::Typed> (&node.v)}; typed != nullptr)
+  {
+    if (typed->type != type)
+    {
+      std::ostringstream oss;
+
+      oss << "a value of type " << typed->type << " can't be used where "
+          << type << " is expected";
+      return {{error_at (node.offset, oss.str ())}};
+    }
+    return get_value (typed->node, type);
+  }
+
+  // A value of a maybe type can be written without "just".
+  if (auto maybe_type {std::get_if<VT::Maybe> (&type.v)};
+      maybe_type != nullptr &&
+      !std::holds_alternative<TN::Nothing> (node.v) &&
+      !std::holds_alternative<TN::Just> (node.v))
+  {
+    auto maybe_value {get_value (node, maybe_type->pointed_type)};
+
+    if (!maybe_value)
+    {
+      return maybe_value;
+    }
+    return {{VariantValue {{VV::Maybe {maybe_type->pointed_type, {std::move (*maybe_value)}}}}}};
+  }
+
+  auto vh {VisitHelper {
+    [&node, &type](TN::Number const& number) -> VariantResult<VariantValue>
+    {
+      return get_number_value (node, number, type);
+    },
+    [&node, &type](TN::String const& string) -> VariantResult<VariantValue>
+    {
+      auto string_type {std::get_if<Leaf::StringType> (&type.v)};
+
+      if (string_type == nullptr)
+      {
+        return {{mismatch (node, "a string", type)}};
+      }
+      if (!string_is_valid (*string_type, string.value))
+      {
+        std::ostringstream oss;
+
+        oss << "the string is not a valid value of type " << type;
+        return {{error_at (node.offset, oss.str ())}};
+      }
+      return {{VariantValue {{VV::String {*string_type, string.value}}}}};
+    },
+    [&node, &type](TN::Bool const& boolean) -> VariantResult<VariantValue>
+    {
+      auto basic {std::get_if<Leaf::Basic> (&type.v)};
+
+      if (basic == nullptr || !std::holds_alternative<Leaf::Bool> (basic->v))
+      {
+        return {{mismatch (node, "a boolean", type)}};
+      }
+      return {{VariantValue {{VV::Basic {VV::Bool {boolean.value}}}}}};
+    },
+    [&node, &type](TN::ByteString const& byte_string) -> VariantResult<VariantValue>
+    {
+      VariantType const byte_type {{Leaf::Basic {Leaf::byte_}}};
+
+      if (type != VariantType {{VT::Array {byte_type}}})
+      {
+        return {{mismatch (node, "a byte string", type)}};
+      }
+
+      std::vector<VariantValue> bytes;
+
+      // GLib makes the value with g_variant_new_bytestring, which
+      // stops at the first zero byte and includes it.
+      for (auto c : byte_string.bytes)
+      {
+        if (c == '\0')
+        {
+          break;
+        }
+        bytes.push_back ({{VV::Basic {VV::Byte {static_cast<std::uint8_t> (c)}}}});
+      }
+      bytes.push_back ({{VV::Basic {VV::Byte {0u}}}});
+      return {{VariantValue {{VV::Array {byte_type, std::move (bytes)}}}}};
+    },
+    [&node, &type](TN::Nothing const&) -> VariantResult<VariantValue>
+    {
+      auto maybe_type {std::get_if<VT::Maybe> (&type.v)};
+
+      if (maybe_type == nullptr)
+      {
+        return {{mismatch (node, "nothing", type)}};
+      }
+      return {{VariantValue {{VV::Maybe {maybe_type->pointed_type, {}}}}}};
+    },
+    [&node, &type](TN::Just const& just) -> VariantResult<VariantValue>
+    {
+      auto maybe_type {std::get_if<VT::Maybe> (&type.v)};
+
+      if (maybe_type == nullptr)
+      {
+        return {{mismatch (node, "a maybe", type)}};
+      }
+
+      auto maybe_value {get_value (just.node, maybe_type->pointed_type)};
+
+      if (!maybe_value)
+      {
+        return maybe_value;
+      }
+      return {{VariantValue {{VV::Maybe {maybe_type->pointed_type, {std::move (*maybe_value)}}}}}};
+    },
+    [&node, &type](TN::Array const& array) -> VariantResult<VariantValue>
+    {
+      auto array_type {std::get_if<VT::Array> (&type.v)};
+
+      if (array_type == nullptr)
+      {
+        return {{mismatch (node, "an array", type)}};
+      }
+
+      VariantType const& element_type = array_type->element_type;
+      auto maybe_values {get_values (array.nodes, std::vector<VariantType> (array.nodes.size (), element_type))};
+
+      if (!maybe_values)
+      {
+        return {{std::move (maybe_values.get_failure ())}};
+      }
+      return {{VariantValue {{VV::Array {element_type, std::move (*maybe_values)}}}}};
+    },
+    [&node, &type](TN::Tuple const& tuple) -> VariantResult<VariantValue>
+    {
+      auto tuple_type {std::get_if<VT::Tuple> (&type.v)};
+
+      if (tuple_type == nullptr || tuple_type->types.size () != tuple.nodes.size ())
+      {
+        return {{mismatch (node, "a tuple", type)}};
+      }
+
+      auto maybe_values {get_values (tuple.nodes, tuple_type->types)};
+
+      if (!maybe_values)
+      {
+        return {{std::move (maybe_values.get_failure ())}};
+      }
+      return {{VariantValue {{VV::Tuple {std::move (*maybe_values)}}}}};
+    },
+    [&node, &type](TN::Dictionary const& dictionary) -> VariantResult<VariantValue>
+    {
+      auto array_type {std::get_if<VT::Array> (&type.v)};
+      auto entry_type {array_type != nullptr ? std::get_if<VT::Entry> (&static_cast<VariantType const&> (array_type->element_type).v) : nullptr};
+
+      if (entry_type == nullptr)
+      {
+        return {{mismatch (node, "a dictionary", type)}};
+      }
+
+      std::vector<VariantValue> entries;
+
+      for (auto idx {0u}; idx < dictionary.keys.size (); ++idx)
+      {
+        auto maybe_entry {get_entry_value (dictionary.keys[idx], dictionary.values[idx], *entry_type)};
+
+        if (!maybe_entry)
+        {
+          return maybe_entry;
+        }
+        entries.push_back (std::move (*maybe_entry));
+      }
+      return {{VariantValue {{VV::Array {array_type->element_type, std::move (entries)}}}}};
+    },
+    [&node, &type](TN::Entry const& entry) -> VariantResult<VariantValue>
+    {
+      auto entry_type {std::get_if<VT::Entry> (&type.v)};
+
+      if (entry_type == nullptr)
+      {
+        return {{mismatch (node, "a dictionary entry", type)}};
+      }
+      return get_entry_value (entry.key, entry.value, *entry_type);
+    },
+    [&node, &type](TN::Boxed const& boxed) -> VariantResult<VariantValue>
+    {
+      if (!std::holds_alternative<Leaf::Variant> (type.v))
+      {
+        return {{mismatch (node, "a variant", type)}};
+      }
+
+      // The boxed value has a type of its own.
+      auto maybe_value {resolve (boxed.node)};
+
+      if (!maybe_value)
+      {
+        return maybe_value;
+      }
+      return {{VariantValue {{VV::Variant {std::move (*maybe_value)}}}}};
+    },
+    // Handled above.
+    [](TN::Typed const&) -> VariantResult<VariantValue> { return {{VariantParseErrorCascade {}}}; },
+  }};
+
+  return std::visit (vh, node.v);
+}
+
+} // anonymous namespace
+
+auto
+parse_variant_text (std::string_view const& text) -> VariantResult<VariantValue>
+{
+  auto state {TextState {text, 0u}};
+  auto maybe_result {parse_value (state)};
+
+  if (!maybe_result)
+  {
+    return {{state.error ("failed to parse variant text", maybe_result.get_failure ())}};
+  }
+  state = maybe_result->state;
+  if (state.peek ())
+  {
+    std::ostringstream oss;
+
+    oss << "text contains more than one value: " << state.get_rest ();
+    return {{state.error (oss.str ())}};
+  }
+
+  return resolve (maybe_result->parsed);
+}
+
+auto
+count_values (VariantValue const& value) -> std::size_t
+{
+  auto sum {[](std::vector<VariantValue> const& values)
+            {
+              std::size_t count {0u};
+
+              for (auto const& child : values)
+              {
+                count += count_values (child);
+              }
+
+              return count;
+            }};
+  auto vh {VisitHelper {
+    [](VV::Variant const& variant) { return 1u + count_values (variant.value); },
+    [](VV::Maybe const& maybe) { return 1u + (maybe.value ? count_values (*maybe.value) : std::size_t {0u}); },
+    [&sum](VV::Array const& array) { return 1u + sum (array.elements); },
+    [&sum](VV::Tuple const& tuple) { return 1u + sum (tuple.values); },
+    [](VV::Entry const& entry) { return 1u + count_values (entry.key) + count_values (entry.value); },
+    [](auto const&) { return std::size_t {1u}; },
+  }};
+
+  return std::visit (vh, value.v);
+}
+
+} // namespace Ggp::Lib
@@ -0,0 +1,53 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*< check: GGP_LIB_VARIANT_TEXT_HH_CHECK >*/
+/*< lib: variant-value.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: cstddef >*/
+/*< stl: string_view >*/
+
+#ifndef GGP_LIB_VARIANT_TEXT_HH
+#define GGP_LIB_VARIANT_TEXT_HH
+
+#define GGP_LIB_VARIANT_TEXT_HH_CHECK_VALUE GGP_LIB_VARIANT_TEXT_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+// Parses a value in the GVariant text format, like g_variant_parse
+// does when no type is given. The types are inferred the same way -
+// numbers are int32 or double and strings are plain strings unless
+// the rest of the text (like "@t" or "uint64") says otherwise.
+// Positional parameters, the "%" ones g_variant_new_parsed takes, are
+// not supported.
+auto
+parse_variant_text (std::string_view const& text) -> VariantResult<VariantValue>;
+
+// Counts the value and all the values nested in it.
+auto
+count_values (VariantValue const& value) -> std::size_t;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_VARIANT_TEXT_HH_CHECK_VALUE != GGP_LIB_VARIANT_TEXT_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_VARIANT_TEXT_HH */
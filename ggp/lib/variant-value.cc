@@ -0,0 +1,232 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< lib: variant-value.hh >*/
+/*< lib: variant.hh >*/
+
+namespace Ggp::Lib
+{
+
+namespace
+{
+
+auto
+basic_type (VV::Basic const& basic) -> Leaf::Basic
+{
+  auto vh {VisitHelper {
+    [](VV::Bool const&) { return Leaf::Basic {Leaf::bool_}; },
+    [](VV::Byte const&) { return Leaf::Basic {Leaf::byte_}; },
+    [](VV::I16 const&) { return Leaf::Basic {Leaf::i16}; },
+    [](VV::U16 const&) { return Leaf::Basic {Leaf::u16}; },
+    [](VV::I32 const&) { return Leaf::Basic {Leaf::i32}; },
+    [](VV::U32 const&) { return Leaf::Basic {Leaf::u32}; },
+    [](VV::I64 const&) { return Leaf::Basic {Leaf::i64}; },
+    [](VV::U64 const&) { return Leaf::Basic {Leaf::u64}; },
+    [](VV::Handle const&) { return Leaf::Basic {Leaf::handle}; },
+    [](VV::Double const&) { return Leaf::Basic {Leaf::double_}; },
+  }};
+
+  return std::visit (vh, basic.v);
+}
+
+auto
+entry_key_type (VariantValue const& key) -> VT::EntryKeyType
+{
+  auto vh {VisitHelper {
+    [](VV::Basic const& basic) { return VT::EntryKeyType {basic_type (basic)}; },
+    [](VV::String const& string) { return VT::EntryKeyType {string.type}; },
+    // Not a valid value, but this is the closest type.
+    [](auto const&) { return VT::EntryKeyType {Leaf::any_basic}; },
+  }};
+
+  return std::visit (vh, key.v);
+}
+
+auto
+utf8_is_valid (std::string_view string) -> bool
+{
+  auto const size {string.size ()};
+  std::size_t idx {0u};
+
+  while (idx < size)
+  {
+    auto const c {static_cast<unsigned char> (string[idx])};
+    std::size_t count {0u};
+    std::uint32_t code_point {0u};
+
+    if (c == 0u)
+    {
+      return false;
+    }
+    if (c < 0x80u)
+    {
+      ++idx;
+      continue;
+    }
+    if ((c & 0xe0u) == 0xc0u)
+    {
+      count = 1u;
+      code_point = c & 0x1fu;
+    }
+    else if ((c & 0xf0u) == 0xe0u)
+    {
+      count = 2u;
+      code_point = c & 0x0fu;
+    }
+    else if ((c & 0xf8u) == 0xf0u)
+    {
+      count = 3u;
+      code_point = c & 0x07u;
+    }
+    else
+    {
+      return false;
+    }
+    if (size - idx <= count)
+    {
+      return false;
+    }
+    for (auto cont_idx {1u}; cont_idx <= count; ++cont_idx)
+    {
+      auto const cont {static_cast<unsigned char> (string[idx + cont_idx])};
+
+      if ((cont & 0xc0u) != 0x80u)
+      {
+        return false;
+      }
+      code_point = (code_point << 6u) | (cont & 0x3fu);
+    }
+
+    // Overlong forms, surrogates and values past the last code
+    // point.
+    std::uint32_t const minimums[] {0u, 0x80u, 0x800u, 0x10000u};
+
+    if (code_point < minimums[count] ||
+        (code_point >= 0xd800u && code_point <= 0xdfffu) ||
+        code_point > 0x10ffffu)
+    {
+      return false;
+    }
+    idx += count + 1u;
+  }
+
+  return true;
+}
+
+// "/" or slash separated non-empty elements of [A-Za-z0-9_].
+auto
+object_path_is_valid (std::string_view string) -> bool
+{
+  if (string.empty () || string[0] != '/')
+  {
+    return false;
+  }
+  if (string.size () == 1u)
+  {
+    return true;
+  }
+  if (string.back () == '/')
+  {
+    return false;
+  }
+
+  for (auto idx {std::size_t {1u}}; idx < string.size (); ++idx)
+  {
+    auto const c {string[idx]};
+
+    if (c == '/')
+    {
+      if (string[idx - 1u] == '/')
+      {
+        return false;
+      }
+      continue;
+    }
+    if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_'))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// A signature is a sequence of definite types.
+auto
+signature_is_valid (std::string_view string) -> bool
+{
+  if (string.find ('\0') != std::string_view::npos)
+  {
+    return false;
+  }
+
+  std::string tuple {"("};
+
+  tuple.append (string);
+  tuple.push_back (')');
+
+  auto maybe_type {VariantType::from_string (tuple)};
+
+  return maybe_type && maybe_type->is_definite ();
+}
+
+} // anonymous namespace
+
+auto
+VariantValue::type () const -> VariantType
+{
+  auto vh {VisitHelper {
+    [](VV::Basic const& basic) { return VariantType {basic_type (basic)}; },
+    [](VV::String const& string) { return VariantType {string.type}; },
+    [](VV::Variant const&) { return VariantType {Leaf::variant}; },
+    [](VV::Maybe const& maybe) { return VariantType {VT::Maybe {maybe.pointed_type}}; },
+    [](VV::Array const& array) { return VariantType {VT::Array {array.element_type}}; },
+    [](VV::Tuple const& tuple)
+    {
+      std::vector<VariantType> types;
+
+      for (auto const& value : tuple.values)
+      {
+        types.push_back (value.type ());
+      }
+
+      return VariantType {VT::Tuple {std::move (types)}};
+    },
+    [](VV::Entry const& entry)
+    {
+      return VariantType {VT::Entry {entry_key_type (entry.key), entry.value->type ()}};
+    },
+  }};
+
+  return std::visit (vh, this->v);
+}
+
+auto
+string_is_valid (Leaf::StringType const& type,
+                 std::string_view string) -> bool
+{
+  auto vh {VisitHelper {
+    [string](Leaf::String const&) { return utf8_is_valid (string); },
+    [string](Leaf::ObjectPath const&) { return object_path_is_valid (string); },
+    [string](Leaf::Signature const&) { return signature_is_valid (string); },
+  }};
+
+  return std::visit (vh, type.v);
+}
+
+} // namespace Ggp::Lib
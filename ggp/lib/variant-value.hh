@@ -0,0 +1,149 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*< check: GGP_LIB_VARIANT_VALUE_HH_CHECK >*/
+/*< lib: util.hh >*/
+/*< lib: value.hh >*/
+/*< lib: variant.hh >*/
+/*< stl: cstdint >*/
+/*< stl: optional >*/
+/*< stl: string >*/
+/*< stl: string_view >*/
+/*< stl: vector >*/
+
+#ifndef GGP_LIB_VARIANT_VALUE_HH
+#define GGP_LIB_VARIANT_VALUE_HH
+
+#define GGP_LIB_VARIANT_VALUE_HH_CHECK_VALUE GGP_LIB_VARIANT_VALUE_HH_CHECK
+
+namespace Ggp::Lib
+{
+
+struct VariantValue;
+
+// variant value
+namespace VV
+{
+
+GGP_LIB_STRUCT (Bool,
+                bool, value);
+
+GGP_LIB_STRUCT (Byte,
+                std::uint8_t, value);
+
+GGP_LIB_STRUCT (I16,
+                std::int16_t, value);
+
+GGP_LIB_STRUCT (U16,
+                std::uint16_t, value);
+
+GGP_LIB_STRUCT (I32,
+                std::int32_t, value);
+
+GGP_LIB_STRUCT (U32,
+                std::uint32_t, value);
+
+GGP_LIB_STRUCT (I64,
+                std::int64_t, value);
+
+GGP_LIB_STRUCT (U64,
+                std::uint64_t, value);
+
+GGP_LIB_STRUCT (Handle,
+                std::int32_t, value);
+
+GGP_LIB_STRUCT (Double,
+                double, value);
+
+GGP_LIB_VARIANT_STRUCT (Basic,
+                        Bool,
+                        Byte,
+                        I16,
+                        U16,
+                        I32,
+                        U32,
+                        I64,
+                        U64,
+                        Handle,
+                        Double);
+
+GGP_LIB_STRUCT (String,
+                Leaf::StringType, type,
+                std::string, value);
+
+GGP_LIB_STRUCT (Variant,
+                Value<VariantValue>, value);
+
+// The pointed type is needed for nothing.
+GGP_LIB_STRUCT (Maybe,
+                VariantType, pointed_type,
+                std::optional<Value<VariantValue>>, value);
+
+// The element type is needed for empty arrays.
+GGP_LIB_STRUCT (Array,
+                VariantType, element_type,
+                std::vector<VariantValue>, elements);
+
+GGP_LIB_STRUCT (Tuple,
+                std::vector<VariantValue>, values);
+
+// The key needs to be a basic or a string value.
+GGP_LIB_STRUCT (Entry,
+                Value<VariantValue>, key,
+                Value<VariantValue>, value);
+
+} // namespace VV
+
+// A value of a definite type, like the one held by a GVariant.
+struct VariantValue
+{
+  using V = std::variant
+  <
+  VV::Basic,
+  VV::String,
+  VV::Variant,
+  VV::Maybe,
+  VV::Array,
+  VV::Tuple,
+  VV::Entry
+  >;
+
+  auto
+  type () const -> VariantType;
+
+  V v;
+};
+
+GGP_LIB_VARIANT_OPS (VariantValue);
+
+// Whether GLib would accept the string as a value of the string
+// type - valid UTF-8 without embedded zeros, an object path or a
+// signature.
+auto
+string_is_valid (Leaf::StringType const& type,
+                 std::string_view string) -> bool;
+
+} // namespace Ggp::Lib
+
+#else
+
+#if GGP_LIB_VARIANT_VALUE_HH_CHECK_VALUE != GGP_LIB_VARIANT_VALUE_HH_CHECK
+#error "This non standalone header file was included from two different wrappers."
+#endif
+
+#endif /* GGP_LIB_VARIANT_VALUE_HH */
@@ -1135,4 +1135,92 @@ VariantFormat::to_type () const -> VariantType
   return std::visit (vh, this->v);
 }
 
+namespace
+{
+
+auto
+format_to_args (VariantFormat const& format, std::vector<FormatArg>& args) -> void;
+
+auto
+entry_key_format_to_format (VF::EntryKeyFormat const& entry_key_format) -> VariantFormat
+{
+  auto vh {VisitHelper {
+    [](Leaf::Basic const& basic) { return VariantFormat {{basic}}; },
+    [](Leaf::StringType const& string_type) { return VariantFormat {{string_type}}; },
+    [](VF::AtEntryKeyType const& at) { return VariantFormat {{VF::AtVariantType {repackage<VariantType> (at.entry_key_type)}}}; },
+    [](VF::Pointer const& pointer) { return VariantFormat {{pointer}}; },
+  }};
+
+  return std::visit (vh, entry_key_format.v);
+}
+
+auto
+entry_to_args (VF::Entry const& entry, std::vector<FormatArg>& args) -> void
+{
+  args.push_back ({{entry_key_format_to_format (entry.key)}});
+  format_to_args (entry.value, args);
+}
+
+auto
+tuple_to_args (VF::Tuple const& tuple, std::vector<FormatArg>& args) -> void
+{
+  for (auto const& format : tuple.formats)
+  {
+    format_to_args (format, args);
+  }
+}
+
+auto
+maybe_to_args (VariantFormat const& format, VF::Maybe const& maybe, std::vector<FormatArg>& args) -> void;
+
+auto
+maybe_bool_to_args (VF::MaybeBool const& maybe_bool, std::vector<FormatArg>& args) -> void
+{
+  auto vh {VisitHelper {
+    [&args](Leaf::Basic const& basic) { args.push_back ({{VariantFormat {{basic}}}}); },
+    [&args](VF::Entry const& entry) { entry_to_args (entry, args); },
+    [&args](VF::Tuple const& tuple) { tuple_to_args (tuple, args); },
+    [&args](VF::Maybe const& maybe) { maybe_to_args (VariantFormat {{maybe}}, maybe, args); },
+  }};
+
+  args.push_back ({{VF::maybe_flag}});
+  std::visit (vh, maybe_bool.v);
+}
+
+auto
+maybe_to_args (VariantFormat const& format, VF::Maybe const& maybe, std::vector<FormatArg>& args) -> void
+{
+  auto vh {VisitHelper {
+    [&args, &format](VF::MaybePointer const&) { args.push_back ({{format}}); },
+    [&args](VF::MaybeBool const& maybe_bool) { maybe_bool_to_args (maybe_bool, args); },
+  }};
+
+  std::visit (vh, maybe.v);
+}
+
+auto
+format_to_args (VariantFormat const& format, std::vector<FormatArg>& args) -> void
+{
+  auto vh {VisitHelper {
+    [&args, &format](VF::Maybe const& maybe) { maybe_to_args (format, maybe, args); },
+    [&args](VF::Tuple const& tuple) { tuple_to_args (tuple, args); },
+    [&args](VF::Entry const& entry) { entry_to_args (entry, args); },
+    [&args, &format](auto const&) { args.push_back ({{format}}); },
+  }};
+
+  std::visit (vh, format.v);
+}
+
+} // anonymous namespace
+
+auto
+args_for_format (VariantFormat const& format) -> std::vector<FormatArg>
+{
+  std::vector<FormatArg> args {};
+
+  format_to_args (format, args);
+
+  return args;
+}
+
 } // namespace Ggp::Lib
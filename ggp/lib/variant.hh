@@ -343,6 +343,26 @@ struct VariantFormat
 
 GGP_LIB_VARIANT_OPS (VariantFormat);
 
+namespace VF
+{
+
+// The boolean parameter that comes before the parameters of a maybe
+// of a non-pointer type.
+GGP_LIB_TRIVIAL_TYPE_WITH_OPS (MaybeFlag);
+inline constexpr MaybeFlag maybe_flag {};
+
+} // namespace VF
+
+// Describes what a single parameter passed after the format string
+// corresponds to. These come in the same order as the types returned
+// by expected_types_for_format.
+GGP_LIB_VARIANT_STRUCT (FormatArg,
+                        VariantFormat,
+                        VF::MaybeFlag);
+
+auto
+args_for_format (VariantFormat const& format) -> std::vector<FormatArg>;
+
 } // namespace Ggp::Lib
 
 // NOTES:
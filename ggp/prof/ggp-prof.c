@@ -0,0 +1,475 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Profiler shim for the GVariant functions taking a format string,
+ * meant to be used with LD_PRELOAD. It counts the calls, the time
+ * spent in them and the size of the values built or read for each
+ * call site and dumps them at exit to the file named in the
+ * GGP_PROF_OUTPUT environment variable or to ggp-prof.<pid>. Lib
+ * reads the file with parse_profile (ggp/lib/profile.hh).
+ *
+ * Each thread counts the calls in its own table, so the counting
+ * needs no locks. The tables are never freed, so the calls of the
+ * threads that are gone are dumped too, but a table is handed over
+ * to a new thread when its thread exits, so there are only as many
+ * tables as there were threads running at once. */
+
+#define _GNU_SOURCE
+
+#include <glib.h>
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Keep in sync with profile_version in ggp/lib/profile.hh. */
+#define GGP_PROF_VERSION 1
+
+/* Needs to be a power of two. */
+#define TABLE_SLOTS 4096
+#define MAX_PROBES 16
+
+typedef enum
+{
+  FUNCTION_NEW,
+  FUNCTION_GET,
+  FUNCTION_BUILDER_ADD,
+  FUNCTION_ITER_NEXT,
+  FUNCTION_LOOKUP,
+} Function;
+
+static const gchar *function_names[] =
+{
+  "g_variant_new",
+  "g_variant_get",
+  "g_variant_builder_add",
+  "g_variant_iter_next",
+  "g_variant_lookup",
+};
+
+typedef struct
+{
+  /* The slot is taken when the format copy is set, it is set last,
+   * so the dump sees only complete keys. */
+  gchar *format;
+  gconstpointer format_pointer;
+  gconstpointer pc;
+  Function function;
+  guint64 calls;
+  guint64 nanoseconds;
+  guint64 bytes;
+} Slot;
+
+typedef struct _Table Table;
+
+struct _Table
+{
+  Table *next;
+  /* Whether some thread counts the calls in the table. */
+  gint in_use;
+  guint64 dropped_calls;
+  Slot slots[TABLE_SLOTS];
+};
+
+static void release_table (gpointer data);
+
+static Table *tables = NULL;
+static __thread Table *thread_table = NULL;
+/* Only used to learn when the thread exits. */
+static GPrivate thread_table_private = G_PRIVATE_INIT (release_table);
+
+/* Runs when the thread exits. The counts stay in the table, the next
+ * thread just adds its own. */
+static void
+release_table (gpointer data)
+{
+  Table *table = data;
+
+  /* Calls made by the other destructors of the thread get a table of
+   * their own. */
+  thread_table = NULL;
+  g_atomic_int_set (&table->in_use, FALSE);
+}
+
+/* Takes over a table released by a thread that is gone. */
+static Table *
+reuse_table (void)
+{
+  Table *table;
+
+  for (table = g_atomic_pointer_get (&tables); table != NULL; table = table->next)
+    {
+      if (g_atomic_int_compare_and_exchange (&table->in_use, FALSE, TRUE))
+        return table;
+    }
+
+  return NULL;
+}
+
+static Table *
+get_thread_table (void)
+{
+  Table *table = thread_table;
+
+  if (G_UNLIKELY (table == NULL))
+    {
+      table = reuse_table ();
+      if (table == NULL)
+        {
+          table = calloc (1, sizeof (Table));
+          if (table == NULL)
+            return NULL;
+          table->in_use = TRUE;
+          do
+            table->next = g_atomic_pointer_get (&tables);
+          while (!g_atomic_pointer_compare_and_exchange (&tables, table->next, table));
+        }
+      g_private_set (&thread_table_private, table);
+      thread_table = table;
+    }
+
+  return table;
+}
+
+static inline guint64
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return (guint64) ts.tv_sec * G_GUINT64_CONSTANT (1000000000) + (guint64) ts.tv_nsec;
+}
+
+static Slot *
+find_slot (Table *table,
+           Function function,
+           const gchar *format,
+           gconstpointer pc)
+{
+  guintptr hash = ((guintptr) format ^ ((guintptr) pc * 0x9e3779b1u)) + function;
+  guint probe;
+
+  hash ^= hash >> 15;
+  for (probe = 0; probe < MAX_PROBES; ++probe)
+    {
+      Slot *slot = &table->slots[(hash + probe) & (TABLE_SLOTS - 1)];
+
+      if (slot->format == NULL)
+        {
+          slot->format_pointer = format;
+          slot->pc = pc;
+          slot->function = function;
+          /* The format might be gone by the time of the dump. */
+          g_atomic_pointer_set (&slot->format, strdup (format));
+          if (slot->format == NULL)
+            return NULL;
+          return slot;
+        }
+      if (slot->format_pointer == format && slot->pc == pc && slot->function == function)
+        return slot;
+    }
+
+  return NULL;
+}
+
+/* The size is taken after the timed part. It serializes the values
+ * built in the tree form, which GLib would otherwise do only when
+ * they are sent or stored. */
+static void
+record (Function function,
+        const gchar *format,
+        gconstpointer pc,
+        guint64 start,
+        GVariant *value)
+{
+  guint64 elapsed = now_ns () - start;
+  Table *table;
+  Slot *slot;
+
+  if (format == NULL)
+    return;
+
+  table = get_thread_table ();
+  if (table == NULL)
+    return;
+
+  slot = find_slot (table, function, format, pc);
+  if (slot == NULL)
+    {
+      ++table->dropped_calls;
+      return;
+    }
+
+  ++slot->calls;
+  slot->nanoseconds += elapsed;
+  if (value != NULL)
+    slot->bytes += g_variant_get_size (value);
+}
+
+GVariant *
+g_variant_new (const gchar *format_string,
+               ...)
+{
+  gconstpointer pc = __builtin_return_address (0);
+  guint64 start = now_ns ();
+  GVariant *value;
+  va_list ap;
+
+  va_start (ap, format_string);
+  value = g_variant_new_va (format_string, NULL, &ap);
+  va_end (ap);
+
+  record (FUNCTION_NEW, format_string, pc, start, value);
+
+  return value;
+}
+
+void
+g_variant_get (GVariant *value,
+               const gchar *format_string,
+               ...)
+{
+  gconstpointer pc = __builtin_return_address (0);
+  guint64 start = now_ns ();
+  va_list ap;
+
+  va_start (ap, format_string);
+  g_variant_get_va (value, format_string, NULL, &ap);
+  va_end (ap);
+
+  record (FUNCTION_GET, format_string, pc, start, value);
+}
+
+void
+g_variant_builder_add (GVariantBuilder *builder,
+                       const gchar *format_string,
+                       ...)
+{
+  gconstpointer pc = __builtin_return_address (0);
+  guint64 start = now_ns ();
+  GVariant *value;
+  va_list ap;
+
+  va_start (ap, format_string);
+  value = g_variant_new_va (format_string, NULL, &ap);
+  va_end (ap);
+  /* The builder keeps a reference, so the value is still alive when
+   * it is recorded. */
+  g_variant_builder_add_value (builder, value);
+
+  record (FUNCTION_BUILDER_ADD, format_string, pc, start, value);
+}
+
+gboolean
+g_variant_iter_next (GVariantIter *iter,
+                     const gchar *format_string,
+                     ...)
+{
+  gconstpointer pc = __builtin_return_address (0);
+  guint64 start = now_ns ();
+  GVariant *value;
+
+  value = g_variant_iter_next_value (iter);
+  if (value != NULL)
+    {
+      va_list ap;
+
+      va_start (ap, format_string);
+      g_variant_get_va (value, format_string, NULL, &ap);
+      va_end (ap);
+    }
+
+  record (FUNCTION_ITER_NEXT, format_string, pc, start, value);
+
+  if (value == NULL)
+    return FALSE;
+
+  g_variant_unref (value);
+
+  return TRUE;
+}
+
+gboolean
+g_variant_lookup (GVariant *dictionary,
+                  const gchar *key,
+                  const gchar *format_string,
+                  ...)
+{
+  gconstpointer pc = __builtin_return_address (0);
+  guint64 start = now_ns ();
+  GVariantType *type;
+  GVariant *value;
+
+  g_return_val_if_fail (format_string != NULL, FALSE);
+
+  /* Like GLib, so the borrowed strings outlive the value. */
+  if (strchr (format_string, '&') != NULL)
+    g_variant_get_data (dictionary);
+
+  type = g_variant_format_string_scan_type (format_string, NULL, NULL);
+  value = g_variant_lookup_value (dictionary, key, type);
+  g_variant_type_free (type);
+
+  if (value != NULL)
+    {
+      va_list ap;
+
+      va_start (ap, format_string);
+      g_variant_get_va (value, format_string, NULL, &ap);
+      va_end (ap);
+    }
+
+  record (FUNCTION_LOOKUP, format_string, pc, start, value);
+
+  if (value == NULL)
+    return FALSE;
+
+  g_variant_unref (value);
+
+  return TRUE;
+}
+
+typedef struct
+{
+  Function function;
+  const gchar *module;
+  guintptr offset;
+  const gchar *format;
+  guint64 calls;
+  guint64 nanoseconds;
+  guint64 bytes;
+} Entry;
+
+static gboolean
+is_valid_field (const gchar *str,
+                const gchar *forbidden)
+{
+  return strpbrk (str, forbidden) == NULL;
+}
+
+/* Sums up the slots of all the threads with the same site. The
+ * formats are compared by contents, the same format may come from
+ * different pointers. */
+static void
+add_slot (GHashTable *entries,
+          const Slot *slot,
+          guint64 *dropped_calls)
+{
+  const gchar *format = g_atomic_pointer_get (&slot->format);
+  const gchar *module = "?";
+  guintptr offset = (guintptr) slot->pc;
+  Dl_info info;
+  gchar *key;
+  Entry *entry;
+
+  if (format == NULL)
+    return;
+
+  if (dladdr (slot->pc, &info) != 0 && info.dli_fname != NULL)
+    {
+      module = info.dli_fname;
+      offset -= (guintptr) info.dli_fbase;
+    }
+  if (!is_valid_field (module, "\t\n") || !is_valid_field (format, "\n"))
+    {
+      *dropped_calls += slot->calls;
+      return;
+    }
+
+  key = g_strdup_printf ("%s\t%s\t%" G_GINTPTR_MODIFIER "x\t%s",
+                         function_names[slot->function], module, offset, format);
+  entry = g_hash_table_lookup (entries, key);
+  if (entry == NULL)
+    {
+      entry = g_new0 (Entry, 1);
+      entry->function = slot->function;
+      entry->module = module;
+      entry->offset = offset;
+      entry->format = format;
+      g_hash_table_insert (entries, key, entry);
+    }
+  else
+    g_free (key);
+
+  entry->calls += slot->calls;
+  entry->nanoseconds += slot->nanoseconds;
+  entry->bytes += slot->bytes;
+}
+
+__attribute__ ((destructor)) static void
+dump (void)
+{
+  const gchar *path = g_getenv ("GGP_PROF_OUTPUT");
+  gchar *default_path = NULL;
+  GHashTable *entries;
+  GHashTableIter iter;
+  gpointer value;
+  guint64 dropped_calls = 0;
+  Table *table;
+  FILE *file;
+  guint idx;
+
+  table = g_atomic_pointer_get (&tables);
+  if (table == NULL)
+    return;
+
+  entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  for (; table != NULL; table = table->next)
+    {
+      dropped_calls += table->dropped_calls;
+      for (idx = 0; idx < TABLE_SLOTS; ++idx)
+        add_slot (entries, &table->slots[idx], &dropped_calls);
+    }
+
+  if (path == NULL)
+    path = default_path = g_strdup_printf ("ggp-prof.%d", (gint) getpid ());
+
+  file = fopen (path, "w");
+  if (file == NULL)
+    {
+      fprintf (stderr, "ggp-prof: failed to open %s for writing\n", path);
+      goto out;
+    }
+
+  fprintf (file, "ggp-profile %d\n", GGP_PROF_VERSION);
+  fprintf (file, "dropped %" G_GUINT64_FORMAT "\n", dropped_calls);
+  g_hash_table_iter_init (&iter, entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      const Entry *entry = value;
+
+      fprintf (file,
+               "%s\t%s\t%" G_GINTPTR_MODIFIER "x\t%" G_GUINT64_FORMAT "\t%" G_GUINT64_FORMAT "\t%" G_GUINT64_FORMAT "\t%s\n",
+               function_names[entry->function],
+               entry->module,
+               entry->offset,
+               entry->calls,
+               entry->nanoseconds,
+               entry->bytes,
+               entry->format);
+    }
+  fclose (file);
+
+ out:
+  g_free (default_path);
+  g_hash_table_unref (entries);
+}
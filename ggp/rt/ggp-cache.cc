@@ -0,0 +1,347 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Format program cache, meant to be used with LD_PRELOAD for programs
+// that can't be rebuilt with the plugin. It replaces the GVariant
+// functions taking a format string with versions that compile each
+// format into a program (see ggp/lib/program.hh) on the first call
+// and run it with libggp-rt afterwards, instead of having GLib scan
+// the format every time.
+//
+// Formats the runtime library can't run, invalid formats and
+// formats taking GVariant pointers checked by GLib against the type
+// ("@", "*", "?", "r") are left to GLib, so the behaviour stays the
+// same.
+
+#include "ggp/rt/ggp-rt.h"
+
+#include "ggp/rt/generated/program.hh"
+#include "ggp/rt/generated/variant.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct CacheEntry
+{
+  // The contents are compared on each hit, the pointer might have
+  // been reused for a different format.
+  std::string format;
+  // Empty if the format is left to GLib.
+  std::vector<guint8> program;
+  // GLib serializes the value before getting borrowed pointers from
+  // it, the cache does the same.
+  bool borrows;
+};
+
+// An open addressing table keyed with the format pointers. A slot is
+// claimed by setting its key and published by setting its entry, so
+// readers never wait. Slots are never freed, nor is the table ever
+// locked, so it stays usable in a child after fork - a slot claimed
+// by a thread that did not make it to the child stays unpublished
+// and its format is left to GLib.
+constexpr std::size_t cache_slots_count {4096u};
+constexpr std::size_t max_probes {8u};
+
+struct CacheSlot
+{
+  std::atomic<gchar const*> format;
+  std::atomic<CacheEntry const*> entry;
+};
+
+CacheSlot cache_slots[cache_slots_count];
+
+auto
+slot_index (gchar const* format,
+            std::size_t probe) -> std::size_t
+{
+  auto const key {reinterpret_cast<std::uintptr_t> (format)};
+
+  return ((key ^ (key >> 12u)) + probe) % cache_slots_count;
+}
+
+auto
+make_entry (gchar const* format) -> CacheEntry const*
+{
+  auto entry {new CacheEntry {format, {}, std::strchr (format, '&') != nullptr}};
+
+  if (std::strpbrk (format, "@*?r") != nullptr)
+  {
+    return entry;
+  }
+  if (auto const maybe_format {Ggp::Lib::VariantFormat::from_string (format)};
+      maybe_format && Ggp::Lib::program_is_runnable (*maybe_format))
+  {
+    entry->program = Ggp::Lib::compile_program (*maybe_format);
+  }
+
+  return entry;
+}
+
+auto
+get_usable_entry (CacheEntry const* entry,
+                  gchar const* format) -> CacheEntry const*
+{
+  if (entry == nullptr || entry->program.empty () || entry->format != format)
+  {
+    return nullptr;
+  }
+
+  return entry;
+}
+
+// Returns nullptr if the format should be left to GLib.
+auto
+lookup (gchar const* format) -> CacheEntry const*
+{
+  if (format == nullptr)
+  {
+    return nullptr;
+  }
+
+  for (auto probe {std::size_t {0u}}; probe < max_probes; ++probe)
+  {
+    auto& slot {cache_slots[slot_index (format, probe)]};
+    auto key {slot.format.load (std::memory_order_acquire)};
+
+    if (key == nullptr)
+    {
+      if (!slot.format.compare_exchange_strong (key, format, std::memory_order_acq_rel))
+      {
+        if (key == format)
+        {
+          return get_usable_entry (slot.entry.load (std::memory_order_acquire), format);
+        }
+        continue;
+      }
+
+      auto const entry {make_entry (format)};
+
+      slot.entry.store (entry, std::memory_order_release);
+
+      return get_usable_entry (entry, format);
+    }
+    if (key == format)
+    {
+      return get_usable_entry (slot.entry.load (std::memory_order_acquire), format);
+    }
+  }
+
+  return nullptr;
+}
+
+auto
+run_get (GVariant* value,
+         CacheEntry const* entry,
+         va_list* app) -> void
+{
+  if (entry->borrows)
+  {
+    g_variant_get_data (value);
+  }
+  ggp_variant_get_program_va (value, entry->program.data (), app);
+}
+
+} // anonymous namespace
+
+extern "C"
+{
+
+GVariant*
+g_variant_new (const gchar* format_string,
+               ...)
+{
+  auto const entry {lookup (format_string)};
+  GVariant* value;
+  va_list ap;
+
+  // g_variant_new_va accepts these, g_variant_new does not.
+  g_return_val_if_fail (format_string != nullptr && std::strchr ("?@*r", format_string[0]) == nullptr, nullptr);
+
+  va_start (ap, format_string);
+  if (entry != nullptr)
+  {
+    value = ggp_variant_new_program_va (entry->program.data (), &ap);
+  }
+  else
+  {
+    value = g_variant_new_va (format_string, nullptr, &ap);
+  }
+  va_end (ap);
+
+  return value;
+}
+
+void
+g_variant_get (GVariant* value,
+               const gchar* format_string,
+               ...)
+{
+  auto const entry {lookup (format_string)};
+  va_list ap;
+
+  va_start (ap, format_string);
+  if (entry != nullptr)
+  {
+    run_get (value, entry, &ap);
+  }
+  else
+  {
+    g_variant_get_va (value, format_string, nullptr, &ap);
+  }
+  va_end (ap);
+}
+
+void
+g_variant_get_child (GVariant* value,
+                     gsize index_,
+                     const gchar* format_string,
+                     ...)
+{
+  auto const entry {lookup (format_string)};
+  auto const child {g_variant_get_child_value (value, index_)};
+  va_list ap;
+
+  va_start (ap, format_string);
+  if (entry != nullptr)
+  {
+    run_get (child, entry, &ap);
+  }
+  else
+  {
+    g_variant_get_va (child, format_string, nullptr, &ap);
+  }
+  va_end (ap);
+  g_variant_unref (child);
+}
+
+void
+g_variant_builder_add (GVariantBuilder* builder,
+                       const gchar* format_string,
+                       ...)
+{
+  auto const entry {lookup (format_string)};
+  GVariant* value;
+  va_list ap;
+
+  va_start (ap, format_string);
+  if (entry != nullptr)
+  {
+    value = ggp_variant_new_program_va (entry->program.data (), &ap);
+  }
+  else
+  {
+    value = g_variant_new_va (format_string, nullptr, &ap);
+  }
+  va_end (ap);
+  g_variant_builder_add_value (builder, value);
+}
+
+gboolean
+g_variant_iter_next (GVariantIter* iter,
+                     const gchar* format_string,
+                     ...)
+{
+  auto const entry {lookup (format_string)};
+  auto const value {g_variant_iter_next_value (iter)};
+
+  if (value == nullptr)
+  {
+    return FALSE;
+  }
+
+  va_list ap;
+
+  va_start (ap, format_string);
+  if (entry != nullptr)
+  {
+    run_get (value, entry, &ap);
+  }
+  else
+  {
+    g_variant_get_va (value, format_string, nullptr, &ap);
+  }
+  va_end (ap);
+  g_variant_unref (value);
+
+  return TRUE;
+}
+
+gboolean
+g_variant_lookup (GVariant* dictionary,
+                  const gchar* key,
+                  const gchar* format_string,
+                  ...)
+{
+  auto const entry {lookup (format_string)};
+
+  g_return_val_if_fail (format_string != nullptr, FALSE);
+
+  // Like GLib, so the borrowed pointers live as long as the
+  // dictionary.
+  if (entry != nullptr ? entry->borrows : std::strchr (format_string, '&') != nullptr)
+  {
+    g_variant_get_data (dictionary);
+  }
+
+  GVariant* value;
+
+  if (entry != nullptr)
+  {
+    // The program keeps the type string of the format after the
+    // version byte.
+    value = g_variant_lookup_value (dictionary,
+                                    key,
+                                    reinterpret_cast<GVariantType const*> (entry->program.data () + 1));
+  }
+  else
+  {
+    auto const type {g_variant_format_string_scan_type (format_string, nullptr, nullptr)};
+
+    value = g_variant_lookup_value (dictionary, key, type);
+    g_variant_type_free (type);
+  }
+
+  if (value == nullptr)
+  {
+    return FALSE;
+  }
+
+  va_list ap;
+
+  va_start (ap, format_string);
+  if (entry != nullptr)
+  {
+    run_get (value, entry, &ap);
+  }
+  else
+  {
+    g_variant_get_va (value, format_string, nullptr, &ap);
+  }
+  va_end (ap);
+  g_variant_unref (value);
+
+  return TRUE;
+}
+
+} // extern "C"
@@ -0,0 +1,162 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/rt/ggp-rt.h"
+
+#include "ggp/rt/generated/arg-kind.hh"
+#include "ggp/rt/generated/variant.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+
+// An open addressing set of the pairs checked so far. Slots are only
+// set once and never cleared, so it needs no locks. The slots point
+// to the pairs themselves rather than to their hashes, so colliding
+// pairs are still told apart. When all the probed slots are taken,
+// the pair is treated as checked, so a full table does not cause a
+// parse and a g_critical on every call.
+constexpr std::size_t checked_slots_count {4096u};
+constexpr std::size_t max_probes {8u};
+
+struct CheckedPair
+{
+  gchar const* format;
+  gchar const* arg_kinds;
+};
+
+std::atomic<CheckedPair const*> checked_slots[checked_slots_count];
+
+auto
+slot_index (gchar const* format,
+            gchar const* arg_kinds,
+            std::size_t probe) -> std::size_t
+{
+  auto const key {(reinterpret_cast<std::uintptr_t> (format) * static_cast<std::uintptr_t> (0x9e3779b97f4a7c15u)) ^
+                  reinterpret_cast<std::uintptr_t> (arg_kinds)};
+
+  return ((key ^ (key >> 17u)) + probe) % checked_slots_count;
+}
+
+auto
+is_pair (CheckedPair const* pair,
+         gchar const* format,
+         gchar const* arg_kinds) -> bool
+{
+  return pair->format == format && pair->arg_kinds == arg_kinds;
+}
+
+// Returns true if the pair was added by this call.
+auto
+add_pair (gchar const* format,
+          gchar const* arg_kinds) -> bool
+{
+  CheckedPair const* new_pair {nullptr};
+
+  for (auto probe {std::size_t {0u}}; probe < max_probes; ++probe)
+  {
+    auto& slot {checked_slots[slot_index (format, arg_kinds, probe)]};
+    auto current {slot.load (std::memory_order_acquire)};
+
+    if (current == nullptr)
+    {
+      if (new_pair == nullptr)
+      {
+        new_pair = new CheckedPair {format, arg_kinds};
+      }
+      if (slot.compare_exchange_strong (current, new_pair, std::memory_order_acq_rel))
+      {
+        return true;
+      }
+      // Some other thread took the slot in the meantime, maybe for
+      // the same pair.
+    }
+    if (is_pair (current, format, arg_kinds))
+    {
+      delete new_pair;
+      return false;
+    }
+  }
+
+  delete new_pair;
+  return false;
+}
+
+auto
+check_format (gchar const* format,
+              GgpRtFormatUse use,
+              gchar const* arg_kinds,
+              gchar const* location) -> void
+{
+  if (format == nullptr)
+  {
+    g_critical ("%s: variant format is NULL", location);
+    return;
+  }
+
+  auto const maybe_format {Ggp::Lib::VariantFormat::from_string (format)};
+
+  if (!maybe_format)
+  {
+    g_critical ("%s: invalid variant format \"%s\"", location, format);
+    return;
+  }
+
+  auto const lib_use {use == GGP_RT_FORMAT_USE_NEW ? Ggp::Lib::FormatUse::New : Ggp::Lib::FormatUse::Get};
+  auto const maybe_kinds {Ggp::Lib::arg_kinds_for_format (*maybe_format, lib_use)};
+
+  if (!maybe_kinds)
+  {
+    return;
+  }
+  if (maybe_kinds->size () != std::strlen (arg_kinds))
+  {
+    g_critical ("%s: variant format \"%s\" expects %zu parameters, got %zu",
+                location,
+                format,
+                maybe_kinds->size (),
+                std::strlen (arg_kinds));
+    return;
+  }
+  if (!Ggp::Lib::arg_kinds_match (*maybe_kinds, arg_kinds))
+  {
+    g_critical ("%s: variant format \"%s\" expects parameters of kinds \"%s\", got \"%s\" "
+                "(i - int, x - 64-bit integer, d - double, p - pointer, 0 - literal zero)",
+                location,
+                format,
+                maybe_kinds->c_str (),
+                arg_kinds);
+  }
+}
+
+} // anonymous namespace
+
+extern "C" void
+ggp_rt_check_format (const gchar *format,
+                     GgpRtFormatUse use,
+                     const gchar *arg_kinds,
+                     const gchar *location)
+{
+  if (add_pair (format, arg_kinds))
+  {
+    check_format (format, use, arg_kinds, location);
+  }
+}
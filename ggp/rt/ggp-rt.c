@@ -0,0 +1,482 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp-rt.h"
+
+/* Keep in sync with ProgramOp in ggp/lib/program.hh. */
+enum
+{
+  OP_POINTER = 0x80,
+  OP_AT_TYPE,
+  OP_TUPLE,
+  OP_ENTRY,
+  OP_ARRAY,
+  OP_MAYBE,
+  OP_CONVENIENCE,
+};
+
+/* Most tuples are small, so their children are collected on the
+ * stack. */
+#define SMALL_TUPLE 16
+
+static gsize
+read_count (const guint8 **pc)
+{
+  gsize count = 0;
+  guint shift = 0;
+  guint8 byte;
+
+  do
+    {
+      byte = *(*pc)++;
+      count |= (gsize) (byte & 0x7f) << shift;
+      shift += 7;
+    }
+  while (byte & 0x80);
+
+  return count;
+}
+
+static void
+skip_type (const guint8 **pc)
+{
+  gsize count;
+
+  switch (*(*pc)++)
+    {
+    case OP_ARRAY:
+    case OP_MAYBE:
+      skip_type (pc);
+      break;
+
+    case OP_TUPLE:
+      for (count = read_count (pc); count > 0; --count)
+        skip_type (pc);
+      break;
+
+    case OP_ENTRY:
+      skip_type (pc);
+      skip_type (pc);
+      break;
+
+    default:
+      break;
+    }
+}
+
+/* Whether the type string at str, the type of some value, is of the
+ * encoded type, which may be indefinite. Advances both. */
+static gboolean
+type_matches (const guint8 **pc,
+              const gchar **str)
+{
+  guint8 op = *(*pc)++;
+  gsize count;
+
+  switch (op)
+    {
+    case OP_ARRAY:
+      return *(*str)++ == 'a' && type_matches (pc, str);
+
+    case OP_MAYBE:
+      return *(*str)++ == 'm' && type_matches (pc, str);
+
+    case OP_TUPLE:
+      if (*(*str)++ != '(')
+        return FALSE;
+      for (count = read_count (pc); count > 0; --count)
+        if (!type_matches (pc, str))
+          return FALSE;
+      return *(*str)++ == ')';
+
+    case OP_ENTRY:
+      return *(*str)++ == '{' && type_matches (pc, str) && type_matches (pc, str) && *(*str)++ == '}';
+
+    case '*':
+      return g_variant_type_string_scan (*str, NULL, str);
+
+    case '?':
+      return **str != '\0' && strchr ("bynqiuxthdsog", *(*str)++) != NULL;
+
+    case 'r':
+      return **str == '(' && g_variant_type_string_scan (*str, NULL, str);
+
+    default:
+      return *(*str)++ == op;
+    }
+}
+
+/* Only for the error messages. */
+static void
+append_type (const guint8 **pc,
+             GString *type)
+{
+  guint8 op = *(*pc)++;
+  gsize count;
+
+  switch (op)
+    {
+    case OP_ARRAY:
+      g_string_append_c (type, 'a');
+      append_type (pc, type);
+      break;
+
+    case OP_MAYBE:
+      g_string_append_c (type, 'm');
+      append_type (pc, type);
+      break;
+
+    case OP_TUPLE:
+      g_string_append_c (type, '(');
+      for (count = read_count (pc); count > 0; --count)
+        append_type (pc, type);
+      g_string_append_c (type, ')');
+      break;
+
+    case OP_ENTRY:
+      g_string_append_c (type, '{');
+      append_type (pc, type);
+      append_type (pc, type);
+      g_string_append_c (type, '}');
+      break;
+
+    default:
+      g_string_append_c (type, op);
+      break;
+    }
+}
+
+/* Takes a GVariant passed for "@type", "*", "?" or "r" and checks it
+ * against the type, aborting on a mismatch like g_variant_new. */
+static GVariant *
+take_typed_value (const guint8 **pc,
+                  va_list *app)
+{
+  GVariant *value = va_arg (*app, GVariant *);
+  const guint8 *type_start = *pc;
+  const guint8 *type_pc = type_start;
+  const gchar *str;
+
+  skip_type (pc);
+  if (G_UNLIKELY (value == NULL ||
+                  (str = g_variant_get_type_string (value),
+                   !type_matches (&type_pc, &str) || *str != '\0')))
+    {
+      GString *type = g_string_new (NULL);
+
+      type_pc = type_start;
+      append_type (&type_pc, type);
+      g_error ("g_variant_new: expected GVariant of type '%s' but "
+               "received value has type '%s'",
+               type->str,
+               value != NULL ? g_variant_get_type_string (value) : "(null)");
+    }
+
+  return value;
+}
+
+/* Skips the version byte and the type string. */
+static const guint8 *
+program_code (const guint8 *program)
+{
+  return program + 1 + strlen ((const gchar *) program + 1) + 1;
+}
+
+static GVariant *
+new_string_type (guint8 string_type,
+                 const gchar *string)
+{
+  switch (string_type)
+    {
+    case 's':
+      return g_variant_new_string (string);
+
+    case 'o':
+      return g_variant_new_object_path (string);
+
+    case 'g':
+      return g_variant_new_signature (string);
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static GVariant *
+run_new (const guint8 **pc,
+         va_list *app)
+{
+  guint8 op = *(*pc)++;
+
+  switch (op)
+    {
+    case 'b':
+      return g_variant_new_boolean (va_arg (*app, gboolean));
+
+    case 'y':
+      return g_variant_new_byte (va_arg (*app, guint));
+
+    case 'n':
+      return g_variant_new_int16 (va_arg (*app, gint));
+
+    case 'q':
+      return g_variant_new_uint16 (va_arg (*app, guint));
+
+    case 'i':
+      return g_variant_new_int32 (va_arg (*app, gint32));
+
+    case 'u':
+      return g_variant_new_uint32 (va_arg (*app, guint32));
+
+    case 'x':
+      return g_variant_new_int64 (va_arg (*app, gint64));
+
+    case 't':
+      return g_variant_new_uint64 (va_arg (*app, guint64));
+
+    case 'h':
+      return g_variant_new_handle (va_arg (*app, gint32));
+
+    case 'd':
+      return g_variant_new_double (va_arg (*app, gdouble));
+
+    case 's':
+    case 'o':
+    case 'g':
+      return new_string_type (op, va_arg (*app, const gchar *));
+
+    case 'v':
+      return g_variant_new_variant (va_arg (*app, GVariant *));
+
+    case OP_POINTER:
+      return new_string_type (*(*pc)++, va_arg (*app, const gchar *));
+
+    case OP_AT_TYPE:
+      return take_typed_value (pc, app);
+
+    case OP_TUPLE:
+      {
+        GVariant *small[SMALL_TUPLE];
+        GVariant **children = small;
+        GVariant *tuple;
+        gsize count = read_count (pc);
+        gsize idx;
+
+        if (count > SMALL_TUPLE)
+          children = g_new (GVariant *, count);
+        for (idx = 0; idx < count; ++idx)
+          children[idx] = run_new (pc, app);
+        tuple = g_variant_new_tuple (children, count);
+        if (children != small)
+          g_free (children);
+
+        return tuple;
+      }
+
+    case OP_ENTRY:
+      {
+        GVariant *key = run_new (pc, app);
+        GVariant *value = run_new (pc, app);
+
+        return g_variant_new_dict_entry (key, value);
+      }
+
+    default:
+      /* The plugin emits programs only for runnable formats. */
+      g_critical ("ggp-rt: unsupported program opcode 0x%02x", op);
+      return NULL;
+    }
+}
+
+static void
+get_string_type (GVariant *value,
+                 gboolean borrow,
+                 va_list *app)
+{
+  gpointer ptr = va_arg (*app, gpointer);
+
+  if (ptr == NULL)
+    return;
+  if (borrow)
+    *(const gchar **) ptr = g_variant_get_string (value, NULL);
+  else
+    *(gchar **) ptr = g_variant_dup_string (value, NULL);
+}
+
+static void
+run_get (GVariant *value,
+         const guint8 **pc,
+         va_list *app)
+{
+  guint8 op = *(*pc)++;
+  gpointer ptr;
+
+  switch (op)
+    {
+    case 's':
+    case 'o':
+    case 'g':
+      get_string_type (value, FALSE, app);
+      return;
+
+    case OP_POINTER:
+      ++*pc;
+      get_string_type (value, TRUE, app);
+      return;
+
+    case OP_TUPLE:
+    case OP_ENTRY:
+      {
+        gsize count = op == OP_ENTRY ? 2 : read_count (pc);
+        gsize idx;
+
+        for (idx = 0; idx < count; ++idx)
+          {
+            GVariant *child = g_variant_get_child_value (value, idx);
+
+            run_get (child, pc, app);
+            g_variant_unref (child);
+          }
+        return;
+      }
+
+    case OP_AT_TYPE:
+      skip_type (pc);
+      break;
+
+    default:
+      break;
+    }
+
+  ptr = va_arg (*app, gpointer);
+  if (ptr == NULL)
+    return;
+
+  switch (op)
+    {
+    case 'b':
+      *(gboolean *) ptr = g_variant_get_boolean (value);
+      break;
+
+    case 'y':
+      *(guint8 *) ptr = g_variant_get_byte (value);
+      break;
+
+    case 'n':
+      *(gint16 *) ptr = g_variant_get_int16 (value);
+      break;
+
+    case 'q':
+      *(guint16 *) ptr = g_variant_get_uint16 (value);
+      break;
+
+    case 'i':
+      *(gint32 *) ptr = g_variant_get_int32 (value);
+      break;
+
+    case 'u':
+      *(guint32 *) ptr = g_variant_get_uint32 (value);
+      break;
+
+    case 'x':
+      *(gint64 *) ptr = g_variant_get_int64 (value);
+      break;
+
+    case 't':
+      *(guint64 *) ptr = g_variant_get_uint64 (value);
+      break;
+
+    case 'h':
+      *(gint32 *) ptr = g_variant_get_handle (value);
+      break;
+
+    case 'd':
+      *(gdouble *) ptr = g_variant_get_double (value);
+      break;
+
+    case 'v':
+      *(GVariant **) ptr = g_variant_get_variant (value);
+      break;
+
+    case OP_AT_TYPE:
+      *(GVariant **) ptr = g_variant_ref (value);
+      break;
+
+    default:
+      g_critical ("ggp-rt: unsupported program opcode 0x%02x", op);
+      break;
+    }
+}
+
+GVariant *
+ggp_variant_new_program (const guint8 *program,
+                         ...)
+{
+  GVariant *value;
+  va_list ap;
+
+  va_start (ap, program);
+  value = ggp_variant_new_program_va (program, &ap);
+  va_end (ap);
+
+  return value;
+}
+
+GVariant *
+ggp_variant_new_program_va (const guint8 *program,
+                            va_list *app)
+{
+  const guint8 *pc;
+
+  g_return_val_if_fail (program != NULL && program[0] == GGP_RT_PROGRAM_VERSION, NULL);
+  g_return_val_if_fail (app != NULL, NULL);
+
+  pc = program_code (program);
+
+  return run_new (&pc, app);
+}
+
+void
+ggp_variant_get_program (GVariant *value,
+                         const guint8 *program,
+                         ...)
+{
+  va_list ap;
+
+  va_start (ap, program);
+  ggp_variant_get_program_va (value, program, &ap);
+  va_end (ap);
+}
+
+void
+ggp_variant_get_program_va (GVariant *value,
+                            const guint8 *program,
+                            va_list *app)
+{
+  const guint8 *pc;
+
+  g_return_if_fail (value != NULL);
+  g_return_if_fail (program != NULL && program[0] == GGP_RT_PROGRAM_VERSION);
+  g_return_if_fail (app != NULL);
+  /* The type string right after the version byte is what
+   * valid_format_string checks in g_variant_get. */
+  g_return_if_fail (g_variant_is_of_type (value, (const GVariantType *) (program + 1)));
+
+  pc = program_code (program);
+  run_get (value, &pc, app);
+}
@@ -0,0 +1,74 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GGP_RT_H
+#define GGP_RT_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Runtime support for the lowering subplugin. It runs format programs
+ * compiled by the plugin (see ggp/lib/program.hh for the layout)
+ * instead of parsing format strings on every call.
+ *
+ * The argument conventions are the same as in g_variant_new and
+ * g_variant_get. */
+
+#define GGP_RT_PROGRAM_VERSION 1
+
+GVariant *ggp_variant_new_program (const guint8 *program,
+                                   ...);
+
+GVariant *ggp_variant_new_program_va (const guint8 *program,
+                                      va_list *app);
+
+void ggp_variant_get_program (GVariant *value,
+                              const guint8 *program,
+                              ...);
+
+void ggp_variant_get_program_va (GVariant *value,
+                                 const guint8 *program,
+                                 va_list *app);
+
+/* Checks of formats that are not string literals, inserted by the
+ * runtime checker subplugin before the calls. */
+
+typedef enum
+{
+  GGP_RT_FORMAT_USE_NEW,
+  GGP_RT_FORMAT_USE_GET,
+} GgpRtFormatUse;
+
+/* Reports invalid formats and parameters not matching the format
+ * with g_critical. arg_kinds has a character for each parameter
+ * passed after the format: 'i' for int, 'x' for 64-bit integers,
+ * 'd' for double, 'p' for pointers, '0' for literal zeros of the
+ * size of a pointer, which match both 'x' and 'p', '?' for anything
+ * else. Each distinct pair of format and arg_kinds pointers is
+ * checked only once, later calls cost a few hash table probes. Once
+ * the table of checked pairs is full, pairs that don't fit are not
+ * checked. */
+void ggp_rt_check_format (const gchar *format,
+                          GgpRtFormatUse use,
+                          const gchar *arg_kinds,
+                          const gchar *location);
+
+G_END_DECLS
+
+#endif /* GGP_RT_H */
@@ -0,0 +1,78 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/advice.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+TEST_CASE ("Advice ranking", "[advice]")
+{
+  std::vector<AdviceSite> const sites {
+    {"a.c:1:1", "f", {}, "first"},
+    {"a.c:2:1", "f", {10u}, "second"},
+    {"a.c:3:1", "g", {2000000u}, "third"},
+    {"a.c:4:1", "g", {}, "fourth"},
+    {"a.c:5:1", "h", {10u}, "fifth"},
+    {"a.c:6:1", "h", {0u}, "sixth"},
+  };
+  auto const ranked {rank_advice (sites)};
+
+  REQUIRE (ranked.size () == sites.size ());
+  CHECK (ranked[0].message == "third");
+  CHECK (ranked[1].message == "second");
+  CHECK (ranked[2].message == "fifth");
+  CHECK (ranked[3].message == "sixth");
+  CHECK (ranked[4].message == "first");
+  CHECK (ranked[5].message == "fourth");
+}
+
+TEST_CASE ("Advice report", "[advice]")
+{
+  std::vector<AdviceSite> const sites {
+    {"a.c:1:1", "f", {}, "some advice"},
+    {"b.c:7:3", "g", {42u}, "other advice"},
+  };
+
+  CHECK (advice_report_to_string (sites) ==
+         "ggp-advice-report\n"
+         "42\tb.c:7:3\tg\tother advice\n"
+         "-\ta.c:1:1\tf\tsome advice\n");
+  CHECK (advice_report_to_string ({}) == "ggp-advice-report\n");
+}
+
+TEST_CASE ("Advice execution counts", "[advice]")
+{
+  ExecutionCounts counts;
+
+  add_execution_count (counts, "f", "a.c:2:1", 10u);
+  add_execution_count (counts, "f", "a.c:2:1", 42u);
+  add_execution_count (counts, "f", "a.c:2:1", 7u);
+  add_execution_count (counts, "g", "a.c:3:1", 0u);
+
+  CHECK (find_execution_count (counts, "f", "a.c:2:1") == std::optional<std::uint64_t> {42u});
+  CHECK (find_execution_count (counts, "g", "a.c:3:1") == std::optional<std::uint64_t> {0u});
+  CHECK_FALSE (find_execution_count (counts, "g", "a.c:2:1"));
+  CHECK_FALSE (find_execution_count (counts, "f", "a.c:1:1"));
+
+  AdviceSite site {"a.c:2:1", "f", {}, "some advice"};
+
+  CHECK (advice_text (site) == "some advice");
+  site.execution_count = find_execution_count (counts, site.function, site.location);
+  CHECK (advice_text (site) == "some advice [executed 42 time(s)]");
+}
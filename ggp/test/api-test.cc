@@ -0,0 +1,129 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/api.hh"
+
+#include "catch.hpp"
+
+#include <set>
+#include <string>
+
+using namespace Ggp::Lib;
+
+TEST_CASE ("Perfect hash", "[api]")
+{
+  SECTION ("No keys")
+  {
+    auto const hash {make_perfect_hash ({})};
+
+    CHECK (perfect_hash_lookup (hash, "foo") == no_key_index);
+  }
+
+  SECTION ("Many keys")
+  {
+    std::vector<std::string> storage;
+
+    for (auto idx {0u}; idx < 1000u; ++idx)
+    {
+      storage.push_back ("function_" + std::to_string (idx));
+    }
+
+    std::vector<std::string_view> const keys (storage.begin (), storage.end ());
+    auto const hash {make_perfect_hash (keys)};
+    std::set<std::uint32_t> indices;
+
+    CHECK (hash.slots.size () >= keys.size ());
+    for (auto idx {0u}; idx < keys.size (); ++idx)
+    {
+      CHECK (perfect_hash_lookup (hash, keys[idx]) == idx);
+      indices.insert (perfect_hash_lookup (hash, keys[idx]));
+    }
+    CHECK (indices.size () == keys.size ());
+  }
+}
+
+TEST_CASE ("API table", "[api]")
+{
+  auto const table {make_api_table (glib_api_functions ())};
+
+  for (auto const& function : glib_api_functions ())
+  {
+    auto const found {find_api_function (table, function.name)};
+
+    REQUIRE (found != nullptr);
+    CHECK (*found == function);
+    CHECK (function.args_index > function.string_index);
+  }
+
+  auto const builder_add {find_api_function (table, "g_variant_builder_add")};
+
+  REQUIRE (builder_add != nullptr);
+  CHECK (*builder_add == ApiFunction {"g_variant_builder_add", FormatUse::New, 2u, 3u});
+
+  CHECK (find_api_function (table, "g_variant_new_parsed") == nullptr);
+  CHECK (find_api_function (table, "") == nullptr);
+  CHECK (find_api_function (table, "g_variant_ne") == nullptr);
+}
+
+TEST_CASE ("API table overrides", "[api]")
+{
+  auto functions {glib_api_functions ()};
+
+  functions.push_back ({"g_variant_new", FormatUse::Get, 2u, 4u});
+  functions.push_back ({"my_lib_pack", FormatUse::New, 2u, 3u});
+
+  auto const table {make_api_table (functions)};
+
+  CHECK (table.functions.size () == glib_api_functions ().size () + 1u);
+
+  auto const new_function {find_api_function (table, "g_variant_new")};
+  auto const my_function {find_api_function (table, "my_lib_pack")};
+
+  REQUIRE (new_function != nullptr);
+  CHECK (*new_function == ApiFunction {"g_variant_new", FormatUse::Get, 2u, 4u});
+  REQUIRE (my_function != nullptr);
+  CHECK (*my_function == ApiFunction {"my_lib_pack", FormatUse::New, 2u, 3u});
+}
+
+TEST_CASE ("API spec", "[api]")
+{
+  SECTION ("Valid")
+  {
+    auto const functions {parse_api_spec ("# my library\n"
+                                          "\n"
+                                          "my_lib_pack new 2 3\n"
+                                          "  my_lib_unpack\tget  3 5\r\n"
+                                          "my_lib_last new 1 2")};
+
+    REQUIRE (functions);
+    CHECK (*functions == std::vector<ApiFunction> {
+        {"my_lib_pack", FormatUse::New, 2u, 3u},
+        {"my_lib_unpack", FormatUse::Get, 3u, 5u},
+        {"my_lib_last", FormatUse::New, 1u, 2u},
+      });
+  }
+
+  SECTION ("Malformed")
+  {
+    CHECK_FALSE (parse_api_spec ("my_lib_pack new 2\n"));
+    CHECK_FALSE (parse_api_spec ("my_lib_pack new 2 3 4\n"));
+    CHECK_FALSE (parse_api_spec ("my_lib_pack set 2 3\n"));
+    CHECK_FALSE (parse_api_spec ("my_lib_pack new 0 3\n"));
+    CHECK_FALSE (parse_api_spec ("my_lib_pack new 3 3\n"));
+    CHECK_FALSE (parse_api_spec ("my_lib_pack new x 3\n"));
+  }
+}
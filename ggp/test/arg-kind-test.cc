@@ -0,0 +1,75 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/test/generated/arg-kind.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "ggp/test/test-print.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+kinds (char const* str, FormatUse use) -> std::optional<std::string>
+{
+  auto v {VariantFormat::from_string (str)};
+
+  REQUIRE(v);
+
+  return arg_kinds_for_format (*v, use);
+}
+
+auto
+just (char const* str) -> std::optional<std::string>
+{
+  return {str};
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Formats have parameter kinds", "[arg-kind]")
+{
+  CHECK (kinds ("(bynqiuxthd)", FormatUse::New) == just ("iiiiiixxid"));
+  CHECK (kinds ("(bynqiuxthd)", FormatUse::Get) == just ("pppppppppp"));
+  CHECK (kinds ("(s&sogv)", FormatUse::New) == just ("ppppp"));
+  CHECK (kinds ("{sv}", FormatUse::Get) == just ("pp"));
+  CHECK (kinds ("(@a{sv}*?r)", FormatUse::New) == just ("pppp"));
+  CHECK (kinds ("as", FormatUse::New) == just ("p"));
+  CHECK (kinds ("^as", FormatUse::Get) == just ("p"));
+  CHECK (kinds ("ms", FormatUse::New) == just ("p"));
+  CHECK (kinds ("mi", FormatUse::New) == just ("ii"));
+  CHECK (kinds ("m(ix)", FormatUse::New) == just ("iix"));
+  CHECK (kinds ("mi", FormatUse::Get) == just ("pp"));
+  CHECK (kinds ("()", FormatUse::New) == just (""));
+}
+
+TEST_CASE ("Literal zeros match pointers and 64-bit integers", "[arg-kind]")
+{
+  CHECK (arg_kind_matches ('p', '0'));
+  CHECK (arg_kind_matches ('x', '0'));
+  CHECK_FALSE (arg_kind_matches ('i', '0'));
+  CHECK_FALSE (arg_kind_matches ('d', '0'));
+  CHECK_FALSE (arg_kind_matches ('0', 'p'));
+  CHECK (arg_kinds_match ("ixp", "i00"));
+  CHECK_FALSE (arg_kinds_match ("ixp", "00p"));
+  CHECK_FALSE (arg_kinds_match ("ixp", "ix"));
+}
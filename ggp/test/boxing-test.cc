@@ -0,0 +1,113 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/boxing.hh"
+#include "ggp/test/generated/variant-print.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "ggp/test/test-print.hh"
+
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+vt (char const* str) -> VariantType
+{
+  auto v {VariantType::from_string (str)};
+
+  REQUIRE(v);
+
+  return std::move (*v);
+}
+
+auto
+vf (char const* str) -> VariantFormat
+{
+  auto v {VariantFormat::from_string (str)};
+
+  REQUIRE(v);
+
+  return std::move (*v);
+}
+
+auto
+unbox (char const* format,
+       std::size_t arg_index,
+       char const* type) -> std::optional<std::string>
+{
+  auto maybe_format {unbox_format_arg (vf (format), arg_index, vt (type))};
+
+  if (!maybe_format)
+  {
+    return {};
+  }
+
+  std::ostringstream oss;
+
+  oss << *maybe_format;
+
+  return {oss.str ()};
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Boxing overhead", "[boxing]")
+{
+  CHECK (boxing_overhead (vt ("i")) == std::optional<BoxingOverhead> {{2u, 4u}});
+  CHECK (boxing_overhead (vt ("y")) == std::optional<BoxingOverhead> {{2u, 7u}});
+  CHECK (boxing_overhead (vt ("x")) == std::optional<BoxingOverhead> {{2u, 0u}});
+  CHECK (boxing_overhead (vt ("s")) == std::optional<BoxingOverhead> {{2u, 7u}});
+  CHECK (boxing_overhead (vt ("a{sv}")) == std::optional<BoxingOverhead> {{6u, 0u}});
+  CHECK (boxing_overhead (vt ("(ius)")) == std::optional<BoxingOverhead> {{6u, 4u}});
+  CHECK (total_overhead ({6u, 4u}) == 10u);
+  CHECK_FALSE (boxing_overhead (vt ("a*")));
+}
+
+TEST_CASE ("Formats taking variants", "[boxing]")
+{
+  CHECK (takes_variant (vf ("v")));
+  CHECK (takes_variant (vf ("@v")));
+  CHECK_FALSE (takes_variant (vf ("@s")));
+  CHECK_FALSE (takes_variant (vf ("(v)")));
+  CHECK_FALSE (takes_variant (vf ("av")));
+}
+
+TEST_CASE ("Unboxing format arguments", "[boxing]")
+{
+  CHECK (unbox ("v", 0u, "i") == std::optional<std::string> {"i"});
+  CHECK (unbox ("{sv}", 1u, "u") == std::optional<std::string> {"{su}"});
+  CHECK (unbox ("{&sv}", 1u, "s") == std::optional<std::string> {"{&ss}"});
+  CHECK (unbox ("{s@v}", 1u, "o") == std::optional<std::string> {"{so}"});
+  CHECK (unbox ("(v)", 0u, "(ii)") == std::optional<std::string> {"(@(ii))"});
+  CHECK (unbox ("(sv)", 1u, "as") == std::optional<std::string> {"(s@as)"});
+  CHECK (unbox ("(vv)", 1u, "b") == std::optional<std::string> {"(vb)"});
+  // The maybe takes a flag and then the tuple members.
+  CHECK (unbox ("(m(ii)v)", 3u, "d") == std::optional<std::string> {"(m(ii)d)"});
+  CHECK (unbox ("(i&sv)", 2u, "t") == std::optional<std::string> {"(i&st)"});
+
+  CHECK_FALSE (unbox ("{sv}", 0u, "u"));
+  CHECK_FALSE (unbox ("(sv)", 2u, "u"));
+  CHECK_FALSE (unbox ("@s", 0u, "u"));
+  // Variants inside maybes are left alone.
+  CHECK_FALSE (unbox ("mv", 0u, "u"));
+}
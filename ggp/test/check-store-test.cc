@@ -0,0 +1,94 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/check-store.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+TEST_CASE ("Text hashing", "[check-store]")
+{
+  CHECK (hash_text (hash_seed, "") != hash_seed);
+  CHECK (hash_text (hash_seed, "ab") == hash_text (hash_seed, "ab"));
+  CHECK (hash_text (hash_seed, "ab") != hash_text (hash_seed, "ba"));
+  // Texts mixed in one after another do not run into each other.
+  CHECK (hash_text (hash_text (hash_seed, "a"), "b") != hash_text (hash_seed, "ab"));
+  CHECK (hash_text (hash_text (hash_seed, "ab"), "") != hash_text (hash_text (hash_seed, "a"), "b"));
+}
+
+TEST_CASE ("Check file names", "[check-store]")
+{
+  CheckKey const key {"foo.h", 10u, 1u, 0x1234u};
+  auto const name {check_file_name (key)};
+
+  CHECK (name.size () == 16u + std::string_view {".ggp-check"}.size ());
+  CHECK (name.substr (16u) == ".ggp-check");
+  CHECK (name.find_first_not_of ("0123456789abcdef") == 16u);
+  CHECK (check_file_name (key) == name);
+  CHECK (check_file_name ({"foo.h", 10u, 1u, 0x1235u}) != name);
+  CHECK (check_file_name ({"foo.h", 11u, 1u, 0x1234u}) != name);
+  CHECK (check_file_name ({"bar.h", 10u, 1u, 0x1234u}) != name);
+}
+
+TEST_CASE ("Check records", "[check-store]")
+{
+  SECTION ("Round trip")
+  {
+    CheckRecord const record {
+      {"inc/foo\tbar.h", 10u, 1u, 0xdeadbeefcafeu},
+      {
+        {"vc-invalid-format", "invalid variant format", "inc/foo\tbar.h", 12u, 3u, "(s\\", {}, "", ""},
+        {"vc-arg-type", "invalid arg 0", "inc/foo\tbar.h", 13u, 5u, "(i)", {0u}, "gint32", "gchar\n*"},
+      },
+    };
+    auto const text {check_record_to_string (record)};
+
+    CHECK (text ==
+           "ggp-check 2\n"
+           "inc/foo\\tbar.h\t10\t1\tdeadbeefcafe\n"
+           "vc-invalid-format\tinvalid variant format\tinc/foo\\tbar.h\t12\t3\t-\t\t\t(s\\\\\n"
+           "vc-arg-type\tinvalid arg 0\tinc/foo\\tbar.h\t13\t5\t0\tgint32\tgchar\\n*\t(i)\n");
+
+    auto const parsed {parse_check_record (text)};
+
+    REQUIRE (parsed);
+    CHECK (*parsed == record);
+  }
+
+  SECTION ("No diagnostics")
+  {
+    CheckRecord const record {{"foo.h", 1u, 2u, 3u}, {}};
+    auto const parsed {parse_check_record (check_record_to_string (record))};
+
+    REQUIRE (parsed);
+    CHECK (*parsed == record);
+  }
+
+  SECTION ("Malformed")
+  {
+    CHECK_FALSE (parse_check_record (""));
+    CHECK_FALSE (parse_check_record ("ggp-check 0\nfoo.h\t1\t2\t3\n"));
+    CHECK_FALSE (parse_check_record ("ggp-check 1\nfoo.h\t1\t2\t3\n"));
+    CHECK_FALSE (parse_check_record ("ggp-check 2\nfoo.h\t1\t2\n"));
+    CHECK_FALSE (parse_check_record ("ggp-check 2\nfoo.h\t1\t2\t3"));
+    CHECK_FALSE (parse_check_record ("ggp-check 2\nfoo.h\t1\t2\tx\n"));
+    CHECK_FALSE (parse_check_record ("ggp-check 2\nfoo.h\t1\t2\t3\nr\tm\tf\t1\t1\t-\t\t\n"));
+    CHECK_FALSE (parse_check_record ("ggp-check 2\nfoo.h\t1\t2\t3\nr\tm\tf\t1\t1\tx\t\t\t\n"));
+    CHECK_FALSE (parse_check_record ("ggp-check 2\nfoo\\x.h\t1\t2\t3\n"));
+  }
+}
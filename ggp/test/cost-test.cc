@@ -0,0 +1,136 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/arg-kind.hh"
+#include "ggp/test/generated/cost.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "ggp/test/test-print.hh"
+
+#include "catch.hpp"
+
+#include <limits>
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+vf (char const* str) -> VariantFormat
+{
+  auto v {VariantFormat::from_string (str)};
+
+  REQUIRE(v);
+
+  return std::move (*v);
+}
+
+struct CostCase
+{
+  char const* format;
+  FormatUse use;
+  Cost fixed;
+  Cost per_element;
+  bool fixed_size;
+};
+
+} // anonymous namespace
+
+TEST_CASE ("Format costs", "[cost]")
+{
+  std::vector<CostCase> const cases {
+    {"i", FormatUse::New, {1u, 0u, 4u}, {0u, 0u, 0u}, true},
+    {"i", FormatUse::Get, {0u, 0u, 4u}, {0u, 0u, 0u}, true},
+    {"s", FormatUse::New, {1u, 1u, 1u}, {0u, 0u, 0u}, false},
+    {"s", FormatUse::Get, {0u, 1u, 1u}, {0u, 0u, 0u}, false},
+    {"&s", FormatUse::New, {1u, 1u, 1u}, {0u, 0u, 0u}, false},
+    {"&s", FormatUse::Get, {0u, 0u, 1u}, {0u, 0u, 0u}, false},
+    {"(ii)", FormatUse::New, {3u, 0u, 8u}, {0u, 0u, 0u}, true},
+    {"(ii)", FormatUse::Get, {2u, 0u, 8u}, {0u, 0u, 0u}, true},
+    {"(s^as)", FormatUse::New, {3u, 1u, 2u}, {1u, 1u, 2u}, false},
+    {"(s^a&s)", FormatUse::Get, {3u, 1u, 2u}, {1u, 0u, 2u}, false},
+    {"(s^as)", FormatUse::Get, {3u, 1u, 2u}, {1u, 1u, 2u}, false},
+    {"a{sv}", FormatUse::New, {1u, 0u, 0u}, {0u, 0u, 17u}, false},
+    {"@a{sv}", FormatUse::New, {0u, 0u, 0u}, {0u, 0u, 17u}, false},
+    {"{sv}", FormatUse::Get, {3u, 1u, 13u}, {0u, 0u, 0u}, false},
+    {"ms", FormatUse::New, {2u, 1u, 0u}, {0u, 0u, 0u}, false},
+    {"m&s", FormatUse::Get, {1u, 0u, 0u}, {0u, 0u, 0u}, false},
+    {"^ay", FormatUse::New, {1u, 1u, 0u}, {0u, 0u, 1u}, false},
+    {"^ay", FormatUse::Get, {0u, 1u, 0u}, {0u, 0u, 1u}, false},
+    {"^&ay", FormatUse::Get, {0u, 0u, 0u}, {0u, 0u, 1u}, false},
+    {"(aas)", FormatUse::New, {2u, 0u, 0u}, {0u, 0u, 1u}, false},
+    {"v", FormatUse::Get, {1u, 0u, 4u}, {0u, 0u, 0u}, false},
+  };
+
+  for (auto const& c : cases)
+  {
+    INFO ("format: " << c.format << ", get: " << (c.use == FormatUse::Get));
+
+    auto const cost {format_cost (vf (c.format), c.use)};
+
+    CHECK (cost.fixed == c.fixed);
+    CHECK (cost.per_element == c.per_element);
+    CHECK (cost.fixed_size == c.fixed_size);
+  }
+}
+
+TEST_CASE ("Cost evaluation and scores", "[cost]")
+{
+  FormatCost const cost {{3u, 1u, 2u}, {1u, 1u, 2u}, false};
+
+  CHECK (evaluate_cost (cost, 0u) == cost.fixed);
+  CHECK (evaluate_cost (cost, 4u) == Cost {7u, 5u, 10u});
+  CHECK (cost_score ({1u, 0u, 0u}) > cost_score ({0u, 1u, 0u}));
+  CHECK (cost_score ({0u, 1u, 0u}) > cost_score ({0u, 0u, 1u}));
+  CHECK (cost_score ({0u, 0u, 0u}) == 0u);
+
+  CostSite site {"a.c:1:1", "f", "g_variant_new", "s", 0u, {}, format_cost (vf ("s"), FormatUse::New)};
+  auto const score {site_score (site)};
+
+  CHECK (score == cost_score ({1u, 1u, 1u}));
+  site.loop_depth = 2u;
+  CHECK (site_score (site) == score * assumed_iterations * assumed_iterations);
+  site.loop_depth = 100u;
+  CHECK (site_score (site) == std::numeric_limits<std::uint64_t>::max ());
+  // Execution counts from profile feedback replace the loop depth.
+  site.execution_count = 5u;
+  CHECK (site_score (site) == score * 5u);
+  site.execution_count = 0u;
+  CHECK (site_score (site) == 0u);
+}
+
+TEST_CASE ("Cost report", "[cost]")
+{
+  std::vector<CostSite> const sites {
+    {"a.c:10:3", "build", "g_variant_new", "(ii)", 0u, {}, format_cost (vf ("(ii)"), FormatUse::New)},
+    {"a.c:20:5", "loop", "g_variant_new", "s", 1u, {}, format_cost (vf ("s"), FormatUse::New)},
+    {"a.c:30:5", "read", "g_variant_get", "(ii)", 0u, {1000u}, format_cost (vf ("(ii)"), FormatUse::Get)},
+    {"a.c:40:3", "build2", "g_variant_new", "(ii)", 0u, {}, format_cost (vf ("(ii)"), FormatUse::New)},
+  };
+  auto const s_score {std::to_string (site_score (sites[1]))};
+  auto const new_score {std::to_string (site_score (sites[0]))};
+  auto const get_score {std::to_string (site_score (sites[2]))};
+
+  CHECK (cost_report_to_string (sites) ==
+         "ggp-cost-report 8 10\n" +
+         get_score + "\ta.c:30:5\tread\tg_variant_get\t0\t1000\t2+0\t0+0\t8+0\tfixed\t(ii)\n" +
+         s_score + "\ta.c:20:5\tloop\tg_variant_new\t1\t-\t1+0\t1+0\t1+0\tvariable\ts\n" +
+         new_score + "\ta.c:10:3\tbuild\tg_variant_new\t0\t-\t3+0\t0+0\t8+0\tfixed\t(ii)\n" +
+         new_score + "\ta.c:40:3\tbuild2\tg_variant_new\t0\t-\t3+0\t0+0\t8+0\tfixed\t(ii)\n");
+  CHECK (cost_report_to_string ({}) == "ggp-cost-report 8 10\n");
+}
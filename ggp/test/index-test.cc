@@ -0,0 +1,132 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/index.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+make_sites () -> std::vector<IndexSite>
+{
+  return {
+    {"a.c", 10u, 3u, "build", "g_variant_new", "(si)", FormatUse::New, "const gchar *;gint", 1u,
+     {{3u, 1u, 8u}, {0u, 0u, 0u}, false}},
+    {"a.c", 20u, 5u, "read", "g_variant_get", "(si)", FormatUse::Get, "gchar * *;gint *", 0u,
+     {{2u, 1u, 8u}, {0u, 0u, 0u}, false}},
+    {"b.c", 7u, 1u, "list", "g_variant_new", "(^as)", FormatUse::New, "gchar * *", 2u,
+     {{2u, 0u, 0u}, {1u, 1u, 2u}, false}},
+    {"b.c", 9u, 1u, "pair", "g_variant_new", "(ii)", FormatUse::New, "gint;gint", 0u,
+     {{3u, 0u, 8u}, {0u, 0u, 0u}, true}},
+  };
+}
+
+auto
+view_to_site (IndexSiteView const& view) -> IndexSite
+{
+  return {std::string {view.file},
+          view.line,
+          view.column,
+          std::string {view.function},
+          std::string {view.callee},
+          std::string {view.format},
+          view.use,
+          std::string {view.arg_types},
+          view.loop_depth,
+          view.cost};
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Index round trip", "[index]")
+{
+  auto const sites {make_sites ()};
+  auto const bytes {index_to_bytes (sites)};
+  auto const maybe_views {parse_index (bytes)};
+
+  REQUIRE (maybe_views);
+  REQUIRE (maybe_views->size () == sites.size ());
+  for (std::size_t idx {0u}; idx < sites.size (); ++idx)
+  {
+    INFO ("site: " << idx);
+    CHECK (view_to_site ((*maybe_views)[idx]) == sites[idx]);
+  }
+
+  auto const empty_bytes {index_to_bytes ({})};
+
+  CHECK (empty_bytes.size () == 32u);
+  CHECK (parse_index (empty_bytes) == std::optional<std::vector<IndexSiteView>> {std::vector<IndexSiteView> {}});
+}
+
+TEST_CASE ("Index layout", "[index]")
+{
+  auto const bytes {index_to_bytes (make_sites ())};
+
+  CHECK (bytes.substr (0u, 8u) == std::string {"GGPIDX\0\0", 8u});
+  // Version 1, 4 sites, and the strings are interned - "a.c", "b.c",
+  // 4 functions, 2 callees, 3 formats and 4 argument types.
+  CHECK (bytes.substr (8u, 8u) == std::string {"\1\0\0\0\4\0\0\0", 8u});
+  CHECK (bytes.substr (16u, 4u) == std::string {"\17\0\0\0", 4u});
+  // The sites are aligned for mmap.
+  CHECK (bytes.substr (32u, 4u) == std::string {"\0\0\0\0", 4u});
+  CHECK (bytes.substr (36u, 4u) == std::string {"\12\0\0\0", 4u});
+}
+
+TEST_CASE ("Argument types", "[index]")
+{
+  CHECK (split_arg_types ("") == std::vector<std::string_view> {});
+  CHECK (split_arg_types ("gint") == std::vector<std::string_view> {"gint"});
+  CHECK (split_arg_types ("const gchar *;gint;void (*) (int, int)") ==
+         std::vector<std::string_view> {"const gchar *", "gint", "void (*) (int, int)"});
+}
+
+TEST_CASE ("Malformed indices", "[index]")
+{
+  auto const bytes {index_to_bytes (make_sites ())};
+
+  CHECK_FALSE (parse_index (""));
+  CHECK_FALSE (parse_index (std::string_view {bytes}.substr (0u, 31u)));
+  CHECK_FALSE (parse_index (std::string_view {bytes}.substr (0u, bytes.size () - 1u)));
+  CHECK_FALSE (parse_index (bytes + '\0'));
+
+  auto bad_magic {bytes};
+
+  bad_magic[0] = 'X';
+  CHECK_FALSE (parse_index (bad_magic));
+
+  auto bad_version {bytes};
+
+  bad_version[8] = '\2';
+  CHECK_FALSE (parse_index (bad_version));
+
+  // The format of the first site refers to a string past the end of
+  // the string offsets.
+  auto bad_string {bytes};
+
+  bad_string[32u + 20u] = '\77';
+  CHECK_FALSE (parse_index (bad_string));
+
+  // The last string is not terminated.
+  auto unterminated {bytes};
+
+  unterminated.back () = 'x';
+  CHECK_FALSE (parse_index (unterminated));
+}
@@ -0,0 +1,219 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/test/generated/layout.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "ggp/test/test-print.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+lfs (char const* str) -> std::optional<Layout>
+{
+  auto v {VariantType::from_string (str)};
+
+  REQUIRE(v);
+
+  return layout_of (*v);
+}
+
+auto
+ofs (char const* str) -> std::optional<std::vector<std::size_t>>
+{
+  auto v {VariantType::from_string (str)};
+
+  REQUIRE(v);
+
+  return fixed_member_offsets (*v);
+}
+
+auto
+fixed (std::size_t alignment, std::size_t size) -> std::optional<Layout>
+{
+  return {{alignment, {size}}};
+}
+
+auto
+variable (std::size_t alignment) -> std::optional<Layout>
+{
+  return {{alignment, {}}};
+}
+
+auto
+offsets (std::vector<std::size_t> const& o) -> std::optional<std::vector<std::size_t>>
+{
+  return {o};
+}
+
+auto none_l {std::optional<Layout> {}};
+auto none_o {std::optional<std::vector<std::size_t>> {}};
+
+} // anonymous namespace
+
+TEST_CASE ("Variant types are laid out", "[layout]")
+{
+  SECTION ("basic types")
+  {
+    CHECK (lfs ("b") == fixed (1, 1));
+    CHECK (lfs ("y") == fixed (1, 1));
+    CHECK (lfs ("n") == fixed (2, 2));
+    CHECK (lfs ("q") == fixed (2, 2));
+    CHECK (lfs ("i") == fixed (4, 4));
+    CHECK (lfs ("u") == fixed (4, 4));
+    CHECK (lfs ("x") == fixed (8, 8));
+    CHECK (lfs ("t") == fixed (8, 8));
+    CHECK (lfs ("h") == fixed (4, 4));
+    CHECK (lfs ("d") == fixed (8, 8));
+  }
+
+  SECTION ("variable size types")
+  {
+    CHECK (lfs ("s") == variable (1));
+    CHECK (lfs ("o") == variable (1));
+    CHECK (lfs ("g") == variable (1));
+    CHECK (lfs ("v") == variable (8));
+    CHECK (lfs ("ay") == variable (1));
+    CHECK (lfs ("at") == variable (8));
+    CHECK (lfs ("mi") == variable (4));
+    CHECK (lfs ("a{sv}") == variable (8));
+  }
+
+  SECTION ("tuples and entries")
+  {
+    CHECK (lfs ("()") == fixed (1, 1));
+    CHECK (lfs ("(y)") == fixed (1, 1));
+    CHECK (lfs ("(yi)") == fixed (4, 8));
+    CHECK (lfs ("(iy)") == fixed (4, 8));
+    CHECK (lfs ("(nyt)") == fixed (8, 16));
+    CHECK (lfs ("((yy)n(i))") == fixed (4, 8));
+    CHECK (lfs ("{yd}") == fixed (8, 16));
+    CHECK (lfs ("(is)") == variable (4));
+    CHECK (lfs ("(sx)") == variable (8));
+    CHECK (lfs ("{sv}") == variable (8));
+  }
+
+  SECTION ("indefinite types")
+  {
+    CHECK (lfs ("*") == none_l);
+    CHECK (lfs ("?") == none_l);
+    CHECK (lfs ("r") == none_l);
+    CHECK (lfs ("a*") == none_l);
+    CHECK (lfs ("(ir)") == none_l);
+    CHECK (lfs ("{?i}") == none_l);
+  }
+}
+
+TEST_CASE ("Fixed size members get offsets", "[layout]")
+{
+  CHECK (ofs ("()") == offsets ({}));
+  CHECK (ofs ("(yi)") == offsets ({0, 4}));
+  CHECK (ofs ("(ybnqiuxthd)") == offsets ({0, 1, 2, 4, 8, 12, 16, 24, 32, 40}));
+  CHECK (ofs ("((yy)n(i))") == offsets ({0, 2, 4}));
+  CHECK (ofs ("{yd}") == offsets ({0, 8}));
+
+  CHECK (ofs ("i") == none_o);
+  CHECK (ofs ("(is)") == none_o);
+  CHECK (ofs ("(si)") == none_o);
+  CHECK (ofs ("(r)") == none_o);
+}
+
+TEST_CASE ("Framing offsets are as small as the container allows", "[layout]")
+{
+  CHECK (framing_offset_size (0u, 0u) == 0u);
+  CHECK (framing_offset_size (10u, 2u) == 1u);
+  CHECK (framing_offset_size (253u, 2u) == 1u);
+  CHECK (framing_offset_size (254u, 2u) == 2u);
+  CHECK (framing_offset_size (65400u, 100u) == 4u);
+  CHECK (framing_offset_size (std::size_t {1u} << 32u, 1u) == 8u);
+}
+
+TEST_CASE ("Container sizes are split into children, padding and framing", "[layout]")
+{
+  auto const cs {[](char const* str, std::vector<std::size_t> const& child_sizes)
+  {
+    auto v {VariantType::from_string (str)};
+
+    REQUIRE(v);
+
+    return container_size (*v, child_sizes);
+  }};
+  auto const size {[](std::size_t children, std::size_t padding, std::size_t framing)
+  {
+    return std::optional<ContainerSize> {{children, padding, framing}};
+  }};
+  std::optional<ContainerSize> const none {};
+
+  SECTION ("tuples and dict entries")
+  {
+    CHECK (cs ("()", {}) == size (0, 0, 1));
+    CHECK (cs ("(yi)", {1, 4}) == size (5, 3, 0));
+    CHECK (cs ("(iy)", {4, 1}) == size (5, 3, 0));
+    // The last member needs no offset.
+    CHECK (cs ("(is)", {4, 4}) == size (8, 0, 0));
+    CHECK (cs ("(si)", {3, 4}) == size (7, 1, 1));
+    CHECK (cs ("(ssi)", {2, 2, 4}) == size (8, 0, 2));
+    CHECK (cs ("{sv}", {2, 6}) == size (8, 6, 1));
+  }
+
+  SECTION ("arrays")
+  {
+    CHECK (cs ("ai", {}) == size (0, 0, 0));
+    CHECK (cs ("ai", {4, 4, 4}) == size (12, 0, 0));
+    CHECK (cs ("as", {2, 3}) == size (5, 0, 2));
+    CHECK (cs ("a(si)", {9, 9}) == size (18, 3, 2));
+  }
+
+  SECTION ("maybes")
+  {
+    CHECK (cs ("ms", {}) == size (0, 0, 0));
+    CHECK (cs ("ms", {3}) == size (3, 0, 1));
+    CHECK (cs ("mi", {4}) == size (4, 0, 0));
+  }
+
+  SECTION ("mismatched children and other types")
+  {
+    CHECK (cs ("(is)", {4}) == none);
+    CHECK (cs ("mi", {4, 4}) == none);
+    CHECK (cs ("i", {}) == none);
+    CHECK (cs ("v", {4}) == none);
+    CHECK (cs ("a*", {}) == none);
+  }
+}
+
+TEST_CASE ("Member sizes are computed from the layouts", "[layout]")
+{
+  std::vector<Layout> const layouts {{1u, {1u}}, {4u, {}}, {4u, {4u}}};
+
+  CHECK (members_size (layouts, {1, 2, 4}) == ContainerSize {7u, 5u, 1u});
+  CHECK (members_size ({}, {}) == ContainerSize {0u, 0u, 1u});
+  CHECK (members_size ({{8u, {8u}}, {1u, {1u}}}, {8, 1}) == ContainerSize {9u, 7u, 0u});
+}
+
+TEST_CASE ("Variants add the type string of the child", "[layout]")
+{
+  auto v {VariantType::from_string ("(is)")};
+
+  REQUIRE(v);
+  CHECK (variant_size (*v, 8u) == ContainerSize {8u, 0u, 5u});
+}
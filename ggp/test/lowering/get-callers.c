@@ -0,0 +1,124 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Calls reading values with constant formats, from serialized values
+ * like the ones coming in D-Bus messages, from values of other types
+ * and from fixed size values with serialized data of a wrong size.
+ * The "expect:" comments list the ways each call is rewritten. */
+
+#include <glib.h>
+
+#include <stdio.h>
+
+/* Values coming from D-Bus are serialized and not trusted. */
+static GVariant *
+from_data (const gchar *type,
+           gconstpointer data,
+           gsize size)
+{
+  return g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE (type),
+                                                      g_memdup2 (data, size),
+                                                      size,
+                                                      FALSE,
+                                                      g_free,
+                                                      NULL));
+}
+
+static GVariant *
+serialize (GVariant *value)
+{
+  GVariant *serialized;
+
+  g_variant_ref_sink (value);
+  serialized = from_data (g_variant_get_type_string (value),
+                          g_variant_get_data (value),
+                          g_variant_get_size (value));
+  g_variant_unref (value);
+
+  return serialized;
+}
+
+static void
+print_printed (const gchar *what,
+               GVariant *value)
+{
+  gchar *text = g_variant_print (value, TRUE);
+
+  printf ("%s: %s\n", what, text);
+  g_free (text);
+  g_variant_unref (value);
+}
+
+static void
+get_values (GVariant *value)
+{
+  const gchar *first = "unset";
+  const gchar *second = "unset";
+  gchar *duplicated = NULL;
+  guint32 serial = 1234;
+  guint32 flags = 1234;
+  gboolean allowed = FALSE;
+  gint16 n = 1234;
+  gint64 x = 1234;
+  gdouble d = 0.5;
+  GVariant *child = NULL;
+
+  printf ("%s:\n", g_variant_get_type_string (value));
+  /* Mismatched types go to GLib, which leaves the parameters alone. */
+  g_variant_get (value, "(&s&o(&sv))", &first, &second, NULL, &child); /* expect: lowered program */
+  printf ("(&s&o(&sv)): %s %s\n", first, second);
+  if (child != NULL)
+    print_printed ("v", child);
+  g_variant_get (value, "(uub)", &serial, &flags, &allowed); /* expect: lowered program */
+  printf ("(uub): %u %u %d\n", serial, flags, allowed);
+  g_variant_get (value, "(nxd)", &n, &x, &d); /* expect: lowered program */
+  printf ("(nxd): %d %" G_GINT64_FORMAT " %g\n", n, x, d);
+  g_variant_get (value, "(s*@(sv))", &duplicated, NULL, &child); /* expect: lowered program */
+  printf ("(s*@(sv)): %s\n", (duplicated != NULL) ? duplicated : "unset");
+  g_free (duplicated);
+  if (child != NULL)
+    print_printed ("@(sv)", child);
+  g_variant_get_child (value, 1, "&o", &second); /* expect: lowered program */
+  printf ("&o: %s\n", second);
+  g_variant_get_child (value, 0, "u", &serial); /* expect: lowered program */
+  printf ("u: %u\n", serial);
+}
+
+int
+main (void)
+{
+  static const guchar short_data[] = { 1, 2, 3 };
+  GVariant *values[] = {
+    serialize (g_variant_new ("(so(sv))", "org.example.Interface", "/org/example/Object", "Property", g_variant_new_string ("value"))), /* expect: lowered program */
+    serialize (g_variant_new ("(uub)", 17u, 4u, TRUE)), /* expect: lowered program */
+    serialize (g_variant_new ("(nxd)", (gint16) -3, G_GINT64_CONSTANT (-5000000000), 2.5)), /* expect: lowered program */
+    /* GLib reads the fixed size values with serialized data of a
+     * wrong size as zeros. */
+    from_data ("(uub)", short_data, sizeof (short_data)),
+    from_data ("(nxd)", short_data, sizeof (short_data)),
+  };
+  gsize idx;
+
+  for (idx = 0; idx < G_N_ELEMENTS (values); ++idx)
+    {
+      get_values (values[idx]);
+      g_variant_unref (values[idx]);
+    }
+
+  return 0;
+}
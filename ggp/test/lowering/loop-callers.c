@@ -0,0 +1,99 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Calls adding children to builders and reading them from iterators
+ * in loops. The "expect:" comments list the ways each call is
+ * rewritten. */
+
+#include <glib.h>
+
+#include <stdio.h>
+
+static GVariant *
+build_entries (guint count)
+{
+  GVariantBuilder builder;
+  guint idx;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  for (idx = 0; idx < count; ++idx)
+    {
+      gchar *key = g_strdup_printf ("key%u", idx);
+
+      g_variant_builder_add (&builder, "{sv}", key, g_variant_new_uint32 (idx)); /* expect: lowered program */
+      g_free (key);
+    }
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static GVariant *
+build_pairs (guint count)
+{
+  GVariantBuilder builder;
+  guint idx;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(uu)"));
+  for (idx = 0; idx < count; ++idx)
+    g_variant_builder_add (&builder, "(uu)", idx, idx * 2); /* expect: lowered program */
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/* Iterators can't be redirected to programs, the lowering needs the
+ * same branches. Mismatched children go to g_variant_get and end the
+ * loops. */
+static void
+iterate (GVariant *value)
+{
+  GVariantIter iter;
+  const gchar *key;
+  GVariant *child;
+  guint32 first;
+  guint32 second;
+  guint count = 0;
+
+  printf ("%s:\n", g_variant_get_type_string (value));
+  g_variant_iter_init (&iter, value);
+  while (g_variant_iter_next (&iter, "{&sv}", &key, &child)) /* expect: lowered */
+    {
+      printf ("{&sv}: %s %u\n", key, g_variant_get_uint32 (child));
+      g_variant_unref (child);
+    }
+  g_variant_iter_init (&iter, value);
+  while (g_variant_iter_next (&iter, "(uu)", &first, &second)) /* expect: lowered */
+    printf ("(uu): %u %u\n", first, second);
+  g_variant_iter_init (&iter, value);
+  while (g_variant_iter_next (&iter, "*", NULL)) /* expect: lowered */
+    ++count;
+  printf ("*: %u\n", count);
+}
+
+int
+main (void)
+{
+  GVariant *entries = build_entries (3);
+  GVariant *pairs = build_pairs (3);
+
+  iterate (entries);
+  iterate (pairs);
+  g_variant_unref (entries);
+  g_variant_unref (pairs);
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Calls building values with constant formats and texts. The
+ * "expect:" comments list the ways each call is rewritten, the
+ * values are printed to compare them with the ones from GLib. */
+
+#include <glib.h>
+
+#include <stdio.h>
+
+static void
+print_value (const gchar *what,
+             GVariant *value)
+{
+  gchar *text;
+
+  g_variant_ref_sink (value);
+  text = g_variant_print (value, TRUE);
+  printf ("%s: %s\n", what, text);
+  g_free (text);
+  g_variant_unref (value);
+}
+
+/* The parameters come from the outside, so they are not constants. */
+static void
+new_values (const gchar *string,
+            gint32 number)
+{
+  GVariant *strings = g_variant_new_parsed ("['a', 'b']"); /* expect: lowered */
+
+  print_value ("(isu)", g_variant_new ("(isu)", number, string, 17u)); /* expect: lowered program */
+  print_value ("(bynqiuxthd)", g_variant_new ("(bynqiuxthd)", /* expect: lowered program */
+                                              number != 0,
+                                              (guchar) number,
+                                              (gint16) -number,
+                                              (guint16) number,
+                                              -number,
+                                              (guint32) number,
+                                              (gint64) number * -3,
+                                              (guint64) number * 3,
+                                              (gint32) 0,
+                                              number / 4.0));
+  print_value ("{sv}", g_variant_new ("{sv}", string, g_variant_new_uint32 (number))); /* expect: lowered program */
+  print_value ("(so(sv))", g_variant_new ("(so(sv))", /* expect: lowered program */
+                                          "org.example.Interface",
+                                          "/org/example/Object",
+                                          string,
+                                          g_variant_new_string ("value")));
+  print_value ("(sog)", g_variant_new ("(sog)", string, "/", "a{sv}")); /* expect: lowered program */
+  print_value ("s", g_variant_new ("s", string)); /* expect: lowered program */
+  print_value ("v", g_variant_new ("v", g_variant_new_int16 (-5))); /* expect: lowered program */
+  /* GLib checks the types of the ready values, only the programs
+   * take them. */
+  print_value ("(s@as)", g_variant_new ("(s@as)", string, strings)); /* expect: program */
+  print_value ("(i*)", g_variant_new ("(i*)", number, g_variant_new_boolean (TRUE))); /* expect: program */
+  print_value ("@(ii)", g_variant_new ("@(ii)",
+                                       g_variant_new ("(ii)", 1, number))); /* expect: lowered program */
+  /* Arrays and maybes are left to GLib. */
+  print_value ("(ias)", g_variant_new ("(ias)", number, NULL));
+  print_value ("ms", g_variant_new ("ms", string));
+  print_value ("[1, 2, 3]", g_variant_new_parsed ("[1, 2, 3]")); /* expect: lowered */
+  print_value ("{'a': <1>}", g_variant_new_parsed ("{'a': <1>}")); /* expect: lowered */
+  print_value ("(@mi nothing, 2.5)", g_variant_new_parsed ("(@mi nothing, 2.5)")); /* expect: lowered */
+}
+
+int
+main (void)
+{
+  new_values ("foo", 42);
+  new_values ("", -7);
+
+  return 0;
+}
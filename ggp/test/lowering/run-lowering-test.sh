@@ -0,0 +1,135 @@
+#!/bin/bash
+
+set -e
+
+compiler=''
+plugin=''
+runtime=''
+input_file=''
+output_dir=''
+
+parse_options() {
+    local default_compiler="${compiler}"
+    local default_plugin="${plugin}"
+    local default_runtime="${runtime}"
+    local default_input_file="${input_file}"
+    local default_output_dir="${output_dir}"
+
+    while [[ -n "${1}" ]]; do
+        case "${1}" in
+            --compiler)
+                compiler="${2}"
+                shift 2
+                ;;
+            --help)
+                cat <<HELP
+Usage: $0 [FLAGS]
+FLAGS:
+--compiler <COMPILER> - GNU C compiler to use for compiling the callers, default: ${default_compiler}
+--help - prints this message and quits
+--input-file <FILE> - a path to the source file with the callers, default: ${default_input_file}
+--output-dir <DIR> - a directory for the binaries and their outputs, default: ${default_output_dir}
+--plugin <PLUGIN> - a path to the compiler plugin, default: ${default_plugin}
+--runtime <LIBRARY> - a path to the runtime library for the format programs, default: ${default_runtime}
+HELP
+                exit 0
+                ;;
+            --input-file)
+                input_file="${2}"
+                shift 2
+                ;;
+            --output-dir)
+                output_dir="${2}"
+                shift 2
+                ;;
+            --plugin)
+                plugin="${2}"
+                shift 2
+                ;;
+            --runtime)
+                runtime="${2}"
+                shift 2
+                ;;
+            *=*)
+                echo "--foo=bar flags are not supported, use --foo bar"
+                exit 1
+                ;;
+            *)
+                echo "unknown flag ${1}, use --help to get help" >&2
+                exit 1
+                ;;
+        esac
+    done
+
+    if [ -z "${compiler}" ]; then
+        echo "Compiler not specified" >&2
+        exit 1
+    fi
+    if [ -z "${plugin}" ]; then
+        echo "Plugin not specified" >&2
+        exit 1
+    fi
+    if [ -z "${runtime}" ]; then
+        echo "Runtime not specified" >&2
+        exit 1
+    fi
+    if [ -z "${input_file}" ]; then
+        echo "Input file not specified" >&2
+        exit 1
+    fi
+    if [ -z "${output_dir}" ]; then
+        echo "Output directory not specified" >&2
+        exit 1
+    fi
+}
+
+# Prints the numbers of the lines with the "expect:" comments listing
+# the given way of rewriting the calls.
+expected_lines() {
+    local way="${1}"
+
+    grep -n "/\* expect:.*\b${way}\b.*\*/" "${input_file}" | cut -d: -f1
+}
+
+# Prints the numbers of the lines with the calls reported by the
+# plugin in the -fopt-info file.
+reported_lines() {
+    local opt_info_file="${1}"
+    local verb="${2}"
+
+    sed -n "s/^[^:]*:\([0-9]*\):[0-9]*: optimized: ${verb} .*$/\1/p" "${opt_info_file}" | sort -n -u
+}
+
+parse_options "${@}"
+
+plugin_name=$(basename "${plugin}" .so)
+glib_flags=$(pkg-config --cflags --libs glib-2.0)
+
+mkdir -p "${output_dir}"
+
+# shellcheck disable=SC2086
+"${compiler}" -O2 -o "${output_dir}/plain" "${input_file}" ${glib_flags}
+# shellcheck disable=SC2086
+"${compiler}" -O2 "-fplugin=${plugin}" "-fplugin-arg-${plugin_name}-lower" "-fopt-info-optimized=${output_dir}/lowered.opt" -o "${output_dir}/lowered" "${input_file}" ${glib_flags}
+# shellcheck disable=SC2086
+"${compiler}" -O2 "-fplugin=${plugin}" "-fplugin-arg-${plugin_name}-lower-programs" "-fopt-info-optimized=${output_dir}/programs.opt" -o "${output_dir}/programs" "${input_file}" "${runtime}" "-Wl,-rpath,$(dirname "${runtime}")" ${glib_flags}
+
+# The rewritten calls must be exactly the expected ones, otherwise the
+# outputs could match only because nothing was rewritten.
+if ! diff -u <(expected_lines lowered) <(reported_lines "${output_dir}/lowered.opt" lowered); then
+    echo "The lowered calls are not the expected ones" >&2
+    exit 1
+fi
+if ! diff -u <(expected_lines program) <(reported_lines "${output_dir}/programs.opt" redirected); then
+    echo "The calls redirected to the format programs are not the expected ones" >&2
+    exit 1
+fi
+
+"${output_dir}/plain" >"${output_dir}/plain.out"
+for variant in lowered programs; do
+    "${output_dir}/${variant}" >"${output_dir}/${variant}.out"
+    if ! diff -u "${output_dir}/plain.out" "${output_dir}/${variant}.out"; then
+        echo "The ${variant} binary gives a different output than the plain one" >&2
+        exit 1
+    fi
+done
@@ -0,0 +1,116 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/test/generated/member-order.hh"
+#include "ggp/test/generated/variant-print.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "ggp/test/test-print.hh"
+
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+vt (char const* str) -> VariantType
+{
+  auto v {VariantType::from_string (str)};
+
+  REQUIRE(v);
+
+  return std::move (*v);
+}
+
+auto
+to_string (VariantType const& type) -> std::string
+{
+  std::ostringstream oss;
+
+  oss << type;
+
+  return oss.str ();
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Minimal sizes of types", "[member-order]")
+{
+  CHECK (minimal_size (vt ("i")) == std::optional<std::size_t> {4u});
+  CHECK (minimal_size (vt ("s")) == std::optional<std::size_t> {1u});
+  CHECK (minimal_size (vt ("o")) == std::optional<std::size_t> {2u});
+  CHECK (minimal_size (vt ("v")) == std::optional<std::size_t> {4u});
+  CHECK (minimal_size (vt ("as")) == std::optional<std::size_t> {0u});
+  CHECK (minimal_size (vt ("mi")) == std::optional<std::size_t> {0u});
+  CHECK (minimal_size (vt ("(is)")) == std::optional<std::size_t> {5u});
+  CHECK (minimal_size (vt ("(si)")) == std::optional<std::size_t> {9u});
+  CHECK (minimal_size (vt ("{sv}")) == std::optional<std::size_t> {13u});
+  CHECK (!minimal_size (vt ("a*")));
+}
+
+TEST_CASE ("Member orders paying less are suggested", "[member-order]")
+{
+  SECTION ("padding between fixed size members")
+  {
+    auto const advices {advise_member_orders (vt ("(yxyxyx)"))};
+
+    REQUIRE (advices.size () == 1u);
+    CHECK (to_string (advices[0].tuple_type) == "(yxyxyx)");
+    CHECK (advices[0].size == ContainerSize {27u, 21u, 0u});
+    CHECK (to_string (advices[0].suggested_type) == "(xxxyyy)");
+    CHECK (advices[0].suggested_size == ContainerSize {27u, 5u, 0u});
+  }
+
+  SECTION ("framing offsets of early variable size members")
+  {
+    auto const advices {advise_member_orders (vt ("(ssi)"))};
+
+    REQUIRE (advices.size () == 1u);
+    CHECK (advices[0].size == ContainerSize {6u, 2u, 2u});
+    CHECK (to_string (advices[0].suggested_type) == "(iss)");
+    CHECK (advices[0].suggested_size == ContainerSize {6u, 0u, 1u});
+  }
+
+  SECTION ("nested tuples")
+  {
+    auto const advices {advise_member_orders (vt ("a{s(yxyx)}"))};
+
+    REQUIRE (advices.size () == 1u);
+    CHECK (to_string (advices[0].suggested_type) == "(xxyy)");
+  }
+
+  SECTION ("nothing to gain")
+  {
+    char const* strs[] {"(xxyy)", "(yi)", "(is)", "()", "{yx}", "i", "as", "(x(ys))"};
+
+    for (auto const str : strs)
+    {
+      INFO (str);
+      CHECK (advise_member_orders (vt (str)).empty ());
+    }
+  }
+
+  SECTION ("indefinite types")
+  {
+    CHECK (advise_member_orders (vt ("(yx*)")).empty ());
+  }
+}
@@ -0,0 +1,95 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/test/generated/profile.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+entry (char const* function,
+       std::uint64_t offset,
+       char const* format,
+       std::uint64_t calls,
+       std::uint64_t nanoseconds,
+       std::uint64_t bytes) -> ProfileEntry
+{
+  return {{function, "/usr/bin/app", offset, format}, {calls, nanoseconds, bytes}};
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Profiles are parsed", "[profile]")
+{
+  auto const text {"ggp-profile 1\n"
+                   "dropped 3\n"
+                   "g_variant_new\t/usr/bin/app\t1a2b\t10\t5000\t160\t(uub)\n"
+                   "g_variant_get\t/usr/bin/app\t30\t2\t100\t0\ta{s\tv}\n"};
+  auto const maybe_profile {parse_profile (text)};
+
+  REQUIRE (maybe_profile);
+  CHECK (maybe_profile->dropped_calls == 3u);
+  REQUIRE (maybe_profile->entries.size () == 2u);
+  CHECK (maybe_profile->entries[0] == entry ("g_variant_new", 0x1a2bu, "(uub)", 10u, 5000u, 160u));
+  CHECK (maybe_profile->entries[1] == entry ("g_variant_get", 0x30u, "a{s\tv}", 2u, 100u, 0u));
+  CHECK (profile_to_string (*maybe_profile) == text);
+}
+
+TEST_CASE ("Malformed profiles are rejected", "[profile]")
+{
+  char const* texts[] {
+    "",
+    "ggp-profile 1\n",
+    "ggp-profile 2\ndropped 0\n",
+    "ggp-profile 1\ndropped x\n",
+    "ggp-profile 1\ndropped 0\ng_variant_new\t/a\t10\t1\t1\t1\t(uub)",
+    "ggp-profile 1\ndropped 0\ng_variant_new\t/a\tzz\t1\t1\t1\t(uub)\n",
+    "ggp-profile 1\ndropped 0\ng_variant_new\t/a\t10\t1\t1\n",
+    "ggp-profile 1\ndropped 0\n\t/a\t10\t1\t1\t1\t(uub)\n",
+  };
+
+  for (auto const text : texts)
+  {
+    INFO (text);
+    CHECK (!parse_profile (text));
+  }
+}
+
+TEST_CASE ("Profiles are merged and ranked", "[profile]")
+{
+  Profile const first {1u, {entry ("g_variant_new", 0x10u, "(ii)", 1u, 10u, 8u),
+                            entry ("g_variant_get", 0x20u, "(ii)", 1u, 50u, 8u)}};
+  Profile const second {2u, {entry ("g_variant_new", 0x10u, "(ii)", 3u, 60u, 24u),
+                             entry ("g_variant_new", 0x30u, "(ii)", 1u, 5u, 8u)}};
+  auto const merged {merge_profiles ({first, second})};
+
+  CHECK (merged.dropped_calls == 3u);
+  REQUIRE (merged.entries.size () == 3u);
+  CHECK (merged.entries[0] == entry ("g_variant_new", 0x10u, "(ii)", 4u, 70u, 32u));
+
+  auto const ranked {rank_profile_entries (merged)};
+
+  REQUIRE (ranked.size () == 3u);
+  CHECK (ranked[0].site.offset == 0x10u);
+  CHECK (ranked[1].site.offset == 0x20u);
+  CHECK (ranked[2].site.offset == 0x30u);
+}
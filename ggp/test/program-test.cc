@@ -0,0 +1,137 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/test/generated/program.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "ggp/test/test-print.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+vf (char const* str) -> VariantFormat
+{
+  auto v {VariantFormat::from_string (str)};
+
+  REQUIRE(v);
+
+  return std::move (*v);
+}
+
+auto
+bytes (std::initializer_list<int> list) -> std::vector<std::uint8_t>
+{
+  std::vector<std::uint8_t> v;
+
+  for (auto i : list)
+  {
+    v.push_back (static_cast<std::uint8_t> (i));
+  }
+
+  return v;
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Formats survive the program round-trip", "[program]")
+{
+  char const* strs[] {"b", "y", "n", "q", "i", "u", "x", "t", "h", "d",
+                      "s", "o", "g", "v", "&s", "&o", "&g",
+                      "*", "?", "r", "@s", "@as", "@a{sv}", "@m(ii)",
+                      "as", "a{sv}", "aay", "a(iii)",
+                      "ms", "mv", "m&s", "m*", "m@i", "mas",
+                      "mi", "m(ii)", "mmi", "m{sv}",
+                      "^as", "^a&s", "^ao", "^a&o", "^ay", "^&ay", "^aay", "^a&ay",
+                      "()", "(i)", "(sv)", "((ii)(ss))", "(bynqiuxthdsogv)",
+                      "{sv}", "{&sv}", "{@sv}", "{?*}", "{ym(i)}"};
+
+  for (auto str : strs)
+  {
+    auto format {vf (str)};
+    auto maybe_format {decompile_program (compile_program (format))};
+
+    INFO ("format: " << str);
+    REQUIRE (maybe_format);
+    CHECK (*maybe_format == format);
+  }
+}
+
+TEST_CASE ("Programs have expected bytes", "[program]")
+{
+  auto const v {program_version};
+
+  CHECK (compile_program (vf ("i")) == bytes ({v, 'i', 0, 'i'}));
+  CHECK (compile_program (vf ("&s")) == bytes ({v, 's', 0, 0x80, 's'}));
+  CHECK (compile_program (vf ("@as")) == bytes ({v, 'a', 's', 0, 0x81, 0x84, 's'}));
+  CHECK (compile_program (vf ("(ub)")) == bytes ({v, '(', 'u', 'b', ')', 0, 0x82, 2, 'u', 'b'}));
+  CHECK (compile_program (vf ("{sv}")) == bytes ({v, '{', 's', 'v', '}', 0, 0x83, 's', 'v'}));
+  CHECK (compile_program (vf ("mi")) == bytes ({v, 'm', 'i', 0, 0x85, 'i'}));
+  CHECK (compile_program (vf ("^a&s")) == bytes ({v, 'a', 's', 0, 0x86, 1}));
+
+  std::string big {"("};
+
+  for (auto idx {0u}; idx < 200u; ++idx)
+  {
+    big.push_back ('y');
+  }
+  big.push_back (')');
+
+  auto program {compile_program (vf (big.c_str ()))};
+
+  REQUIRE (program.size () == 1u + big.size () + 1u + 3u + 200u);
+  CHECK (program[big.size () + 2u] == 0x82);
+  CHECK (program[big.size () + 3u] == 0xc8);
+  CHECK (program[big.size () + 4u] == 0x01);
+  CHECK (decompile_program (program) == std::optional<VariantFormat> {vf (big.c_str ())});
+}
+
+TEST_CASE ("Malformed programs are rejected", "[program]")
+{
+  auto const v {program_version};
+
+  CHECK_FALSE (decompile_program (bytes ({})));
+  CHECK_FALSE (decompile_program (bytes ({v + 1, 'i', 0, 'i'})));
+  CHECK_FALSE (decompile_program (bytes ({v, 'i', 0})));
+  CHECK_FALSE (decompile_program (bytes ({v, 'i', 'i'})));
+  CHECK_FALSE (decompile_program (bytes ({v, 'u', 0, 'i'})));
+  CHECK_FALSE (decompile_program (bytes ({v, 'i', 0, 'i', 'i'})));
+  CHECK_FALSE (decompile_program (bytes ({v, '(', 'i', 'i', ')', 0, 0x82, 3, 'i', 'i'})));
+  CHECK_FALSE (decompile_program (bytes ({v, 's', 0, 0x80, 'i'})));
+  CHECK_FALSE (decompile_program (bytes ({v, 'a', 's', 0, 0x86, 42})));
+  CHECK_FALSE (decompile_program (bytes ({v, 'i', 0, 'z'})));
+}
+
+TEST_CASE ("Runnable programs", "[program]")
+{
+  CHECK (program_is_runnable (vf ("i")));
+  CHECK (program_is_runnable (vf ("&s")));
+  CHECK (program_is_runnable (vf ("@as")));
+  CHECK (program_is_runnable (vf ("(uu&s*)")));
+  CHECK (program_is_runnable (vf ("{sv}")));
+  CHECK (program_is_runnable (vf ("((ii)(v{&s@ay}))")));
+  CHECK_FALSE (program_is_runnable (vf ("as")));
+  CHECK_FALSE (program_is_runnable (vf ("mi")));
+  CHECK_FALSE (program_is_runnable (vf ("^as")));
+  CHECK_FALSE (program_is_runnable (vf ("(ims)")));
+  CHECK_FALSE (program_is_runnable (vf ("{s^as}")));
+}
@@ -0,0 +1,110 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/sarif.hh"
+#include "ggp/test/generated/type.hh"
+#include "ggp/test/generated/type-print.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace Ggp::Lib;
+
+TEST_CASE ("JSON escaping", "[sarif]")
+{
+  CHECK (json_escape ("plain (si)") == "plain (si)");
+  CHECK (json_escape ("\"a\\b\"") == "\\\"a\\\\b\\\"");
+  CHECK (json_escape ("a\nb\tc\r") == "a\\nb\\tc\\r");
+  CHECK (json_escape (std::string_view {"\x01\x1f", 2u}) == "\\u0001\\u001f");
+  CHECK (json_escape ("zażółć") == "zażółć");
+}
+
+TEST_CASE ("SARIF log", "[sarif]")
+{
+  SECTION ("No diagnostics")
+  {
+    CHECK (diagnostics_to_sarif ({}) ==
+           "{\n"
+           "  \"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\",\n"
+           "  \"version\": \"2.1.0\",\n"
+           "  \"runs\": [\n"
+           "    {\n"
+           "      \"tool\": {\"driver\": {\"name\": \"glib-gcc-plugin\"}},\n"
+           "      \"results\": []\n"
+           "    }\n"
+           "  ]\n"
+           "}\n");
+  }
+
+  SECTION ("Diagnostics")
+  {
+    std::vector<Diagnostic> const diagnostics {
+      {"vc-invalid-format", "invalid variant format", "a.c", 3u, 5u, "(s", {}, "", ""},
+      {"vc-arg-type", "invalid argument 1", "dir/b \"quoted\".c", 0u, 0u, "(si)", {1u}, "gint32", "gchar const*"},
+    };
+
+    CHECK (diagnostics_to_sarif (diagnostics) ==
+           "{\n"
+           "  \"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\",\n"
+           "  \"version\": \"2.1.0\",\n"
+           "  \"runs\": [\n"
+           "    {\n"
+           "      \"tool\": {\"driver\": {\"name\": \"glib-gcc-plugin\"}},\n"
+           "      \"results\": [\n"
+           "        {\n"
+           "          \"ruleId\": \"vc-invalid-format\",\n"
+           "          \"level\": \"warning\",\n"
+           "          \"message\": {\"text\": \"invalid variant format\"},\n"
+           "          \"locations\": [{\"physicalLocation\": {\"artifactLocation\": {\"uri\": \"a.c\"}, \"region\": {\"startLine\": 3, \"startColumn\": 5}}}],\n"
+           "          \"properties\": {\"format\": \"(s\"}\n"
+           "        },\n"
+           "        {\n"
+           "          \"ruleId\": \"vc-arg-type\",\n"
+           "          \"level\": \"warning\",\n"
+           "          \"message\": {\"text\": \"invalid argument 1\"},\n"
+           "          \"locations\": [{\"physicalLocation\": {\"artifactLocation\": {\"uri\": \"dir/b \\\"quoted\\\".c\"}}}],\n"
+           "          \"properties\": {\"format\": \"(si)\", \"argumentIndex\": 1, \"expectedType\": \"gint32\", \"actualType\": \"gchar const*\"}\n"
+           "        }\n"
+           "      ]\n"
+           "    }\n"
+           "  ]\n"
+           "}\n");
+  }
+}
+
+TEST_CASE ("Type printing", "[sarif]")
+{
+  auto const maybe_format {VariantFormat::from_string ("s")};
+
+  REQUIRE (maybe_format);
+
+  auto const types {expected_types_for_format (*maybe_format)};
+
+  REQUIRE (types.size () == 1u);
+
+  std::ostringstream for_new;
+  std::ostringstream for_get;
+  std::ostringstream both;
+
+  for_new << types[0].for_new;
+  for_get << types[0].for_get;
+  both << types[0];
+  CHECK_FALSE (for_new.str ().empty ());
+  CHECK (both.str () == "new: " + for_new.str () + "; get: " + for_get.str ());
+}
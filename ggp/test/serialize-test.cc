@@ -0,0 +1,230 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggp/test/generated/serialize.hh"
+#include "ggp/test/generated/variant-value.hh"
+#include "ggp/test/generated/variant.hh"
+
+#include "ggp/test/test-print.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+using Bytes = std::vector<std::uint8_t>;
+
+auto
+vt (char const* str) -> VariantType
+{
+  auto v {VariantType::from_string (str)};
+
+  REQUIRE(v);
+
+  return std::move (*v);
+}
+
+template <typename BasicT, typename ValueT>
+auto
+basic (ValueT value) -> VariantValue
+{
+  return {VV::Basic {BasicT {static_cast<decltype (BasicT::value)> (value)}}};
+}
+
+auto
+str (Leaf::StringType type, char const* value) -> VariantValue
+{
+  return {VV::String {type, value}};
+}
+
+auto
+s (char const* value) -> VariantValue
+{
+  return str ({Leaf::string_}, value);
+}
+
+auto
+i (std::int32_t value) -> VariantValue
+{
+  return basic<VV::I32> (value);
+}
+
+auto
+y (std::uint8_t value) -> VariantValue
+{
+  return basic<VV::Byte> (value);
+}
+
+auto
+var (VariantValue value) -> VariantValue
+{
+  return {VV::Variant {std::move (value)}};
+}
+
+auto
+just (char const* pointed_type, VariantValue value) -> VariantValue
+{
+  return {VV::Maybe {vt (pointed_type), {std::move (value)}}};
+}
+
+auto
+nothing (char const* pointed_type) -> VariantValue
+{
+  return {VV::Maybe {vt (pointed_type), {}}};
+}
+
+auto
+arr (char const* element_type, std::vector<VariantValue> elements) -> VariantValue
+{
+  return {VV::Array {vt (element_type), std::move (elements)}};
+}
+
+auto
+tup (std::vector<VariantValue> values) -> VariantValue
+{
+  return {VV::Tuple {std::move (values)}};
+}
+
+auto
+entry (VariantValue key, VariantValue value) -> VariantValue
+{
+  return {VV::Entry {std::move (key), std::move (value)}};
+}
+
+auto
+le (VariantValue const& value) -> Bytes
+{
+  return serialize (value, ByteOrder::Little);
+}
+
+} // anonymous namespace
+
+// The expected bytes come from g_variant_get_data in GLib 2.74 on
+// x86_64.
+TEST_CASE ("Basic values are serialized like in GLib", "[serialize]")
+{
+  CHECK (le (basic<VV::Bool> (true)) == Bytes {0x01});
+  CHECK (le (y (200u)) == Bytes {0xc8});
+  CHECK (le (basic<VV::I16> (-2)) == Bytes {0xfe, 0xff});
+  CHECK (le (basic<VV::U16> (4660u)) == Bytes {0x34, 0x12});
+  CHECK (le (i (-5)) == Bytes {0xfb, 0xff, 0xff, 0xff});
+  CHECK (le (basic<VV::U32> (3000000000u)) == Bytes {0x00, 0x5e, 0xd0, 0xb2});
+  CHECK (le (basic<VV::I64> (-7)) == Bytes {0xf9, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+  CHECK (le (basic<VV::U64> (81985529216486895u)) == Bytes {0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01});
+  CHECK (le (basic<VV::Handle> (3)) == Bytes {0x03, 0x00, 0x00, 0x00});
+  CHECK (le (basic<VV::Double> (2.5)) == Bytes {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x40});
+  CHECK (le (s ("hello")) == Bytes {0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x00});
+  CHECK (le (str ({Leaf::object_path}, "/a/b")) == Bytes {0x2f, 0x61, 0x2f, 0x62, 0x00});
+  CHECK (le (str ({Leaf::signature}, "a{sv}")) == Bytes {0x61, 0x7b, 0x73, 0x76, 0x7d, 0x00});
+}
+
+TEST_CASE ("Numbers follow the byte order", "[serialize]")
+{
+  auto const value {tup ({basic<VV::I16> (-2), basic<VV::U32> (3000000000u)})};
+
+  CHECK (serialize (value, ByteOrder::Little) == Bytes {0xfe, 0xff, 0x00, 0x00, 0x00, 0x5e, 0xd0, 0xb2});
+  CHECK (serialize (value, ByteOrder::Big) == Bytes {0xff, 0xfe, 0x00, 0x00, 0xb2, 0xd0, 0x5e, 0x00});
+  CHECK (serialize (basic<VV::Double> (2.5), ByteOrder::Big) == Bytes {0x40, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+}
+
+TEST_CASE ("Variants and maybes are serialized like in GLib", "[serialize]")
+{
+  CHECK (le (var (i (5))) == Bytes {0x05, 0x00, 0x00, 0x00, 0x00, 0x69});
+  CHECK (le (var (s ("s"))) == Bytes {0x73, 0x00, 0x00, 0x73});
+  CHECK (le (just ("i", i (7))) == Bytes {0x07, 0x00, 0x00, 0x00});
+  CHECK (le (nothing ("s")) == Bytes {});
+  CHECK (le (just ("s", s ("x"))) == Bytes {0x78, 0x00, 0x00});
+  CHECK (le (just ("my", nothing ("y"))) == Bytes {0x00});
+}
+
+TEST_CASE ("Arrays are serialized like in GLib", "[serialize]")
+{
+  CHECK (le (arr ("i", {i (1), i (2), i (3)})) == Bytes {0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00});
+  CHECK (le (arr ("s", {s ("a"), s ("bc")})) == Bytes {0x61, 0x00, 0x62, 0x63, 0x00, 0x02, 0x05});
+  CHECK (le (arr ("s", {})) == Bytes {});
+  CHECK (le (arr ("ay", {arr ("y", {y (1u)}), arr ("y", {})})) == Bytes {0x01, 0x01, 0x01});
+  CHECK (le (arr ("{sv}", {entry (s ("a"), var (i (1))), entry (s ("b"), var (s ("x")))})) ==
+         Bytes {0x61, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x69, 0x02, 0x00,
+                0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x73, 0x02, 0x0f, 0x1d});
+
+  std::vector<VariantValue> strings;
+
+  for (auto idx {0u}; idx < 300u; ++idx)
+  {
+    strings.push_back (s ("abc"));
+  }
+
+  // Too large for single byte offsets.
+  auto const bytes {le (arr ("s", std::move (strings)))};
+
+  REQUIRE (bytes.size () == 1800u);
+  CHECK (Bytes (bytes.cbegin () + 1200, bytes.cbegin () + 1204) == Bytes {0x04, 0x00, 0x08, 0x00});
+  CHECK (Bytes (bytes.cend () - 4, bytes.cend ()) == Bytes {0xac, 0x04, 0xb0, 0x04});
+}
+
+TEST_CASE ("Tuples and entries are serialized like in GLib", "[serialize]")
+{
+  CHECK (le (tup ({})) == Bytes {0x00});
+  CHECK (le (tup ({y (1u), i (2)})) == Bytes {0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00});
+  CHECK (le (tup ({s ("s"), i (2)})) == Bytes {0x73, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02});
+  CHECK (le (tup ({i (2), s ("s")})) == Bytes {0x02, 0x00, 0x00, 0x00, 0x73, 0x00});
+  CHECK (le (tup ({s ("a"), i (1), s ("bc")})) == Bytes {0x61, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x62, 0x63, 0x00, 0x02});
+  CHECK (le (tup ({tup ({y (1u), y (2u)}), basic<VV::I16> (3), tup ({i (4)})})) == Bytes {0x01, 0x02, 0x03, 0x00, 0x04, 0x00, 0x00, 0x00});
+  CHECK (le (tup ({y (1u), s ("x")})) == Bytes {0x01, 0x78, 0x00});
+  CHECK (le (tup ({s ("x"), y (1u)})) == Bytes {0x78, 0x00, 0x01, 0x02});
+  CHECK (le (entry (s ("k"), y (5u))) == Bytes {0x6b, 0x00, 0x05, 0x02});
+  CHECK (le (tup ({arr ("{sv}", {entry (s ("x"), var (basic<VV::Bool> (true)))}), just ("ai", arr ("i", {i (1)}))})) ==
+         Bytes {0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x62, 0x02, 0x0c, 0x00, 0x00, 0x00,
+                0x01, 0x00, 0x00, 0x00, 0x00, 0x0d});
+  CHECK (le (tup ({arr ("i", {}), nothing ("s"), s ("e")})) == Bytes {0x65, 0x00, 0x00, 0x00});
+}
+
+TEST_CASE ("Values have types", "[serialize]")
+{
+  CHECK (tup ({s ("a"), arr ("{sv}", {}), var (i (1)), nothing ("ay")}).type () == vt ("(sa{sv}vmay)"));
+  CHECK (entry (y (1u), tup ({})).type () == vt ("{y()}"));
+}
+
+TEST_CASE ("Strings are validated like in GLib", "[serialize]")
+{
+  Leaf::StringType const string {Leaf::string_};
+  Leaf::StringType const object_path {Leaf::object_path};
+  Leaf::StringType const signature {Leaf::signature};
+
+  CHECK (string_is_valid (string, ""));
+  CHECK (string_is_valid (string, "za\xc5\xbc\xc3\xb3\xc5\x82\xc4\x87"));
+  CHECK (string_is_valid (string, "\xf0\x9f\x98\x80"));
+  CHECK_FALSE (string_is_valid (string, "\xc5"));
+  CHECK_FALSE (string_is_valid (string, "\xc0\x80"));
+  CHECK_FALSE (string_is_valid (string, "\xed\xa0\x80"));
+  CHECK_FALSE (string_is_valid (string, std::string_view {"a\0b", 3u}));
+  CHECK (string_is_valid (object_path, "/"));
+  CHECK (string_is_valid (object_path, "/org/gtk_2/App0"));
+  CHECK_FALSE (string_is_valid (object_path, ""));
+  CHECK_FALSE (string_is_valid (object_path, "org"));
+  CHECK_FALSE (string_is_valid (object_path, "/org/"));
+  CHECK_FALSE (string_is_valid (object_path, "/org//gtk"));
+  CHECK_FALSE (string_is_valid (object_path, "/org-gtk"));
+  CHECK (string_is_valid (signature, ""));
+  CHECK (string_is_valid (signature, "a{sv}ii(sb)"));
+  CHECK_FALSE (string_is_valid (signature, "a"));
+  CHECK_FALSE (string_is_valid (signature, "i)(i"));
+  CHECK_FALSE (string_is_valid (signature, "a*"));
+}
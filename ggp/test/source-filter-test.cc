@@ -0,0 +1,187 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/source-filter.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+TEST_CASE ("Path filter", "[source-filter]")
+{
+  SECTION ("No prefixes")
+  {
+    auto const filter {make_path_filter ({}, {})};
+
+    CHECK (path_is_wanted (filter, "/usr/include/glib-2.0/glib.h"));
+    CHECK (path_is_wanted (filter, ""));
+  }
+
+  SECTION ("Excludes only")
+  {
+    auto const filter {make_path_filter ({}, {"/usr/", "src/vendor/"})};
+
+    CHECK_FALSE (path_is_wanted (filter, "/usr/include/glib-2.0/glib.h"));
+    CHECK_FALSE (path_is_wanted (filter, "src/vendor/lib.h"));
+    CHECK (path_is_wanted (filter, "src/main.c"));
+    CHECK (path_is_wanted (filter, "/us"));
+  }
+
+  SECTION ("Includes and excludes")
+  {
+    auto const filter {make_path_filter ({"src/", "include/"}, {"src/vendor/", "src/vendor/ours/"})};
+
+    CHECK (path_is_wanted (filter, "src/main.c"));
+    CHECK (path_is_wanted (filter, "include/foo.h"));
+    CHECK_FALSE (path_is_wanted (filter, "tests/test.c"));
+    CHECK_FALSE (path_is_wanted (filter, "src/vendor/lib.c"));
+    CHECK_FALSE (path_is_wanted (filter, "src/vendor/ours/lib.c"));
+    CHECK_FALSE (path_is_wanted (filter, "sr"));
+  }
+
+  SECTION ("The longest prefix decides")
+  {
+    auto const filter {make_path_filter ({"src/", "src/vendor/ours/"}, {"src/vendor/"})};
+
+    CHECK (path_is_wanted (filter, "src/main.c"));
+    CHECK_FALSE (path_is_wanted (filter, "src/vendor/lib.c"));
+    CHECK (path_is_wanted (filter, "src/vendor/ours/lib.c"));
+  }
+
+  SECTION ("Prefixes match whole path components")
+  {
+    auto const filter {make_path_filter ({"src", "/usr/include/"}, {"src/vendor"})};
+
+    CHECK (path_is_wanted (filter, "src"));
+    CHECK (path_is_wanted (filter, "src/main.c"));
+    CHECK_FALSE (path_is_wanted (filter, "src2/main.c"));
+    CHECK_FALSE (path_is_wanted (filter, "src/vendor/lib.c"));
+    CHECK (path_is_wanted (filter, "src/vendored/lib.c"));
+    CHECK (path_is_wanted (filter, "/usr/include/glib.h"));
+    CHECK_FALSE (path_is_wanted (filter, "/usr/includes/glib.h"));
+  }
+
+  SECTION ("Excludes win over the same includes")
+  {
+    auto const filter {make_path_filter ({"src/"}, {"src/"})};
+
+    CHECK_FALSE (path_is_wanted (filter, "src/main.c"));
+  }
+}
+
+TEST_CASE ("Unified diffs", "[source-filter]")
+{
+  SECTION ("Git diff")
+  {
+    auto const filter {parse_line_filter ("diff --git a/src/foo.c b/src/foo.c\n"
+                                          "index 1111111..2222222 100644\n"
+                                          "--- a/src/foo.c\n"
+                                          "+++ b/src/foo.c\n"
+                                          "@@ -10,4 +10,5 @@ some_function (void)\n"
+                                          " context\n"
+                                          "-removed\n"
+                                          "--- removed line looking like a header\n"
+                                          "+added\n"
+                                          "+++ added line looking like a header\n"
+                                          "+added\n"
+                                          " context\n"
+                                          "@@ -40 +41,0 @@\n"
+                                          "-removed\n"
+                                          "diff --git a/gone.c b/gone.c\n"
+                                          "deleted file mode 100644\n"
+                                          "--- a/gone.c\n"
+                                          "+++ /dev/null\n"
+                                          "@@ -1 +0,0 @@\n"
+                                          "-removed\n"
+                                          "diff --git a/new.c b/new.c\n"
+                                          "--- /dev/null\n"
+                                          "+++ b/new.c\n"
+                                          "@@ -0,0 +1,2 @@\n"
+                                          "+added\n"
+                                          "+added\n"
+                                          "\\ No newline at end of file\n")};
+
+    REQUIRE (filter);
+    CHECK (*filter == LineFilter {
+        {"src/foo.c", {{11u, 13u}}},
+        {"new.c", {{1u, 2u}}},
+      });
+  }
+
+  SECTION ("Plain diff")
+  {
+    auto const filter {parse_line_filter ("--- foo.c.orig\t2019-01-01 00:00:00\n"
+                                          "+++ foo.c\t2019-01-01 00:00:01\n"
+                                          "@@ -1,2 +1,2 @@\n"
+                                          "+added\n"
+                                          " context\n"
+                                          "-removed\n")};
+
+    REQUIRE (filter);
+    CHECK (*filter == LineFilter {{"foo.c", {{1u, 1u}}}});
+  }
+
+  SECTION ("Malformed")
+  {
+    // Too many lines in the hunk.
+    CHECK_FALSE (parse_unified_diff ("+++ b/foo.c\n@@ -1 +1 @@\n+added\n+added\n"));
+    // Too few lines in the hunk.
+    CHECK_FALSE (parse_unified_diff ("+++ b/foo.c\n@@ -1,2 +1,2 @@\n context\n"));
+    CHECK_FALSE (parse_unified_diff ("+++ b/foo.c\n@@ -1 +x @@\n+added\n"));
+    CHECK_FALSE (parse_unified_diff ("+++ b/foo.c\n@@ -1 +1 @@\n?what\n"));
+  }
+}
+
+TEST_CASE ("Line ranges", "[source-filter]")
+{
+  auto const filter {parse_line_filter ("src/foo.c:10-20\n"
+                                        "\n"
+                                        "src/foo.c:21\n"
+                                        "src/foo.c:5-7\n"
+                                        "C:/odd/path.c:3")};
+
+  REQUIRE (filter);
+  CHECK (*filter == LineFilter {
+      {"src/foo.c", {{5u, 7u}, {10u, 21u}}},
+      {"C:/odd/path.c", {{3u, 3u}}},
+    });
+
+  CHECK_FALSE (parse_line_ranges ("foo.c\n"));
+  CHECK_FALSE (parse_line_ranges (":1\n"));
+  CHECK_FALSE (parse_line_ranges ("foo.c:2-1\n"));
+  CHECK_FALSE (parse_line_ranges ("foo.c:x\n"));
+}
+
+TEST_CASE ("Line filter", "[source-filter]")
+{
+  LineFilter const filter {
+    {"src/foo.c", {{5u, 7u}, {10u, 21u}}},
+  };
+
+  CHECK (lines_are_wanted (filter, "src/foo.c", 5u, 5u));
+  CHECK (lines_are_wanted (filter, "src/foo.c", 1u, 5u));
+  CHECK (lines_are_wanted (filter, "src/foo.c", 8u, 10u));
+  CHECK (lines_are_wanted (filter, "src/foo.c", 21u, 100u));
+  CHECK_FALSE (lines_are_wanted (filter, "src/foo.c", 1u, 4u));
+  CHECK_FALSE (lines_are_wanted (filter, "src/foo.c", 8u, 9u));
+  CHECK_FALSE (lines_are_wanted (filter, "src/foo.c", 22u, 100u));
+  CHECK (lines_are_wanted (filter, "/home/me/project/src/foo.c", 6u, 6u));
+  CHECK (lines_are_wanted (filter, "../src/foo.c", 6u, 6u));
+  CHECK_FALSE (lines_are_wanted (filter, "/home/me/project/xsrc/foo.c", 6u, 6u));
+  CHECK_FALSE (lines_are_wanted (filter, "foo.c", 6u, 6u));
+  CHECK_FALSE (lines_are_wanted (filter, "src/bar.c", 6u, 6u));
+}
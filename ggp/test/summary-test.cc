@@ -0,0 +1,230 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/summary.hh"
+
+#include "catch.hpp"
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+auto
+make_summary () -> UnitSummary
+{
+  UnitSummary summary;
+
+  summary.sinks.push_back ({"g_variant_new_va", FormatUse::New, 1u, 2u, true});
+  summary.sinks.push_back ({"g_variant_get", FormatUse::Get, 2u, 3u, false});
+
+  // void my_new (char const* prefix, char const* format, ...)
+  // { va_list ap; …; g_variant_new_va (format, &ap); … }
+  FunctionSummary my_new {"my_new", 2u, true, {}, {}};
+  my_new.passes.push_back ({2u, "g_variant_new_va", 1u});
+
+  // void my_new_twice (char const* format, ...) { …; my_new ("x", format, …); }
+  FunctionSummary my_new_twice {"my_new_twice", 1u, true, {}, {}};
+  my_new_twice.passes.push_back ({1u, "my_new", 2u});
+
+  // void my_get (GVariant* v, char const* format) { g_variant_get (v, format, …); }
+  FunctionSummary my_get {"my_get@lib.c", 2u, false, {}, {}};
+  my_get.passes.push_back ({2u, "g_variant_get", 2u});
+
+  FunctionSummary caller {"caller", 0u, false, {}, {}};
+  caller.calls.push_back ({"my_new", 2u, "(ii)", "main.c", 10u, 3u, "pppii"});
+  caller.calls.push_back ({"my_new", 2u, "(ii)", "main.c", 11u, 3u, "ppid"});
+  caller.calls.push_back ({"my_new", 2u, "(ii)", "main.c", 12u, 3u, "ppi"});
+  caller.calls.push_back ({"my_new_twice", 1u, "((", "main.c", 13u, 3u, "p"});
+  caller.calls.push_back ({"my_get@lib.c", 2u, "(ii)", "main.c", 14u, 3u, "pp"});
+  caller.calls.push_back ({"my_new", 1u, "(ii)", "main.c", 15u, 3u, "ppii"});
+  caller.calls.push_back ({"g_variant_get", 2u, "s", "main.c", 16u, 3u, "ppp"});
+
+  summary.functions.push_back (std::move (caller));
+  summary.functions.push_back (std::move (my_new_twice));
+  summary.functions.push_back (std::move (my_get));
+  summary.functions.push_back (std::move (my_new));
+
+  return summary;
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Summary serialization", "[summary]")
+{
+  SECTION ("Round trip")
+  {
+    auto summary {make_summary ()};
+
+    summary.functions.front ().calls.front ().literal = "a\tb\nc\\d";
+    summary.functions.front ().calls.front ().file = "dir with\ttab/main.c";
+
+    auto const contents {summary_to_string (summary)};
+    auto const parsed {parse_summary (contents)};
+
+    REQUIRE (parsed);
+    CHECK (*parsed == summary);
+    CHECK (contents.find ("a\\tb\\nc\\\\d") != std::string::npos);
+  }
+
+  SECTION ("Empty summary")
+  {
+    auto const contents {summary_to_string ({})};
+
+    CHECK (contents == "ggp-summary 1\n");
+    CHECK (parse_summary (contents) == UnitSummary {});
+  }
+
+  SECTION ("Malformed summaries")
+  {
+    CHECK_FALSE (parse_summary (""));
+    CHECK_FALSE (parse_summary ("ggp-summary 2\n"));
+    CHECK_FALSE (parse_summary ("ggp-check 1\n"));
+    CHECK_FALSE (parse_summary ("ggp-summary 1\npass\t1\tf\t1\n"));
+    CHECK_FALSE (parse_summary ("ggp-summary 1\nfunction\tf\t1\t0"));
+    CHECK_FALSE (parse_summary ("ggp-summary 1\nfunction\tf\t1\t2\n"));
+    CHECK_FALSE (parse_summary ("ggp-summary 1\nsink\tf\tset\t1\t2\t0\n"));
+    CHECK_FALSE (parse_summary ("ggp-summary 1\nfunction\tf\t1\t0\ncall\tg\t1\tmain.c\t1\t1\tp\n"));
+    CHECK_FALSE (parse_summary ("ggp-summary 1\nfunction\tf\\x\t1\t0\n"));
+    CHECK_FALSE (parse_summary ("ggp-summary 1\nfoo\n"));
+  }
+}
+
+TEST_CASE ("Summary merging", "[summary]")
+{
+  UnitSummary first;
+  UnitSummary second;
+
+  first.sinks.push_back ({"g_variant_new", FormatUse::New, 1u, 2u, false});
+  first.functions.push_back ({"inline_helper", 1u, false, {{1u, "g_variant_new", 1u}}, {}});
+  first.functions.push_back ({"local@a.c", 0u, false, {}, {}});
+  second.sinks.push_back ({"g_variant_new", FormatUse::New, 1u, 2u, false});
+  second.sinks.push_back ({"g_variant_get", FormatUse::Get, 2u, 3u, false});
+  second.functions.push_back ({"inline_helper", 1u, false, {{1u, "g_variant_new", 1u}}, {}});
+  second.functions.push_back ({"local@b.c", 0u, false, {}, {}});
+
+  auto const merged {merge_summaries ({first, second})};
+
+  REQUIRE (merged.sinks.size () == 2u);
+  CHECK (merged.sinks[0].function == "g_variant_new");
+  CHECK (merged.sinks[1].function == "g_variant_get");
+  REQUIRE (merged.functions.size () == 3u);
+  CHECK (merged.functions[0].name == "inline_helper");
+  CHECK (merged.functions[1].name == "local@a.c");
+  CHECK (merged.functions[2].name == "local@b.c");
+}
+
+TEST_CASE ("Wrappers", "[summary]")
+{
+  SECTION ("Chains of wrappers")
+  {
+    auto const wrappers {find_wrappers (make_summary ())};
+
+    REQUIRE (wrappers.size () == 3u);
+    // The callees are visited first.
+    CHECK (wrappers[0] == FormatSink {"my_new", FormatUse::New, 2u, 3u, false});
+    CHECK (wrappers[1] == FormatSink {"my_new_twice", FormatUse::New, 1u, 0u, false});
+    CHECK (wrappers[2] == FormatSink {"my_get@lib.c", FormatUse::Get, 2u, 0u, false});
+  }
+
+  SECTION ("Recursion")
+  {
+    UnitSummary summary;
+
+    summary.sinks.push_back ({"g_variant_new", FormatUse::New, 1u, 2u, false});
+    summary.functions.push_back ({"ping", 1u, false, {{1u, "pong", 1u}}, {}});
+    summary.functions.push_back ({"pong", 1u, false, {{1u, "ping", 1u}, {1u, "g_variant_new", 1u}}, {}});
+
+    auto const wrappers {find_wrappers (summary)};
+
+    REQUIRE (wrappers.size () == 2u);
+    CHECK (wrappers[0].function == "pong");
+    CHECK (wrappers[1].function == "ping");
+  }
+
+  SECTION ("Unknown callees")
+  {
+    UnitSummary summary;
+
+    summary.functions.push_back ({"f", 1u, false, {{1u, "printf", 1u}}, {}});
+
+    CHECK (find_wrappers (summary).empty ());
+  }
+}
+
+TEST_CASE ("Wrapper calls", "[summary]")
+{
+  auto const summary {make_summary ()};
+  auto const wrappers {find_wrappers (summary)};
+  auto const diagnostics {check_wrapper_calls (summary, wrappers)};
+
+  REQUIRE (diagnostics.size () == 4u);
+
+  CHECK (diagnostics[0].rule == "wpa-args-count");
+  CHECK (diagnostics[0].line == 10u);
+  CHECK (diagnostics[0].message == "expected 2 parameters for my_new, got 3");
+
+  CHECK (diagnostics[1].rule == "wpa-arg-kind");
+  CHECK (diagnostics[1].line == 11u);
+  CHECK (diagnostics[1].arg_index == std::optional<std::uint32_t> {1u});
+  CHECK (diagnostics[1].expected_type == "int");
+  CHECK (diagnostics[1].actual_type == "double");
+
+  CHECK (diagnostics[2].rule == "wpa-args-count");
+  CHECK (diagnostics[2].line == 12u);
+
+  CHECK (diagnostics[3].rule == "wpa-invalid-format");
+  CHECK (diagnostics[3].line == 13u);
+  CHECK (diagnostics[3].format == "((");
+  CHECK (diagnostics[3].message == "invalid variant format passed to my_new_twice");
+}
+
+TEST_CASE ("Literal zeros in wrapper calls", "[summary]")
+{
+  auto summary {make_summary ()};
+  auto& caller {summary.functions.front ()};
+
+  caller.calls.clear ();
+  // my_new ("x", "(xs)", (gint64) 0, NULL);
+  caller.calls.push_back ({"my_new", 2u, "(xs)", "main.c", 20u, 3u, "pp00"});
+  // my_new ("x", "(id)", 0L, 0.0);
+  caller.calls.push_back ({"my_new", 2u, "(id)", "main.c", 21u, 3u, "pp0d"});
+
+  auto const diagnostics {check_wrapper_calls (summary, find_wrappers (summary))};
+
+  REQUIRE (diagnostics.size () == 1u);
+  CHECK (diagnostics[0].rule == "wpa-arg-kind");
+  CHECK (diagnostics[0].line == 21u);
+  CHECK (diagnostics[0].arg_index == std::optional<std::uint32_t> {0u});
+  CHECK (diagnostics[0].expected_type == "int");
+  CHECK (diagnostics[0].actual_type == "literal zero");
+}
+
+TEST_CASE ("WPA report", "[summary]")
+{
+  auto const summary {make_summary ()};
+  auto const report {wpa_report_to_string (summary, find_wrappers (summary))};
+
+  CHECK (report ==
+         "ggp-wpa-report\n"
+         "functions\t4\n"
+         "wrappers\t3\n"
+         "format calls\t6\n"
+         "4\t(ii)\n"
+         "1\t((\n"
+         "1\ts\n");
+}
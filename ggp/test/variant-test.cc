@@ -574,3 +574,60 @@ TEST_CASE ("Variant formats are converted to variant types", "[variant]")
     CHECK (vf2t ("(@s&s)") == vt ("(ss)"));
   }
 }
+
+namespace
+{
+
+auto
+fa (char const* str) -> FormatArg {
+  auto v {VariantFormat::from_string (str)};
+
+  REQUIRE (v);
+
+  return {{std::move (*v)}};
+}
+
+auto
+vf2a (char const* str) -> std::vector<FormatArg> {
+  auto v {VariantFormat::from_string (str)};
+
+  REQUIRE (v);
+
+  return args_for_format (*v);
+}
+
+auto flag_a {FormatArg {{VF::maybe_flag}}};
+
+} // anonymous namespace
+
+TEST_CASE ("Variant formats are split into arguments", "[variant]")
+{
+  SECTION ("simple formats")
+  {
+    CHECK (vf2a ("b") == std::vector {fa ("b")});
+    CHECK (vf2a ("s") == std::vector {fa ("s")});
+    CHECK (vf2a ("&s") == std::vector {fa ("&s")});
+    CHECK (vf2a ("^as") == std::vector {fa ("^as")});
+    CHECK (vf2a ("^a&s") == std::vector {fa ("^a&s")});
+    CHECK (vf2a ("aa{sv}") == std::vector {fa ("aa{sv}")});
+  }
+
+  SECTION ("maybe formats")
+  {
+    CHECK (vf2a ("ms") == std::vector {fa ("ms")});
+    CHECK (vf2a ("m&s") == std::vector {fa ("m&s")});
+    CHECK (vf2a ("mb") == std::vector {flag_a, fa ("b")});
+    CHECK (vf2a ("m(bs)") == std::vector {flag_a, fa ("b"), fa ("s")});
+    CHECK (vf2a ("mmb") == std::vector {flag_a, flag_a, fa ("b")});
+  }
+
+  SECTION ("tuple and entry formats")
+  {
+    CHECK (vf2a ("()").empty ());
+    CHECK (vf2a ("(s&s)") == std::vector {fa ("s"), fa ("&s")});
+    CHECK (vf2a ("(b(ss))") == std::vector {fa ("b"), fa ("s"), fa ("s")});
+    CHECK (vf2a ("{&sv}") == std::vector {fa ("&s"), fa ("v")});
+    CHECK (vf2a ("{@sv}") == std::vector {fa ("@s"), fa ("v")});
+    CHECK (vf2a ("{?(bb)}") == std::vector {fa ("@?"), fa ("b"), fa ("b")});
+  }
+}
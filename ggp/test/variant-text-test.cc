@@ -0,0 +1,173 @@
+/* This file is part of glib-gcc-plugin.
+ *
+ * Copyright 2019 Krzesimir Nowak
+ *
+ * gcc-glib-plugin is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * gcc-glib-plugin is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gcc-glib-plugin. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ggp/test/generated/serialize.hh"
+#include "ggp/test/generated/variant-print.hh"
+#include "ggp/test/generated/variant-text.hh"
+
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace Ggp::Lib;
+
+namespace
+{
+
+using Bytes = std::vector<std::uint8_t>;
+
+struct Parsed
+{
+  std::string type;
+  Bytes data;
+};
+
+// The type and the data GLib would give for g_variant_parse, as on a
+// little endian machine.
+auto
+parse (char const* text) -> std::optional<Parsed>
+{
+  auto maybe_value {parse_variant_text (text)};
+
+  if (!maybe_value)
+  {
+    return {};
+  }
+
+  std::ostringstream oss;
+
+  oss << maybe_value->type ();
+
+  return {{oss.str (), serialize (*maybe_value, ByteOrder::Little)}};
+}
+
+struct TextCase
+{
+  char const* text;
+  char const* type;
+  Bytes data;
+};
+
+auto
+check_cases (std::vector<TextCase> const& cases) -> void
+{
+  for (auto const& text_case : cases)
+  {
+    INFO (text_case.text);
+
+    auto const maybe_parsed {parse (text_case.text)};
+
+    REQUIRE (maybe_parsed);
+    CHECK (maybe_parsed->type == text_case.type);
+    CHECK (maybe_parsed->data == text_case.data);
+  }
+}
+
+} // anonymous namespace
+
+TEST_CASE ("Basic values in the text format", "[variant-text]")
+{
+  check_cases ({
+    {"5", "i", {0x05, 0x00, 0x00, 0x00}},
+    {"-5", "i", {0xfb, 0xff, 0xff, 0xff}},
+    {"0x10", "i", {0x10, 0x00, 0x00, 0x00}},
+    {"010", "i", {0x08, 0x00, 0x00, 0x00}},
+    {"2.5", "d", {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x40}},
+    {"-inf", "d", {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0xff}},
+    {"1e-400", "d", {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {"true", "b", {0x01}},
+    {"byte 255", "y", {0xff}},
+    {"int16 -32768", "n", {0x00, 0x80}},
+    {"uint64 18446744073709551615", "t", {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}},
+    {"'hello'", "s", {0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x00}},
+    {"\"it's\"", "s", {0x69, 0x74, 0x27, 0x73, 0x00}},
+    {"'a\\u00e9b'", "s", {0x61, 0xc3, 0xa9, 0x62, 0x00}},
+    {"objectpath '/a/b'", "o", {0x2f, 0x61, 0x2f, 0x62, 0x00}},
+    {"signature 'a{sv}'", "g", {0x61, 0x7b, 0x73, 0x76, 0x7d, 0x00}},
+    {"b'abc'", "ay", {0x61, 0x62, 0x63, 0x00}},
+    {"b\"x\\101\"", "ay", {0x78, 0x41, 0x00}},
+    // Like g_variant_new_bytestring, GLib stops at the first zero byte.
+    {"b\"ab\\0c\"", "ay", {0x61, 0x62, 0x00}},
+    {"b'\\0'", "ay", {0x00}},
+  });
+}
+
+TEST_CASE ("Container values in the text format", "[variant-text]")
+{
+  check_cases ({
+    {"[1, 2, 3]", "ai", {0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00}},
+    {"(1,)", "(i)", {0x01, 0x00, 0x00, 0x00}},
+    {"()", "()", {0x00}},
+    {"(1, 'a', true)", "(isb)", {0x01, 0x00, 0x00, 0x00, 0x61, 0x00, 0x01, 0x06}},
+    {"{1, 'a'}", "{is}", {0x01, 0x00, 0x00, 0x00, 0x61, 0x00}},
+    {"{'a': <1>, 'b': <'x'>}", "a{sv}", {0x61, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                         0x01, 0x00, 0x00, 0x00, 0x00, 0x69, 0x02, 0x00,
+                                         0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                         0x78, 0x00, 0x00, 0x73, 0x02, 0x0f, 0x1d}},
+    {"[<1>, <'a'>]", "av", {0x01, 0x00, 0x00, 0x00, 0x00, 0x69, 0x00, 0x00, 0x61, 0x00, 0x00, 0x73, 0x06, 0x0c}},
+    {"<@t 7>", "v", {0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x74}},
+    {"@a{sv} {}", "a{sv}", {}},
+    {"@as []", "as", {}},
+  });
+}
+
+TEST_CASE ("Types are inferred from the whole text", "[variant-text]")
+{
+  check_cases ({
+    {"[1, 2.5]", "ad", {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x40}},
+    {"[@u 1, 2]", "au", {0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00}},
+    {"just 5", "mi", {0x05, 0x00, 0x00, 0x00}},
+    {"@mi nothing", "mi", {}},
+    {"@mi 5", "mi", {0x05, 0x00, 0x00, 0x00}},
+    {"[just 1, nothing]", "ami", {0x01, 0x00, 0x00, 0x00, 0x04, 0x04}},
+  });
+}
+
+TEST_CASE ("Invalid texts are rejected like in GLib", "[variant-text]")
+{
+  for (auto text : {"(1)", "{}", "[]", "nothing", "int16 32768", "objectpath 'bad'",
+                    "[1, 'a']", "{[1]: 2}", "(1, 2,)", "[1,]", "1 2", "'abc", "foo",
+                    "2.5 5", "byte 2.5", "@s 5", "<1", "1e400", "@d -1e400",
+                    "{'a': [], 'b': [nothing, just true]}"})
+  {
+    INFO (text);
+    CHECK_FALSE (parse_variant_text (text));
+  }
+}
+
+TEST_CASE ("Positional parameters are not supported", "[variant-text]")
+{
+  CHECK_FALSE (parse_variant_text ("%i"));
+  CHECK_FALSE (parse_variant_text ("(%s, 1)"));
+}
+
+TEST_CASE ("Values are counted with the nested ones", "[variant-text]")
+{
+  auto count {[](char const* text)
+              {
+                auto maybe_value {parse_variant_text (text)};
+
+                REQUIRE (maybe_value);
+
+                return count_values (*maybe_value);
+              }};
+
+  CHECK (count ("5") == 1u);
+  CHECK (count ("[1, 2, 3]") == 4u);
+  CHECK (count ("{'a': <1>, 'b': <'x'>}") == 9u);
+  CHECK (count ("@mi 5") == 2u);
+}